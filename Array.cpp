@@ -5,8 +5,18 @@
 #include "Struct.cpp"
 #include "Typing.cpp"
 
+Array::~Array() {
+  dismantle();
+}
+
+void Array::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, len);
+  hand_over(pending, init);
+  Expression::release(pending);
+}
+
 bool Array::is_arr_literal(Stream &stream, const size_t &start_index) {
-  return stream.is_next(start_index, [](const Token token) {
+  return stream.is_next(start_index, [](const Token &token) {
     return 
       token.is_given_kind(Token::Kind::LITERAL) &&
       token.data == "[]";
@@ -22,7 +32,7 @@ PeekPtr<Array> Array::build(Stream &stream, const size_t &start_index) {
 
   Peek<Typing> typing = Typing::build(stream, start_index);
 
-  bool has_init = stream.is_next(typing.end_index, [](const Token token) {
+  bool has_init = stream.is_next(typing.end_index, [](const Token &token) {
     return token.is_given_marker(Marker::LEFT_BRACE);
   });
 
@@ -53,24 +63,25 @@ PeekPtr<Array> Array::build(Stream &stream, const size_t &start_index) {
   }
 
   result.data->variant = Expression::Variant::LITERAL;
+  result.data->literal = Token::Literal::ARRAY;
   return result;
 }
 
-void Array::print(size_t indent) const {
+void Array::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Array Literal {");
-  println(indentation + "  type: " + typing.to_string(indent + 1));
-  println(indentation + "  value: " + value);
+  printer.line(indentation + "Array Literal {");
+  printer.line(indentation + "  type: " + typing.to_string(indent + 1));
+  printer.line(indentation + "  value: " + value);
 
   if (len) {
-    println(indentation + "  len: " + len->to_string(indent + 1));
+    printer.line(indentation + "  len: " + len->to_string(indent + 1));
   }
 
   if (init) {
-    println(indentation + "  init: " + init->to_string(indent + 1));
+    printer.line(indentation + "  init: " + init->to_string(indent + 1));
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
 std::string Array::to_string(size_t indent) const {
@@ -90,4 +101,20 @@ std::string Array::to_string(size_t indent) const {
   result += indentation + "}";
 
   return result;
+}
+
+void Array::write_source(std::string &output) const {
+  output += typing.value;
+
+  if (len) {
+    output += " { len: ";
+    len->write_source(output);
+
+    if (init) {
+      output += ", init: ";
+      init->write_source(output);
+    }
+
+    output += " }";
+  }
 }
\ No newline at end of file
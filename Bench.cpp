@@ -0,0 +1,1658 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "Bench.h"
+#include "Parser.cpp"
+#include "Checker.cpp"
+#include "Transpiler.cpp"
+#include "Session.cpp"
+#include "Pipeline.cpp"
+#include "Machine.cpp"
+#include "Json.cpp"
+#include "LanguageServer.cpp"
+
+const std::map<Bench::Phase, std::string> PHASE_NAME = {
+  {Bench::Phase::LEX, "lex"},
+  {Bench::Phase::PARSE, "parse"},
+  {Bench::Phase::CHECK, "check"},
+  {Bench::Phase::TRANSPILE, "transpile"},
+};
+
+// Phases faster than this at the largest size are too noisy to judge
+const double BENCH_NOISE_FLOOR = 0.0002;
+// Allowed slack over the slope n log n has across the same sizes, which also
+// absorbs cache and allocator effects as the inputs outgrow each cache level
+const double BENCH_TOLERANCE = 0.25;
+const size_t BENCH_REPETITIONS = 5;
+const size_t STRESS_PROGRAMS = 512;
+const size_t STRESS_ROUNDS = 4;
+const size_t LSP_BENCH_LINES = 50000;
+// Per keystroke, from sending the change to receiving its diagnostics
+const double LSP_BENCH_BUDGET = 0.010;
+// The file peak memory of the others is measured against
+const size_t STREAM_BENCH_BASELINE = 4 << 20;
+// Allowed growth of peak memory over the baseline, in bytes
+const size_t STREAM_BENCH_SLACK = 16 << 20;
+// Allowed slowdown of the pipeline over running the stages in turn, for noise
+const double PIPELINE_BENCH_TOLERANCE = 1.05;
+const size_t EMIT_BENCH_LINES = 400000;
+const size_t NATIVE_BENCH_ROUNDS = 100000;
+const double NATIVE_BENCH_SPEEDUP = 10;
+// The machine has to beat CPython by this much on the workload, and get a
+// small program from source to its last line within the startup budget
+const double MACHINE_BENCH_SPEEDUP = 2;
+const double MACHINE_BENCH_STARTUP = 0.001;
+const size_t INLINE_BENCH_ROUNDS = 1000000;
+// Python at -O2 has to beat -O0 by this much once the calls are inlined
+const double INLINE_BENCH_SPEEDUP = 1.2;
+// Recursion stays under Python's limit at -O0, and goes far past it once
+const size_t TAIL_BENCH_DEPTH = 900;
+const size_t TAIL_BENCH_ROUNDS = 2000;
+const size_t TAIL_BENCH_DEEP = 1000000;
+const double TAIL_BENCH_SPEEDUP = 1.2;
+
+std::string Bench::generate_operator_chain(size_t size) {
+  std::string source = "val total = 0";
+  for (size_t i = 0; i < size; i++) source += " + 1";
+  return source + "\n";
+}
+
+std::string Bench::generate_nested_blocks(size_t size) {
+  std::string source;
+  for (size_t i = 0; i < size; i++) source += "if true {\n";
+  source += "println(\"deep\")\n";
+  for (size_t i = 0; i < size; i++) source += "}\n";
+  return source;
+}
+
+std::string Bench::generate_else_if_chain(size_t size) {
+  std::string source = "val number = 0\nif number == 0 {\n  println(0)\n}";
+  for (size_t i = 1; i < size; i++) {
+    source += " else if number == " + std::to_string(i) + " {\n";
+    source += "  println(" + std::to_string(i) + ")\n}";
+  }
+  return source + " else {\n  println(number)\n}\n";
+}
+
+std::string Bench::generate_argument_list(size_t size) {
+  std::string source = "val name = \"Shawn\"\nprintln(name";
+  for (size_t i = 1; i < size; i++) source += ", name";
+  return source + ")\n";
+}
+
+std::string Bench::generate_str_injections(size_t size) {
+  std::string source = "val name = \"Shawn\"\nprintln(\"";
+  for (size_t i = 0; i < size; i++) source += "#name ";
+  return source + "\")\n";
+}
+
+std::string Bench::generate_property_chain(size_t size) {
+  std::string source = "struct Person {\n  name str\n}\nval person = Person { name: \"Shawn\" }\nval name = person";
+  for (size_t i = 0; i < size; i++) source += ":name";
+  return source + "\n";
+}
+
+std::string Bench::generate_program(size_t seed) {
+  std::string id = std::to_string(seed);
+  std::string source;
+
+  source += "fn greet_" + id + "(name str, times int) {\n";
+  source += "  for index in times {\n";
+  source += "    println(\"#index: Hello #name from " + id + " {" + id + "}\")\n";
+  source += "  }\n";
+  source += "}\n\n";
+  source += "val limit = " + std::to_string(seed % 13) + "\n";
+  source += "var count = 0\n";
+  source += generate_operator_chain(seed % 50);
+  source += "if limit > 6 {\n  greet_" + id + "(\"Shawn\", limit)\n";
+  source += "} else if limit == 0 {\n  println(\"none\")\n";
+  source += "} else {\n  println(limit)\n}\n";
+  source += "match limit {\n  when 1 2 3 {\n    println(\"few\")\n  }\n";
+  source += "  else {\n    println(\"many\")\n  }\n}\n";
+  source += generate_nested_blocks(seed % 20);
+  source += "val names = []str { len: limit, init: \"name #it\" }\n";
+
+  if (seed % 7 == 0) {
+    source += "missing_" + id + " = count\n";
+    source += "val limit = 1\n";
+  }
+
+  return source;
+}
+
+std::vector<Bench::Axis> Bench::get_axes() {
+  return {
+    // Checking the chain chases a pointer per operand, which is bound by memory
+    // latency once the tree outgrows the caches, so sizes start past that point
+    {"operator chain", generate_operator_chain, {32000, 64000, 128000, 256000, 512000}},
+    {"nested blocks", generate_nested_blocks, {1000, 2000, 4000, 8000, 16000}},
+    {"else if chain", generate_else_if_chain, {1000, 2000, 4000, 8000, 16000}},
+    {"argument list", generate_argument_list, {8000, 16000, 32000, 64000, 128000}},
+    {"str injections", generate_str_injections, {32000, 64000, 128000, 256000, 512000}},
+    {"property chain", generate_property_chain, {8000, 16000, 32000, 64000, 128000}},
+  };
+}
+
+Bench::Sample Bench::measure(const std::string &source, size_t size) {
+  using Clock = std::chrono::steady_clock;
+
+  auto elapsed = [](Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  };
+
+  std::filesystem::path file_path = std::filesystem::temp_directory_path() / "pino_bench.pino";
+  Utils::write_file(file_path.string(), source);
+
+  Sample sample;
+  sample.size = size;
+
+  for (size_t i = 0; i < BENCH_REPETITIONS; i++) {
+    std::map<Phase, double> seconds;
+
+    Clock::time_point start = Clock::now();
+    Stream stream = Lexer::lex_file(file_path.string());
+    seconds[Phase::LEX] = elapsed(start);
+
+    start = Clock::now();
+    Statement program = Parser::build_program(stream);
+    seconds[Phase::PARSE] = elapsed(start);
+
+    start = Clock::now();
+    Checker checker(program);
+    seconds[Phase::CHECK] = elapsed(start);
+
+    start = Clock::now();
+    Transpiler transpiler;
+    sample.output_size = transpiler.emit(program).size();
+    seconds[Phase::TRANSPILE] = elapsed(start);
+
+    // Keep the fastest run of each phase to filter out scheduling noise
+    for (const auto &[phase, value] : seconds) {
+      if (i == 0 || value < sample.seconds[phase]) sample.seconds[phase] = value;
+    }
+  }
+
+  std::filesystem::remove(file_path);
+  return sample;
+}
+
+double Bench::fit_exponent(const std::vector<Sample> &samples, Phase phase) {
+  double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  double count = samples.size();
+
+  for (const Sample &sample : samples) {
+    // Emission is judged per byte written, since nested blocks need indentation
+    // that grows with depth no matter how the output is produced
+    double x = std::log(phase == Phase::TRANSPILE ? sample.output_size : sample.size);
+    double y = std::log(std::max(sample.seconds.at(phase), 1e-9));
+    sum_x += x;
+    sum_y += y;
+    sum_xx += x * x;
+    sum_xy += x * y;
+  }
+
+  return (count * sum_xy - sum_x * sum_y) / (count * sum_xx - sum_x * sum_x);
+}
+
+bool Bench::complexity() {
+  bool passed = true;
+
+  for (const Axis &axis : get_axes()) {
+    std::vector<Sample> samples;
+
+    // Diagnostics emitted while checking generated code are not part of the report
+    std::ostringstream discarded;
+    std::streambuf *previous = std::cout.rdbuf(discarded.rdbuf());
+
+    try {
+      for (size_t size : axis.sizes) {
+        samples.push_back(measure(axis.generate(size), size));
+      }
+    } catch (const std::exception &error) {
+      std::cout.rdbuf(previous);
+      println(axis.name + ": FAIL (" + error.what() + ")");
+      passed = false;
+      continue;
+    }
+
+    std::cout.rdbuf(previous);
+
+    // The budget is the slope n log n itself has across the same sizes
+    std::vector<Sample> reference;
+    for (size_t size : axis.sizes) {
+      Sample sample;
+      sample.size = size;
+      sample.output_size = size;
+      sample.seconds[Phase::LEX] = size * std::log(size);
+      reference.push_back(sample);
+    }
+    double budget = fit_exponent(reference, Phase::LEX) + BENCH_TOLERANCE;
+
+    println(axis.name + ":");
+
+    for (const auto &[phase, name] : PHASE_NAME) {
+      double exponent = fit_exponent(samples, phase);
+      double largest = samples.back().seconds.at(phase);
+      char line[128];
+
+      snprintf(
+        line, sizeof(line), "  %-10s n^%.2f  %10.3f ms  ",
+        name.c_str(), exponent, largest * 1000
+      );
+
+      // Every axis grows something the checker has to walk, so a check phase
+      // too fast to judge means it skipped the nodes
+      if (largest < BENCH_NOISE_FLOOR && phase == Phase::CHECK) {
+        println(std::string(line) + "FAIL (not walked)");
+        passed = false;
+      } else if (largest < BENCH_NOISE_FLOOR) {
+        println(std::string(line) + "skipped");
+      } else if (exponent > budget) {
+        println(std::string(line) + "FAIL");
+        passed = false;
+      } else {
+        println(std::string(line) + "ok");
+      }
+    }
+  }
+
+  return passed;
+}
+
+bool Bench::stress() {
+  using Clock = std::chrono::steady_clock;
+
+  // Everything a compilation hands back, diagnostics included
+  auto render = [](const Session &session) {
+    std::string result = session.output;
+    for (const Diagnostic &diagnostic : session.diagnostics.entries) {
+      result += "\n" + std::to_string(static_cast<int>(diagnostic.stage));
+      result += ":" + std::to_string(static_cast<int>(diagnostic.severity));
+      result += ":" + diagnostic.message;
+    }
+    return result;
+  };
+
+  std::vector<std::string> sources;
+  std::vector<std::string> expected;
+  Session reference;
+
+  for (size_t i = 0; i < STRESS_PROGRAMS; i++) {
+    sources.push_back(generate_program(i));
+    reference.compile(sources.back());
+    expected.push_back(render(reference));
+  }
+
+  size_t workers = std::max(1u, std::thread::hardware_concurrency());
+  size_t jobs = STRESS_PROGRAMS * STRESS_ROUNDS;
+  std::vector<std::string> results(jobs);
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+
+  Clock::time_point start = Clock::now();
+
+  for (size_t i = 0; i < workers; i++) {
+    threads.emplace_back([&]() {
+      Session session;
+      for (size_t job = next++; job < jobs; job = next++) {
+        session.compile(sources[job % STRESS_PROGRAMS]);
+        results[job] = render(session);
+      }
+    });
+  }
+
+  for (std::thread &thread : threads) thread.join();
+
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  size_t mismatches = 0;
+
+  for (size_t job = 0; job < jobs; job++) {
+    if (results[job] != expected[job % STRESS_PROGRAMS]) mismatches++;
+  }
+
+  char line[128];
+  snprintf(
+    line, sizeof(line), "stress: %zu compilations on %zu threads in %.3f s, %zu mismatched",
+    jobs, workers, seconds, mismatches
+  );
+  println(line);
+
+  return mismatches == 0;
+}
+
+void Bench::generate_statements(const std::string &path, size_t bytes) {
+  std::ofstream file(path);
+  size_t written = 0;
+
+  for (size_t seed = 1; written < bytes; seed++) {
+    if (seed % 7 == 0) continue;
+
+    std::string statement = "if true {\n";
+    std::istringstream body(generate_program(seed));
+
+    for (std::string line; std::getline(body, line);) {
+      statement += line.empty() ? "\n" : "  " + line + "\n";
+    }
+
+    statement += "}\n";
+    file << statement;
+    written += statement.size();
+  }
+}
+
+bool Bench::regressions() {
+  bool passed = true;
+
+  auto expect = [&passed](const std::string &name, bool is_held) {
+    println(name + ": " + (is_held ? "ok" : "FAIL"));
+    passed = passed && is_held;
+  };
+
+  // Lines of the definitions and references of a name, as the index reads them
+  auto find_symbol = [](const std::string &source, const std::string &name) {
+    Stream stream = Lexer::lex_source(source);
+    Statement program = Parser::build_program(stream);
+    Diagnostics diagnostics(false);
+    Symbols symbols;
+    Checker checker(program, &diagnostics, &symbols);
+
+    std::pair<std::vector<size_t>, std::vector<size_t>> lines;
+    for (const Symbols::Definition &definition : symbols.definitions) {
+      if (definition.name == name) lines.first.push_back(definition.line);
+    }
+    for (const Symbols::Reference &reference : symbols.references) {
+      if (reference.name == name) lines.second.push_back(reference.line);
+    }
+    return lines;
+  };
+
+  const std::string references =
+    "fn add(\n"
+    "  left int\n"
+    "  right int\n"
+    ") {\n"
+    "  return left + add(right, 0)\n"
+    "}\n"
+    "val total = add(1, 2)\n"
+    "val doubled = total + total * 2\n"
+    "println(add(doubled, total), \"#total\")\n";
+
+  auto add = find_symbol(references, "add");
+  expect("function defined once", add.first == std::vector<size_t>{0});
+  expect("recursive call referenced", add.second == std::vector<size_t>{4, 6, 8});
+
+  auto right = find_symbol(references, "right");
+  expect("parameter at its own line", right.first == std::vector<size_t>{2});
+  expect("parameter as call argument", right.second == std::vector<size_t>{4});
+
+  auto total = find_symbol(references, "total");
+  expect("operands, arguments and injections", total.second == std::vector<size_t>{7, 7, 8, 8});
+
+  // Statements split across lines, which streaming has to hand over whole
+  const std::string continued =
+    "val total = 1\n"
+    "  + 2\n"
+    "  * 3\n"
+    "var is_small = total > 6\n"
+    "  and total < 10\n"
+    "fn add(left int, right int) {\n"
+    "  return left\n"
+    "    + right\n"
+    "}\n"
+    "if is_small {\n"
+    "  println(add(total, 1))\n"
+    "}\n"
+    "else {\n"
+    "  println(total)\n"
+    "}\n";
+
+  Stream whole_stream = Lexer::lex_source(continued);
+  Statement whole = Parser::build_program(whole_stream);
+  std::string expected = Transpiler().emit(whole);
+
+  for (bool is_pipelined : {false, true}) {
+    std::istringstream input(continued);
+    Transpiler transpiler;
+    std::string output;
+    size_t count = 0;
+
+    Parser::parse_each(input, [&](Statement &program) {
+      output += transpiler.emit(program);
+      count += program.children.size();
+    }, is_pipelined);
+
+    std::string name = is_pipelined ? "pipelined" : "streamed";
+    expect(name + " lines opening with an operator", output == expected && count == whole.children.size());
+  }
+
+  // The lexer has to hand over the statements the whole file parses to, one each
+  const std::vector<std::string> splits = {
+    continued,
+    "struct Person {\n  name str\n}\nval person = Person {\n  name: \"Shawn\"\n}\n"
+    "val name = person\n  :name\nprintln(name)\n",
+    "fn greet(\n  name str\n  planet = \"Earth\"\n) {\n  return name\n}\n"
+    "greet(\n  \"Shawn\"\n  \"Mars\"\n)\nval limit = 3\nmatch limit {\n  when\n    1\n    2\n"
+    "  {\n    println(limit)\n  }\n  else {\n    println(0)\n  }\n}\n",
+  };
+
+  for (size_t i = 0; i < splits.size(); i++) {
+    Stream stream = Lexer::lex_source(splits[i]);
+    Statement program = Parser::build_program(stream);
+
+    std::vector<size_t> expected_lines;
+    for (const auto &child : program.children) expected_lines.push_back(child->line);
+
+    std::istringstream input(splits[i]);
+    std::vector<size_t> lines;
+    bool is_single = true;
+
+    Lexer::lex_each(input, [&](Stream &piece) {
+      lines.push_back(piece.front().line);
+      is_single = is_single && Parser::build_program(piece).children.size() == 1;
+    });
+
+    expect("lexed statements of split " + std::to_string(i + 1), is_single && lines == expected_lines);
+  }
+
+  // The language server cuts a document into chunks by the same rule
+  Document document;
+  document.open(continued);
+  expect("language server chunks", document.chunks.size() == whole.children.size());
+
+  // Bodies call what is declared below them, each other included, however the file is checked
+  const std::string forward =
+    "fn is_even(n int) {\n"
+    "  if n == 0 {\n"
+    "    return true\n"
+    "  }\n"
+    "  return is_odd(n - 1)\n"
+    "}\n"
+    "fn is_odd(n int) {\n"
+    "  if n == 0 {\n"
+    "    return false\n"
+    "  }\n"
+    "  return is_even(n - 1)\n"
+    "}\n"
+    "fn main {\n"
+    "  println(later(2), is_even(4))\n"
+    "}\n"
+    "fn later(n int) {\n"
+    "  return n * 2\n"
+    "}\n"
+    "main()\n";
+
+  Stream forward_stream = Lexer::lex_source(forward);
+  Statement forward_program = Parser::build_program(forward_stream);
+  Diagnostics forward_diagnostics(false);
+  bool is_accepted = true;
+
+  try {
+    Checker checker(forward_program, &forward_diagnostics);
+  } catch (const std::exception &) {
+    is_accepted = false;
+  }
+
+  expect("forward calls and mutual recursion checked whole", is_accepted);
+
+  std::string forward_base = std::filesystem::temp_directory_path().string() + "/pino-forward-" + std::to_string(getpid());
+  Utils::write_file(forward_base + ".pino", forward);
+
+  for (bool is_pipelined : {false, true}) {
+    Diagnostics compiled(false);
+    bool is_compiled = Pipeline::compile(forward_base + ".pino", forward_base + ".py", compiled, nullptr, nullptr, is_pipelined);
+    expect(std::string(is_pipelined ? "pipelined" : "streamed") + " forward calls and mutual recursion", is_compiled);
+  }
+
+  // Top level statements run in order, so they still can't
+  Utils::write_file(forward_base + ".pino", "println(later(2))\nfn later(n int) {\n  return n\n}\n");
+  Diagnostics early(false);
+  expect("top level call before the declaration", not Pipeline::compile(forward_base + ".pino", forward_base + ".py", early));
+
+  std::filesystem::remove(forward_base + ".pino");
+  std::filesystem::remove(forward_base + ".py");
+
+  // A return that recurses before any other can't have its type deduced in C++
+  const std::string recursive =
+    "fn depth(n int) {\n"
+    "  if n > 0 {\n"
+    "    return depth(n - 1) + 1\n"
+    "  }\n"
+    "  return 0\n"
+    "}\n"
+    "fn halve(x float) {\n"
+    "  if x > 1.0 {\n"
+    "    return halve(x / 2)\n"
+    "  }\n"
+    "  return x\n"
+    "}\n";
+
+  Stream recursive_stream = Lexer::lex_source(recursive);
+  Statement recursive_program = Parser::build_program(recursive_stream);
+  Diagnostics diagnostics(false);
+  std::string native = CppTranspiler(&diagnostics).emit(recursive_program);
+
+  bool is_typed =
+    native.find("long long depth(long long n)") != std::string::npos &&
+    native.find("double halve(double x)") != std::string::npos;
+
+  expect("recursive return types", is_typed);
+
+  // mypyc is told what the same returns agree on, and nothing where a path can
+  // fall off the end without one
+  const std::string returning = recursive +
+    "fn show(n int) {\n"
+    "  println(n)\n"
+    "}\n"
+    "fn maybe(n int) {\n"
+    "  if n > 0 {\n"
+    "    return 1\n"
+    "  }\n"
+    "}\n";
+
+  Stream returning_stream = Lexer::lex_source(returning);
+  Statement returning_program = Parser::build_program(returning_stream);
+  std::string annotated = Transpiler(&diagnostics, Transpiler::Mode::ANNOTATED).emit(returning_program);
+
+  bool is_annotated =
+    annotated.find("def depth(n: int) -> int:") != std::string::npos &&
+    annotated.find("def halve(x: float) -> float:") != std::string::npos &&
+    annotated.find("def show(n: int) -> None:") != std::string::npos &&
+    annotated.find("def maybe(n: int):") != std::string::npos;
+
+  expect("mypyc return annotations", is_annotated);
+
+  // Python's evaluation order and and / or, which C++ leaves open or makes bools
+  const std::string semantics =
+    "var count = 0\n"
+    "fn tick() {\n"
+    "  count += 1\n"
+    "  return count\n"
+    "}\n"
+    "fn sub(a int, b int) {\n"
+    "  return a - b\n"
+    "}\n"
+    "println(0 or 5, 3 and 0, \"\" or \"x\")\n"
+    "println(3 > 2 > 1, 1 < 2 == true, 1 < 3 < 2)\n"
+    "println(sub(tick(), tick()))\n"
+    "var big = 9223372036854775806\n"
+    "big += 1\n"
+    "println(big)\n"
+    "big += 1\n";
+
+  if (std::system("command -v g++ > /dev/null") == 0) {
+    std::string base = std::filesystem::temp_directory_path().string() + "/pino-semantics-" + std::to_string(getpid());
+    Utils::write_file(base + ".pino", semantics);
+
+    Diagnostics semantic(false);
+    bool is_built =
+      Pipeline::compile(base + ".pino", base + ".cpp", semantic, nullptr, nullptr, false, Pipeline::Target::CPP) &&
+      std::system(("g++ -std=c++17 -w " + base + ".cpp -o " + base + " 2> /dev/null").c_str()) == 0;
+
+    // The last addition overflows, which stops the program instead of wrapping
+    bool is_raised = is_built && std::system((base + " > " + base + ".out 2> /dev/null").c_str()) != 0;
+
+    expect(
+      "c++ evaluates as python does",
+      is_raised && Utils::read_file(base + ".out") ==
+        "5 0 x\n"
+        "True False False\n"
+        "-1\n"
+        "9223372036854775807\n"
+    );
+
+    for (const std::string extension : {".pino", ".cpp", ".out", ""}) std::filesystem::remove(base + extension);
+
+    // Libraries build under a cache path a shell would split, and the stubs of
+    // a module share one set of imports
+    std::string cache = base + " cache; x";
+    const char *outer = std::getenv("PINO_CACHE");
+    std::string kept = outer ? outer : "";
+    setenv("PINO_CACHE", cache.c_str(), 1);
+
+    Utils::write_file(
+      base + ".pino",
+      "@native fn twice(n int) {\n  return n * 2\n}\n"
+      "@native fn half(x float) {\n  return x / 2\n}\n"
+      "println(twice(2), half(1.0))\n"
+    );
+
+    Diagnostics native(false);
+    bool is_native = Pipeline::compile(base + ".pino", base + ".py", native);
+    std::string stubs = is_native ? Utils::read_file(base + ".py") : "";
+    size_t imports = 0;
+    for (size_t at = stubs.find("import ctypes"); at != std::string::npos; at = stubs.find("import ctypes", at + 1)) imports++;
+
+    expect("native builds under any path, importing once", is_native && imports == 1);
+
+    if (outer) setenv("PINO_CACHE", kept.c_str(), 1);
+    else unsetenv("PINO_CACHE");
+
+    std::filesystem::remove_all(cache);
+    std::filesystem::remove(base + ".pino");
+    std::filesystem::remove(base + ".py");
+  }
+
+  // What the machine prints of a program, or the error it stops at
+  auto run = [](const std::string &source) {
+    Stream stream = Lexer::lex_source(source);
+    Statement program = Parser::build_program(stream);
+    Diagnostics diagnostics(false);
+    Checker checker(&diagnostics);
+    checker.check(program);
+    Program compiled = Bytecode(&diagnostics).compile(program);
+
+    std::FILE *sink = std::tmpfile();
+    std::string printed;
+
+    try {
+      Machine machine(sink);
+      machine.execute(compiled);
+    } catch (const std::runtime_error &error) {
+      printed = error.what();
+    }
+
+    std::rewind(sink);
+    for (int character; (character = std::fgetc(sink)) != EOF;) printed += static_cast<char>(character);
+    std::fclose(sink);
+    return printed;
+  };
+
+  const std::string smallest = "val low = 0 - 9223372036854775807 - 1\nval m = 0 - 1\n";
+  expect("smallest integer modulo -1", run(smallest + "println(low % m)\nprintln(low % 3)\n") == "0\n1\n");
+  expect("integer overflow", run(smallest + "println(low * m)\n") == "USER: Integer Overflow");
+  expect("integer overflow on add", run(smallest + "println(low + m)\n") == "USER: Integer Overflow");
+
+  // The middle operand is compared with both sides, once, and the rest skipped
+  // as soon as one comparison fails
+  const std::string chained =
+    "var count = 0\n"
+    "fn tick() {\n"
+    "  count += 1\n"
+    "  return count\n"
+    "}\n"
+    "println(3 > 2 > 1, 1 < 2 == true, 1 < 3 < 2, 1 + 1 < 2 * 2 < 5 and true)\n"
+    "println(0 < tick() < 2, 1 < 0 < tick(), count)\n";
+
+  expect("chained comparisons", run(chained) == "True False False True\nTrue False 1\n");
+
+  // The .pyc prints what the .py does, under each Python there is to run it
+  const std::string loaded = generate_workload(50) +
+    "fn apply(f fn(int), n int) {\n  return f(n)\n}\n"
+    "val offset = 3\n"
+    "fn shift(x int) {\n  return x + offset\n}\n"
+    "println(apply(shift, 4))\n"
+    "val squares = []int { len: 5, init: it * it }\n"
+    "val words = []str { len: 3, init: \"w#it\" }\n"
+    "println(squares, len(squares), words)\n"
+    "println(7 % 3, 0 - 7 % 3, 7 / 2, 0.1 + 0.2, 1.5 * 10000000000000000.0, 2 > 1 and 3 > 2)\n"
+    "val name = \"pino\"\n"
+    "println(\"#name:#offset\", name:upper(), str(42) + \"!\", int(\"12\") + 1, float(\"2.5\"), bool(0))\n"
+    "var i = 0\n"
+    "for {\n  i += 1\n  if i == 3 {\n    continue\n  }\n  if i > 5 {\n    break\n  }\n  println(i)\n}\n";
+
+  std::string loaded_base = std::filesystem::temp_directory_path().string() + "/pino-pyc-" + std::to_string(getpid());
+  Utils::write_file(loaded_base + ".pino", loaded);
+
+  for (const std::string version : {"3.11", "3.12"}) {
+    std::string python = "python" + version;
+    if (std::system((python + " -c '' > /dev/null 2>&1").c_str()) != 0) continue;
+
+    Pyc::Version target;
+    Pyc::parse_version(version, target);
+    Diagnostics pyc(false);
+
+    bool is_compiled =
+      Pipeline::compile(loaded_base + ".pino", loaded_base + ".py", pyc) &&
+      Pipeline::compile(loaded_base + ".pino", loaded_base + ".pyc", pyc, nullptr, nullptr, false, Pipeline::Target::PYC, target);
+
+    bool is_run =
+      is_compiled &&
+      std::system((python + " " + loaded_base + ".py > " + loaded_base + ".py.out").c_str()) == 0 &&
+      std::system((python + " " + loaded_base + ".pyc > " + loaded_base + ".pyc.out").c_str()) == 0;
+
+    expect(
+      "pyc prints what the py does on " + python,
+      is_run && Utils::read_file(loaded_base + ".py.out") == Utils::read_file(loaded_base + ".pyc.out")
+    );
+  }
+
+  for (const std::string extension : {".pino", ".py", ".pyc", ".py.out", ".pyc.out"}) {
+    std::filesystem::remove(loaded_base + extension);
+  }
+
+  if (std::system("command -v python3 > /dev/null") != 0) return passed;
+
+  // What Python prints of a program at each -O level, along with what was emitted
+  struct Level {
+    std::string printed;
+    std::string emitted;
+  };
+
+  std::string level_base = std::filesystem::temp_directory_path().string() + "/pino-levels-" + std::to_string(getpid());
+
+  auto run_levels = [&level_base](const std::string &source, bool is_whole_program) {
+    std::vector<Level> levels;
+    Utils::write_file(level_base + ".pino", source);
+
+    for (int level = 0; level <= Optimizer::MAX_LEVEL; level++) {
+      Diagnostics diagnostics(false);
+      Optimizer optimizer(level, true, is_whole_program);
+
+      bool is_compiled = Pipeline::compile(
+        level_base + ".pino", level_base + ".py", diagnostics, nullptr, nullptr, false,
+        Pipeline::Target::PYTHON, Pyc::Version::PYTHON_3_11, &optimizer
+      );
+
+      bool is_run = is_compiled && std::system(("python3 " + level_base + ".py > " + level_base + ".out").c_str()) == 0;
+
+      levels.push_back({
+        is_run ? Utils::read_file(level_base + ".out") : "",
+        is_compiled ? Utils::read_file(level_base + ".py") : "",
+      });
+    }
+
+    for (const std::string extension : {".pino", ".py", ".out"}) std::filesystem::remove(level_base + extension);
+    return levels;
+  };
+
+  auto is_same = [](const std::vector<Level> &levels) {
+    return std::all_of(levels.begin(), levels.end(), [&levels](const Level &level) {
+      return not level.printed.empty() && level.printed == levels.front().printed;
+    });
+  };
+
+  auto has = [](const std::string &text, const std::string &part) {
+    return text.find(part) != std::string::npos;
+  };
+
+  // Folding reads through vals and injections, but not into a scope that
+  // declares the name again, and leaves what Python can't hold in 64 bits alone
+  const std::string folded =
+    "val a = 6\n"
+    "val b = a * 7\n"
+    "fn scope(a int) {\n  return a + b\n}\n"
+    "val name = \"pino\"\n"
+    "val m3 = 0 - 3\n"
+    "println(\"#name has #b\", scope(1), 7 % m3, 0.1 + 0.2, 1.5 * 10000000000000000.0)\n"
+    "val big = 9223372036854775807 + 1\n"
+    "println(big)\n";
+
+  std::vector<Level> fold_levels = run_levels(folded, false);
+  expect("folding prints the same at every level", is_same(fold_levels));
+
+  const std::string &fold_text = fold_levels[1].emitted;
+  expect(
+    "folding writes literals in place",
+    has(fold_text, "b = 42\n") &&
+    has(fold_text, "return a + 42\n") &&
+    has(fold_text, "print(\"pino has 42\", scope(1), -2, 0.30000000000000004, 1.5e+16)") &&
+    has(fold_text, "9223372036854775807 + 1") &&
+    has(fold_levels[0].emitted, "b = a * 7\n")
+  );
+
+  // Pruned are branches never taken, code after a return and literals never
+  // read, and with the whole program at hand functions never called too
+  const std::string dead =
+    "fn used(x int) {\n"
+    "  val unused = 5\n"
+    "  if false {\n    println(\"never\")\n  }\n"
+    "  return x * 2\n"
+    "  println(\"after\")\n"
+    "}\n"
+    "fn unreached() {\n  println(\"gone\")\n}\n"
+    "var total = 0\n"
+    "for i in 3 {\n  total = total + used(i)\n}\n"
+    "println(total)\n";
+
+  std::vector<Level> dead_levels = run_levels(dead, false);
+  std::vector<Level> whole_levels = run_levels(dead, true);
+  expect("dead code prints the same at every level", is_same(dead_levels) && is_same(whole_levels));
+
+  const std::string &dead_text = dead_levels[1].emitted;
+  expect(
+    "dead code is dropped",
+    has(dead_text, "def used(x):\n    return x * 2\n\n") &&
+    has(dead_text, "def unreached():") &&
+    not has(whole_levels[1].emitted, "def unreached():") &&
+    has(dead_levels[0].emitted, "print(\"after\")")
+  );
+
+  // Calls take the body in their place, unless an argument would need the
+  // parentheses Pino can't write to keep its precedence
+  const std::string inlined =
+    "fn twice(x int) {\n  return x * 2\n}\n"
+    "var sum = 0\n"
+    "for i in 5 {\n  sum = sum + twice(i) + twice(i + 1)\n}\n"
+    "println(sum, twice(sum))\n";
+
+  std::vector<Level> inline_levels = run_levels(inlined, false);
+  expect("inlining prints the same at every level", is_same(inline_levels));
+
+  const std::string &inline_text = inline_levels[2].emitted;
+  expect(
+    "inlining puts bodies in place of calls",
+    has(inline_text, "sum = sum + i * 2 + twice(i + 1)\n") &&
+    has(inline_text, "print(sum, sum * 2)\n") &&
+    has(inline_levels[1].emitted, "print(sum, twice(sum))\n")
+  );
+
+  // Calls to the function itself in return position become a loop, with
+  // every argument read before any parameter is assigned
+  const std::string tail =
+    "fn gcd(a int, b int) {\n  if b == 0 {\n    return a\n  }\n  return gcd(b, a % b)\n}\n"
+    "fn count(n int, total int) {\n  if n == 0 {\n    return total\n  }\n  return count(n - 1, total + n)\n}\n"
+    "println(gcd(1071, 462), count(500, 0))\n";
+
+  std::vector<Level> tail_levels = run_levels(tail, false);
+  expect("tail calls print the same at every level", is_same(tail_levels));
+
+  const std::string &tail_text = tail_levels[1].emitted;
+  expect(
+    "tail calls become loops",
+    has(tail_text, "def gcd(a, b):\n    while True:\n") &&
+    has(tail_text, "        a_next = b\n        b = a % b\n        a = a_next\n") &&
+    not has(tail_text, "return gcd(") &&
+    not has(tail_text, "return count(") &&
+    has(tail_levels[0].emitted, "return gcd(b, a % b)\n")
+  );
+
+  return passed;
+}
+
+bool Bench::streaming(size_t megabytes) {
+  using Clock = std::chrono::steady_clock;
+  std::string directory = std::filesystem::temp_directory_path().string();
+  bool passed = true;
+  long baseline = 0;
+
+  for (size_t bytes : {STREAM_BENCH_BASELINE, megabytes << 20}) {
+    std::string source_path = directory + "/pino-stream-" + std::to_string(getpid()) + ".pino";
+    std::string output_path = directory + "/pino-stream-" + std::to_string(getpid()) + ".py";
+    generate_statements(source_path, bytes);
+
+    Clock::time_point start = Clock::now();
+
+    // Peak memory is only ever reported for a whole process
+    pid_t child = fork();
+    if (child == 0) {
+      Diagnostics diagnostics(false);
+      _exit(Pipeline::compile(source_path, output_path, diagnostics) ? 0 : 1);
+    }
+
+    int status;
+    rusage usage;
+    wait4(child, &status, 0, &usage);
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t size = std::filesystem::file_size(source_path);
+    bool compiled = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    long peak = usage.ru_maxrss * 1024;
+
+    std::filesystem::remove(source_path);
+    std::filesystem::remove(output_path);
+
+    if (baseline == 0) baseline = peak;
+    bool is_bounded = peak <= baseline + static_cast<long>(STREAM_BENCH_SLACK);
+    if (not compiled || not is_bounded) passed = false;
+
+    char line[160];
+    snprintf(
+      line, sizeof(line), "stream: %8.1f MB in %7.3f s (%6.1f MB/s), peak %6.1f MB  %s",
+      size / 1048576.0, seconds, size / 1048576.0 / seconds, peak / 1048576.0,
+      not compiled ? "FAIL (errors)" : is_bounded ? "ok" : "FAIL (unbounded)"
+    );
+    println(line);
+  }
+
+  return passed;
+}
+
+bool Bench::pipelining(size_t megabytes) {
+  using Clock = std::chrono::steady_clock;
+  std::string path = std::filesystem::temp_directory_path().string();
+  path += "/pino-pipeline-" + std::to_string(getpid()) + ".pino";
+  generate_statements(path, megabytes << 20);
+
+  auto measure = [&](const std::function<void(std::istream &)> &run) {
+    double best = 0;
+
+    for (size_t i = 0; i < BENCH_REPETITIONS; i++) {
+      std::ifstream input(path);
+      Clock::time_point start = Clock::now();
+      run(input);
+
+      double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (i == 0 || seconds < best) best = seconds;
+    }
+
+    return best;
+  };
+
+  size_t statements = 0;
+  auto count = [&](Statement &) { statements++; };
+
+  double lex = measure([](std::istream &input) {
+    Lexer::lex_each(input, [](Stream &) {});
+  });
+  double serial = measure([&](std::istream &input) {
+    Parser::parse_each(input, count, false);
+  });
+  double pipelined = measure([&](std::istream &input) {
+    Parser::parse_each(input, [](Statement &) {}, true);
+  });
+
+  std::string output_path = path + ".py";
+  auto compile = [&](bool is_pipelined) {
+    return [&, is_pipelined](std::istream &) {
+      Diagnostics diagnostics(false);
+      Pipeline::compile(path, output_path, diagnostics, nullptr, nullptr, is_pipelined);
+    };
+  };
+
+  double compile_serial = measure(compile(false));
+  double compile_pipelined = measure(compile(true));
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(output_path);
+
+  // Parsing alone can't be timed without lexing first, so it is what serial adds
+  double parse = std::max(0.0, serial - lex);
+  bool has_cores = std::thread::hardware_concurrency() > 1;
+  bool passed = 
+    not has_cores || (
+      pipelined <= serial * PIPELINE_BENCH_TOLERANCE &&
+      compile_pipelined <= compile_serial * PIPELINE_BENCH_TOLERANCE
+    );
+  const char *verdict = not has_cores ? "skipped (one core)" : passed ? "ok" : "FAIL";
+
+  char line[200];
+  snprintf(
+    line, sizeof(line), 
+    "pipeline: %zu MB, %zu statements: lex %.3f s, parse %.3f s, serial %.3f s, "
+    "pipelined %.3f s (ideal %.3f s, %.2fx)",
+    megabytes, statements / BENCH_REPETITIONS, lex, parse, serial, pipelined, 
+    std::max(lex, parse), serial / pipelined
+  );
+  println(line);
+
+  snprintf(
+    line, sizeof(line), 
+    "pipeline: compile serial %.3f s, staged %.3f s (%.2fx)  %s",
+    compile_serial, compile_pipelined, compile_serial / compile_pipelined, verdict
+  );
+  println(line);
+
+  return passed;
+}
+
+bool Bench::emission() {
+  using Clock = std::chrono::steady_clock;
+  Stream stream = Lexer::lex_source(generate_document(EMIT_BENCH_LINES));
+  Statement program = Parser::build_program(stream);
+
+  // Past the core count too, so the splice is checked even on small machines
+  size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<size_t> job_counts = {1};
+  while (job_counts.back() < std::max<size_t>(cores, 4)) job_counts.push_back(job_counts.back() * 2);
+
+  std::string expected;
+  double serial = 0;
+  bool passed = true;
+
+  for (size_t jobs : job_counts) {
+    Transpiler transpiler;
+    std::string output;
+    double best = 0;
+
+    for (size_t i = 0; i < BENCH_REPETITIONS; i++) {
+      Clock::time_point start = Clock::now();
+      output = transpiler.emit(program, jobs);
+
+      double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (i == 0 || seconds < best) best = seconds;
+    }
+
+    if (jobs == 1) {
+      expected = output;
+      serial = best;
+    }
+
+    bool is_identical = output == expected;
+    if (not is_identical) passed = false;
+
+    char line[160];
+    snprintf(
+      line, sizeof(line), "emit: %zu statements, %2zu jobs in %.3f s (%.2fx)  %s",
+      program.children.size(), jobs, best, serial / best, is_identical ? "ok" : "FAIL (differs)"
+    );
+    println(line);
+  }
+
+  return passed;
+}
+
+std::string Bench::generate_workload(size_t rounds) {
+  std::string source;
+
+  source += "fn step(state int) {\n  return state * 1103515245 + 12345\n}\n\n";
+  source += "fn label(index int, name str) {\n  return \"#name-#index\"\n}\n\n";
+  source += "fn score(seed int, rounds int) {\n";
+  source += "  var state = seed\n  var total = 0\n  var round = 0\n";
+  source += "  for rounds {\n";
+  source += "    state = step(state) % 2147483648\n";
+  source += "    val bucket = state % 4\n";
+  source += "    match bucket {\n";
+  source += "      when 0 {\n        total += round\n      }\n";
+  source += "      when 1 2 {\n        total -= bucket\n      }\n";
+  source += "      else {\n        total += len(label(round, \"item\"))\n      }\n";
+  source += "    }\n";
+  source += "    round += 1\n";
+  source += "  }\n  return total\n}\n\n";
+  source += "var checksum = 0\n";
+  source += "for seed in 8 {\n  checksum += score(seed, " + std::to_string(rounds) + ")\n}\n";
+  source += "println(\"checksum #checksum\", checksum / 7)\n";
+  return source;
+}
+
+bool Bench::native() {
+  using Clock = std::chrono::steady_clock;
+
+  if (std::system("command -v g++ > /dev/null && command -v python3 > /dev/null") != 0) {
+    println("native: skipped (needs g++ and python3)");
+    return true;
+  }
+
+  std::string base = std::filesystem::temp_directory_path().string();
+  base += "/pino-native-" + std::to_string(getpid());
+  Utils::write_file(base + ".pino", generate_workload(NATIVE_BENCH_ROUNDS));
+
+  Diagnostics diagnostics(false);
+  bool compiled =
+    Pipeline::compile(base + ".pino", base + ".py", diagnostics) &&
+    Pipeline::compile(base + ".pino", base + ".cpp", diagnostics, nullptr, nullptr, false, Pipeline::Target::CPP);
+
+  Clock::time_point start = Clock::now();
+  compiled = compiled && std::system(("g++ -std=c++17 -O2 " + base + ".cpp -o " + base).c_str()) == 0;
+  double building = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (not compiled) {
+    println("native: FAIL (workload did not compile)");
+    return false;
+  }
+
+  auto measure = [&](const std::string &command, const std::string &output_path) {
+    double best = 0;
+
+    for (size_t i = 0; i < 3; i++) {
+      Clock::time_point start = Clock::now();
+      if (std::system((command + " > " + output_path).c_str()) != 0) return -1.0;
+
+      double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (i == 0 || seconds < best) best = seconds;
+    }
+
+    return best;
+  };
+
+  double python = measure("python3 " + base + ".py", base + ".python.out");
+  double binary = measure(base, base + ".native.out");
+
+  std::string expected = Utils::read_file(base + ".python.out");
+  bool is_identical = python >= 0 && binary >= 0 && expected == Utils::read_file(base + ".native.out");
+  bool passed = is_identical && python / binary >= NATIVE_BENCH_SPEEDUP;
+
+  char line[200];
+  snprintf(
+    line, sizeof(line), "native: python %.3f s, c++ %.3f s (%.1fx, g++ took %.2f s)  %s",
+    python, binary, python / binary, building,
+    not is_identical ? "FAIL (output differs)" : passed ? "ok" : "FAIL (too slow)"
+  );
+  println(line);
+
+  for (const char *extension : {".pino", ".py", ".cpp", "", ".python.out", ".native.out"}) {
+    std::filesystem::remove(base + extension);
+  }
+
+  return passed;
+}
+
+std::string Bench::generate_helper_calls(size_t rounds) {
+  std::string source;
+
+  source += "fn mix(hash int, value int) {\n  return hash * 31 + value\n}\n\n";
+  source += "fn wrap(value int) {\n  return value % 1000000007\n}\n\n";
+  source += "fn is_even(value int) {\n  return value % 2 == 0\n}\n\n";
+  source += "fn weight(value int) {\n  return value * value + 1\n}\n\n";
+  source += "fn churn(rounds int) {\n";
+  source += "  var hash = 7\n  var total = 0\n  var index = 0\n  var evens = 0\n";
+  source += "  for rounds {\n";
+  source += "    hash = mix(hash, index)\n";
+  source += "    hash = wrap(hash)\n";
+  source += "    if is_even(hash) {\n      total += weight(evens)\n      evens += 1\n    }\n";
+  source += "    index += 1\n";
+  source += "  }\n  return hash + total\n}\n\n";
+  source += "val checksum = churn(" + std::to_string(rounds) + ")\n";
+  source += "println(\"checksum #checksum\")\n";
+  return source;
+}
+
+bool Bench::inlining() {
+  using Clock = std::chrono::steady_clock;
+
+  if (std::system("command -v python3 > /dev/null") != 0) {
+    println("inline: skipped (needs python3)");
+    return true;
+  }
+
+  std::string base = std::filesystem::temp_directory_path().string();
+  base += "/pino-inline-" + std::to_string(getpid());
+  Utils::write_file(base + ".pino", generate_helper_calls(INLINE_BENCH_ROUNDS));
+
+  Diagnostics diagnostics(false);
+  Optimizer plain(0);
+  Optimizer optimized(2);
+  bool compiled =
+    Pipeline::compile(
+      base + ".pino", base + ".O0.py", diagnostics, nullptr, nullptr, false,
+      Pipeline::Target::PYTHON, Pyc::Version::PYTHON_3_11, &plain
+    ) &&
+    Pipeline::compile(
+      base + ".pino", base + ".O2.py", diagnostics, nullptr, nullptr, false,
+      Pipeline::Target::PYTHON, Pyc::Version::PYTHON_3_11, &optimized
+    );
+
+  if (not compiled) {
+    println("inline: FAIL (workload did not compile)");
+    return false;
+  }
+
+  auto measure = [&](const std::string &command, const std::string &output_path) {
+    double best = 0;
+
+    for (size_t i = 0; i < 3; i++) {
+      Clock::time_point start = Clock::now();
+      if (std::system((command + " > " + output_path).c_str()) != 0) return -1.0;
+
+      double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (i == 0 || seconds < best) best = seconds;
+    }
+
+    return best;
+  };
+
+  double called = measure("python3 " + base + ".O0.py", base + ".O0.out");
+  double inlined = measure("python3 " + base + ".O2.py", base + ".O2.out");
+
+  std::string expected = Utils::read_file(base + ".O0.out");
+  bool is_identical = called >= 0 && inlined >= 0 && expected == Utils::read_file(base + ".O2.out");
+  bool passed = is_identical && called / inlined >= INLINE_BENCH_SPEEDUP;
+
+  char line[200];
+  snprintf(
+    line, sizeof(line), "inline: -O0 %.3f s, -O2 %.3f s (%.2fx)  %s",
+    called, inlined, called / inlined,
+    not is_identical ? "FAIL (output differs)" : passed ? "ok" : "FAIL (too slow)"
+  );
+  println(line);
+
+  for (const char *extension : {".pino", ".O0.py", ".O2.py", ".O0.out", ".O2.out"}) {
+    std::filesystem::remove(base + extension);
+  }
+
+  return passed;
+}
+
+std::string Bench::generate_tail_calls(size_t depth, size_t rounds) {
+  std::string source;
+
+  source += "fn walk(n int, sum int) {\n";
+  source += "  if n == 0 {\n    return sum\n  }\n";
+  source += "  match n % 3 {\n";
+  source += "    when 0 {\n      return walk(n - 1, sum + n)\n    }\n";
+  source += "    when 1 {\n      return walk(n - 1, sum - 1)\n    }\n";
+  source += "    else {\n      return walk(n - 1, sum * 3 % 1000003)\n    }\n";
+  source += "  }\n}\n\n";
+  source += "var checksum = 0\n";
+  source += "for " + std::to_string(rounds) + " {\n";
+  source += "  checksum += walk(" + std::to_string(depth) + ", checksum % 7)\n}\n";
+  source += "println(\"checksum #checksum\")\n";
+  return source;
+}
+
+bool Bench::tail_calls() {
+  using Clock = std::chrono::steady_clock;
+
+  if (std::system("command -v python3 > /dev/null") != 0) {
+    println("tailcall: skipped (needs python3)");
+    return true;
+  }
+
+  std::string base = std::filesystem::temp_directory_path().string();
+  base += "/pino-tailcall-" + std::to_string(getpid());
+  Utils::write_file(base + ".pino", generate_tail_calls(TAIL_BENCH_DEPTH, TAIL_BENCH_ROUNDS));
+  Utils::write_file(base + ".deep.pino", generate_tail_calls(TAIL_BENCH_DEEP, 1));
+
+  Diagnostics diagnostics(false);
+  Optimizer plain(0);
+  Optimizer optimized(1);
+
+  auto compile = [&](const std::string &source, const std::string &output, Optimizer &optimizer) {
+    return Pipeline::compile(
+      source, output, diagnostics, nullptr, nullptr, false,
+      Pipeline::Target::PYTHON, Pyc::Version::PYTHON_3_11, &optimizer
+    );
+  };
+
+  bool compiled =
+    compile(base + ".pino", base + ".O0.py", plain) &&
+    compile(base + ".pino", base + ".O1.py", optimized) &&
+    compile(base + ".deep.pino", base + ".deep.py", optimized);
+
+  if (not compiled) {
+    println("tailcall: FAIL (workload did not compile)");
+    return false;
+  }
+
+  auto measure = [&](const std::string &command, const std::string &output_path) {
+    double best = 0;
+
+    for (size_t i = 0; i < 3; i++) {
+      Clock::time_point start = Clock::now();
+      if (std::system((command + " > " + output_path).c_str()) != 0) return -1.0;
+
+      double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (i == 0 || seconds < best) best = seconds;
+    }
+
+    return best;
+  };
+
+  double recursive = measure("python3 " + base + ".O0.py", base + ".O0.out");
+  double looped = measure("python3 " + base + ".O1.py", base + ".O1.out");
+  bool is_deep = std::system(("python3 " + base + ".deep.py > /dev/null 2>&1").c_str()) == 0;
+
+  std::string expected = Utils::read_file(base + ".O0.out");
+  bool is_identical = recursive >= 0 && looped >= 0 && expected == Utils::read_file(base + ".O1.out");
+  bool passed = is_identical && is_deep && recursive / looped >= TAIL_BENCH_SPEEDUP;
+
+  char line[200];
+  snprintf(
+    line, sizeof(line), "tailcall: -O0 %.3f s, -O1 %.3f s (%.2fx), %zu deep %s  %s",
+    recursive, looped, recursive / looped, TAIL_BENCH_DEEP, is_deep ? "ran" : "failed",
+    not is_identical ? "FAIL (output differs)" : not is_deep ? "FAIL (too deep)" : passed ? "ok" : "FAIL (too slow)"
+  );
+  println(line);
+
+  for (const char *extension : {".pino", ".deep.pino", ".O0.py", ".O1.py", ".deep.py", ".O0.out", ".O1.out"}) {
+    std::filesystem::remove(base + extension);
+  }
+
+  return passed;
+}
+
+bool Bench::machine() {
+  using Clock = std::chrono::steady_clock;
+
+  if (std::system("command -v python3 > /dev/null") != 0) {
+    println("machine: skipped (needs python3)");
+    return true;
+  }
+
+  std::string base = std::filesystem::temp_directory_path().string();
+  base += "/pino-machine-" + std::to_string(getpid());
+  Utils::write_file(base + ".pino", generate_workload(NATIVE_BENCH_ROUNDS));
+  Utils::write_file(base + ".small.pino", "val name = \"world\"\nprintln(\"hello #name\")\n");
+
+  Diagnostics diagnostics(false);
+  if (not Pipeline::compile(base + ".pino", base + ".py", diagnostics)) {
+    println("machine: FAIL (workload did not compile)");
+    return false;
+  }
+
+  // Parsed, checked, compiled and run in process, the way run does it
+  auto execute = [&](const std::string &source_path, const std::string &output_path) {
+    Statement program = Parser::parse(source_path);
+    Checker checker(&diagnostics);
+    checker.check(program);
+
+    Bytecode compiler(&diagnostics);
+    Program compiled = compiler.compile(program);
+    if (diagnostics.has_errors()) throw std::runtime_error("DEV: Workload did not compile to bytecode");
+
+    std::FILE *sink = std::fopen(output_path.c_str(), "w");
+    Machine machine(sink);
+    machine.execute(compiled);
+    std::fclose(sink);
+  };
+
+  auto measure = [&](const std::function<void()> &run) {
+    double best = 0;
+
+    for (size_t i = 0; i < BENCH_REPETITIONS; i++) {
+      Clock::time_point start = Clock::now();
+      run();
+
+      double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (i == 0 || seconds < best) best = seconds;
+    }
+
+    return best;
+  };
+
+  bool is_python = true;
+  double python = measure([&]() {
+    is_python = is_python && std::system(("python3 " + base + ".py > " + base + ".python.out").c_str()) == 0;
+  });
+
+  double bytecode = 0;
+  double startup = 0;
+
+  try {
+    bytecode = measure([&]() { execute(base + ".pino", base + ".machine.out"); });
+    startup = measure([&]() { execute(base + ".small.pino", base + ".small.out"); });
+  } catch (const std::exception &error) {
+    println("machine: FAIL (" + std::string(error.what()) + ")");
+    return false;
+  }
+
+  std::string expected = Utils::read_file(base + ".python.out");
+  bool is_identical = is_python && expected == Utils::read_file(base + ".machine.out");
+  bool is_fast = python / bytecode >= MACHINE_BENCH_SPEEDUP && startup <= MACHINE_BENCH_STARTUP;
+  bool passed = is_identical && is_fast;
+
+  char line[200];
+  snprintf(
+    line, sizeof(line), "machine: python %.3f s, bytecode %.3f s (%.1fx), startup %.3f ms  %s",
+    python, bytecode, python / bytecode, startup * 1000,
+    not is_identical ? "FAIL (output differs)" : passed ? "ok" : "FAIL (too slow)"
+  );
+  println(line);
+
+  for (const char *extension : {".pino", ".small.pino", ".py", ".python.out", ".machine.out", ".small.out"}) {
+    std::filesystem::remove(base + extension);
+  }
+
+  return passed;
+}
+
+std::string Bench::generate_document(size_t lines) {
+  std::string source;
+  size_t count = 0;
+
+  // Every seventh program carries errors on purpose, so those are skipped
+  for (size_t seed = 1; count < lines; seed++) {
+    if (seed % 7 == 0) continue;
+
+    std::string program = "fn module_" + std::to_string(seed) + "() {\n";
+    std::istringstream body(generate_program(seed));
+
+    // Indented the way a formatter would leave it
+    for (std::string line; std::getline(body, line);) {
+      program += line.empty() ? "\n" : "  " + line + "\n";
+    }
+
+    program += "}\n\n";
+    count += std::count(program.begin(), program.end(), '\n');
+    source += program;
+  }
+
+  return source;
+}
+
+// One end of a language server conversation over a pair of pipes
+class Conversation {
+  int input;
+  int output;
+  std::string buffer;
+
+  public:
+    Conversation(int input, int output) : input(input), output(output) {}
+
+    void send(const Json &message) {
+      std::string body = message.dump();
+      std::string frame = "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+
+      for (size_t sent = 0; sent < frame.size();) {
+        ssize_t count = write(input, frame.data() + sent, frame.size() - sent);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) throw std::runtime_error("DEV: Language server closed its input");
+        sent += count;
+      }
+    }
+
+    Json receive() {
+      while (true) {
+        size_t header_end = buffer.find("\r\n\r\n");
+
+        if (header_end != std::string::npos) {
+          size_t length_start = buffer.find("Content-Length:");
+          size_t length = std::stoul(buffer.substr(length_start + 15, header_end - length_start - 15));
+
+          if (buffer.size() >= header_end + 4 + length) {
+            Json message = Json::parse(buffer.substr(header_end + 4, length));
+            buffer.erase(0, header_end + 4 + length);
+            return message;
+          }
+        }
+
+        char chunk[65536];
+        ssize_t count = read(output, chunk, sizeof(chunk));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) throw std::runtime_error("DEV: Language server closed its output");
+        buffer.append(chunk, count);
+      }
+    }
+
+    // Skips everything until the response to id, or diagnostics for version
+    Json wait_for_response(int id) {
+      while (true) {
+        Json message = receive();
+        if (not message["id"].is_null() && message["id"].number == id) return message;
+      }
+    }
+
+    Json wait_for_diagnostics(int version) {
+      while (true) {
+        Json message = receive();
+        if (message["method"].string != "textDocument/publishDiagnostics") continue;
+        if (message["params"]["version"].number == version) return message;
+      }
+    }
+};
+
+bool Bench::language_server() {
+  using Clock = std::chrono::steady_clock;
+
+  auto elapsed = [](Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  };
+
+  int to_server[2];
+  int from_server[2];
+  if (pipe(to_server) < 0 || pipe(from_server) < 0) {
+    println("language server: FAIL (unable to create pipes)");
+    return false;
+  }
+
+  pid_t child = fork();
+  if (child == 0) {
+    dup2(to_server[0], STDIN_FILENO);
+    dup2(from_server[1], STDOUT_FILENO);
+    close(to_server[1]);
+    close(from_server[0]);
+    execl("/proc/self/exe", "pino", "lsp", static_cast<char *>(nullptr));
+    _exit(127);
+  }
+
+  close(to_server[0]);
+  close(from_server[1]);
+
+  Conversation conversation(to_server[1], from_server[0]);
+  const std::string uri = "file:///bench.pino";
+  std::string text = generate_document(LSP_BENCH_LINES);
+  size_t line_count = std::count(text.begin(), text.end(), '\n');
+
+  struct Edit {
+    size_t line;
+    size_t column;
+    size_t end_line;
+    size_t end_column;
+    std::string text;
+  };
+
+  auto find_line = [&](size_t from, const std::string &needle) {
+    size_t offset = 0;
+    for (size_t line = 0; line < from; line++) offset = text.find('\n', offset) + 1;
+    size_t found = text.find(needle, offset);
+    return std::count(text.begin(), text.begin() + found, '\n');
+  };
+
+  // Sessions are typed one character at a time and undone the same way
+  std::vector<std::pair<std::string, std::vector<Edit>>> sessions;
+
+  auto type_and_erase = [](size_t line, size_t column, const std::string &typed) {
+    std::vector<Edit> edits;
+    for (size_t i = 0; i < typed.size(); i++) {
+      edits.push_back({line, column + i, line, column + i, typed.substr(i, 1)});
+    }
+    for (size_t i = typed.size(); i > 0; i--) {
+      edits.push_back({line, column + i - 1, line, column + i, ""});
+    }
+    return edits;
+  };
+
+  size_t middle = line_count / 2;
+  std::vector<Edit> new_statement = {{middle, 0, middle, 0, "\n"}};
+  for (const Edit &edit : type_and_erase(middle, 0, "val typed = 12 + limit")) new_statement.push_back(edit);
+  new_statement.push_back({middle, 0, middle + 1, 0, ""});
+  sessions.push_back({"new statement", new_statement});
+
+  size_t body = find_line(line_count * 3 / 4, "    println(limit)");
+  sessions.push_back({"inside a body", type_and_erase(body, 18, "\n    greet_1(\"x\", limit)")});
+
+  std::vector<Edit> shift = {{0, 0, 0, 0, "val top = 1\n"}, {0, 0, 1, 0, ""}};
+  for (size_t i = 0; i < 20; i++) sessions.push_back({"shift every line", shift});
+
+  bool passed = true;
+
+  try {
+    conversation.send(Json::make_object()
+      .set("jsonrpc", "2.0").set("id", 1).set("method", "initialize")
+      .set("params", Json::make_object())
+    );
+    conversation.wait_for_response(1);
+
+    Clock::time_point start = Clock::now();
+    int version = 1;
+    conversation.send(Json::make_object()
+      .set("jsonrpc", "2.0").set("method", "textDocument/didOpen")
+      .set("params", Json::make_object().set("textDocument", Json::make_object()
+        .set("uri", uri).set("version", version).set("text", text)
+      ))
+    );
+    conversation.wait_for_diagnostics(version);
+    double open_seconds = elapsed(start);
+
+    std::vector<double> keystrokes;
+
+    for (const auto &[name, edits] : sessions) {
+      Json published;
+
+      for (const Edit &edit : edits) {
+        version++;
+        Json range = Json::make_object()
+          .set("start", Json::make_object().set("line", edit.line).set("character", edit.column))
+          .set("end", Json::make_object().set("line", edit.end_line).set("character", edit.end_column));
+
+        start = Clock::now();
+        conversation.send(Json::make_object()
+          .set("jsonrpc", "2.0").set("method", "textDocument/didChange")
+          .set("params", Json::make_object()
+            .set("textDocument", Json::make_object().set("uri", uri).set("version", version))
+            .set("contentChanges", Json::make_array().push(Json::make_object()
+              .set("range", range).set("text", edit.text)
+            ))
+          )
+        );
+
+        published = conversation.wait_for_diagnostics(version);
+        keystrokes.push_back(elapsed(start));
+      }
+
+      // Half typed text is rightly reported, but every session ends where it began
+      if (not published["params"]["diagnostics"].array.empty()) {
+        const std::string &message = published["params"]["diagnostics"][0]["message"].string;
+        println("language server: '" + name + "' left a diagnostic: " + message);
+        passed = false;
+      }
+    }
+
+    std::vector<double> hovers;
+    int id = 2;
+    for (size_t line = 0; line < line_count; line += line_count / 50) {
+      start = Clock::now();
+      conversation.send(Json::make_object()
+        .set("jsonrpc", "2.0").set("id", id).set("method", "textDocument/hover")
+        .set("params", Json::make_object()
+          .set("textDocument", Json::make_object().set("uri", uri))
+          .set("position", Json::make_object().set("line", line).set("character", 4))
+        )
+      );
+      conversation.wait_for_response(id++);
+      hovers.push_back(elapsed(start));
+    }
+
+    start = Clock::now();
+    conversation.send(Json::make_object()
+      .set("jsonrpc", "2.0").set("id", id).set("method", "textDocument/semanticTokens/full")
+      .set("params", Json::make_object().set("textDocument", Json::make_object().set("uri", uri)))
+    );
+    conversation.wait_for_response(id++);
+    double tokens_seconds = elapsed(start);
+
+    conversation.send(Json::make_object().set("jsonrpc", "2.0").set("id", id).set("method", "shutdown"));
+    conversation.wait_for_response(id);
+    conversation.send(Json::make_object().set("jsonrpc", "2.0").set("method", "exit"));
+
+    auto percentile = [](std::vector<double> values, double fraction) {
+      std::sort(values.begin(), values.end());
+      return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+    };
+
+    double p95 = percentile(keystrokes, 0.95);
+    char line[192];
+
+    snprintf(line, sizeof(line), "language server: %zu lines, opened in %.3f ms", line_count, open_seconds * 1000);
+    println(line);
+    snprintf(
+      line, sizeof(line), "  keystrokes %4zu  p50 %7.3f ms  p95 %7.3f ms  max %7.3f ms  %s",
+      keystrokes.size(), percentile(keystrokes, 0.5) * 1000, p95 * 1000, 
+      percentile(keystrokes, 1) * 1000, p95 <= LSP_BENCH_BUDGET ? "ok" : "FAIL"
+    );
+    println(line);
+    snprintf(
+      line, sizeof(line), "  hovers     %4zu  p50 %7.3f ms  p95 %7.3f ms",
+      hovers.size(), percentile(hovers, 0.5) * 1000, percentile(hovers, 0.95) * 1000
+    );
+    println(line);
+    snprintf(line, sizeof(line), "  semantic tokens  %.3f ms", tokens_seconds * 1000);
+    println(line);
+
+    if (p95 > LSP_BENCH_BUDGET) passed = false;
+  } catch (const std::exception &error) {
+    println(std::string("language server: FAIL (") + error.what() + ")");
+    passed = false;
+  }
+
+  close(to_server[1]);
+  close(from_server[0]);
+  waitpid(child, nullptr, 0);
+
+  return passed;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Utils.h"
+
+class Bench {
+  public:
+    enum class Phase {
+      LEX,
+      PARSE,
+      CHECK,
+      TRANSPILE,
+    };
+
+    // A family of generated programs that grow along a single dimension
+    struct Axis {
+      std::string name;
+      std::function<std::string(size_t)> generate;
+      std::vector<size_t> sizes;
+    };
+
+    struct Sample {
+      size_t size;
+      size_t output_size;
+      std::map<Phase, double> seconds;
+    };
+
+    static std::string generate_operator_chain(size_t size);
+    static std::string generate_nested_blocks(size_t size);
+    static std::string generate_else_if_chain(size_t size);
+    static std::string generate_argument_list(size_t size);
+    static std::string generate_str_injections(size_t size);
+    static std::string generate_property_chain(size_t size);
+
+    // A small program exercising most statements, with an error in every seventh
+    static std::string generate_program(size_t seed);
+
+    static std::vector<Axis> get_axes();
+
+    static Sample measure(const std::string &source, size_t size);
+
+    // Least squares slope of log(seconds) over log(size)
+    static double fit_exponent(const std::vector<Sample> &samples, Phase phase);
+
+    // Runs every axis and fails if any phase grows faster than O(n log n), or the
+    // check phase is too fast to have walked what the axis grows
+    static bool complexity();
+
+    // Compiles many programs on every core at once and fails unless each result is
+    // byte for byte the one a single session produces alone
+    static bool stress();
+
+    // Compiles small programs whose results are known and fails on any that
+    // comes out differently
+    static bool regressions();
+
+    // At least the given number of bytes of error free top level statements, each
+    // a generated program in a block of its own so no names pile up between them
+    static void generate_statements(const std::string &path, size_t bytes);
+
+    // Streams generated files through the pipeline in a child process each and
+    // fails if peak memory for the largest grows with the size of the file
+    static bool streaming(size_t megabytes);
+
+    // Times lexing alone, then lexing and parsing, then whole compiles, each
+    // one stage after the other and pipelined, and fails if a pipeline is
+    // slower than running its stages in turn
+    static bool pipelining(size_t megabytes);
+
+    // Emits a large program with growing numbers of jobs and fails unless every
+    // output is byte for byte the serial one
+    static bool emission();
+
+    // Integer loops, calls, matches and string injections, written in what both
+    // backends lower, which prints a checksum at the end
+    static std::string generate_workload(size_t rounds);
+
+    // Compiles a workload to Python and to C++, builds the latter with g++ and
+    // fails unless both print the same and the binary is an order of magnitude faster
+    static bool native();
+
+    // Runs the same workload on the bytecode machine and fails unless it prints
+    // what Python does, faster, and a small program starts within a millisecond
+    static bool machine();
+
+    // Tiny helpers called from a loop, a value each, which prints a checksum at the end
+    static std::string generate_helper_calls(size_t rounds);
+
+    // Runs the helper calls compiled to Python at -O0 and -O2 and fails unless
+    // both print the same and inlining the helpers made it faster
+    static bool inlining();
+
+    // A function recursing through the arms of a match to the depth given, called
+    // the given number of times, which prints a checksum at the end
+    static std::string generate_tail_calls(size_t depth, size_t rounds);
+
+    // Runs the recursion compiled to Python at -O0 and -O1 and fails unless both
+    // print the same, the loop it became is faster and runs far past the recursion limit
+    static bool tail_calls();
+
+    // A document of at least the given number of lines, free of errors
+    static std::string generate_document(size_t lines);
+
+    // Drives the language server over stdio through scripted edit sessions on a
+    // large document and fails if keystrokes take longer than the latency budget
+    static bool language_server();
+};
@@ -12,9 +12,14 @@ bool Block::is_block(Stream &stream, const size_t &start_index) {
   // block <struct> <fn> <arr_literal> {} 
   if (stream.is_next(start_index, Keyword::BLOCK)) return true;
 
+  // start_index wraps around when the expression is the first token of the program
+  bool is_after_keyword = 
+    start_index < stream.size() && 
+    stream.at(start_index).is_given_kind(Token::Kind::KEYWORD);
+
   // <type> {}
   return 
-    not stream.at(start_index).is_given_kind(Token::Kind::KEYWORD) &&
+    not is_after_keyword &&
     stream.is_next(start_index, [](const Token &token) {
       return token.is_given_kind(Token::Kind::IDENTIFIER);
     }) &&
@@ -30,13 +35,12 @@ PeekPtr<Block> Block::build(Stream &stream, const size_t &start_index) {
 
   PeekPtr<Block> result;
 
-  Token next = stream.get_next(start_index);
+  const Token &next = stream.get_next(start_index);
   if (next.kind == Token::Kind::KEYWORD) {
     result.end_index = start_index + 1;
   } else result.end_index = start_index;    
 
   Peek<Typing> typing = Typing::build(stream, result.end_index);
-  typing.data.print();
   PeekVectorPtr<Statement> body = Parser::build_block(stream, typing.end_index + 1);
 
   result.end_index = body.end_index;
@@ -54,14 +58,18 @@ std::string Block::to_string(size_t indent) const {
   return result;
 }
 
-void Block::print(size_t indent) const {
+void Block::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Block {");
-  println(indentation + "  typing: " + typing.to_string(indent + 1));
+  printer.line(indentation + "Block {");
+  printer.line(indentation + "  typing: " + typing.to_string(indent + 1));
 
   for (const auto &child : children) {
-    child->print(indent + 1);
+    printer.child(child.get(), indent + 1);
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
+}
+
+void Block::write_source(std::string &output) const {
+  output += typing.value + " { ... }";
 }
\ No newline at end of file
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <set>
+#include "Build.h"
+#include "Pool.cpp"
+#include "Pipeline.cpp"
+#include "Interface.cpp"
+
+Jobserver::Jobserver() : read_fd(-1), write_fd(-1), owns_fds(false) {}
+
+Jobserver::~Jobserver() {
+  if (owns_fds) close(read_fd);
+}
+
+std::unique_ptr<Jobserver> Jobserver::from_environment() {
+  auto jobserver = std::make_unique<Jobserver>();
+  const char *flags = std::getenv("MAKEFLAGS");
+  if (not flags) return jobserver;
+
+  std::string makeflags = flags;
+  std::string auth;
+
+  // Older versions of make spell it --jobserver-fds
+  for (const std::string option : {"--jobserver-auth=", "--jobserver-fds="}) {
+    size_t index = makeflags.rfind(option);
+    if (index == std::string::npos) continue;
+
+    size_t start = index + option.size();
+    auth = makeflags.substr(start, makeflags.find(' ', start) - start);
+    break;
+  }
+
+  if (auth.rfind("fifo:", 0) == 0) {
+    int fd = open(auth.substr(5).c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return jobserver;
+
+    jobserver->read_fd = jobserver->write_fd = fd;
+    jobserver->owns_fds = true;
+    return jobserver;
+  }
+
+  size_t comma = auth.find(',');
+  if (comma == std::string::npos) return jobserver;
+
+  int read_fd = std::atoi(auth.substr(0, comma).c_str());
+  int write_fd = std::atoi(auth.substr(comma + 1).c_str());
+
+  // make closes the pipe for recipes it doesn't consider recursive
+  if (read_fd < 0 || write_fd < 0) return jobserver;
+  if (fcntl(read_fd, F_GETFD) == -1 || fcntl(write_fd, F_GETFD) == -1) return jobserver;
+
+  jobserver->read_fd = read_fd;
+  jobserver->write_fd = write_fd;
+  return jobserver;
+}
+
+bool Jobserver::is_active() const {
+  return read_fd >= 0;
+}
+
+bool Jobserver::acquire(char &token) {
+  // The pipe may be non-blocking and shared with other clients, so a read
+  // can come back empty even after poll reported it readable
+  while (true) {
+    pollfd request = {read_fd, POLLIN, 0};
+    if (poll(&request, 1, -1) < 0 && errno != EINTR) return false;
+
+    ssize_t count = read(read_fd, &token, 1);
+    if (count == 1) return true;
+    if (count == 0) return false;
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+  }
+}
+
+void Jobserver::release(char token) {
+  while (write(write_fd, &token, 1) < 0 && errno == EINTR) {}
+}
+
+std::vector<std::string> Build::discover(const std::vector<std::string> &paths) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> sources;
+
+  for (const std::string &path : paths) {
+    if (not fs::is_directory(path)) {
+      sources.push_back(fs::path(path).lexically_normal().string());
+      continue;
+    }
+
+    auto options = fs::directory_options::skip_permission_denied;
+    for (const auto &entry : fs::recursive_directory_iterator(path, options)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".pino") {
+        sources.push_back(entry.path().lexically_normal().string());
+      }
+    }
+  }
+
+  std::sort(sources.begin(), sources.end());
+  sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+  return sources;
+}
+
+std::string Build::get_module(const std::string &source_path) {
+  namespace fs = std::filesystem;
+  fs::path path = fs::path(source_path).lexically_normal();
+
+  if (path.is_absolute()) path = path.lexically_relative(fs::current_path());
+  return path.replace_extension("").generic_string();
+}
+
+std::vector<std::string> Build::scan(const std::string &source_path, uint64_t &hash) {
+  std::ifstream input(source_path);
+  if (not input) throw std::runtime_error("USER: Unable to read '" + source_path + "'");
+
+  std::vector<std::string> imports;
+  std::string line;
+  hash = Utils::hash("");
+
+  while (std::getline(input, line)) {
+    // Hashed line by line the same as the whole file, the last newline only if it is there
+    hash = Utils::hash(line, hash);
+    if (not input.eof()) hash = Utils::hash("\n", hash);
+
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 6, "import") != 0) continue;
+
+    // Lines that don't lex are left for the compile to report
+    try {
+      Stream stream = Lexer::lex_ln(line);
+
+      if (
+        stream.size() >= 2 && 
+        stream[0].is_given_keyword(Keyword::IMPORT) && 
+        stream[1].is_given_literal(Token::Literal::STRING)
+      ) {
+        imports.push_back(stream[1].data);
+      }
+    } catch (const std::exception &) {}
+  }
+
+  return imports;
+}
+
+std::vector<Build::Unit> Build::compile(
+  const std::vector<std::string> &sources, 
+  size_t jobs, 
+  Jobserver *jobserver
+) {
+  std::vector<Unit> units;
+  std::map<std::string, size_t> modules;
+
+  for (const std::string &source_path : sources) {
+    std::string output_path = std::filesystem::path(source_path).replace_extension(".py").string();
+    Unit unit = {source_path, output_path, get_module(source_path), {}, 0, false, false, {}};
+    unit.imports = scan(source_path, unit.source_hash);
+
+    modules[unit.module] = units.size();
+    units.push_back(std::move(unit));
+  }
+
+  if (units.empty()) return units;
+
+  // Imports of modules outside the build are read from their interfaces as they stand
+  std::vector<size_t> waiting(units.size(), 0);
+  std::vector<std::vector<size_t>> dependents(units.size());
+
+  for (size_t i = 0; i < units.size(); i++) {
+    for (const std::string &module : units[i].imports) {
+      auto found = modules.find(module);
+      if (found == modules.end()) continue;
+
+      waiting[i]++;
+      dependents[found->second].push_back(i);
+    }
+  }
+
+  std::vector<size_t> wave;
+  for (size_t i = 0; i < units.size(); i++) {
+    if (waiting[i] == 0) wave.push_back(i);
+  }
+
+  Interfaces interfaces;
+  bool has_jobserver = jobserver && jobserver->is_active();
+  // Jobs a wave leaves over go to emitting its modules. Make only hands out
+  // tokens for whole modules, so under a jobserver each is emitted serially
+  size_t emit_jobs = 1;
+
+  auto build = [&](Unit &unit) {
+    std::string interface_path = Interface::get_path(unit.module);
+    std::optional<Interface> previous;
+
+    if (std::filesystem::exists(interface_path)) {
+      previous = Interface::parse(Utils::read_file(interface_path));
+    }
+
+    std::map<std::string, uint64_t> imports;
+    for (const std::string &module : unit.imports) {
+      const Interface *imported = interfaces.find(module);
+      if (imported) imports[module] = imported->get_hash();
+    }
+
+    unit.is_current =
+      previous &&
+      previous->source_hash == unit.source_hash &&
+      previous->imports == imports &&
+      imports.size() == std::set<std::string>(unit.imports.begin(), unit.imports.end()).size() &&
+      std::filesystem::exists(unit.output_path);
+
+    if (unit.is_current) {
+      unit.compiled = true;
+      interfaces.add(unit.module, std::move(*previous));
+      return;
+    }
+
+    Diagnostics diagnostics(false);
+    Interface interface;
+    unit.compiled = Pipeline::compile(
+      unit.source_path, unit.output_path, diagnostics, &interfaces, &interface,
+      false, Pipeline::Target::PYTHON, Pyc::Version::PYTHON_3_11, nullptr, emit_jobs
+    );
+    unit.diagnostics = diagnostics.entries;
+    if (not unit.compiled) return;
+
+    // A source edited since it was scanned just gets compiled again next time
+    interface.source_hash = unit.source_hash;
+    interface.imports = std::move(imports);
+    Utils::write_file_atomic(interface_path, interface.serialise());
+    interfaces.add(unit.module, std::move(interface));
+  };
+
+  // The token make gave this process, which the first worker runs on and any
+  // other that can't get one from the jobserver shares with it
+  std::mutex implicit_token;
+
+  while (not wave.empty()) {
+    size_t workers = std::max<size_t>(1, std::min(jobs, wave.size()));
+    Pool pool(workers, wave.size());
+    emit_jobs = has_jobserver ? 1 : std::max<size_t>(1, jobs / workers);
+
+    auto work = [&](size_t worker) {
+      size_t job;
+
+      while (pool.next(worker, job)) {
+        Unit &unit = units[wave[job]];
+
+        char token;
+        bool has_token = has_jobserver && worker > 0 && jobserver->acquire(token);
+
+        std::unique_lock<std::mutex> serial(implicit_token, std::defer_lock);
+        if (has_jobserver && not has_token) serial.lock();
+
+        try {
+          build(unit);
+        } catch (const std::exception &error) {
+          unit.compiled = false;
+          unit.diagnostics.push_back(Diagnostic::from_exception(Diagnostic::Stage::EMIT, error));
+        }
+
+        if (has_token) jobserver->release(token);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t worker = 1; worker < workers; worker++) {
+      threads.emplace_back(work, worker);
+    }
+
+    work(0);
+    for (std::thread &thread : threads) thread.join();
+
+    std::vector<size_t> settled = wave;
+    wave.clear();
+
+    // Dependents of a failed module are settled without compiling, since they
+    // would be checked against a stale interface, and fail their own in turn
+    while (not settled.empty()) {
+      size_t index = settled.back();
+      settled.pop_back();
+
+      for (size_t dependent : dependents[index]) {
+        Unit &unit = units[dependent];
+
+        if (not units[index].compiled) {
+          unit.diagnostics.push_back({
+            Diagnostic::Stage::CHECK, 
+            Diagnostic::Severity::USER, 
+            "Import '" + units[index].module + "' failed to build", 
+            std::nullopt
+          });
+        }
+
+        if (--waiting[dependent] > 0) continue;
+
+        if (unit.diagnostics.empty()) wave.push_back(dependent);
+        else settled.push_back(dependent);
+      }
+    }
+
+    std::sort(wave.begin(), wave.end());
+  }
+
+  for (Unit &unit : units) {
+    if (not unit.compiled && unit.diagnostics.empty()) {
+      unit.diagnostics.push_back({
+        Diagnostic::Stage::CHECK, 
+        Diagnostic::Severity::USER, 
+        "Import cycle through '" + unit.module + "'", 
+        std::nullopt
+      });
+    }
+  }
+
+  return units;
+}
+
+int Build::run(const std::vector<std::string> &arguments) {
+  size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> paths;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    const std::string &argument = arguments[i];
+
+    if (argument.rfind("-j", 0) == 0) {
+      std::string count = argument.size() > 2 ? argument.substr(2) : "";
+      if (count.empty() && i + 1 < arguments.size()) count = arguments[++i];
+
+      if (count.empty() || not std::all_of(count.begin(), count.end(), isdigit) || std::stoul(count) == 0) {
+        println("Invalid job count '" + count + "'");
+        return 2;
+      }
+
+      jobs = std::stoul(count);
+      continue;
+    }
+
+    paths.push_back(argument);
+  }
+
+  if (paths.empty()) paths.push_back(".");
+
+  std::unique_ptr<Jobserver> jobserver = Jobserver::from_environment();
+  std::vector<Unit> units;
+
+  try {
+    units = compile(discover(paths), jobs, jobserver.get());
+  } catch (const std::exception &error) {
+    println(error.what());
+    return 2;
+  }
+
+  // Reported once everything is done, so the order never depends on scheduling
+  size_t failed = 0;
+  size_t current = 0;
+  for (const Unit &unit : units) {
+    if (not unit.compiled) failed++;
+    if (unit.is_current) current++;
+
+    for (const Diagnostic &diagnostic : unit.diagnostics) {
+      if (diagnostic.severity == Diagnostic::Severity::NOTE) continue;
+      println(unit.source_path + ": " + diagnostic.message);
+    }
+  }
+
+  println(
+    "Built " + std::to_string(units.size() - failed) + " of " + 
+    std::to_string(units.size()) + " files, " + std::to_string(current) + " up to date"
+  );
+
+  return failed == 0 ? 0 : 1;
+}
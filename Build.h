@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Diagnostic.h"
+#include "Pool.h"
+
+// A client of the GNU make jobserver, inactive when make didn't hand us one
+class Jobserver {
+  int read_fd;
+  int write_fd;
+  bool owns_fds;
+
+  public:
+    Jobserver();
+    ~Jobserver();
+
+    Jobserver(const Jobserver &) = delete;
+    Jobserver &operator=(const Jobserver &) = delete;
+
+    // Reads --jobserver-auth from MAKEFLAGS, accepting both "R,W" and "fifo:PATH"
+    static std::unique_ptr<Jobserver> from_environment();
+
+    bool is_active() const;
+
+    // Blocks until make grants a token, which must be given back once done,
+    // false if the jobserver went away, in which case the job has to wait for
+    // the token this process was started with
+    bool acquire(char &token);
+    void release(char token);
+};
+
+// Modules are compiled in waves, each made of the modules whose imports are all
+// done, and a module is compiled again only when its source or the interface of
+// something it imports changed since its own interface was written
+class Build {
+  public:
+    struct Unit {
+      std::string source_path;
+      std::string output_path;
+      // The source path from the project root without its extension
+      std::string module;
+      std::vector<std::string> imports;
+      uint64_t source_hash;
+      bool compiled;
+      // Left alone since nothing it was compiled from changed
+      bool is_current;
+      std::vector<Diagnostic> diagnostics;
+    };
+
+    // Every .pino file given or found under the given directories, in path order
+    static std::vector<std::string> discover(const std::vector<std::string> &paths);
+
+    static std::string get_module(const std::string &source_path);
+
+    // The modules named by the import statements of a source, without parsing
+    // it, along with the hash of its content
+    static std::vector<std::string> scan(const std::string &source_path, uint64_t &hash);
+
+    static std::vector<Unit> compile(
+      const std::vector<std::string> &sources, 
+      size_t jobs, 
+      Jobserver *jobserver
+    );
+
+    // build [-j N] [path...]
+    static int run(const std::vector<std::string> &arguments);
+};
@@ -0,0 +1,962 @@
+#pragma once
+
+#include <charconv>
+#include <memory>
+#include "Bytecode.h"
+#include "Parser.cpp"
+#include "Checker.cpp"
+
+// The same names as BUILT_IN_FN, each run by the machine itself
+const std::map<std::string, BuiltIn> BYTECODE_BUILT_IN_FN = {
+  {"println", BuiltIn::PRINTLN},
+  {"readln", BuiltIn::READLN},
+  {"str", BuiltIn::STR},
+  {"int", BuiltIn::INT},
+  {"float", BuiltIn::FLOAT},
+  {"bool", BuiltIn::BOOL},
+  {"len", BuiltIn::LEN},
+};
+
+// The instruction behind each operator and Python's precedence for it.
+// Assignments are 0 and take everything to their right, and / or become jumps
+// over their right hand side
+const std::map<std::string, std::pair<Op, int>> BYTECODE_OPERATORS = {
+  {"=", {Op::MOVE, 0}}, {"+=", {Op::ADD, 0}}, {"-=", {Op::SUBTRACT, 0}},
+  {"*=", {Op::MULTIPLY, 0}}, {"/=", {Op::DIVIDE, 0}}, {"%=", {Op::MODULO, 0}},
+  {"or", {Op::JUMP_IF_TRUE, 1}},
+  {"and", {Op::JUMP_IF_FALSE, 2}},
+  {"==", {Op::EQUAL, 3}}, {"!=", {Op::NOT_EQUAL, 3}}, {"<", {Op::LESS, 3}},
+  {"<=", {Op::LESS_EQUAL, 3}}, {">", {Op::MORE, 3}}, {">=", {Op::MORE_EQUAL, 3}},
+  {"+", {Op::ADD, 4}}, {"-", {Op::SUBTRACT, 4}},
+  {"*", {Op::MULTIPLY, 5}}, {"/", {Op::DIVIDE, 5}}, {"%", {Op::MODULO, 5}},
+};
+
+Bytecode::Bytecode(Diagnostics *diagnostics) {
+  this->diagnostics = diagnostics ? diagnostics : &echoed;
+}
+
+void Bytecode::report(const std::string &message, Diagnostic::Severity severity) {
+  diagnostics->report(Diagnostic::Stage::EMIT, message, severity, line);
+}
+
+Bytecode::Unit &Bytecode::unit() {
+  return units.back();
+}
+
+Prototype &Bytecode::prototype() {
+  return compiled.prototypes[units.back().prototype];
+}
+
+bool Bytecode::is_global() const {
+  return units.size() == 1 && units.back().scopes.size() == 1;
+}
+
+size_t Bytecode::here() {
+  return prototype().code.size();
+}
+
+size_t Bytecode::emit(Op op, uint16_t a, uint16_t b, uint16_t c) {
+  Prototype &target = prototype();
+  target.code.push_back({op, a, b, c});
+  target.lines.push_back(line);
+  return target.code.size() - 1;
+}
+
+size_t Bytecode::emit_jump(Op op, uint16_t a, size_t target) {
+  return emit(op, a, target & 0xffff, target >> 16);
+}
+
+void Bytecode::patch(size_t jump, size_t target) {
+  Instruction &instruction = prototype().code[jump];
+  instruction.b = target & 0xffff;
+  instruction.c = target >> 16;
+}
+
+uint16_t Bytecode::add_constant(const Value &value) {
+  std::vector<Value> &constants = prototype().constants;
+
+  if (constants.size() > UINT16_MAX) {
+    report("Function Too Large");
+    return 0;
+  }
+
+  constants.push_back(value);
+  return constants.size() - 1;
+}
+
+Value Bytecode::get_constant(const Expression *literal) {
+  if (literal->variant != Expression::Variant::LITERAL) return Value();
+
+  switch (literal->literal) {
+    case Token::Literal::INTEGER: {
+      int64_t integer = 0;
+      const char *end = literal->value.data() + literal->value.size();
+      auto [pointer, error] = std::from_chars(literal->value.data(), end, integer);
+
+      if (error != std::errc() || pointer != end) {
+        report("Integer Too Large", Diagnostic::Severity::USER);
+      }
+
+      return Value::of_integer(integer);
+    }
+    case Token::Literal::FLOAT:
+      return Value::of_float(std::stod(literal->value));
+    case Token::Literal::BOOLEAN:
+      return Value::of_boolean(literal->value == "true");
+    case Token::Literal::STRING: {
+      const auto string = static_cast<const String *>(literal);
+
+      for (const Segment &segment : string->segments) {
+        if (segment.kind == Segment::Kind::INJECTION) return Value();
+      }
+
+      return Value::of_text(compiled.arena.make_text(Utils::unescape(literal->value)));
+    }
+    default:
+      return Value();
+  }
+}
+
+uint16_t Bytecode::allocate() {
+  Unit &current = unit();
+
+  if (current.top == UINT16_MAX) {
+    report("Function Too Large");
+    return current.top;
+  }
+
+  Prototype &target = prototype();
+  uint16_t allocated = current.top++;
+  if (current.top > target.registers) target.registers = current.top;
+
+  return allocated;
+}
+
+void Bytecode::free(uint16_t mark) {
+  unit().top = mark;
+}
+
+void Bytecode::open_scope() {
+  unit().scopes.emplace_back();
+  unit().marks.push_back(unit().top);
+}
+
+void Bytecode::close_scope() {
+  unit().top = unit().marks.back();
+  unit().marks.pop_back();
+  unit().scopes.pop_back();
+}
+
+void Bytecode::declare(const std::string &name, uint16_t target) {
+  unit().scopes.back()[name] = target;
+}
+
+Bytecode::Binding Bytecode::resolve(const std::string &name, size_t depth) {
+  Unit &current = units[depth];
+
+  for (auto scope = current.scopes.rbegin(); scope != current.scopes.rend(); scope++) {
+    auto found = scope->find(name);
+    if (found != scope->end()) return {Binding::Place::LOCAL, found->second};
+  }
+
+  for (size_t i = 0; i < current.captures.size(); i++) {
+    if (current.captures[i] == name) return {Binding::Place::CAPTURE, static_cast<uint32_t>(i)};
+  }
+
+  if (depth > 0) {
+    Binding outer = resolve(name, depth - 1);
+    if (outer.place != Binding::Place::LOCAL && outer.place != Binding::Place::CAPTURE) return outer;
+
+    // Locals of an enclosing function are copied in when the closure is made
+    current.captures.push_back(name);
+    current.sources.push_back(outer);
+    return {Binding::Place::CAPTURE, static_cast<uint32_t>(current.captures.size() - 1)};
+  }
+
+  auto global = globals.find(name);
+  if (global != globals.end()) return {Binding::Place::GLOBAL, global->second};
+
+  auto function = functions.find(name);
+  if (function != functions.end()) return {Binding::Place::FUNCTION, function->second};
+
+  return {Binding::Place::NONE, 0};
+}
+
+void Bytecode::load_name(const std::string &name, uint16_t target) {
+  Binding binding = resolve(name, units.size() - 1);
+
+  switch (binding.place) {
+    case Binding::Place::LOCAL:
+      if (binding.index != target) emit(Op::MOVE, target, binding.index);
+      break;
+    case Binding::Place::CAPTURE:
+      emit(Op::GET_CAPTURE, target, binding.index);
+      break;
+    case Binding::Place::GLOBAL:
+      emit(Op::GET_GLOBAL, target, binding.index);
+      break;
+    case Binding::Place::FUNCTION:
+      emit(Op::LOAD_CONSTANT, target, add_constant(Value::of_function(binding.index)));
+      break;
+    default:
+      report("Undefined Identifier '" + name + "'", Diagnostic::Severity::USER);
+  }
+}
+
+void Bytecode::load_sources(const std::vector<Binding> &sources, uint16_t target, uint32_t index) {
+  if (sources.empty()) {
+    emit(Op::LOAD_CONSTANT, target, add_constant(Value::of_function(index)));
+    return;
+  }
+
+  uint16_t mark = unit().top;
+
+  for (const Binding &source : sources) {
+    uint16_t copy = allocate();
+
+    if (source.place == Binding::Place::LOCAL) {
+      emit(Op::MOVE, copy, source.index);
+    } else {
+      emit(Op::GET_CAPTURE, copy, source.index);
+    }
+  }
+
+  emit(Op::CLOSURE, target, index, mark);
+  free(mark);
+}
+
+void Bytecode::handle_arr_literal(const Array *literal, uint16_t target) {
+  // Built aside and moved in at the end, as the elements may read the target
+  uint16_t mark = unit().top;
+  uint16_t list = allocate();
+
+  if (not literal->len) {
+    emit(Op::NEW_LIST, list, list, 0);
+    emit(Op::MOVE, target, list);
+    free(mark);
+    return;
+  }
+
+  uint16_t counter = allocate();
+  allocate();
+  allocate();
+
+  emit(Op::LOAD_CONSTANT, counter, add_constant(Value::of_integer(0)));
+  handle_expression(literal->len.get(), counter + 1);
+  emit(Op::NEW_LIST, list, counter + 1, 1);
+
+  size_t start = here();
+  size_t exit = emit_jump(Op::NEXT, counter, 0);
+
+  open_scope();
+  declare("it", counter + 2);
+  uint16_t element = allocate();
+
+  if (literal->init) {
+    handle_expression(literal->init.get(), element);
+  } else {
+    emit(Op::LOAD_CONSTANT, element, add_constant(Value()));
+  }
+
+  emit(Op::PUSH, list, element);
+  close_scope();
+  emit_jump(Op::JUMP, 0, start);
+  patch(exit, here());
+
+  emit(Op::MOVE, target, list);
+  free(mark);
+}
+
+void Bytecode::handle_str_literal(const String *literal, uint16_t target) {
+  Value constant = get_constant(literal);
+
+  if (constant.kind != Value::Kind::NONE) {
+    emit(Op::LOAD_CONSTANT, target, add_constant(constant));
+    return;
+  }
+
+  // Every piece goes in a register of its own and is joined by one instruction
+  uint16_t mark = unit().top;
+  uint16_t count = 0;
+
+  for (const Segment &segment : literal->segments) {
+    std::string text = literal->value.substr(segment.start, segment.length);
+
+    if (segment.kind == Segment::Kind::INJECTION) {
+      load_name(text, allocate());
+      count++;
+    } else if (not text.empty()) {
+      Value piece = Value::of_text(compiled.arena.make_text(Utils::unescape(text)));
+      emit(Op::LOAD_CONSTANT, allocate(), add_constant(piece));
+      count++;
+    }
+  }
+
+  emit(Op::CONCAT, target, mark, count);
+  free(mark);
+}
+
+void Bytecode::handle_literal(const Expression *literal, uint16_t target) {
+  switch (literal->literal) {
+    case Token::Literal::ARRAY:
+      handle_arr_literal(static_cast<const Array *>(literal), target);
+      return;
+    case Token::Literal::STRING:
+      handle_str_literal(static_cast<const String *>(literal), target);
+      return;
+    case Token::Literal::LAMBDA: {
+      const auto lambda = static_cast<const Lambda *>(literal);
+      uint32_t index = add_prototype("lambda", lambda->parameters);
+      std::vector<Binding> sources = compile_function(index, lambda->parameters, lambda->children);
+      load_sources(sources, target, index);
+      return;
+    }
+    default:
+      break;
+  }
+
+  Value constant = get_constant(literal);
+
+  if (constant.kind == Value::Kind::NONE) {
+    report("Expression Unsupported");
+    return;
+  }
+
+  emit(Op::LOAD_CONSTANT, target, add_constant(constant));
+}
+
+void Bytecode::handle_call(const Expression *call, uint16_t target) {
+  uint16_t mark = unit().top;
+  size_t count = call->arguments.size();
+
+  auto push_arguments = [&]() {
+    for (const auto &argument : call->arguments) handle_expression(argument.get(), allocate());
+  };
+
+  auto built_in = BYTECODE_BUILT_IN_FN.find(call->value);
+  Binding binding = resolve(call->value, units.size() - 1);
+
+  // Built ins are only shadowed by locals, which the checker already refuses
+  if (built_in != BYTECODE_BUILT_IN_FN.end() && binding.place == Binding::Place::NONE) {
+    if (count > UINT8_MAX) report("Too Many Arguments", Diagnostic::Severity::USER);
+
+    push_arguments();
+    emit(Op::BUILT_IN, target, mark, static_cast<uint16_t>(built_in->second) | count << 8);
+    free(mark);
+    return;
+  }
+
+  switch (binding.place) {
+    case Binding::Place::FUNCTION: {
+      // Copied, as lambdas among the arguments add prototypes of their own
+      size_t parameters = compiled.prototypes[binding.index].parameters;
+      std::vector<Value> defaults = compiled.prototypes[binding.index].defaults;
+
+      if (count > parameters) {
+        report("Too Many Arguments to '" + call->value + "'", Diagnostic::Severity::USER);
+      }
+
+      push_arguments();
+
+      for (size_t i = count; i < parameters; i++) {
+        if (defaults[i].kind == Value::Kind::NONE) {
+          report("Missing Argument to '" + call->value + "'", Diagnostic::Severity::USER);
+        }
+
+        emit(Op::LOAD_CONSTANT, allocate(), add_constant(defaults[i]));
+      }
+
+      emit(Op::CALL_DIRECT, target, mark, binding.index);
+      break;
+    }
+    case Binding::Place::NONE:
+      report("Undefined Function '" + call->value + "'", Diagnostic::Severity::USER);
+      break;
+    default: {
+      load_name(call->value, allocate());
+      push_arguments();
+      emit(Op::CALL, target, mark, count);
+    }
+  }
+
+  free(mark);
+}
+
+void Bytecode::handle_member(const Expression *member, uint16_t owner) {
+  if (member->variant == Expression::Variant::IDENTIFIER && member->value == "len") {
+    emit(Op::LENGTH, owner, owner);
+    return;
+  }
+
+  bool is_method = member->variant == Expression::Variant::FUNCTION_CALL && member->arguments.size() == 1;
+
+  if (is_method && member->value == "push") {
+    uint16_t mark = unit().top;
+    uint16_t element = allocate();
+    handle_expression(member->arguments.front().get(), element);
+    emit(Op::PUSH, owner, element);
+    emit(Op::LOAD_CONSTANT, owner, add_constant(Value()));
+    free(mark);
+    return;
+  }
+
+  if (is_method && member->value == "at") {
+    uint16_t mark = unit().top;
+    uint16_t index = allocate();
+    handle_expression(member->arguments.front().get(), index);
+    emit(Op::INDEX, owner, owner, index);
+    free(mark);
+    return;
+  }
+
+  report("Expression Unsupported");
+}
+
+void Bytecode::handle_assignment(const Expression *subject, const std::string &operation, const Expression *value) {
+  if (subject->variant != Expression::Variant::IDENTIFIER) {
+    report("Expression Unsupported");
+    return;
+  }
+
+  Binding binding = resolve(subject->value, units.size() - 1);
+  Op op = BYTECODE_OPERATORS.at(operation).first;
+  uint16_t mark = unit().top;
+
+  switch (binding.place) {
+    case Binding::Place::LOCAL: {
+      // The value is only written once everything it reads has been read
+      if (op == Op::MOVE) {
+        handle_expression(value, binding.index);
+        break;
+      }
+
+      uint16_t right = allocate();
+      handle_expression(value, right);
+      emit(op, binding.index, binding.index, right);
+      break;
+    }
+    case Binding::Place::GLOBAL: {
+      uint16_t right = allocate();
+      handle_expression(value, right);
+
+      if (op != Op::MOVE) {
+        uint16_t left = allocate();
+        emit(Op::GET_GLOBAL, left, binding.index);
+        emit(op, right, left, right);
+      }
+
+      emit(Op::SET_GLOBAL, right, binding.index);
+      break;
+    }
+    case Binding::Place::CAPTURE:
+      report("Captured Variables Are Read Only", Diagnostic::Severity::USER);
+      break;
+    default:
+      report("Undefined Identifier '" + subject->value + "'", Diagnostic::Severity::USER);
+  }
+
+  free(mark);
+}
+
+void Bytecode::handle_chain(const Expression *expression, uint16_t target) {
+  const auto root = static_cast<const BinaryExpression *>(expression);
+  auto assignment = BYTECODE_OPERATORS.find(root->operation);
+
+  if (assignment != BYTECODE_OPERATORS.end() && assignment->second.second == 0) {
+    handle_assignment(root->left.get(), root->operation, root->right.get());
+    return;
+  }
+
+  // Flattened and regrouped by precedence like the other backends. Operands
+  // take consecutive registers, so each operator folds the top two into one
+  std::vector<const Expression *> nodes;
+  std::vector<std::string> operations;
+
+  const Expression *node = expression;
+  while (node->is_binary()) {
+    auto binary = static_cast<const BinaryExpression *>(node);
+    nodes.push_back(binary->left.get());
+    operations.push_back(binary->operation);
+    node = binary->right.get();
+  }
+
+  nodes.push_back(node);
+
+  struct Waiting {
+    Op op;
+    int precedence;
+    // The jump over the right hand side of and / or
+    size_t jump;
+  };
+
+  uint16_t mark = unit().top;
+  std::vector<uint16_t> values;
+  std::vector<Waiting> pending;
+  size_t i = 0;
+
+  // Property access binds tightest, so members are folded into their owners first
+  auto push_term = [&]() {
+    uint16_t term = allocate();
+    handle_expression(nodes[i], term);
+
+    while (i < operations.size() && operations[i] == ":") {
+      handle_member(nodes[++i], term);
+    }
+
+    values.push_back(term);
+  };
+
+  auto reduce = [&](bool is_last) {
+    uint16_t right = values.back();
+    values.pop_back();
+    uint16_t left = values.back();
+    Waiting waiting = pending.back();
+    pending.pop_back();
+
+    if (waiting.op == Op::JUMP_IF_FALSE || waiting.op == Op::JUMP_IF_TRUE) {
+      emit(Op::MOVE, left, right);
+      patch(waiting.jump, here());
+    } else if (is_last) {
+      // The last operator writes the target itself, having read both operands
+      emit(waiting.op, target, left, right);
+      values.back() = target;
+    } else {
+      emit(waiting.op, left, left, right);
+    }
+
+    free(right);
+  };
+
+  push_term();
+
+  while (i < operations.size()) {
+    auto found = BYTECODE_OPERATORS.find(operations[i]);
+
+    if (found == BYTECODE_OPERATORS.end() || found->second.second == 0) {
+      report("Expression Unsupported");
+      break;
+    }
+
+    auto [op, precedence] = found->second;
+
+    while (not pending.empty() && pending.back().precedence >= precedence) {
+      // Python runs a < b < c as a < b and b < c, with b read once and kept in
+      // its register for the second comparison
+      bool is_chained =
+        precedence == BYTECODE_OPERATORS.at("==").second &&
+        pending.back().precedence == precedence &&
+        pending.back().op != Op::JUMP_IF_FALSE;
+
+      if (is_chained) {
+        uint16_t left = values[values.size() - 2];
+        emit(pending.back().op, left, left, values.back());
+        pending.back() = {Op::JUMP_IF_FALSE, precedence, emit_jump(Op::JUMP_IF_FALSE, left, 0)};
+        break;
+      }
+
+      reduce(false);
+    }
+
+    size_t jump = 0;
+    if (op == Op::JUMP_IF_FALSE || op == Op::JUMP_IF_TRUE) jump = emit_jump(op, values.back(), 0);
+
+    pending.push_back({op, precedence, jump});
+    i++;
+    push_term();
+  }
+
+  while (not pending.empty()) reduce(pending.size() == 1);
+
+  if (values.front() != target) emit(Op::MOVE, target, values.front());
+  free(mark);
+}
+
+void Bytecode::handle_expression(const Expression *expression, uint16_t target) {
+  switch (expression->variant) {
+    case Expression::Variant::ASSIGNMENT:
+    case Expression::Variant::PROPERTY_ACCESS:
+    case Expression::Variant::BINARY:
+      handle_chain(expression, target);
+      break;
+    case Expression::Variant::IDENTIFIER:
+      load_name(expression->value, target);
+      break;
+    case Expression::Variant::LITERAL:
+      handle_literal(expression, target);
+      break;
+    case Expression::Variant::FUNCTION_CALL:
+      handle_call(expression, target);
+      break;
+    default:
+      report("Expression Unsupported");
+  }
+}
+
+uint32_t Bytecode::add_prototype(const std::string &name, const std::vector<std::unique_ptr<Variable>> &parameters) {
+  if (compiled.prototypes.size() > UINT16_MAX) report("Too Many Functions");
+
+  Prototype added;
+  added.name = name;
+  added.parameters = parameters.size();
+
+  for (const auto &parameter : parameters) {
+    Value initial;
+    if (parameter->value) initial = get_constant(parameter->value.get());
+    if (parameter->value && initial.kind == Value::Kind::NONE) report("Default Unsupported");
+
+    added.defaults.push_back(initial);
+  }
+
+  compiled.prototypes.push_back(std::move(added));
+  return compiled.prototypes.size() - 1;
+}
+
+std::vector<Bytecode::Binding> Bytecode::compile_function(
+  uint32_t index,
+  const std::vector<std::unique_ptr<Variable>> &parameters,
+  const std::vector<std::unique_ptr<Statement>> &children
+) {
+  size_t outer_line = line;
+
+  units.emplace_back();
+  unit().prototype = index;
+  open_scope();
+
+  // Arguments arrive in the first registers
+  for (const auto &parameter : parameters) declare(parameter->name, allocate());
+
+  handle_body(children);
+  emit(Op::RETURN_NONE);
+
+  prototype().captures = unit().captures.size();
+  std::vector<Binding> sources = std::move(unit().sources);
+  units.pop_back();
+  line = outer_line;
+
+  return sources;
+}
+
+void Bytecode::handle_body(const std::vector<std::unique_ptr<Statement>> &children) {
+  // Bodies are queued on an explicit stack so deeply nested programs don't recurse
+  std::vector<Pending> pending;
+  for (auto child = children.rbegin(); child != children.rend(); child++) {
+    pending.push_back({child->get(), nullptr});
+  }
+
+  while (not pending.empty()) {
+    Pending item = std::move(pending.back());
+    pending.pop_back();
+
+    std::vector<Pending> body;
+
+    if (item.action) {
+      item.action(body);
+    } else {
+      expand_statement(item.statement, body);
+    }
+
+    pending.insert(pending.end(), std::make_move_iterator(body.rbegin()), std::make_move_iterator(body.rend()));
+  }
+}
+
+void Bytecode::expand_statement(const Statement *statement, std::vector<Pending> &body) {
+  line = statement->line;
+
+  if (statement->kind == Statement::Kind::EXPRESSION) {
+    uint16_t mark = unit().top;
+    handle_expression(static_cast<const Expression *>(statement), allocate());
+    free(mark);
+    return;
+  }
+
+  switch (statement->type) {
+    case Statement::Type::VARIABLE_DECLARATION:
+    case Statement::Type::CONSTANT_DECLARATION: {
+      auto variable = static_cast<const Variable *>(statement);
+      bool is_top = is_global();
+      uint16_t mark = unit().top;
+      uint16_t value = allocate();
+
+      if (variable->value) {
+        handle_expression(variable->value.get(), value);
+      } else {
+        emit(Op::LOAD_CONSTANT, value, add_constant(Value()));
+      }
+
+      // Declared once the value is in, which may read an outer one of the same name
+      if (is_top) {
+        emit(Op::SET_GLOBAL, value, globals.at(variable->name));
+        free(mark);
+      } else {
+        declare(variable->name, value);
+      }
+
+      break;
+    }
+    case Statement::Type::FUNCTION_DECLARATION: {
+      auto function = static_cast<const Function *>(statement);
+
+      if (is_global()) {
+        compile_function(functions.at(function->name), function->parameters, function->children);
+        break;
+      }
+
+      // Nested functions are closures, which can't call themselves by name
+      uint32_t index = add_prototype(function->name, function->parameters);
+      std::vector<Binding> sources = compile_function(index, function->parameters, function->children);
+      uint16_t closure = allocate();
+      load_sources(sources, closure, index);
+      declare(function->name, closure);
+      break;
+    }
+    case Statement::Type::IF_STATEMENT: {
+      expand_if(static_cast<const If *>(statement), body);
+      break;
+    }
+    case Statement::Type::MATCH_STATEMENT: {
+      expand_match(static_cast<const Match *>(statement), body);
+      break;
+    }
+    case Statement::Type::LOOP_STATEMENT: {
+      expand_loop(static_cast<const For *>(statement), body);
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT: {
+      auto jump = static_cast<const Jump *>(statement);
+
+      if (units.size() == 1) {
+        report("Return Outside of a Function", Diagnostic::Severity::USER);
+        break;
+      }
+
+      if (not jump->value) {
+        emit(Op::RETURN_NONE);
+        break;
+      }
+
+      uint16_t mark = unit().top;
+      uint16_t value = allocate();
+      handle_expression(jump->value.get(), value);
+      emit(Op::RETURN, value);
+      free(mark);
+      break;
+    }
+    case Statement::Type::BREAK_STATEMENT:
+    case Statement::Type::CONTINUE_STATEMENT: {
+      if (unit().loops.empty()) {
+        report("Jump Outside of a Loop", Diagnostic::Severity::USER);
+        break;
+      }
+
+      Loop &loop = unit().loops.back();
+
+      if (statement->type == Statement::Type::BREAK_STATEMENT) {
+        loop.breaks.push_back(emit_jump(Op::JUMP, 0, 0));
+      } else {
+        emit_jump(Op::JUMP, 0, loop.start);
+      }
+
+      break;
+    }
+    default:
+      report("Statement Unsupported");
+  }
+}
+
+void Bytecode::expand_if(const If *statement, std::vector<Pending> &body) {
+  uint16_t mark = unit().top;
+  uint16_t condition = allocate();
+  handle_expression(statement->condition.get(), condition);
+  free(mark);
+
+  size_t skip = emit_jump(Op::JUMP_IF_FALSE, condition, 0);
+  open_scope();
+
+  for (const auto &child : statement->children) body.push_back({child.get(), nullptr});
+
+  body.push_back({nullptr, [this, statement, skip](std::vector<Pending> &after) {
+    close_scope();
+
+    const Else *else_block = statement->else_block.get();
+
+    if (not else_block) {
+      patch(skip, here());
+      return;
+    }
+
+    size_t end = emit_jump(Op::JUMP, 0, 0);
+    patch(skip, here());
+
+    auto finish = [this, end](std::vector<Pending> &) {
+      patch(end, here());
+    };
+
+    // An else if is compiled as the if it holds
+    const Statement *owner = else_block->get_body_owner();
+
+    if (owner != else_block) {
+      after.push_back({owner, nullptr});
+      after.push_back({nullptr, finish});
+      return;
+    }
+
+    open_scope();
+    for (const auto &child : else_block->children) after.push_back({child.get(), nullptr});
+    after.push_back({nullptr, [this, finish](std::vector<Pending> &rest) {
+      close_scope();
+      finish(rest);
+    }});
+  }});
+}
+
+void Bytecode::expand_match(const Match *match, std::vector<Pending> &body) {
+  // The subject is evaluated once and compared arm by arm
+  uint16_t mark = unit().top;
+  uint16_t subject = allocate();
+  handle_expression(match->condition.get(), subject);
+
+  auto ends = std::make_shared<std::vector<size_t>>();
+
+  for (const auto &arm : match->children) {
+    const Statement *statement = arm.get();
+
+    body.push_back({nullptr, [this, statement, subject, ends](std::vector<Pending> &after) {
+      line = statement->line;
+      size_t miss = 0;
+      bool is_when = statement->type == Statement::Type::WHEN_STATEMENT;
+
+      if (is_when) {
+        const auto &conditions = static_cast<const When *>(statement)->conditions;
+        uint16_t test = unit().top;
+        uint16_t value = allocate();
+        allocate();
+
+        // A single condition jumps straight past the arm when it fails
+        if (conditions.size() == 1) {
+          handle_expression(conditions.front().get(), value + 1);
+          emit(Op::NOT_EQUAL, value, subject, value + 1);
+          miss = emit_jump(Op::JUMP_IF_TRUE, value, 0);
+        } else {
+          std::vector<size_t> hits;
+
+          for (const auto &condition : conditions) {
+            handle_expression(condition.get(), value + 1);
+            emit(Op::EQUAL, value, subject, value + 1);
+            hits.push_back(emit_jump(Op::JUMP_IF_TRUE, value, 0));
+          }
+
+          miss = emit_jump(Op::JUMP, 0, 0);
+          for (size_t hit : hits) patch(hit, here());
+        }
+
+        free(test);
+      }
+
+      open_scope();
+      for (const auto &child : statement->children) after.push_back({child.get(), nullptr});
+
+      after.push_back({nullptr, [this, is_when, miss, ends](std::vector<Pending> &) {
+        close_scope();
+        if (not is_when) return;
+
+        ends->push_back(emit_jump(Op::JUMP, 0, 0));
+        patch(miss, here());
+      }});
+    }});
+  }
+
+  body.push_back({nullptr, [this, mark, ends](std::vector<Pending> &) {
+    for (size_t end : *ends) patch(end, here());
+    free(mark);
+  }});
+}
+
+void Bytecode::expand_loop(const For *loop, std::vector<Pending> &body) {
+  uint16_t mark = unit().top;
+  size_t start = here();
+  std::optional<size_t> exit;
+
+  if (loop->variant != For::Variant::INFINITE) {
+    const Expression *subject = loop->variant == For::Variant::TIMES ? loop->index.get() : loop->limit.get();
+
+    if (subject->literal == Token::Literal::FLOAT) {
+      report("Cannot use a float in a range loop", Diagnostic::Severity::USER);
+    }
+
+    // A counter, what it counts through and the element it is at
+    uint16_t counter = allocate();
+    allocate();
+    allocate();
+
+    emit(Op::LOAD_CONSTANT, counter, add_constant(Value::of_integer(0)));
+    handle_expression(subject, counter + 1);
+
+    start = here();
+    exit = emit_jump(Op::NEXT, counter, 0);
+    open_scope();
+
+    if (loop->variant == For::Variant::FOR_IN) declare(loop->index->value, counter + 2);
+  } else {
+    open_scope();
+  }
+
+  unit().loops.push_back({start, {}});
+
+  for (const auto &child : loop->children) body.push_back({child.get(), nullptr});
+
+  body.push_back({nullptr, [this, mark, start, exit](std::vector<Pending> &) {
+    close_scope();
+    emit_jump(Op::JUMP, 0, start);
+
+    size_t end = here();
+    if (exit) patch(*exit, end);
+    for (size_t jump : unit().loops.back().breaks) patch(jump, end);
+
+    unit().loops.pop_back();
+    free(mark);
+  }});
+}
+
+Program Bytecode::compile(const Statement &program) {
+  compiled = Program();
+  units.clear();
+  globals.clear();
+  functions.clear();
+
+  compiled.prototypes.emplace_back();
+  compiled.prototypes.front().name = "<top level>";
+
+  // Declared up front, so that functions may use globals and call functions
+  // declared below them
+  for (const auto &child : program.children) {
+    if (child->kind != Statement::Kind::STATEMENT) continue;
+
+    line = child->line;
+
+    if (
+      child->type == Statement::Type::VARIABLE_DECLARATION ||
+      child->type == Statement::Type::CONSTANT_DECLARATION
+    ) {
+      const std::string &name = static_cast<const Variable *>(child.get())->name;
+      if (globals.count(name)) continue;
+
+      if (compiled.globals.size() > UINT16_MAX) report("Too Many Globals");
+
+      globals[name] = compiled.globals.size();
+      compiled.globals.push_back(name);
+    } else if (child->type == Statement::Type::FUNCTION_DECLARATION) {
+      const auto function = static_cast<const Function *>(child.get());
+      functions[function->name] = add_prototype(function->name, function->parameters);
+    }
+  }
+
+  units.emplace_back();
+  unit().prototype = 0;
+  open_scope();
+
+  handle_body(program.children);
+  emit(Op::RETURN_NONE);
+  units.pop_back();
+
+  return std::move(compiled);
+}
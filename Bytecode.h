@@ -0,0 +1,116 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include "Utils.h"
+#include "Diagnostic.h"
+#include "Machine.h"
+#include "Parser.cpp"
+#include "Statement.cpp"
+
+// Compiles a checked program to register bytecode for the Machine. Locals live
+// in registers of their function and are freed with the block they are
+// declared in, top level declarations become globals. Lambdas copy what they
+// capture when they are made
+class Bytecode {
+  // A statement still to be compiled, or what to do once its body is done
+  struct Pending {
+    const Statement *statement;
+    std::function<void(std::vector<Pending> &)> action;
+  };
+
+  // Where a name is found from the function being compiled
+  struct Binding {
+    enum class Place {
+      LOCAL,
+      CAPTURE,
+      GLOBAL,
+      FUNCTION,
+      NONE,
+    };
+
+    Place place;
+    uint32_t index;
+  };
+
+  struct Loop {
+    size_t start;
+    std::vector<size_t> breaks;
+  };
+
+  // A function being compiled, nested in the ones below it on the stack
+  struct Unit {
+    uint32_t prototype;
+    std::vector<std::map<std::string, uint16_t>> scopes;
+    // First register of each scope, freed when it closes
+    std::vector<uint16_t> marks;
+    // Names captured so far, and where the enclosing function has them
+    std::vector<std::string> captures;
+    std::vector<Binding> sources;
+    std::vector<Loop> loops;
+    uint16_t top = 0;
+  };
+
+  Program compiled;
+  std::vector<Unit> units;
+  std::map<std::string, uint16_t> globals;
+  // Top level functions, called directly by prototype
+  std::map<std::string, uint32_t> functions;
+  Diagnostics echoed;
+  Diagnostics *diagnostics;
+  // Line of the statement being compiled, given to every instruction of it
+  size_t line = 0;
+
+  void report(const std::string &message, Diagnostic::Severity severity = Diagnostic::Severity::INTERNAL);
+
+  Unit &unit();
+  Prototype &prototype();
+  bool is_global() const;
+
+  size_t here();
+  size_t emit(Op op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0);
+  size_t emit_jump(Op op, uint16_t a, size_t target);
+  void patch(size_t jump, size_t target);
+  uint16_t add_constant(const Value &value);
+  Value get_constant(const Expression *literal);
+
+  uint16_t allocate();
+  void free(uint16_t mark);
+  void open_scope();
+  void close_scope();
+  void declare(const std::string &name, uint16_t target);
+  Binding resolve(const std::string &name, size_t depth);
+
+  void load_name(const std::string &name, uint16_t target);
+  void load_sources(const std::vector<Binding> &sources, uint16_t target, uint32_t index);
+
+  void handle_arr_literal(const Array *literal, uint16_t target);
+  void handle_str_literal(const String *literal, uint16_t target);
+  void handle_literal(const Expression *literal, uint16_t target);
+  void handle_call(const Expression *call, uint16_t target);
+  void handle_member(const Expression *member, uint16_t owner);
+  void handle_assignment(const Expression *subject, const std::string &operation, const Expression *value);
+  void handle_chain(const Expression *expression, uint16_t target);
+  void handle_expression(const Expression *expression, uint16_t target);
+
+  // Compiles a body into a prototype of its own, returning what it captured
+  std::vector<Binding> compile_function(
+    uint32_t index,
+    const std::vector<std::unique_ptr<Variable>> &parameters,
+    const std::vector<std::unique_ptr<Statement>> &children
+  );
+  uint32_t add_prototype(const std::string &name, const std::vector<std::unique_ptr<Variable>> &parameters);
+
+  void handle_body(const std::vector<std::unique_ptr<Statement>> &children);
+  void expand_statement(const Statement *statement, std::vector<Pending> &body);
+  void expand_if(const If *statement, std::vector<Pending> &body);
+  void expand_match(const Match *match, std::vector<Pending> &body);
+  void expand_loop(const For *loop, std::vector<Pending> &body);
+
+  public:
+    // Unsupported nodes are printed unless a sink is given to collect them
+    Bytecode(Diagnostics *diagnostics = nullptr);
+
+    // Compiles a whole program, whose top level may call functions declared below
+    Program compile(const Statement &program);
+};
@@ -2,8 +2,10 @@
 
 #include "Utils.h"
 #include "Checker.h"
+#include "Diagnostic.cpp"
+#include "Interface.cpp"
 
-std::map<std::string, std::string> BUILT_IN_FN = {
+const std::map<std::string, std::string> BUILT_IN_FN = {
   {"println", "print"},
   {"readln", "input"},
   {"str", "str"},
@@ -13,6 +15,45 @@ std::map<std::string, std::string> BUILT_IN_FN = {
   {"len", "len"},
 };
 
+const std::map<Scope::Entity, std::string> ENTITY_NAMES = {
+  {Scope::Entity::CONSTANT, "Constant"},
+  {Scope::Entity::FUNCTION, "Function"},
+  {Scope::Entity::VARIABLE, "Variable"},
+  {Scope::Entity::STRUCT, "Struct"},
+  {Scope::Entity::ENUM, "Enum"},
+  {Scope::Entity::FIELD, "Field"},
+  {Scope::Entity::METHOD, "Method"},
+  {Scope::Entity::VALUE, "Value"},
+};
+
+const std::map<Scope::Entity, Symbols::Kind> ENTITY_KINDS = {
+  {Scope::Entity::CONSTANT, Symbols::Kind::CONSTANT},
+  {Scope::Entity::FUNCTION, Symbols::Kind::FUNCTION},
+  {Scope::Entity::VARIABLE, Symbols::Kind::VARIABLE},
+  {Scope::Entity::STRUCT, Symbols::Kind::STRUCT},
+  {Scope::Entity::ENUM, Symbols::Kind::ENUM},
+  {Scope::Entity::FIELD, Symbols::Kind::FIELD},
+  {Scope::Entity::METHOD, Symbols::Kind::METHOD},
+  {Scope::Entity::VALUE, Symbols::Kind::VALUE},
+};
+
+// What a native function may take, as it has a fixed layout on both sides
+bool is_native_typing(const Typing &typing) {
+  switch (typing.data) {
+    case Token::Literal::INTEGER:
+    case Token::Literal::FLOAT:
+    case Token::Literal::BOOLEAN:
+      return true;
+    case Token::Literal::ARRAY:
+      return typing.children.size() == 1 && (
+        typing.children.front().data == Token::Literal::INTEGER ||
+        typing.children.front().data == Token::Literal::FLOAT
+      );
+    default:
+      return false;
+  }
+}
+
 std::string get_built_in_fn(const std::string &name) {
   return BUILT_IN_FN.at(name);
 }
@@ -21,62 +62,110 @@ bool is_built_in_fn(const std::string &name) {
   return BUILT_IN_FN.find(name) != BUILT_IN_FN.end();
 }
 
+void Symbols::clear() {
+  definitions.clear();
+  references.clear();
+}
+
 std::shared_ptr<Scope> Scope::create(std::shared_ptr<Scope> &parent) {
   auto scope = std::make_shared<Scope>();
   scope->failed = false;
   scope->parent = parent;
+  scope->diagnostics = parent->diagnostics;
+  scope->symbols = parent->symbols;
+  scope->summary = nullptr;
   return scope;
 }
 
-Typing Scope::get_typing(std::string name) {
-  if (Utils::has_key(entities, name)) {
-    return entities.at(name);
-  }
+void Scope::observe(const std::string &name) {
+  if (not summary) return;
 
-  if (parent == nullptr) {
-    return Typing::create(Token::Literal::UNKNOWN);
+  std::map<std::string, Summary::Access> &accesses = is_ahead ? summary->ahead : summary->accesses;
+  if (Utils::has_key(accesses, name)) return;
+
+  Summary::Access &access = accesses[name];
+  auto entity = entities.find(name);
+  if (entity != entities.end()) access.before = entity->second;
+}
+
+Typing Scope::get_typing(std::string name) {
+  for (Scope *scope = this; scope != nullptr; scope = scope->parent.get()) {
+    if (scope->is_duplicate(name)) {
+      return scope->entities.at(name);
+    }
   }
 
-  return parent->get_typing(name);
+  return Typing::create(Token::Literal::UNKNOWN);
 }
 
 bool Scope::is_duplicate(std::string name) {
+  observe(name);
   return Utils::has_key(entities, name);
 }
 
+std::optional<size_t> Scope::get_definition(const std::string &name) {
+  for (Scope *scope = this; scope != nullptr; scope = scope->parent.get()) {
+    if (scope->is_duplicate(name)) {
+      auto definition = scope->definitions.find(name);
+      if (definition == scope->definitions.end()) return std::nullopt;
+      return definition->second;
+    }
+  }
+
+  return std::nullopt;
+}
+
 bool Scope::is_undefined(std::string name) {
-  if (is_duplicate(name)) {
-    return false;
+  for (Scope *scope = this; scope != nullptr; scope = scope->parent.get()) {
+    if (scope->is_duplicate(name)) {
+      return false;
+    }
   }
 
-  if (parent == nullptr) {
-    return true;
+  return true;
+}
+
+void Scope::append(std::string name, const Typing &type, Entity entity, std::optional<size_t> line) {
+  observe(name);
+
+  if (symbols && line) {
+    size_t separator = name.find(':');
+    std::string owner = separator == std::string::npos ? "" : name.substr(0, separator);
+    std::string member = separator == std::string::npos ? name : name.substr(separator + 1);
+
+    definitions[name] = symbols->definitions.size();
+    symbols->definitions.push_back({member, type, *line, ENTITY_KINDS.at(entity), owner});
+  } else {
+    definitions.erase(name);
+  }
+
+  if (is_duplicate(name)) {
+    diagnostics->report(
+      Diagnostic::Stage::CHECK, 
+      ENTITY_NAMES.at(entity) + " '" + name + "' has been already declared.",
+      Diagnostic::Severity::USER,
+      line
+    );
+    failed = true;
   }
 
-  return parent->is_undefined(name);
+  entities[name] = type;
 }
 
-void Scope::append(std::string name, const Typing &type, Entity entity) {
-  switch (entity) {
-    case Entity::CONSTANT:
-    case Entity::VARIABLE: {
-      std::string entity_name = entity == Entity::CONSTANT ? "Constant" : "Variable";
+size_t Checker::locate(const Statement *node) const {
+  return line_offset + node->line;
+}
 
-      if (is_duplicate(name)) {
-        println(entity_name + " '" + name + "' has been already declared.");
-        failed = true;
-      }
+void Checker::report(const std::string &message, const Statement *node) {
+  diagnostics->report(Diagnostic::Stage::CHECK, message, Diagnostic::Severity::USER, locate(node));
+}
 
-      entities[name] = type;
-    } break;
-    case Entity::FUNCTION: {
-      if (is_duplicate(name)) {
-        println("Function '" + name + "' has been already declared.");
-        failed = true;
-      }
+void Checker::refer(const Statement *element, const std::string &name, std::shared_ptr<Scope> &current_scope) {
+  if (not symbols) return;
 
-      entities[name] = type;
-    }
+  std::optional<size_t> definition = current_scope->get_definition(name);
+  if (definition) {
+    symbols->references.push_back({symbols->definitions[*definition].name, locate(element), *definition});
   }
 }
 
@@ -90,8 +179,11 @@ Typing Checker::check_binary_expression(
       Typing right = check_expression(element->right, current_scope);
 
       if (right.data != left.data) {
-        println("Unable to Assign: " + element->left->value + " to " + element->right->value);
-        println("\tType Mismatch: " + left.value + " and " + right.value);
+        report(
+          "Unable to Assign: " + element->left->to_source() + " to " + element->right->to_source() +
+          "\n\tType Mismatch: " + left.value + " and " + right.value,
+          element
+        );
         global_scope->failed = failed = true;
         return Typing::create(Token::Literal::UNKNOWN);
       }
@@ -103,6 +195,105 @@ Typing Checker::check_binary_expression(
   return Typing::create(Token::Literal::UNKNOWN);
 }
 
+Typing Checker::check_operator_chain(
+  const BinaryExpression *element,
+  std::shared_ptr<Scope> &current_scope
+) {
+  // Chains lean right and are walked link by link, so long ones don't recurse.
+  // After a ':' the next operand names a member of what the one before gave
+  std::optional<Typing> owner;
+  bool is_access = true;
+  const Expression *node = element;
+
+  auto check_operand = [&](const Expression *operand) {
+    return owner ? check_member(*owner, operand, current_scope) : check_expression(operand, current_scope);
+  };
+
+  while (node->is_binary()) {
+    auto link = static_cast<const BinaryExpression*>(node);
+    Typing operand = check_operand(link->left.get());
+
+    is_access = is_access && link->variant == Expression::Variant::PROPERTY_ACCESS;
+    owner = link->variant == Expression::Variant::PROPERTY_ACCESS ? std::optional<Typing>(operand) : std::nullopt;
+    node = link->right.get();
+  }
+
+  Typing last = check_operand(node);
+
+  // Only a chain of members has the type of the last one
+  return is_access ? last : Typing::create(Token::Literal::UNKNOWN);
+}
+
+Typing Checker::check_member(
+  const Typing &owner,
+  const Expression *member,
+  std::shared_ptr<Scope> &current_scope
+) {
+  bool is_named = 
+    member->variant == Expression::Variant::IDENTIFIER || 
+    member->variant == Expression::Variant::FUNCTION_CALL;
+
+  if (member->variant == Expression::Variant::FUNCTION_CALL) check_arguments(member, current_scope);
+
+  // Members of built in types, like str:to_upper(), aren't declared anywhere
+  std::string name = owner.value + ":" + member->value;
+  if (not is_named || current_scope->is_undefined(name)) {
+    return Typing::create(Token::Literal::UNKNOWN);
+  }
+
+  refer(member, name, current_scope);
+  return current_scope->get_typing(name);
+}
+
+void Checker::check_arguments(const Expression *call, std::shared_ptr<Scope> &current_scope) {
+  for (const auto &argument : call->arguments) check_expression(argument, current_scope);
+}
+
+void Checker::check_injections(const String *literal, std::shared_ptr<Scope> &current_scope) {
+  for (const std::string &name : literal->get_injections()) {
+    if (current_scope->is_undefined(name)) {
+      report("Undefined Identifier '" + name + "'", literal);
+      global_scope->failed = failed = true;
+      continue;
+    }
+
+    refer(literal, name, current_scope);
+  }
+}
+
+Typing Checker::check_struct_literal(
+  const Expression *literal,
+  const std::string &name,
+  const std::vector<std::unique_ptr<Variable>> &properties,
+  std::shared_ptr<Scope> &current_scope
+) {
+  Typing typing = Typing::create(Token::Literal::STRUCT);
+  typing.value = name;
+
+  if (current_scope->is_undefined(name)) {
+    report("Undefined Struct '" + name + "'", literal);
+    global_scope->failed = failed = true;
+    return typing;
+  }
+
+  refer(literal, name, current_scope);
+
+  for (const auto &property : properties) {
+    check_expression(property->value, current_scope);
+
+    std::string field = name + ":" + property->name;
+    if (current_scope->is_undefined(field)) {
+      report("Unknown Field '" + property->name + "' of " + name, property.get());
+      global_scope->failed = failed = true;
+      continue;
+    }
+
+    refer(property.get(), field, current_scope);
+  }
+
+  return typing;
+}
+
 Typing Checker::check_expression(
   const std::unique_ptr<Statement> &element,
   std::shared_ptr<Scope> &current_scope
@@ -125,23 +316,28 @@ Typing Checker::check_expression(
   switch (element->variant) {
     case Expression::Variant::IDENTIFIER: {
       if (current_scope->is_undefined(element->value)) {
-        println("Undefined Identifier '" + element->value + "'");
+        report("Undefined Identifier '" + element->value + "'", element);
         global_scope->failed = failed = true;
         return Typing::create(Token::Literal::UNKNOWN);
       }
 
+      refer(element, element->value, current_scope);
       return current_scope->get_typing(element->value);
     } break;
     case Expression::Variant::FUNCTION_CALL: {
+      check_arguments(element, current_scope);
+
       if (is_built_in_fn(element->value)) {
         return global_scope->get_typing(get_built_in_fn(element->value));
       }
 
       if (current_scope->is_undefined(element->value)) {
-        println("Undefined Function '" + element->value + "'");
+        report("Undefined Function '" + element->value + "'", element);
         global_scope->failed = failed = true;
         return Typing::create(Token::Literal::UNKNOWN);
       }
+
+      refer(element, element->value, current_scope);
     } break;
     case Expression::Variant::ASSIGNMENT: {
       return check_binary_expression(
@@ -149,11 +345,39 @@ Typing Checker::check_expression(
         current_scope
       );
     } break;
+    case Expression::Variant::BINARY:
+    case Expression::Variant::PROPERTY_ACCESS: {
+      return check_operator_chain(
+        static_cast<const BinaryExpression*>(element), 
+        current_scope
+      );
+    } break;
     case Expression::Variant::LITERAL: 
+      if (element->literal == Token::Literal::STRUCT) {
+        const auto object = static_cast<const Object*>(element);
+        return check_struct_literal(object, object->name, object->properties, current_scope);
+      }
+
+      if (element->literal == Token::Literal::STRING) {
+        check_injections(static_cast<const String*>(element), current_scope);
+      }
+
       return Typing::create(element->literal);
       break;
+    case Expression::Variant::BLOCK: {
+      // Struct literals come out of the parser as blocks typed by the struct, without their fields
+      const auto block = static_cast<const Block*>(element);
+      if (block->typing.data == Token::Literal::STRUCT) {
+        return check_struct_literal(block, block->typing.value, {}, current_scope);
+      }
+    } [[fallthrough]];
     default:
-      println("Unhandled Expression Variant");
+      diagnostics->report(
+        Diagnostic::Stage::CHECK, 
+        "Unhandled Expression Variant", 
+        Diagnostic::Severity::NOTE,
+        locate(element)
+      );
   }
 
   return Typing::create(Token::Literal::UNKNOWN);
@@ -163,63 +387,335 @@ void Checker::check_statement(
   const std::unique_ptr<Statement> &element,
   std::shared_ptr<Scope> &current_scope
 ) {
-  if (element->kind == Statement::Kind::EXPRESSION) {
-    check_expression(element, current_scope);
-    return;
+  // Nested bodies are checked from an explicit stack in source order
+  std::vector<std::pair<const Statement *, std::shared_ptr<Scope>>> pending;
+  std::vector<std::shared_ptr<Scope>> opened;
+  pending.push_back({element.get(), current_scope});
+
+  auto push_body = [&](const Statement *parent, std::shared_ptr<Scope> &scope) {
+    for (auto child = parent->children.rbegin(); child != parent->children.rend(); child++) {
+      pending.push_back({child->get(), scope});
+    }
+  };
+
+  while (not pending.empty()) {
+    auto [statement, scope] = std::move(pending.back());
+    pending.pop_back();
+
+    if (statement->kind == Statement::Kind::EXPRESSION) {
+      check_expression(static_cast<const Expression *>(statement), scope);
+      continue;
+    }
+
+    switch (statement->type) {
+      case Statement::Type::CONSTANT_DECLARATION: 
+      case Statement::Type::VARIABLE_DECLARATION: {
+        const auto variable = static_cast<const Variable*>(statement);
+        Typing typing = check_expression(variable->value, scope);
+        if (typings) (*typings)[variable] = typing;
+
+        scope->append(
+          variable->name, 
+          typing,
+          variable->is_constant ? Scope::Entity::CONSTANT : Scope::Entity::VARIABLE,
+          locate(variable)
+        );
+      } break;
+      case Statement::Type::FUNCTION_DECLARATION: {
+        const auto function = static_cast<const Function*>(statement);
+        const Typing typing = function->typing;
+        scope->append(function->name, typing, Scope::Entity::FUNCTION, locate(function));
+
+        if (function->is_native && scope != global_scope) {
+          report("Native Function '" + function->name + "' Must Be Declared At The Top Level", function);
+        }
+
+        // Native parameters cross into machine code, so only scalars and flat arrays of numbers may
+        if (function->is_native) {
+          for (const auto &parameter : function->parameters) {
+            if (is_native_typing(parameter->typing)) continue;
+            report("Native Parameter '" + parameter->name + "' Must Be int, float, bool, []int or []float", function);
+          }
+        }
+
+        // Top level bodies run once the whole module was, so they see what is declared below
+        auto child_scope = Scope::create(scope == global_scope ? ahead_scope : scope);
+        // The function is visible in its own body under the definition made above
+        child_scope->append(function->name, typing, Scope::Entity::FUNCTION);
+        std::optional<size_t> definition = scope->get_definition(function->name);
+        if (definition) child_scope->definitions[function->name] = *definition;
+
+        for (const auto &parameter : function->parameters) {
+          const Typing typing = parameter->typing;
+          child_scope->append(parameter->name, typing, Scope::Entity::CONSTANT, locate(parameter.get()));
+        }
+
+        opened.push_back(child_scope);
+        push_body(function, child_scope);
+      } break;
+      case Statement::Type::STRUCT_DECLARATION: {
+        const auto structure = static_cast<const Struct*>(statement);
+        Typing typing = Typing::create(Token::Literal::STRUCT);
+        typing.value = structure->name;
+        scope->append(structure->name, typing, Scope::Entity::STRUCT, locate(structure));
+
+        for (const auto &field : structure->fields) {
+          if (field->value) check_expression(field->value, scope);
+
+          std::string name = structure->name + ":" + field->name;
+          scope->append(name, field->typing, Scope::Entity::FIELD, locate(field.get()));
+        }
+
+        // Method bodies are left to a later pass, they need the fields in scope
+        for (const auto &method : structure->methods) {
+          std::string name = structure->name + ":" + method->name;
+          scope->append(name, method->typing, Scope::Entity::METHOD, locate(method.get()));
+        }
+      } break;
+      case Statement::Type::ENUM_DECLARATION: {
+        const auto enumeration = static_cast<const Enum*>(statement);
+        Typing typing = Typing::create(Token::Literal::UNKNOWN);
+        typing.value = enumeration->name;
+        scope->append(enumeration->name, typing, Scope::Entity::ENUM, locate(enumeration));
+
+        for (size_t i = 0; i < enumeration->values.size(); i++) {
+          std::string name = enumeration->name + ":" + enumeration->values[i];
+          scope->append(name, typing, Scope::Entity::VALUE, line_offset + enumeration->value_lines[i]);
+        }
+
+        for (const auto &method : enumeration->methods) {
+          std::string name = enumeration->name + ":" + method->name;
+          scope->append(name, method->typing, Scope::Entity::METHOD, locate(method.get()));
+        }
+      } break;
+      case Statement::Type::IMPORT_STATEMENT: {
+        const auto import = static_cast<const Import*>(statement);
+
+        if (scope != global_scope) {
+          report("Imports are only allowed at the top level", import);
+          global_scope->failed = failed = true;
+          break;
+        }
+
+        const Interface *interface = interfaces->find(import->module);
+
+        if (not interface) {
+          report("Unresolved Import '" + import->module + "'", import);
+          global_scope->failed = failed = true;
+          break;
+        }
+
+        interface->declare(*scope);
+      } break;
+      case Statement::Type::IF_STATEMENT: {
+        const auto if_statement = static_cast<const If*>(statement);
+        check_expression(if_statement->condition, scope);
+
+        auto child_scope = Scope::create(scope);
+        opened.push_back(child_scope);
+
+        if (if_statement->else_block) {
+          pending.push_back({if_statement->else_block.get(), scope});
+        }
+
+        push_body(if_statement, child_scope);
+      } break;
+      case Statement::Type::RETURN_STATEMENT: {
+        const auto jump = static_cast<const Jump*>(statement);
+        if (jump->value) check_expression(jump->value, scope);
+      } break;
+      case Statement::Type::ELSE_STATEMENT: {
+        // An else if declares nothing of its own, so its If is checked beside the
+        // first one and a long ladder doesn't deepen the scope chain
+        if (static_cast<const Else*>(statement)->is_else_if) {
+          push_body(statement, scope);
+          break;
+        }
+
+        auto child_scope = Scope::create(scope);
+        opened.push_back(child_scope);
+        push_body(statement, child_scope);
+      } break;
+      case Statement::Type::BREAK_STATEMENT:
+      case Statement::Type::CONTINUE_STATEMENT:
+        // Nothing to read or declare
+        break;
+    }
   }
 
-  switch (element->type) {
-    case Statement::Type::CONSTANT_DECLARATION: 
-    case Statement::Type::VARIABLE_DECLARATION: {
-      const auto variable = static_cast<Variable*>(element.get());
+  // Deepest scopes go first so the parent chain is never released recursively
+  while (not opened.empty()) {
+    if (opened.back()->failed) {
+      global_scope->failed = failed = true;
+    }
 
-      current_scope->append(
-        variable->name, 
-        check_expression(variable->value, current_scope),
-        variable->is_constant ? Scope::Entity::CONSTANT : Scope::Entity::VARIABLE
-      );
-    } break;
-    case Statement::Type::FUNCTION_DECLARATION: {
-      const auto function = static_cast<Function*>(element.get());
-      const Typing typing = function->typing;
-      current_scope->append(function->name, typing, Scope::Entity::FUNCTION);
+    opened.pop_back();
+  }
+}
 
-      auto child_scope = Scope::create(current_scope);
-      child_scope->append(function->name, typing, Scope::Entity::FUNCTION);
+void Checker::check_program(const Statement &program) {
+  for (const auto &child : program.children) {
+    if (child->kind == Statement::Kind::STATEMENT) {
+      check_statement(child, global_scope);
+    }
 
-      for (const auto &parameter : function->parameters) {
-        const Typing typing = parameter->typing;
-        child_scope->append(parameter->name, typing, Scope::Entity::CONSTANT);
-      }
+    if (child->kind == Statement::Kind::EXPRESSION) {
+      check_expression(child, global_scope);
+    }
+  }
+}
 
-      for (const auto &child : function->children) {
-        check_statement(child, child_scope);
-      }
+void Checker::summarise(const Statement &program, Summary &summary) {
+  size_t first_diagnostic = diagnostics->entries.size();
+  size_t first_definition = symbols->definitions.size();
+  size_t first_reference = symbols->references.size();
+
+  global_scope->summary = &summary;
+  ahead_scope->summary = &summary;
+  check_program(program);
+  global_scope->summary = nullptr;
+  ahead_scope->summary = nullptr;
+
+  // Every write to the global scope is preceded by a lookup, so accesses covers them all
+  for (auto &[name, access] : summary.accesses) {
+    auto entity = global_scope->entities.find(name);
+    if (entity != global_scope->entities.end()) access.after = entity->second;
+
+    auto definition = global_scope->definitions.find(name);
+    if (definition != global_scope->definitions.end() && definition->second >= first_definition) {
+      access.definition = definition->second - first_definition;
+    }
+  }
 
-      if (child_scope->failed) {
-        global_scope->failed = failed = true;
-      }
-    } break;
-    case Statement::Type::IF_STATEMENT: {
-      const auto if_statement = static_cast<If*>(element.get());
-      check_expression(if_statement->condition, current_scope);
+  for (size_t i = first_diagnostic; i < diagnostics->entries.size(); i++) {
+    Diagnostic diagnostic = diagnostics->entries[i];
+    if (diagnostic.line) diagnostic.line = *diagnostic.line - line_offset;
+    summary.diagnostics.push_back(std::move(diagnostic));
+  }
 
-      auto child_scope = Scope::create(current_scope);
+  for (size_t i = first_definition; i < symbols->definitions.size(); i++) {
+    Symbols::Definition definition = symbols->definitions[i];
+    definition.line -= line_offset;
+    summary.symbols.definitions.push_back(std::move(definition));
+  }
 
-      for (const auto &child : if_statement->children) {
-        check_statement(child, child_scope);
-      }
+  for (size_t i = first_reference; i < symbols->references.size(); i++) {
+    Symbols::Reference reference = symbols->references[i];
+    reference.line -= line_offset;
+    reference.definition = reference.definition >= first_definition
+      ? reference.definition - first_definition
+      : Summary::OUTSIDE;
+    summary.symbols.references.push_back(std::move(reference));
+  }
+}
 
-      if (child_scope->failed) {
-        global_scope->failed = failed = true;
-      }
-    } break;
+bool Checker::is_current(const Summary &summary) {
+  auto is_unchanged = [](const std::map<std::string, Summary::Access> &accesses, const Scope &scope) {
+    for (const auto &[name, access] : accesses) {
+      auto entity = scope.entities.find(name);
+      bool is_declared = entity != scope.entities.end();
+
+      if (is_declared != access.before.has_value()) return false;
+      if (is_declared && not (entity->second == *access.before)) return false;
+    }
+
+    return true;
+  };
+
+  return is_unchanged(summary.accesses, *global_scope) && is_unchanged(summary.ahead, *ahead_scope);
+}
+
+void Checker::replay(const Summary &summary) {
+  size_t first_definition = symbols->definitions.size();
+
+  for (const Diagnostic &diagnostic : summary.diagnostics) {
+    std::optional<size_t> line = diagnostic.line;
+    if (line) line = *line + line_offset;
+
+    diagnostics->report(diagnostic.stage, diagnostic.message, diagnostic.severity, line);
+    if (diagnostic.severity != Diagnostic::Severity::NOTE) global_scope->failed = failed = true;
+  }
+
+  // Names from outside resolve against the global scope as it stands before this program
+  for (const Symbols::Reference &reference : summary.symbols.references) {
+    size_t definition = first_definition + reference.definition;
+
+    if (reference.definition == Summary::OUTSIDE) {
+      auto found = global_scope->definitions.find(reference.name);
+      if (found == global_scope->definitions.end()) continue;
+      definition = found->second;
+    }
+
+    symbols->references.push_back({reference.name, reference.line + line_offset, definition});
+  }
+
+  for (Symbols::Definition definition : summary.symbols.definitions) {
+    definition.line += line_offset;
+    symbols->definitions.push_back(std::move(definition));
+  }
+
+  for (const auto &[name, access] : summary.accesses) {
+    if (access.after) global_scope->entities[name] = *access.after;
+    if (access.definition) global_scope->definitions[name] = first_definition + *access.definition;
   }
 }
 
-Checker::Checker(const Statement &element) {
+Checker::Checker(
+  const Statement &element, 
+  Diagnostics *diagnostics, 
+  Symbols *symbols, 
+  Interfaces *interfaces
+) : Checker(std::vector<Piece>{{&element, 0, nullptr}}, diagnostics, symbols, interfaces) {}
+
+Checker::Checker(
+  const std::vector<Piece> &pieces, 
+  Diagnostics *diagnostics, 
+  Symbols *symbols,
+  Interfaces *interfaces
+) : Checker(diagnostics, symbols, interfaces) {
+  for (const Piece &piece : pieces) declare_ahead(Interface::from_program(*piece.program));
+
+  for (const Piece &piece : pieces) {
+    line_offset = piece.line;
+
+    // Summaries are made of symbols, so without a table to fill there is nothing to reuse
+    if (not piece.summary || not symbols) {
+      check_program(*piece.program);
+      continue;
+    }
+
+    std::optional<Summary> &summary = *piece.summary;
+
+    if (summary && is_current(*summary)) {
+      replay(*summary);
+      continue;
+    }
+
+    summary.emplace();
+    summarise(*piece.program, *summary);
+  }
+
+  if (has_failed()) {
+    throw std::runtime_error("USER: Unable to Transpile Invalid Source");
+  }
+}
+
+Checker::Checker(Diagnostics *diagnostics, Symbols *symbols, Interfaces *interfaces) {
   failed = false;
+  line_offset = 0;
+  this->diagnostics = diagnostics ? diagnostics : &echoed;
+  this->symbols = symbols;
+
+  if (not interfaces) {
+    loaded = std::make_shared<Interfaces>();
+    interfaces = loaded.get();
+  }
+
+  this->interfaces = interfaces;
   global_scope = std::make_shared<Scope>();
+  global_scope->diagnostics = this->diagnostics;
+  global_scope->symbols = symbols;
+  global_scope->summary = nullptr;
 
   global_scope->append("print", Typing::create(Token::Literal::VOID), Scope::Entity::FUNCTION);
   global_scope->append("input", Typing::create(Token::Literal::STRING), Scope::Entity::FUNCTION);
@@ -229,21 +725,30 @@ Checker::Checker(const Statement &element) {
   global_scope->append("bool", Typing::create(Token::Literal::BOOLEAN), Scope::Entity::FUNCTION);
   global_scope->append("len", Typing::create(Token::Literal::INTEGER), Scope::Entity::FUNCTION);
 
-  for (const auto &child : element.children) {
-    if (child->kind == Statement::Kind::STATEMENT) {
-      check_statement(child, global_scope);
-    }
+  ahead_scope = Scope::create(global_scope);
+  ahead_scope->is_ahead = true;
+}
 
-    if (child->kind == Statement::Kind::EXPRESSION) {
-      check_expression(child, global_scope);
+void Checker::declare_ahead(const Interface &interface) {
+  // Set directly, as a name declared twice is reported where the file declares it
+  for (const Interface::Export &declaration : interface.exports) {
+    ahead_scope->entities[declaration.name] = declaration.typing;
+
+    for (const Interface::Member &member : declaration.members) {
+      ahead_scope->entities[declaration.name + ":" + member.name] = member.typing;
     }
   }
+}
 
-  if (global_scope->failed) {
-    failed = true;
-  }
+void Checker::check(const Statement &program) {
+  line_offset = 0;
+  check_program(program);
+}
 
-  if (failed) {
-    throw std::runtime_error("USER: Unable to Transpile Invalid Source");
-  }
-}
\ No newline at end of file
+void Checker::record(Typings *typings) {
+  this->typings = typings;
+}
+
+bool Checker::has_failed() const {
+  return failed || global_scope->failed;
+}
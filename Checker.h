@@ -1,9 +1,79 @@
 #pragma once
 
 #include <map>
+#include <optional>
 #include "Variable.h"
 #include "Function.h"
 #include "Struct.h"
+#include "Enum.h"
+#include "Import.h"
+#include "Jump.h"
+#include "Diagnostic.h"
+
+class Interface;
+class Interfaces;
+
+// Declarations and the uses resolved to them, gathered for editor tooling
+class Symbols {
+  public:
+    enum class Kind {
+      CONSTANT,
+      VARIABLE,
+      FUNCTION,
+      STRUCT,
+      ENUM,
+      FIELD,
+      METHOD,
+      VALUE,
+    };
+
+    struct Definition {
+      std::string name;
+      Typing typing;
+      size_t line;
+      Kind kind;
+      // The struct or enum that members belong to
+      std::string owner;
+    };
+
+    struct Reference {
+      std::string name;
+      size_t line;
+      size_t definition;
+    };
+
+    std::vector<Definition> definitions;
+    std::vector<Reference> references;
+
+    void clear();
+};
+
+// The type settled on for each declaration the checker reached, by node, for
+// backends that emit typed code
+using Typings = std::map<const Statement *, Typing>;
+
+// What checking one top level program read from and left in the global scope,
+// with its findings relative to the program, so it can be replayed instead of
+// walked again for as long as those global names resolve the same way
+class Summary {
+  public:
+    struct Access {
+      // The global entity before the program first touched the name, and after it
+      std::optional<Typing> before;
+      std::optional<Typing> after;
+      // Index into definitions, when the program itself declared the name
+      std::optional<size_t> definition;
+    };
+
+    // References to names declared before the program point at this instead
+    static const size_t OUTSIDE = SIZE_MAX;
+
+    std::map<std::string, Access> accesses;
+    // Names looked up among the declarations known ahead, with what they were then
+    std::map<std::string, Access> ahead;
+    std::vector<Diagnostic> diagnostics;
+    Symbols symbols;
+};
 
 class Scope {
   public:
@@ -12,17 +82,40 @@ class Scope {
       FUNCTION,
       VARIABLE,
       STRUCT,
+      ENUM,
+      // Members are entities named "Owner:member", which no identifier can shadow
+      FIELD,
+      METHOD,
+      VALUE,
     };
     
     std::shared_ptr<Scope> parent;
     std::map<std::string, Typing> entities;
+    // Index of each entity in symbols, for those declared in the source
+    std::map<std::string, size_t> definitions;
+    Diagnostics *diagnostics;
+    Symbols *symbols;
+    // Only set on the global scope and the one ahead of it, while a program is
+    // being summarised
+    Summary *summary;
+    bool is_ahead = false;
     bool failed;
 
     static std::shared_ptr<Scope> create(std::shared_ptr<Scope> &parent);
 
+    // Notes the state of a global name the first time a summarised program touches it
+    void observe(const std::string &name);
+
     Typing get_typing(std::string name);
 
-    void append(std::string name, const Typing &type, enum Entity entity);
+    void append(
+      std::string name, 
+      const Typing &type, 
+      enum Entity entity, 
+      std::optional<size_t> line = std::nullopt
+    );
+
+    std::optional<size_t> get_definition(const std::string &name);
 
     bool is_undefined(std::string name);
     bool is_duplicate(std::string name);
@@ -30,13 +123,51 @@ class Scope {
 
 class Checker {
   std::shared_ptr<Scope> global_scope;
+  // Top level declarations of the whole file, seen from function bodies before
+  // the statements declaring them are reached
+  std::shared_ptr<Scope> ahead_scope;
+  Diagnostics echoed;
+  Diagnostics *diagnostics;
+  Symbols *symbols;
+  Typings *typings = nullptr;
+  // Where imports are resolved, read from beside the sources unless given
+  Interfaces *interfaces;
+  std::shared_ptr<Interfaces> loaded;
+  // Added to every line, for programs that start further down a document
+  size_t line_offset;
   bool failed;
 
+  size_t locate(const Statement *node) const;
+  void report(const std::string &message, const Statement *node);
+  void refer(const Statement *element, const std::string &name, std::shared_ptr<Scope> &current_scope);
+
   Typing check_binary_expression(
     const BinaryExpression *element,
     std::shared_ptr<Scope> &current_scope
   );
 
+  // Operators and property access, whose operands are all checked
+  Typing check_operator_chain(
+    const BinaryExpression *element,
+    std::shared_ptr<Scope> &current_scope
+  );
+
+  Typing check_member(
+    const Typing &owner,
+    const Expression *member,
+    std::shared_ptr<Scope> &current_scope
+  );
+
+  void check_arguments(const Expression *call, std::shared_ptr<Scope> &current_scope);
+  void check_injections(const String *literal, std::shared_ptr<Scope> &current_scope);
+
+  Typing check_struct_literal(
+    const Expression *literal,
+    const std::string &name,
+    const std::vector<std::unique_ptr<Variable>> &properties,
+    std::shared_ptr<Scope> &current_scope
+  );
+
   Typing check_expression(
     const std::unique_ptr<Statement> &element,
     std::shared_ptr<Scope> &current_scope
@@ -55,6 +186,51 @@ class Checker {
     std::shared_ptr<Scope> &current_scope
   );
 
+  void check_program(const Statement &program);
+  void summarise(const Statement &program, Summary &summary);
+  bool is_current(const Summary &summary);
+  void replay(const Summary &summary);
+
   public:
-    Checker(const Statement &element);
+    // A top level program of a document, paired with the line it starts at. An
+    // empty summary is filled in as the piece is checked; a filled one is replayed
+    // when still current, and otherwise checked and filled in again
+    struct Piece {
+      const Statement *program;
+      size_t line;
+      std::optional<Summary> *summary;
+    };
+
+    // Diagnostics are printed as found unless a sink is given to collect them
+    Checker(
+      const Statement &element, 
+      Diagnostics *diagnostics = nullptr, 
+      Symbols *symbols = nullptr,
+      Interfaces *interfaces = nullptr
+    );
+
+    // Checks consecutive pieces of one document in order
+    Checker(
+      const std::vector<Piece> &pieces, 
+      Diagnostics *diagnostics = nullptr, 
+      Symbols *symbols = nullptr,
+      Interfaces *interfaces = nullptr
+    );
+
+    // Checks nothing yet, programs are handed over one at a time through check
+    explicit Checker(Diagnostics *diagnostics, Symbols *symbols = nullptr, Interfaces *interfaces = nullptr);
+
+    // Checks a program against everything declared by those checked before it.
+    // Errors are reported without throwing, so every program gets checked
+    void check(const Statement &program);
+
+    // Lets the bodies of top level functions call the functions and use the
+    // structs and enums of the interface, wherever in the file those are declared
+    void declare_ahead(const Interface &interface);
+
+    // Declarations checked from now on have their types kept in typings, until
+    // it is set back to nullptr
+    void record(Typings *typings);
+
+    bool has_failed() const;
 };
\ No newline at end of file
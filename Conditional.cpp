@@ -4,7 +4,7 @@
 #include "Conditional.h"
 #include "Parser.h"
 
-PeekPtr<Else> Else::build(Stream &stream, const size_t &start_index) {
+PeekPtr<Else> Else::build_header(Stream &stream, const size_t &start_index) {
   if (not stream.at(start_index).is_given_keyword(Keyword::ELSE)) {
     throw std::runtime_error("DEV: Expected 'else' keyword");
   }
@@ -12,13 +12,12 @@ PeekPtr<Else> Else::build(Stream &stream, const size_t &start_index) {
   PeekPtr<Else> result;
 
   if (stream.is_next(start_index, Keyword::IF)) {
-    PeekPtr<If> if_statement = If::build(stream, start_index + 1);
+    PeekPtr<If> if_statement = If::build_header(stream, start_index + 1);
     result.data->children.push_back(std::move(if_statement.data));
+    result.data->is_else_if = true;
     result.end_index = if_statement.end_index;
   } else {
-    PeekVectorPtr<Statement> body = Parser::build_block(stream, start_index + 1);
-    result.data->children = std::move(body.data);
-    result.end_index = body.end_index;
+    result.end_index = start_index + 1;
   }
 
   result.data->is_match_else = false;
@@ -26,63 +25,113 @@ PeekPtr<Else> Else::build(Stream &stream, const size_t &start_index) {
   return result;
 }
 
-void Else::print(size_t indent) const {
+Statement *Else::get_body_owner() const {
+  // else if { <body> } belongs to the nested If
+  if (not is_else_if) return const_cast<Else *>(this);
+  return children.front().get();
+}
+
+PeekPtr<Else> Else::build(Stream &stream, const size_t &start_index) {
+  if (stream.is_next(start_index, Keyword::IF)) {
+    PeekPtr<Else> result;
+    PeekPtr<If> if_statement = If::build(stream, start_index + 1);
+    result.data->children.push_back(std::move(if_statement.data));
+    result.data->is_else_if = true;
+    result.data->is_match_else = false;
+    result.data->type = Statement::Type::ELSE_STATEMENT;
+    result.end_index = if_statement.end_index;
+    return result;
+  }
+
+  PeekPtr<Else> result = build_header(stream, start_index);
+  PeekVectorPtr<Statement> body = Parser::build_block(stream, result.end_index);
+  result.data->children = std::move(body.data);
+  result.end_index = body.end_index;
+  return result;
+}
+
+void Else::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Else Statement {");
+  printer.line(indentation + "Else Statement {");
 
   if (not children.empty()) {
-    println(indentation + "  children: [");
+    printer.line(indentation + "  children: [");
     for (const auto &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
-PeekPtr<If> If::build(Stream &stream, const size_t &start_index) {
+If::~If() {
+  dismantle();
+}
+
+void If::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, condition);
+  hand_over(pending, else_block);
+  Statement::release(pending);
+}
+
+PeekPtr<If> If::build_header(Stream &stream, const size_t &start_index) {
   if (not stream.at(start_index).is_given_keyword(Keyword::IF)) {
     throw std::runtime_error("DEV: Expected 'if' keyword");
   }
 
   PeekPtr<If> result;
-
   PeekPtr<Expression> condition = Expression::build(stream, start_index);
-  PeekVectorPtr<Statement> body = Parser::build_block(stream, condition.end_index + 1);
 
   result.data->condition = std::move(condition.data);
+  result.data->type = Statement::Type::IF_STATEMENT;
+  result.end_index = condition.end_index + 1;
+  return result;
+}
+
+PeekPtr<If> If::build(Stream &stream, const size_t &start_index) {
+  PeekPtr<If> result = build_header(stream, start_index);
+  PeekVectorPtr<Statement> body = Parser::build_block(stream, result.end_index);
+
   result.data->children = std::move(body.data);
   result.end_index = body.end_index;
- 
-  if (stream.is_next(body.end_index, Keyword::ELSE)) {
-    PeekPtr<Else> else_block = Else::build(stream, result.end_index + 1);
-    
-    result.data->else_block = std::move(else_block.data);
-    result.end_index = else_block.end_index;
+
+  // else if chains are walked in place instead of recursing once per link
+  If *current = result.data.get();
+
+  while (stream.is_next(result.end_index, Keyword::ELSE)) {
+    PeekPtr<Else> else_block = Else::build_header(stream, result.end_index + 1);
+    Statement *owner = else_block.data->get_body_owner();
+    PeekVectorPtr<Statement> else_body = Parser::build_block(stream, else_block.end_index);
+
+    owner->children = std::move(else_body.data);
+    result.end_index = else_body.end_index;
+    current->else_block = std::move(else_block.data);
+
+    if (owner == current->else_block.get()) break;
+    current = static_cast<If *>(owner);
   }
 
-  result.data->type = Statement::Type::IF_STATEMENT;
   return result;
 }
 
-void If::print(size_t indent) const {
+void If::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "If Statement {");
-  println(indentation + "  condition: " + condition->to_string(indent + 1));
+  printer.line(indentation + "If Statement {");
+  printer.line(indentation + "  condition: " + condition->to_string(indent + 1));
 
   if (not children.empty()) {
-    println(indentation + "  children: [");
+    printer.line(indentation + "  children: [");
     for (const auto &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
 
   }
-  println(indentation + "}");
+  printer.line(indentation + "}");
   
   if (else_block) {
-    else_block->print(indent);
+    printer.child(else_block.get(), indent);
   }
 }
 
@@ -90,6 +139,15 @@ Match::Match() {
   type = Type::MATCH_STATEMENT;
 }
 
+Match::~Match() {
+  dismantle();
+}
+
+void Match::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, condition);
+  Statement::release(pending);
+}
+
 PeekPtr<Match> Match::build(Stream &stream, const size_t &start_index) {
   if (not stream.at(start_index).is_given_keyword(Keyword::MATCH)) {
     throw std::runtime_error("DEV: Expected 'match' keyword");
@@ -132,26 +190,35 @@ PeekPtr<Match> Match::build(Stream &stream, const size_t &start_index) {
   throw std::runtime_error("DEV: Unterminated 'match' statement");
 }
 
-void Match::print(size_t indent) const {
+void Match::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Match Statement {");
-  println(indentation + "  condition: " + condition->to_string(indent + 1));
+  printer.line(indentation + "Match Statement {");
+  printer.line(indentation + "  condition: " + condition->to_string(indent + 1));
 
   if (not children.empty()) {
-    println(indentation + "  children: [");
+    printer.line(indentation + "  children: [");
     for (const auto &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
 When::When() {
   type = Type::WHEN_STATEMENT;
 }
 
+When::~When() {
+  dismantle();
+}
+
+void When::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, conditions);
+  Statement::release(pending);
+}
+
 PeekPtr<When> When::build(Stream &stream, const size_t &start_index) {
   if (not stream.at(start_index).is_given_keyword(Keyword::WHEN)) {
     throw std::runtime_error("DEV: Expected 'when' keyword");
@@ -162,7 +229,7 @@ PeekPtr<When> When::build(Stream &stream, const size_t &start_index) {
   size_t index = start_index;
 
   while (index < stream.size()) {
-    Token next = stream.get_next(index);
+    const Token &next = stream.get_next(index);
 
     if (next.is_given_marker(Marker::LEFT_BRACE)) {
       break;
@@ -184,25 +251,25 @@ PeekPtr<When> When::build(Stream &stream, const size_t &start_index) {
   return result;
 }
 
-void When::print(size_t indent) const {
+void When::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "When Statement {");
+  printer.line(indentation + "When Statement {");
 
   if (not conditions.empty()) {
-    println(indentation + "  conditions: [");
+    printer.line(indentation + "  conditions: [");
     for (const auto &condition : conditions) {
-      println(indentation + "    " + condition->to_string(indent + 2));
+      printer.line(indentation + "    " + condition->to_string(indent + 2));
     }
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
   if (not children.empty()) {
-    println(indentation + "  children: [");
+    printer.line(indentation + "  children: [");
     for (const auto &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
\ No newline at end of file
@@ -7,10 +7,16 @@
 class Else : public Statement {
   public:
     bool is_match_else; 
+    bool is_else_if = false;
 
+    // Parses up to the opening brace, an else if also gets its nested If
+    static PeekPtr<Else> build_header(Stream &stream, const size_t &start_index);
     static PeekPtr<Else> build(Stream &stream, const size_t &start_index);
 
-    virtual void print(size_t indent = 0) const;
+    // The node whose children are the statements between the braces
+    Statement *get_body_owner() const;
+
+    void describe(Printer &printer, size_t indent) const override;
 };
 
 class If : public Statement {
@@ -18,9 +24,15 @@ class If : public Statement {
     std::unique_ptr<Expression> condition;
     std::unique_ptr<Else> else_block;
 
+    ~If() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
+    // Parses up to the opening brace of the body
+    static PeekPtr<If> build_header(Stream &stream, const size_t &start_index);
     static PeekPtr<If> build(Stream &stream, const size_t &start_index);
 
-    virtual void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
 
 class When : public Statement {
@@ -29,9 +41,13 @@ class When : public Statement {
 
     When();
 
+    ~When() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static PeekPtr<When> build(Stream &stream, const size_t &start_index);
 
-    void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
 
 class Match : public Statement {
@@ -40,7 +56,11 @@ class Match : public Statement {
 
     Match();
 
+    ~Match() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static PeekPtr<Match> build(Stream &stream, const size_t &start_index);
 
-    void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
\ No newline at end of file
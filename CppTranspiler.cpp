@@ -0,0 +1,1600 @@
+#pragma once
+
+#include "CppTranspiler.h"
+#include "Parser.cpp"
+#include "Checker.cpp"
+
+const std::map<std::string, std::string> CPP_BUILT_IN_FN = {
+  {"println", "pino::println"},
+  {"readln", "pino::readln"},
+  {"str", "pino::str"},
+  {"int", "pino::to_int"},
+  {"float", "pino::to_float"},
+  {"bool", "pino::to_bool"},
+  {"len", "pino::len"},
+};
+
+// Methods of built in types, lowered to free functions of the runtime
+const std::set<std::string> CPP_BUILT_IN_METHODS = {
+  "push", "at", "to_upper", "upper", "to_lower", "lower",
+};
+
+// Python's, which is what programs were written against. Assignments are the
+// only ones grouping to the right
+const std::map<std::string, int> CPP_PRECEDENCE = {
+  {"=", 0}, {"+=", 0}, {"-=", 0}, {"*=", 0}, {"/=", 0}, {"%=", 0},
+  {"or", 1},
+  {"and", 2},
+  {"==", 3}, {"!=", 3}, {"<", 3}, {"<=", 3}, {">", 3}, {">=", 3},
+  {"+", 4}, {"-", 4},
+  {"*", 5}, {"/", 5}, {"%", 5},
+};
+
+const int CPP_TERM_PRECEDENCE = 6;
+
+// Operators lowered to the runtime, for Python's division and modulo and for
+// integers that raise rather than overflow
+const std::map<std::string, std::string> CPP_OPERATOR_FN = {
+  {"+", "pino::add"}, {"-", "pino::subtract"}, {"*", "pino::multiply"},
+  {"/", "pino::divide"}, {"%", "pino::modulo"},
+  {"+=", "pino::add_to"}, {"-=", "pino::subtract_from"}, {"*=", "pino::multiply_by"},
+  {"/=", "pino::divide_by"}, {"%=", "pino::modulo_by"},
+};
+
+// Operators whose result is a bool whatever they compare
+const std::set<std::string> CPP_BOOLEAN_OPERATORS = {"==", "!=", "<", "<=", ">", ">="};
+
+// What the built in functions return, for the return types of functions returning them
+const std::map<std::string, Token::Literal> CPP_CALL_RESULTS = {
+  {"readln", Token::Literal::STRING},
+  {"str", Token::Literal::STRING},
+  {"int", Token::Literal::INTEGER},
+  {"float", Token::Literal::FLOAT},
+  {"bool", Token::Literal::BOOLEAN},
+  {"len", Token::Literal::INTEGER},
+};
+
+const std::set<std::string> CPP_KEYWORDS = {
+  "alignas", "alignof", "asm", "auto", "bitand", "bitor", "bool", "case", "catch", "char",
+  "class", "compl", "const", "const_cast", "constexpr", "decltype", "default", "delete",
+  "do", "double", "dynamic_cast", "explicit", "export", "extern", "float", "friend", "goto",
+  "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+  "nullptr", "operator", "or_eq", "pino", "private", "protected", "public", "register",
+  "reinterpret_cast", "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+  "std", "switch", "template", "this", "thread_local", "throw", "try", "typedef", "typeid",
+  "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t",
+  "while", "xor", "xor_eq",
+};
+
+// The runtime, written to the top of every program so it builds on its own.
+// Values print the way the Python output prints them
+const std::string CPP_PRELUDE = R"PRELUDE(#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pino {
+  inline void write(std::string &out, const std::string &value) { out += value; }
+  inline void write(std::string &out, const char *value) { out += value; }
+  inline void write(std::string &out, bool value) { out += value ? "True" : "False"; }
+
+  inline void write(std::string &out, long long value) {
+    char buffer[24];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+  }
+
+  inline void write(std::string &out, int value) { write(out, static_cast<long long>(value)); }
+
+  // The shortest digits that read back the same, laid out like Python's repr
+  inline void write(std::string &out, double value) {
+    if (std::isnan(value)) { out += "nan"; return; }
+    if (std::isinf(value)) { out += value < 0 ? "-inf" : "inf"; return; }
+
+    char buffer[32];
+    char *end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+    std::string text(buffer, end);
+    size_t mark = text.find('e');
+    int exponent = std::stoi(text.substr(mark + 1));
+
+    if (exponent < -4 || exponent >= 16) { out += text; return; }
+
+    bool is_negative = text[0] == '-';
+    std::string digits;
+    for (size_t i = is_negative; i < mark; i++) {
+      if (text[i] != '.') digits += text[i];
+    }
+
+    if (is_negative) out += '-';
+
+    if (exponent < 0) {
+      out += "0." + std::string(-exponent - 1, '0') + digits;
+      return;
+    }
+
+    size_t whole = exponent + 1;
+    if (digits.size() < whole) digits.append(whole - digits.size(), '0');
+    out.append(digits, 0, whole);
+    out += '.';
+    out += digits.size() > whole ? digits.substr(whole) : "0";
+  }
+
+  template <typename T>
+  void write(std::string &out, const std::vector<T> &values);
+
+  template <typename T>
+  void repr(std::string &out, const T &value) { write(out, value); }
+
+  inline void repr(std::string &out, const std::string &value) {
+    out += '\'';
+    for (char character : value) {
+      if (character == '\n') { out += "\\n"; continue; }
+      if (character == '\t') { out += "\\t"; continue; }
+      if (character == '\\' || character == '\'') out += '\\';
+      out += character;
+    }
+    out += '\'';
+  }
+
+  template <typename T>
+  void write(std::string &out, const std::vector<T> &values) {
+    out += '[';
+    for (size_t i = 0; i < values.size(); i++) {
+      if (i > 0) out += ", ";
+      repr(out, values[i]);
+    }
+    out += ']';
+  }
+
+  template <typename... Values>
+  void println(const Values &... values) {
+    std::string line;
+    size_t count = 0;
+    ((count++ ? void(line += ' ') : void(), write(line, values)), ...);
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stdout);
+  }
+
+  inline std::string readln(const std::string &prompt = "") {
+    std::fwrite(prompt.data(), 1, prompt.size(), stdout);
+    std::fflush(stdout);
+    std::string line;
+    std::getline(std::cin, line);
+    return line;
+  }
+
+  // String injections, written straight into one buffer
+  template <typename... Values>
+  std::string concat(const Values &... values) {
+    std::string out;
+    (write(out, values), ...);
+    return out;
+  }
+
+  template <typename T>
+  std::string str(const T &value) { return concat(value); }
+
+  inline long long to_int(const std::string &value) { return std::stoll(value); }
+  template <typename T>
+  long long to_int(const T &value) { return static_cast<long long>(value); }
+
+  inline double to_float(const std::string &value) { return std::stod(value); }
+  template <typename T>
+  double to_float(const T &value) { return static_cast<double>(value); }
+
+  inline bool to_bool(const std::string &value) { return not value.empty(); }
+  template <typename T>
+  bool to_bool(const std::vector<T> &values) { return not values.empty(); }
+  template <typename T>
+  bool to_bool(const T &value) { return value != T(); }
+
+  template <typename T>
+  long long len(const T &values) { return static_cast<long long>(values.size()); }
+
+  // An error nothing catches ends the program as in Python, after what it printed
+  [[noreturn]] inline void terminate() {
+    std::fflush(stdout);
+    try {
+      if (std::current_exception()) std::rethrow_exception(std::current_exception());
+    } catch (const std::exception &error) {
+      std::fprintf(stderr, "%s\n", error.what());
+    } catch (...) {
+    }
+    std::_Exit(1);
+  }
+
+  // Integers are 64 bit, and arithmetic past that throws rather than wrapping
+  template <typename Left, typename Right>
+  constexpr bool is_integers = std::is_same_v<std::decay_t<Left>, long long> && std::is_same_v<std::decay_t<Right>, long long>;
+
+  [[noreturn]] inline void overflow() { throw std::overflow_error("Integer Overflow"); }
+
+  template <typename Left, typename Right>
+  auto add(Left &&left, Right &&right) {
+    if constexpr (is_integers<Left, Right>) {
+      long long result;
+      if (__builtin_add_overflow(left, right, &result)) overflow();
+      return result;
+    } else {
+      return std::forward<Left>(left) + std::forward<Right>(right);
+    }
+  }
+
+  template <typename Left, typename Right>
+  auto subtract(const Left &left, const Right &right) {
+    if constexpr (is_integers<Left, Right>) {
+      long long result;
+      if (__builtin_sub_overflow(left, right, &result)) overflow();
+      return result;
+    } else {
+      return left - right;
+    }
+  }
+
+  template <typename Left, typename Right>
+  auto multiply(const Left &left, const Right &right) {
+    if constexpr (is_integers<Left, Right>) {
+      long long result;
+      if (__builtin_mul_overflow(left, right, &result)) overflow();
+      return result;
+    } else {
+      return left * right;
+    }
+  }
+
+  // Strings are appended to where they lie rather than copied
+  template <typename Left, typename Right>
+  Left &add_to(Left &left, Right &&right) {
+    if constexpr (is_integers<Left, Right>) return left = add(left, right);
+    else return left += std::forward<Right>(right);
+  }
+
+  template <typename Left, typename Right>
+  Left &subtract_from(Left &left, const Right &right) { return left = subtract(left, right); }
+
+  template <typename Left, typename Right>
+  Left &multiply_by(Left &left, const Right &right) { return left = multiply(left, right); }
+
+  // The right operand of an and / or, which Python hands back as it is, so
+  // the left one must be of its type for both to come back from one place
+  template <typename T, typename Value>
+  T either(Value &&value) {
+    static_assert(std::is_same_v<T, std::decay_t<Value>>, "and / or takes operands of one type");
+    return std::forward<Value>(value);
+  }
+
+  // True division, like Python's /
+  template <typename Left, typename Right>
+  double divide(const Left &left, const Right &right) {
+    return static_cast<double>(left) / static_cast<double>(right);
+  }
+
+  // Takes the sign of the divisor, like Python's %
+  template <typename Left, typename Right>
+  auto modulo(const Left &left, const Right &right) {
+    if constexpr (std::is_integral_v<Left> && std::is_integral_v<Right>) {
+      // Which also keeps the smallest integer modulo -1 from trapping
+      long long result = right == -1 ? 0 : left % right;
+      return result != 0 && (result < 0) != (right < 0) ? result + right : result;
+    } else {
+      double result = std::fmod(left, right);
+      return result != 0 && (result < 0) != (right < 0) ? result + right : result;
+    }
+  }
+
+  template <typename Left, typename Right>
+  Left &divide_by(Left &left, const Right &right) { return left = divide(left, right); }
+
+  template <typename Left, typename Right>
+  Left &modulo_by(Left &left, const Right &right) { return left = modulo(left, right); }
+
+  // for <name> in <int> counts up from zero
+  struct Range {
+    struct Iterator {
+      long long value;
+      long long operator*() const { return value; }
+      Iterator &operator++() { value++; return *this; }
+      bool operator!=(const Iterator &other) const { return value != other.value; }
+    };
+
+    long long count;
+    Iterator begin() const { return {0}; }
+    Iterator end() const { return {std::max(count, 0LL)}; }
+  };
+
+  inline Range each(long long count) { return {count}; }
+  template <typename T>
+  std::vector<T> &each(std::vector<T> &values) { return values; }
+  template <typename T>
+  const std::vector<T> &each(const std::vector<T> &values) { return values; }
+  template <typename T>
+  std::vector<T> each(std::vector<T> &&values) { return std::move(values); }
+
+  template <typename T, typename Init>
+  std::vector<T> array(long long count, Init init) {
+    std::vector<T> values;
+    values.reserve(std::max(count, 0LL));
+    for (long long it = 0; it < count; it++) values.push_back(init(it));
+    return values;
+  }
+
+  template <typename T, typename Value>
+  void push(std::vector<T> &values, Value &&value) { values.push_back(std::forward<Value>(value)); }
+  template <typename T>
+  T &at(std::vector<T> &values, long long index) { return values.at(index); }
+  template <typename T>
+  const T &at(const std::vector<T> &values, long long index) { return values.at(index); }
+
+  // An array lent by the caller of a native function, read where it lies
+  template <typename T>
+  struct Span {
+    const T *values;
+    long long count;
+
+    const T *begin() const { return values; }
+    const T *end() const { return values + count; }
+    long long size() const { return count; }
+  };
+
+  template <typename T>
+  void write(std::string &out, const Span<T> &values) { write(out, std::vector<T>(values.begin(), values.end())); }
+  template <typename T>
+  bool to_bool(const Span<T> &values) { return values.count > 0; }
+  template <typename T>
+  const Span<T> &each(const Span<T> &values) { return values; }
+  template <typename T>
+  const T &at(const Span<T> &values, long long index) {
+    if (index < 0 || index >= values.count) throw std::out_of_range("index out of range");
+    return values.values[index];
+  }
+
+  // What a native function hands back, and how its caller is told which it is
+  template <typename T>
+  constexpr int native_kind() {
+    static_assert(
+      std::is_void_v<T> || std::is_arithmetic_v<T>,
+      "native functions return an int, a float, a bool or nothing"
+    );
+    if constexpr (std::is_void_v<T>) return 0;
+    else if constexpr (std::is_same_v<T, bool>) return 3;
+    else if constexpr (std::is_integral_v<T>) return 1;
+    else return 2;
+  }
+
+  template <typename T>
+  using native_result = std::conditional_t<
+    std::is_void_v<T> || std::is_same_v<T, bool>,
+    T,
+    std::conditional_t<std::is_integral_v<T>, long long, double>
+  >;
+
+  inline std::string to_upper(std::string value) {
+    for (char &character : value) character = std::toupper(static_cast<unsigned char>(character));
+    return value;
+  }
+
+  inline std::string to_lower(std::string value) {
+    for (char &character : value) character = std::tolower(static_cast<unsigned char>(character));
+    return value;
+  }
+
+  inline std::string upper(const std::string &value) { return to_upper(value); }
+  inline std::string lower(const std::string &value) { return to_lower(value); }
+}
+)PRELUDE";
+
+const std::string CPP_PROGRAM = "\nnamespace program {\n\nusing namespace std::string_literals;\n\n";
+
+CppTranspiler::CppTranspiler(Diagnostics *diagnostics) {
+  this->diagnostics = diagnostics ? diagnostics : &echoed;
+}
+
+void CppTranspiler::report(const std::string &message) {
+  diagnostics->report(Diagnostic::Stage::EMIT, message, Diagnostic::Severity::INTERNAL);
+}
+
+std::string CppTranspiler::get_header() {
+  // Set before the globals of the program, its statements among them
+  return
+    CPP_PRELUDE + "\nstatic const std::terminate_handler terminating = std::set_terminate(pino::terminate);\n" +
+    CPP_PROGRAM;
+}
+
+std::string CppTranspiler::get_footer() {
+  return "}\n\nint main() {\n  return 0;\n}\n";
+}
+
+std::string CppTranspiler::get_name(const std::string &name) const {
+  return CPP_KEYWORDS.count(name) ? name + "_" : name;
+}
+
+std::string CppTranspiler::get_type(const Typing &typing) {
+  switch (typing.data) {
+    case Token::Literal::INTEGER:
+      return "long long";
+    case Token::Literal::FLOAT:
+      return "double";
+    case Token::Literal::STRING:
+      return "std::string";
+    case Token::Literal::BOOLEAN:
+      return "bool";
+    case Token::Literal::ARRAY: {
+      if (typing.children.empty()) break;
+      return "std::vector<" + get_type(typing.children.front()) + ">";
+    }
+    case Token::Literal::STRUCT:
+      return get_name(typing.value);
+    case Token::Literal::LAMBDA: {
+      std::vector<std::string> parameters;
+      for (const Typing &child : typing.children) parameters.push_back(get_type(child));
+      return "std::function<void(" + Utils::join(parameters, ", ") + ")>";
+    }
+    default:
+      break;
+  }
+
+  report("Type Unsupported");
+  return "auto";
+}
+
+std::string CppTranspiler::get_parameter(
+  const Variable *parameter,
+  bool is_lambda,
+  std::vector<std::string> &templates
+) {
+  std::string name = get_name(parameter->name);
+  const Typing &typing = parameter->typing;
+
+  // Functions are taken as they are, so closures are called without a std::function
+  if (typing.data == Token::Literal::LAMBDA) {
+    if (is_lambda) return "auto " + name;
+
+    templates.push_back("typename " + parameter->name + "_type");
+    return parameter->name + "_type " + name;
+  }
+
+  // Native functions read arrays where their caller keeps them
+  if (is_native && typing.data == Token::Literal::ARRAY && not typing.children.empty()) {
+    return "pino::Span<" + get_type(typing.children.front()) + "> " + name;
+  }
+
+  std::string type;
+  std::string initial;
+
+  if (parameter->value) initial = " = " + handle_expression(parameter->value);
+
+  if (parameter->value && typing.data == Token::Literal::UNKNOWN) {
+    type = "decltype(" + handle_expression(parameter->value) + ")";
+  } else {
+    type = get_type(typing);
+  }
+
+  bool is_value =
+    typing.data == Token::Literal::INTEGER ||
+    typing.data == Token::Literal::FLOAT ||
+    typing.data == Token::Literal::BOOLEAN ||
+    Utils::has_key(enums, typing.value);
+
+  return (is_value ? type + " " : "const " + type + " &") + name + initial;
+}
+
+Token::Literal CppTranspiler::get_value_type(
+  const Expression *expression,
+  const std::map<std::string, Token::Literal> &names
+) {
+  switch (expression->variant) {
+    case Expression::Variant::LITERAL: {
+      bool is_value =
+        expression->literal == Token::Literal::INTEGER ||
+        expression->literal == Token::Literal::FLOAT ||
+        expression->literal == Token::Literal::BOOLEAN ||
+        expression->literal == Token::Literal::STRING;
+
+      return is_value ? expression->literal : Token::Literal::UNKNOWN;
+    }
+    case Expression::Variant::IDENTIFIER: {
+      auto name = names.find(expression->value);
+      return name == names.end() ? Token::Literal::UNKNOWN : name->second;
+    }
+    case Expression::Variant::FUNCTION_CALL: {
+      auto result = CPP_CALL_RESULTS.find(expression->value);
+      return result == CPP_CALL_RESULTS.end() ? Token::Literal::UNKNOWN : result->second;
+    }
+    case Expression::Variant::BINARY: {
+      std::vector<Token::Literal> types;
+      bool is_boolean = false;
+      bool is_division = false;
+      const Expression *node = expression;
+
+      while (node->variant == Expression::Variant::BINARY) {
+        auto link = static_cast<const BinaryExpression *>(node);
+        // and / or give back an operand, which may or may not be a comparison
+        if (link->operation == "and" || link->operation == "or") return Token::Literal::UNKNOWN;
+        is_boolean = is_boolean || CPP_BOOLEAN_OPERATORS.count(link->operation);
+        is_division = is_division || link->operation == "/";
+        types.push_back(get_value_type(link->left.get(), names));
+        node = link->right.get();
+      }
+
+      // Members and assignments are left to deduction
+      if (node->is_binary()) return Token::Literal::UNKNOWN;
+      types.push_back(get_value_type(node, names));
+
+      auto has_type = [&types](Token::Literal type) {
+        return std::find(types.begin(), types.end(), type) != types.end();
+      };
+
+      // Comparisons bind looser than arithmetic, so one of them is outermost
+      if (is_boolean) return Token::Literal::BOOLEAN;
+      if (has_type(Token::Literal::UNKNOWN)) return Token::Literal::UNKNOWN;
+      if (has_type(Token::Literal::STRING)) return Token::Literal::STRING;
+      if (is_division || has_type(Token::Literal::FLOAT)) return Token::Literal::FLOAT;
+      return Token::Literal::INTEGER;
+    }
+    default:
+      return Token::Literal::UNKNOWN;
+  }
+}
+
+bool CppTranspiler::is_calling(const Expression *expression, const std::string &name) {
+  std::vector<const Expression *> pending = {expression};
+
+  while (not pending.empty()) {
+    const Expression *node = pending.back();
+    pending.pop_back();
+
+    if (node->variant == Expression::Variant::FUNCTION_CALL && node->value == name) return true;
+    for (const auto &argument : node->arguments) pending.push_back(argument.get());
+
+    if (node->is_binary()) {
+      auto binary = static_cast<const BinaryExpression *>(node);
+      pending.push_back(binary->left.get());
+      pending.push_back(binary->right.get());
+    }
+  }
+
+  return false;
+}
+
+bool CppTranspiler::has_effects(const Expression *expression) {
+  std::vector<const Expression *> pending = {expression};
+
+  while (not pending.empty()) {
+    const Expression *node = pending.back();
+    pending.pop_back();
+
+    bool is_effect =
+      node->variant == Expression::Variant::FUNCTION_CALL ||
+      node->variant == Expression::Variant::ASSIGNMENT ||
+      node->variant == Expression::Variant::BLOCK ||
+      (node->variant == Expression::Variant::LITERAL && (
+        node->literal == Token::Literal::ARRAY ||
+        node->literal == Token::Literal::STRUCT
+      ));
+
+    if (is_effect) return true;
+
+    if (node->is_binary()) {
+      auto binary = static_cast<const BinaryExpression *>(node);
+      pending.push_back(binary->left.get());
+      pending.push_back(binary->right.get());
+    }
+  }
+
+  return false;
+}
+
+Token::Literal CppTranspiler::get_return_type(const Function *function) {
+  // Types of the parameters and locals that are passed around by value
+  std::map<std::string, Token::Literal> names;
+  std::set<std::string> ambiguous;
+
+  for (const auto &parameter : function->parameters) {
+    switch (parameter->typing.data) {
+      case Token::Literal::INTEGER:
+      case Token::Literal::FLOAT:
+      case Token::Literal::BOOLEAN:
+      case Token::Literal::STRING:
+        names[parameter->name] = parameter->typing.data;
+        break;
+      default:
+        ambiguous.insert(parameter->name);
+    }
+  }
+
+  std::set<Token::Literal> types;
+  bool is_unknown = false;
+
+  // Returns of lambdas and nested functions are their own, so those aren't entered.
+  // Statements are paired with whether they are in a block of the body
+  std::vector<std::pair<const Statement *, bool>> pending;
+  for (auto child = function->children.rbegin(); child != function->children.rend(); child++) {
+    pending.push_back({child->get(), false});
+  }
+
+  while (not pending.empty()) {
+    auto [statement, is_nested] = pending.back();
+    pending.pop_back();
+
+    if (statement->kind != Statement::Kind::STATEMENT) continue;
+
+    switch (statement->type) {
+      case Statement::Type::FUNCTION_DECLARATION:
+        continue;
+      case Statement::Type::CONSTANT_DECLARATION:
+      case Statement::Type::VARIABLE_DECLARATION: {
+        auto variable = static_cast<const Variable *>(statement);
+        Token::Literal type = get_value_type(variable->value.get(), names);
+        auto known = names.find(variable->name);
+
+        // A name declared again with another type could be either at a return, and
+        // one declared in a block may be another outside it
+        bool is_known = known != names.end() && known->second == type;
+        bool is_ambiguous = type == Token::Literal::UNKNOWN || ambiguous.count(variable->name) || (known != names.end() && not is_known);
+
+        if (is_ambiguous || (is_nested && not is_known)) {
+          names.erase(variable->name);
+          ambiguous.insert(variable->name);
+        } else {
+          names[variable->name] = type;
+        }
+        break;
+      }
+      case Statement::Type::RETURN_STATEMENT: {
+        const Expression *value = static_cast<const Jump *>(statement)->value.get();
+        if (not value) break;
+
+        Token::Literal type = get_value_type(value, names);
+
+        // A return through the function itself has whatever type the others give
+        if (type != Token::Literal::UNKNOWN) types.insert(type);
+        else if (not is_calling(value, function->name)) is_unknown = true;
+        break;
+      }
+      case Statement::Type::IF_STATEMENT: {
+        auto conditional = static_cast<const If *>(statement);
+        if (conditional->else_block) pending.push_back({conditional->else_block.get(), true});
+        break;
+      }
+      case Statement::Type::LOOP_STATEMENT: {
+        auto loop = static_cast<const For *>(statement);
+
+        // The index takes the type of what is looped over
+        if (loop->variant == For::Variant::FOR_IN && loop->index->variant == Expression::Variant::IDENTIFIER) {
+          names.erase(loop->index->value);
+          ambiguous.insert(loop->index->value);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+
+    for (auto child = statement->children.rbegin(); child != statement->children.rend(); child++) {
+      pending.push_back({child->get(), true});
+    }
+  }
+
+  if (is_unknown || types.size() > 1) return Token::Literal::UNKNOWN;
+  if (types.size() == 1) return *types.begin();
+  return Token::Literal::VOID;
+}
+
+std::string CppTranspiler::get_capture() const {
+  return is_global ? "[]" : "[&]";
+}
+
+bool CppTranspiler::is_enum_value(const Expression *expression, std::string &qualified) const {
+  if (expression->variant != Expression::Variant::IDENTIFIER) return false;
+
+  std::vector<std::string> owners;
+  for (const auto &[name, values] : enums) {
+    if (std::find(values.begin(), values.end(), expression->value) != values.end()) {
+      owners.push_back(name);
+    }
+  }
+
+  // Inside an enum its own values win, elsewhere a value has to be unique
+  if (std::find(owners.begin(), owners.end(), enumeration) != owners.end()) {
+    owners = {enumeration};
+  }
+
+  if (owners.size() != 1) return false;
+
+  qualified = owners.front() + "::" + expression->value;
+  return true;
+}
+
+std::string CppTranspiler::handle_arr_literal(const Array *literal) {
+  std::string type = literal->typing.children.empty()
+    ? get_type(Typing::create(Token::Literal::UNKNOWN))
+    : get_type(literal->typing.children.front());
+
+  if (literal->len && literal->init) {
+    return
+      "pino::array<" + type + ">(" + handle_expression(literal->len) + ", " +
+      get_capture() + "(long long it) { return " + handle_expression(literal->init) + "; })";
+  }
+
+  if (literal->len) {
+    return "std::vector<" + type + ">(" + handle_expression(literal->len) + ")";
+  }
+
+  return "std::vector<" + type + ">()";
+}
+
+std::string CppTranspiler::handle_str_literal(const String *literal) {
+  bool has_injections = std::any_of(literal->segments.begin(), literal->segments.end(), [](const Segment &segment) {
+    return segment.kind == Segment::Kind::INJECTION;
+  });
+
+  if (not has_injections) {
+    return "\"" + literal->value + "\"s";
+  }
+
+  // Each segment is appended in turn, nothing is parsed at run time
+  std::vector<std::string> pieces;
+
+  for (const Segment &segment : literal->segments) {
+    std::string text = literal->value.substr(segment.start, segment.length);
+
+    if (segment.kind == Segment::Kind::INJECTION) {
+      Expression injection;
+      injection.variant = Expression::Variant::IDENTIFIER;
+      injection.value = text;
+      pieces.push_back(handle_expression(&injection));
+    } else if (not text.empty()) {
+      pieces.push_back("\"" + text + "\"");
+    }
+  }
+
+  return "pino::concat(" + Utils::join(pieces, ", ") + ")";
+}
+
+std::string CppTranspiler::handle_struct_literal(
+  const std::string &name,
+  const std::map<std::string, const Expression *> &given
+) {
+  auto structure = structs.find(name);
+  if (structure == structs.end()) {
+    report("Struct Unsupported");
+    return get_name(name) + "{}";
+  }
+
+  // Fields are given in declaration order, the ones left out keep their defaults
+  std::vector<std::string> values;
+
+  for (const Field &field : structure->second) {
+    auto value = given.find(field.name);
+
+    if (value != given.end()) {
+      values.push_back(handle_expression(value->second));
+    } else {
+      values.push_back(field.initial.empty() ? "{}" : field.initial);
+    }
+  }
+
+  return get_name(name) + "{" + Utils::join(values, ", ") + "}";
+}
+
+std::string CppTranspiler::handle_lambda(const Lambda *lambda) {
+  std::vector<std::string> templates;
+  std::vector<std::string> parameters;
+
+  for (const auto &parameter : lambda->parameters) {
+    parameters.push_back(get_parameter(parameter.get(), true, templates));
+  }
+
+  std::string capture = get_capture();
+  size_t indentation = current;
+  std::string body = emit_body(lambda->children, indentation + 1);
+
+  return
+    capture + "(" + Utils::join(parameters, ", ") + ") {\n" +
+    body + Utils::get_indent(indentation) + "}";
+}
+
+std::string CppTranspiler::handle_literal(const Expression *literal) {
+  switch (literal->literal) {
+    case Token::Literal::ARRAY:
+      return handle_arr_literal(static_cast<const Array *>(literal));
+    case Token::Literal::STRING:
+      return handle_str_literal(static_cast<const String *>(literal));
+    case Token::Literal::INTEGER:
+      return literal->value + "LL";
+    case Token::Literal::LAMBDA:
+      return handle_lambda(static_cast<const Lambda *>(literal));
+    case Token::Literal::STRUCT: {
+      const auto object = static_cast<const Object *>(literal);
+      std::map<std::string, const Expression *> given;
+
+      for (const auto &property : object->properties) {
+        given[property->name] = property->value.get();
+      }
+
+      return handle_struct_literal(object->name, given);
+    }
+    default:
+      return literal->value;
+  }
+}
+
+std::string CppTranspiler::handle_member(
+  const std::string &owner,
+  const Expression *subject,
+  const Expression *member
+) {
+  // Set when the owner is the name of an enum rather than a value
+  bool is_enum =
+    subject &&
+    subject->variant == Expression::Variant::IDENTIFIER &&
+    Utils::has_key(enums, subject->value);
+
+  if (member->variant == Expression::Variant::FUNCTION_CALL) {
+    if (is_enum) return handle_call(subject->value + "_" + member->value, member->arguments);
+
+    if (not methods.count(member->value) && CPP_BUILT_IN_METHODS.count(member->value)) {
+      return handle_call("pino::" + member->value, member->arguments, owner);
+    }
+
+    return handle_call(owner + "." + get_name(member->value), member->arguments);
+  }
+
+  if (member->variant == Expression::Variant::IDENTIFIER) {
+    if (is_enum) return subject->value + "::" + member->value;
+
+    if (member->value == "len" && not fields.count(member->value)) {
+      return "pino::len(" + owner + ")";
+    }
+
+    return owner + "." + get_name(member->value);
+  }
+
+  report("Expression Unsupported");
+  return owner;
+}
+
+std::string CppTranspiler::handle_call(
+  const std::string &name,
+  const std::vector<std::unique_ptr<Expression>> &arguments,
+  const std::string &owner
+) {
+  std::vector<std::string> lowered;
+  std::vector<bool> constant;
+  bool is_effect = false;
+  size_t read = 0;
+
+  if (not owner.empty()) {
+    lowered.push_back(owner);
+    constant.push_back(true);
+  }
+
+  for (const auto &argument : arguments) {
+    bool is_constant =
+      argument->variant == Expression::Variant::LITERAL && (
+        argument->literal == Token::Literal::INTEGER ||
+        argument->literal == Token::Literal::FLOAT ||
+        argument->literal == Token::Literal::BOOLEAN ||
+        (argument->literal == Token::Literal::STRING && std::none_of(
+          static_cast<const String *>(argument.get())->segments.begin(),
+          static_cast<const String *>(argument.get())->segments.end(),
+          [](const Segment &segment) { return segment.kind == Segment::Kind::INJECTION; }
+        ))
+      );
+
+    lowered.push_back(handle_expression(argument));
+    constant.push_back(is_constant);
+    is_effect = is_effect || has_effects(argument.get());
+    if (not is_constant) read++;
+  }
+
+  if (not is_effect || read < 2) return name + "(" + Utils::join(lowered, ", ") + ")";
+
+  // C++ leaves the order of arguments open, so where one may change what another
+  // reads they are bound first, left to right as Python evaluates them
+  std::string text = "(" + get_capture() + "() -> decltype(auto) {";
+  std::vector<std::string> forwarded;
+
+  for (size_t i = 0; i < lowered.size(); i++) {
+    if (constant[i]) {
+      forwarded.push_back(lowered[i]);
+      continue;
+    }
+
+    std::string temporary = "argument_" + std::to_string(counter++);
+    text += " auto &&" + temporary + " = " + lowered[i] + ";";
+    forwarded.push_back("std::forward<decltype(" + temporary + ")>(" + temporary + ")");
+  }
+
+  return text + " return " + name + "(" + Utils::join(forwarded, ", ") + "); }())";
+}
+
+std::string CppTranspiler::handle_comparison(const std::vector<std::string> &chain) {
+  if (chain.size() == 3) return chain[0] + " " + chain[1] + " " + chain[2];
+
+  // Python compares each operand with the next, evaluating each once and
+  // stopping at the first comparison that fails
+  std::string text = "(" + get_capture() + "() {";
+  std::string previous = "compare_" + std::to_string(counter++);
+  text += " auto &&" + previous + " = " + chain[0] + ";";
+
+  for (size_t i = 1; i + 1 < chain.size(); i += 2) {
+    std::string next = "compare_" + std::to_string(counter++);
+    std::string test = previous + " " + chain[i] + " " + next;
+    text += " auto &&" + next + " = " + chain[i + 1] + ";";
+    text += i + 2 < chain.size() ? " if (not (" + test + ")) return false;" : " return " + test + ";";
+    previous = next;
+  }
+
+  return text + " }())";
+}
+
+std::string CppTranspiler::handle_chain(const Expression *expression) {
+  // Chains lean right no matter the operators, so the spine is flattened and
+  // regrouped by precedence, which also keeps long chains off the stack
+  std::vector<const Expression *> nodes;
+  std::vector<std::string> operations;
+
+  const Expression *node = expression;
+  while (node->is_binary()) {
+    auto binary = static_cast<const BinaryExpression *>(node);
+    nodes.push_back(binary->left.get());
+    operations.push_back(binary->operation);
+    node = binary->right.get();
+  }
+
+  nodes.push_back(node);
+
+  // Property access binds tightest, so members are folded into their owners first
+  std::vector<Operand> terms;
+  std::vector<std::string> operators;
+  std::string term = handle_expression(nodes.front());
+  const Expression *subject = nodes.front();
+
+  for (size_t i = 0; i < operations.size(); i++) {
+    if (operations[i] == ":") {
+      term = handle_member(term, subject, nodes[i + 1]);
+      subject = nullptr;
+      continue;
+    }
+
+    terms.push_back({term, CPP_TERM_PRECEDENCE, subject ? get_value_type(subject, {}) : Token::Literal::UNKNOWN});
+    operators.push_back(operations[i]);
+    term = handle_expression(nodes[i + 1]);
+    subject = nodes[i + 1];
+  }
+
+  terms.push_back({term, CPP_TERM_PRECEDENCE, subject ? get_value_type(subject, {}) : Token::Literal::UNKNOWN});
+
+  auto wrap = [](const Operand &operand, int precedence) {
+    return operand.precedence < precedence ? "(" + operand.text + ")" : operand.text;
+  };
+
+  auto combine = [&](const Operand &left, const std::string &operation, const Operand &right) -> Operand {
+    int precedence = CPP_PRECEDENCE.at(operation);
+    auto function = CPP_OPERATOR_FN.find(operation);
+
+    if (function != CPP_OPERATOR_FN.end() && precedence == 0) {
+      return {function->second + "(" + left.text + ", " + right.text + ")", 0};
+    }
+
+    if (function != CPP_OPERATOR_FN.end()) {
+      Token::Literal type = left.type == right.type ? left.type : Token::Literal::UNKNOWN;
+      if (operation == "/") type = Token::Literal::FLOAT;
+      return {function->second + "(" + left.text + ", " + right.text + ")", CPP_TERM_PRECEDENCE, type};
+    }
+
+    if (precedence == 0) return {left.text + " " + operation + " " + right.text, 0};
+
+    // Comparisons chain, which is only the case when the left one is a comparison
+    // too, as nothing else of their precedence or looser can be an operand
+    if (precedence == CPP_PRECEDENCE.at("==")) {
+      std::vector<std::string> chain = not left.chain.empty()
+        ? left.chain
+        : std::vector<std::string>{wrap(left, precedence)};
+
+      chain.push_back(operation);
+      chain.push_back(wrap(right, precedence + 1));
+      return {handle_comparison(chain), chain.size() == 3 ? precedence : CPP_TERM_PRECEDENCE, Token::Literal::BOOLEAN, chain};
+    }
+
+    std::string symbol = operation == "and" ? "&&" : "||";
+    if (left.type == Token::Literal::BOOLEAN && right.type == Token::Literal::BOOLEAN) {
+      return {wrap(left, precedence) + " " + symbol + " " + wrap(right, precedence + 1), precedence, Token::Literal::BOOLEAN};
+    }
+
+    // Otherwise and / or give back one of their operands, as Python does
+    bool is_known = left.type != Token::Literal::UNKNOWN && right.type != Token::Literal::UNKNOWN;
+    if (is_known && left.type != right.type) {
+      report("Operands Of Different Types Unsupported");
+    }
+
+    std::string either = "either_" + std::to_string(counter++);
+    std::string test = (operation == "and" ? "not pino::to_bool(" : "pino::to_bool(") + either + ")";
+
+    return {
+      "(" + get_capture() + "() { auto " + either + " = " + left.text + "; return " + test + " ? " +
+        either + " : pino::either<decltype(" + either + ")>(" + right.text + "); }())",
+      CPP_TERM_PRECEDENCE,
+      left.type == right.type ? left.type : Token::Literal::UNKNOWN
+    };
+  };
+
+  std::vector<Operand> values = {terms.front()};
+  std::vector<std::string> pending;
+
+  auto reduce = [&]() {
+    Operand right = std::move(values.back());
+    values.pop_back();
+    Operand left = std::move(values.back());
+    values.pop_back();
+    values.push_back(combine(left, pending.back(), right));
+    pending.pop_back();
+  };
+
+  for (size_t i = 0; i < operators.size(); i++) {
+    int precedence = CPP_PRECEDENCE.at(operators[i]);
+
+    while (not pending.empty()) {
+      int top = CPP_PRECEDENCE.at(pending.back());
+      if (top < precedence || (top == precedence && precedence == 0)) break;
+      reduce();
+    }
+
+    pending.push_back(operators[i]);
+    values.push_back(terms[i + 1]);
+  }
+
+  while (not pending.empty()) reduce();
+
+  return values.front().text;
+}
+
+std::string CppTranspiler::handle_expression(const std::unique_ptr<Expression> &expression) {
+  return handle_expression(expression.get());
+}
+
+std::string CppTranspiler::handle_expression(const Expression *expression) {
+  switch (expression->variant) {
+    case Expression::Variant::ASSIGNMENT:
+    case Expression::Variant::PROPERTY_ACCESS:
+    case Expression::Variant::BINARY:
+      return handle_chain(expression);
+    case Expression::Variant::IDENTIFIER: {
+      std::string qualified;
+      if (not enumeration.empty() && is_enum_value(expression, qualified)) return qualified;
+      return get_name(expression->value);
+    }
+    case Expression::Variant::LITERAL:
+      return handle_literal(expression);
+    case Expression::Variant::FUNCTION_CALL: {
+      auto built_in = CPP_BUILT_IN_FN.find(expression->value);
+      std::string name = built_in != CPP_BUILT_IN_FN.end() ? built_in->second : get_name(expression->value);
+
+      return handle_call(name, expression->arguments);
+    }
+    case Expression::Variant::BLOCK: {
+      // Struct literals come out of the parser as blocks of "field: value" accesses
+      const auto block = static_cast<const Block *>(expression);
+      if (block->typing.data != Token::Literal::STRUCT) break;
+
+      std::map<std::string, const Expression *> given;
+
+      for (const auto &child : block->children) {
+        bool is_property =
+          child->kind == Statement::Kind::EXPRESSION &&
+          static_cast<const Expression *>(child.get())->variant == Expression::Variant::PROPERTY_ACCESS;
+
+        auto property = static_cast<const BinaryExpression *>(child.get());
+        if (not is_property || property->left->variant != Expression::Variant::IDENTIFIER) {
+          report("Expression Unsupported");
+          continue;
+        }
+
+        given[property->left->value] = property->right.get();
+      }
+
+      return handle_struct_literal(block->typing.value, given);
+    }
+    default:
+      break;
+  }
+
+  report("Expression Unsupported");
+  return "";
+}
+
+std::string CppTranspiler::emit_body(const std::vector<std::unique_ptr<Statement>> &children, size_t indentation) {
+  std::string outer = std::move(output);
+  size_t outer_current = current;
+  bool outer_global = is_global;
+
+  output.clear();
+  for (const auto &child : children) handle_statement(child.get(), indentation);
+
+  std::string body = std::move(output);
+  output = std::move(outer);
+  current = outer_current;
+  is_global = outer_global;
+  return body;
+}
+
+std::string CppTranspiler::emit_function(const Function *function, size_t indentation, const std::string &name) {
+  std::string indent = Utils::get_indent(indentation);
+  std::vector<std::string> templates;
+  std::vector<std::string> parameters;
+
+  for (const auto &parameter : function->parameters) {
+    parameters.push_back(get_parameter(parameter.get(), false, templates));
+  }
+
+  std::string text;
+  if (not templates.empty()) text += indent + "template <" + Utils::join(templates, ", ") + ">\n";
+
+  // Written out where the returns tell, so a return that recurses before any other
+  // doesn't need the type deduced yet. Otherwise it is deduced from the body
+  Token::Literal returned = get_return_type(function);
+  std::string type =
+    returned == Token::Literal::UNKNOWN ? "auto" :
+    returned == Token::Literal::VOID ? "void" :
+    get_type(Typing::create(returned));
+
+  text += indent + type + " " + name + "(" + Utils::join(parameters, ", ") + ") {\n";
+  text += emit_body(function->children, indentation + 1);
+  text += indent + "}\n";
+  return text;
+}
+
+void CppTranspiler::emit_struct(const Struct *structure) {
+  std::string name = get_name(structure->name);
+  std::vector<Field> declared;
+
+  output += "struct " + name + " {\n";
+
+  // Defaults are evaluated where the struct is declared, so they can't capture
+  is_global = true;
+
+  for (const auto &field : structure->fields) {
+    Field lowered = {field->name, ""};
+    std::string type;
+
+    if (field->value) lowered.initial = handle_expression(field->value);
+
+    if (field->value && field->typing.data == Token::Literal::UNKNOWN) {
+      type = "decltype(" + lowered.initial + ")";
+    } else {
+      type = get_type(field->typing);
+    }
+
+    output += "  " + type + " " + get_name(field->name);
+    output += lowered.initial.empty() ? ";\n" : " = " + lowered.initial + ";\n";
+
+    fields.insert(field->name);
+    declared.push_back(std::move(lowered));
+  }
+
+  // Registered before the methods, which may build values of their own struct
+  structs[structure->name] = std::move(declared);
+
+  for (const auto &method : structure->methods) {
+    methods.insert(method->name);
+    output += "\n" + emit_function(method.get(), 1, get_name(method->name));
+  }
+
+  output += "};\n\n";
+  output += "inline void write(std::string &out, const " + name + " &value) {\n";
+  output += "  out += \"" + structure->name + " {";
+
+  for (size_t i = 0; i < structure->fields.size(); i++) {
+    const std::string &field = structure->fields[i]->name;
+    output += std::string(i > 0 ? ", " : " ") + field + ": \";\n";
+    output += "  pino::repr(out, value." + get_name(field) + ");\n";
+    output += "  out += \"";
+  }
+
+  output += " }\";\n}\n\n";
+}
+
+void CppTranspiler::emit_enum(const Enum *declaration) {
+  std::string name = get_name(declaration->name);
+  enums[declaration->name] = declaration->values;
+
+  output += "enum class " + name + " {\n";
+  for (const std::string &value : declaration->values) output += "  " + value + ",\n";
+  output += "};\n\n";
+
+  output += "inline void write(std::string &out, " + name + " value) {\n";
+  output += "  static const char *const NAMES[] = {";
+
+  for (size_t i = 0; i < declaration->values.size(); i++) {
+    output += std::string(i > 0 ? ", " : "") + "\"" + declaration->name + ":" + declaration->values[i] + "\"";
+  }
+
+  output += "};\n  out += NAMES[static_cast<size_t>(value)];\n}\n\n";
+
+  // Methods take no value of the enum, so they are free functions named after it
+  enumeration = declaration->name;
+
+  for (const auto &method : declaration->methods) {
+    output += emit_function(method.get(), 0, declaration->name + "_" + method->name) + "\n";
+  }
+
+  enumeration.clear();
+}
+
+void CppTranspiler::handle_statement(const Statement *statement, size_t indentation) {
+  // Bodies are queued on an explicit stack so deeply nested programs don't recurse
+  std::vector<Pending> pending = {{statement, indentation, ""}};
+
+  while (not pending.empty()) {
+    Pending item = std::move(pending.back());
+    pending.pop_back();
+
+    if (not item.statement) {
+      output += item.text;
+      continue;
+    }
+
+    std::vector<Pending> body;
+    expand_statement(item.statement, item.indentation, body);
+    pending.insert(pending.end(), std::make_move_iterator(body.rbegin()), std::make_move_iterator(body.rend()));
+  }
+}
+
+void CppTranspiler::expand_statement(
+  const Statement *statement,
+  size_t indentation,
+  std::vector<Pending> &body
+) {
+  std::string indent = Utils::get_indent(indentation);
+  current = indentation;
+  is_global = indentation == 0;
+
+  if (statement->kind == Statement::Kind::EXPRESSION) {
+    output += indent + handle_expression(static_cast<const Expression *>(statement)) + ";\n";
+    return;
+  }
+
+  auto push_children = [&](const Statement *parent) {
+    for (const auto &child : parent->children) {
+      body.push_back({child.get(), indentation + 1, ""});
+    }
+  };
+
+  switch (statement->type) {
+    case Statement::Type::VARIABLE_DECLARATION: {
+      auto variable = static_cast<const Variable *>(statement);
+      output += indent + "auto " + get_name(variable->name) + " = " + handle_expression(variable->value) + ";\n";
+      break;
+    }
+    case Statement::Type::FUNCTION_DECLARATION: {
+      auto function = static_cast<const Function *>(statement);
+
+      if (indentation == 0) {
+        output += emit_function(function, 0, get_name(function->name)) + "\n";
+        break;
+      }
+
+      // Nested functions are closures over the body they are declared in
+      std::vector<std::string> templates;
+      std::vector<std::string> parameters;
+
+      for (const auto &parameter : function->parameters) {
+        parameters.push_back(get_parameter(parameter.get(), true, templates));
+      }
+
+      output += indent + "auto " + get_name(function->name) + " = [&](" + Utils::join(parameters, ", ") + ") {\n";
+      push_children(function);
+      body.push_back({nullptr, 0, indent + "};\n"});
+      break;
+    }
+    case Statement::Type::STRUCT_DECLARATION: {
+      if (indentation > 0) {
+        report("Statement Unsupported");
+        break;
+      }
+
+      emit_struct(static_cast<const Struct *>(statement));
+      break;
+    }
+    case Statement::Type::ENUM_DECLARATION: {
+      if (indentation > 0) {
+        report("Statement Unsupported");
+        break;
+      }
+
+      emit_enum(static_cast<const Enum *>(statement));
+      break;
+    }
+    case Statement::Type::IF_STATEMENT: {
+      auto if_statement = static_cast<const If *>(statement);
+      output += indent + "if (" + handle_expression(if_statement->condition) + ") {\n";
+      push_children(if_statement);
+
+      while (if_statement->else_block) {
+        const Else *else_block = if_statement->else_block.get();
+        const Statement *owner = else_block->get_body_owner();
+
+        if (owner == else_block) {
+          body.push_back({nullptr, 0, indent + "} else {\n"});
+          push_children(else_block);
+          break;
+        }
+
+        if_statement = static_cast<const If *>(owner);
+        body.push_back({nullptr, 0, indent + "} else if (" + handle_expression(if_statement->condition) + ") {\n"});
+        push_children(if_statement);
+      }
+
+      body.push_back({nullptr, 0, indent + "}\n"});
+      break;
+    }
+    case Statement::Type::MATCH_STATEMENT: {
+      expand_match(static_cast<const Match *>(statement), indentation, body);
+      break;
+    }
+    case Statement::Type::LOOP_STATEMENT: {
+      handle_loop_statement(static_cast<const For *>(statement), indentation);
+      push_children(statement);
+      body.push_back({nullptr, 0, indent + "}\n"});
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT: {
+      auto jump = static_cast<const Jump *>(statement);
+      output += indent + "return" + (jump->value ? " " + handle_expression(jump->value) : "") + ";\n";
+      break;
+    }
+    case Statement::Type::BREAK_STATEMENT: {
+      output += indent + "break;\n";
+      break;
+    }
+    case Statement::Type::CONTINUE_STATEMENT: {
+      output += indent + "continue;\n";
+      break;
+    }
+    default:
+      report("Statement Unsupported");
+  }
+}
+
+void CppTranspiler::expand_match(const Match *match, size_t indentation, std::vector<Pending> &body) {
+  std::string indent = Utils::get_indent(indentation);
+  std::string inner = Utils::get_indent(indentation + 1);
+  std::string subject = handle_expression(match->condition);
+
+  // Integers and enum values become a switch, unless an arm breaks out of a
+  // loop around the match, which inside a switch would only leave the switch
+  bool is_switch = true;
+  std::vector<const Statement *> stack;
+
+  for (const auto &arm : match->children) {
+    stack.push_back(arm.get());
+    if (arm->type != Statement::Type::WHEN_STATEMENT) continue;
+
+    std::string qualified;
+    for (const auto &condition : static_cast<const When *>(arm.get())->conditions) {
+      bool is_constant =
+        (condition->variant == Expression::Variant::LITERAL && condition->literal == Token::Literal::INTEGER) ||
+        is_enum_value(condition.get(), qualified);
+
+      if (not is_constant) is_switch = false;
+    }
+  }
+
+  while (is_switch && not stack.empty()) {
+    const Statement *node = stack.back();
+    stack.pop_back();
+
+    if (node->type == Statement::Type::BREAK_STATEMENT || node->type == Statement::Type::CONTINUE_STATEMENT) {
+      is_switch = false;
+    }
+
+    if (node->type == Statement::Type::LOOP_STATEMENT) continue;
+
+    for (const auto &child : node->children) stack.push_back(child.get());
+
+    if (node->type == Statement::Type::IF_STATEMENT) {
+      const auto if_statement = static_cast<const If *>(node);
+      if (if_statement->else_block) stack.push_back(if_statement->else_block.get());
+    }
+  }
+
+  auto get_condition = [&](const std::unique_ptr<Expression> &condition) {
+    std::string qualified;
+    return is_enum_value(condition.get(), qualified) ? qualified : handle_expression(condition);
+  };
+
+  auto push_arm = [&](const Statement *arm, size_t depth) {
+    for (const auto &child : arm->children) {
+      body.push_back({child.get(), depth, ""});
+    }
+  };
+
+  if (is_switch) {
+    output += indent + "switch (" + subject + ") {\n";
+
+    // A value given again can't be a case twice, and the first arm with it wins
+    std::set<std::string> labelled;
+
+    for (const auto &arm : match->children) {
+      std::vector<std::string> cases;
+
+      if (arm->type == Statement::Type::WHEN_STATEMENT) {
+        for (const auto &condition : static_cast<const When *>(arm.get())->conditions) {
+          std::string label = get_condition(condition);
+          if (labelled.insert(label).second) cases.push_back(inner + "case " + label + ":");
+        }
+
+        if (cases.empty()) continue;
+      } else {
+        cases.push_back(inner + "default:");
+      }
+
+      body.push_back({nullptr, 0, Utils::join(cases, "\n") + " {\n"});
+      push_arm(arm.get(), indentation + 2);
+      body.push_back({nullptr, 0, Utils::get_indent(indentation + 2) + "break;\n" + inner + "}\n"});
+    }
+
+    body.push_back({nullptr, 0, indent + "}\n"});
+    return;
+  }
+
+  // Anything else is compared arm by arm against the subject, evaluated once
+  std::string name = "match_" + std::to_string(counter++);
+  output += indent + "{\n" + inner + "const auto &" + name + " = " + subject + ";\n";
+
+  bool is_first = true;
+
+  for (const auto &arm : match->children) {
+    if (arm->type == Statement::Type::WHEN_STATEMENT) {
+      std::vector<std::string> tests;
+
+      for (const auto &condition : static_cast<const When *>(arm.get())->conditions) {
+        tests.push_back(name + " == " + get_condition(condition));
+      }
+
+      std::string test = Utils::join(tests, " || ");
+      body.push_back({nullptr, 0, inner + (is_first ? "if (" : "} else if (") + test + ") {\n"});
+    } else {
+      body.push_back({nullptr, 0, inner + (is_first ? "{\n" : "} else {\n")});
+    }
+
+    push_arm(arm.get(), indentation + 2);
+    is_first = false;
+  }
+
+  if (not is_first) body.push_back({nullptr, 0, inner + "}\n"});
+  body.push_back({nullptr, 0, indent + "}\n"});
+}
+
+void CppTranspiler::handle_loop_statement(const For *loop, size_t indentation) {
+  std::string indent = Utils::get_indent(indentation);
+
+  if (loop->index && loop->index->literal == Token::Literal::FLOAT) {
+    throw std::runtime_error("USER: Cannot use a float in a range loop");
+  }
+
+  if (loop->limit && loop->limit->literal == Token::Literal::FLOAT) {
+    throw std::runtime_error("USER: Cannot use a float in a range loop");
+  }
+
+  switch (loop->variant) {
+    case For::Variant::INFINITE: {
+      output += indent + "while (true) {\n";
+      break;
+    }
+    case For::Variant::TIMES: {
+      std::string name = "times_" + std::to_string(counter++);
+      output +=
+        indent + "for (long long " + name + " = " + handle_expression(loop->index) + "; " +
+        name + " > 0; " + name + "--) {\n";
+      break;
+    }
+    default: {
+      output +=
+        indent + "for (auto &&" + handle_expression(loop->index) +
+        " : pino::each(" + handle_expression(loop->limit) + ")) {\n";
+      break;
+    }
+  }
+}
+
+const std::string &CppTranspiler::emit(const Statement &program) {
+  output.clear();
+
+  for (const auto &statement : program.children) {
+    bool is_declaration =
+      statement->kind == Statement::Kind::STATEMENT && (
+        statement->type == Statement::Type::VARIABLE_DECLARATION ||
+        statement->type == Statement::Type::FUNCTION_DECLARATION ||
+        statement->type == Statement::Type::STRUCT_DECLARATION ||
+        statement->type == Statement::Type::ENUM_DECLARATION
+      );
+
+    if (is_declaration) {
+      handle_statement(statement.get(), 0);
+      continue;
+    }
+
+    if (statement->type == Statement::Type::IMPORT_STATEMENT) {
+      report("Statement Unsupported");
+      continue;
+    }
+
+    // Run where they stand among the globals, as those are initialised in order
+    output += "static const bool statement_" + std::to_string(counter++) + " = [] {\n";
+    handle_statement(statement.get(), 1);
+    output += "  return true;\n}();\n\n";
+  }
+
+  return output;
+}
+
+std::string CppTranspiler::emit_native(const Function *function) {
+  is_native = true;
+
+  std::string name = get_name(function->name);
+  // Without the terminate handler, which isn't for a library to set in its host
+  std::string text = CPP_PRELUDE + CPP_PROGRAM + emit_function(function, 0, name) + "\n}\n\n";
+
+  std::vector<std::string> declared;
+  std::vector<std::string> probes;
+  std::vector<std::string> arguments;
+
+  for (const auto &parameter : function->parameters) {
+    std::string argument = get_name(parameter->name);
+    const Typing &typing = parameter->typing;
+
+    if (typing.data == Token::Literal::ARRAY && not typing.children.empty()) {
+      std::string span = "pino::Span<" + get_type(typing.children.front()) + ">";
+      declared.push_back("const " + get_type(typing.children.front()) + " *" + argument + ", long long " + argument + "_count");
+      probes.push_back("std::declval<" + span + ">()");
+      arguments.push_back(span + "{" + argument + ", " + argument + "_count}");
+      continue;
+    }
+
+    declared.push_back(get_type(typing) + " " + argument);
+    probes.push_back("std::declval<" + get_type(typing) + ">()");
+    arguments.push_back(argument);
+  }
+
+  std::string symbol = "pino_" + function->name;
+  std::string result = symbol + "_result";
+
+  text += "using " + result + " = decltype(program::" + name + "(" + Utils::join(probes, ", ") + "));\n\n";
+  text += "extern \"C\" const int " + symbol + "_kind = pino::native_kind<" + result + ">();\n\n";
+  text += "extern \"C\" pino::native_result<" + result + "> " + symbol + "(" + Utils::join(declared, ", ") + ") {\n";
+  // The caller prints through buffers of its own, flushed before each call
+  text += "  struct Flush { ~Flush() { std::fflush(stdout); } } flush;\n\n";
+  text += "  try {\n";
+  text += "    return program::" + name + "(" + Utils::join(arguments, ", ") + ");\n";
+  // Nothing may be thrown across the C boundary, so errors end the program as they would in Python
+  text += "  } catch (const std::exception &error) {\n";
+  text += "    std::fflush(stdout);\n";
+  text += "    std::fprintf(stderr, \"" + function->name + ": %s\\n\", error.what());\n";
+  text += "    std::exit(1);\n";
+  text += "  }\n}\n";
+  return text;
+}
+
+void CppTranspiler::transpile(const std::string &file_path, const std::string &output_path) {
+  std::ifstream input(file_path);
+  std::ofstream file(output_path);
+
+  file << get_header();
+
+  Parser::parse_each(input, [&](Statement &program) {
+    file << emit(program);
+  });
+
+  file << get_footer();
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include "Utils.h"
+#include "Diagnostic.h"
+#include "Parser.cpp"
+#include "Statement.cpp"
+
+// Lowers programs to C++17 that builds into a standalone binary against the
+// standard library alone. Structs become value types, enums enum classes with
+// their methods as free functions, arrays vectors and lambdas closures. Top
+// level statements run in source order as the globals around them are set up
+class CppTranspiler {
+  // A statement still to be emitted, or text to emit once its body is done
+  struct Pending {
+    const Statement *statement;
+    size_t indentation;
+    std::string text;
+  };
+
+  // A field of a struct declared so far, with its default already lowered
+  struct Field {
+    std::string name;
+    std::string initial;
+  };
+
+  // An operand of a binary chain, with the precedence of its outermost operator,
+  // its type where the source makes it plain, and for comparisons what they chain
+  struct Operand {
+    std::string text;
+    int precedence;
+    Token::Literal type = Token::Literal::UNKNOWN;
+    std::vector<std::string> chain = {};
+  };
+
+  std::string output;
+  Diagnostics echoed;
+  Diagnostics *diagnostics;
+
+  // Declarations of the programs emitted so far, since they come one at a time
+  std::map<std::string, std::vector<Field>> structs;
+  std::map<std::string, std::vector<std::string>> enums;
+  std::set<std::string> fields;
+  std::set<std::string> methods;
+
+  // Numbers the temporaries and wrapped statements so their names never clash
+  size_t counter = 0;
+  // The enum whose methods are being emitted, where its values go unqualified
+  std::string enumeration;
+  // Indentation of the statement being emitted, for the bodies of its lambdas
+  size_t current = 0;
+  // Lambdas outside of any function can't capture
+  bool is_global = false;
+  // Arrays are taken as spans of what the caller lends, for emit_native
+  bool is_native = false;
+
+  void report(const std::string &message);
+
+  std::string get_name(const std::string &name) const;
+  std::string get_type(const Typing &typing);
+  std::string get_parameter(
+    const Variable *parameter,
+    bool is_lambda,
+    std::vector<std::string> &templates
+  );
+  // The type an expression evaluates to, from its literals, the built in
+  // functions it calls and the names given, or unknown when that takes deduction
+  static Token::Literal get_value_type(
+    const Expression *expression,
+    const std::map<std::string, Token::Literal> &names
+  );
+  static bool is_calling(const Expression *expression, const std::string &name);
+  // Whether evaluating an expression may call or assign, so when it runs matters
+  static bool has_effects(const Expression *expression);
+  std::string get_capture() const;
+  bool is_enum_value(const Expression *expression, std::string &qualified) const;
+
+  std::string handle_arr_literal(const Array *literal);
+  std::string handle_str_literal(const String *literal);
+  std::string handle_struct_literal(
+    const std::string &name,
+    const std::map<std::string, const Expression *> &given
+  );
+  std::string handle_lambda(const Lambda *lambda);
+  std::string handle_literal(const Expression *literal);
+  std::string handle_member(
+    const std::string &owner,
+    const Expression *subject,
+    const Expression *member
+  );
+  std::string handle_call(
+    const std::string &name,
+    const std::vector<std::unique_ptr<Expression>> &arguments,
+    const std::string &owner = ""
+  );
+  std::string handle_comparison(const std::vector<std::string> &chain);
+  std::string handle_chain(const Expression *expression);
+  std::string handle_expression(const std::unique_ptr<Expression> &expression);
+  std::string handle_expression(const Expression *expression);
+
+  std::string emit_body(const std::vector<std::unique_ptr<Statement>> &children, size_t indentation);
+  std::string emit_function(const Function *function, size_t indentation, const std::string &name);
+  void emit_struct(const Struct *structure);
+  void emit_enum(const Enum *enumeration);
+
+  void handle_statement(const Statement *statement, size_t indentation);
+  void expand_statement(
+    const Statement *statement,
+    size_t indentation,
+    std::vector<Pending> &body
+  );
+  void expand_match(const Match *match, size_t indentation, std::vector<Pending> &body);
+  void handle_loop_statement(const For *loop, size_t indentation);
+
+  public:
+    // Unsupported nodes are printed unless a sink is given to collect them
+    CppTranspiler(Diagnostics *diagnostics = nullptr);
+
+    // The runtime every program is emitted after, and what closes it off
+    static std::string get_header();
+    static std::string get_footer();
+
+    // What the returns of a function agree on, void when none gives a value, or
+    // unknown to leave it to deduction. The Python output annotates it for mypyc
+    static Token::Literal get_return_type(const Function *function);
+
+    // Emits the top level statements of a program, which may use anything the
+    // programs emitted before it declared
+    const std::string &emit(const Statement &program);
+
+    // A translation unit of the prelude and one function, exported with C
+    // linkage as pino_<name> taking each array as a pointer and a count, with
+    // pino_<name>_kind telling whether it returns nothing, an int, a float or a bool
+    std::string emit_native(const Function *function);
+
+    void transpile(const std::string &file_path, const std::string &output_path);
+};
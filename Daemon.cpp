@@ -0,0 +1,391 @@
+#pragma once
+
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Daemon.h"
+#include "Session.cpp"
+
+const size_t DAEMON_DEFAULT_MEMORY = 256;
+const size_t DAEMON_REQUEST_LIMIT = 4096;
+
+Daemon::Daemon(const std::string &socket_path, size_t memory_limit) {
+  this->socket_path = socket_path;
+  this->memory_limit = memory_limit;
+  memory = 0;
+  stats = {0, 0, 0, 0};
+  running = false;
+  inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+Daemon::~Daemon() {
+  if (inotify_fd >= 0) close(inotify_fd);
+}
+
+std::string Daemon::get_default_socket() {
+  std::string name = "pino-" + std::to_string(getuid()) + ".sock";
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+Daemon::Entry Daemon::compile(const std::string &path) {
+  Entry entry;
+  std::error_code error;
+  entry.modified = std::filesystem::last_write_time(path, error);
+  entry.file_size = std::filesystem::file_size(path, error);
+
+  try {
+    entry.compiled = session.compile(Utils::read_file(path));
+    entry.diagnostics = session.diagnostics.entries;
+  } catch (const std::exception &error) {
+    entry.compiled = false;
+    entry.diagnostics = {Diagnostic::from_exception(Diagnostic::Stage::LEX, error)};
+  }
+
+  entry.stream = std::move(session.stream);
+  entry.program = std::move(session.program);
+  entry.output = session.output;
+
+  // An estimate: tokens plus roughly one tree node for each of them
+  entry.bytes = sizeof(Entry) + entry.output.size() + 
+    entry.stream.size() * (sizeof(Token) + sizeof(Expression));
+  for (const Diagnostic &diagnostic : entry.diagnostics) {
+    entry.bytes += sizeof(Diagnostic) + diagnostic.message.size();
+  }
+
+  return entry;
+}
+
+void Daemon::store(const std::string &path, Entry entry) {
+  evict(path);
+
+  recency.push_front(path);
+  memory += entry.bytes;
+  slots.emplace(path, Slot{std::move(entry), recency.begin()});
+
+  // The newest entry stays even when it alone is over budget
+  while (memory > memory_limit && recency.size() > 1) {
+    evict(recency.back());
+    stats.evictions++;
+  }
+}
+
+void Daemon::evict(const std::string &path) {
+  auto slot = slots.find(path);
+  if (slot == slots.end()) return;
+
+  memory -= slot->second.entry.bytes;
+  recency.erase(slot->second.recency);
+  slots.erase(slot);
+}
+
+const Daemon::Entry &Daemon::lookup(const std::string &path) {
+  auto slot = slots.find(path);
+
+  if (slot != slots.end()) {
+    // Edits the watcher can't see, like files outside the roots, still show up here
+    std::error_code error;
+    const Entry &entry = slot->second.entry;
+    bool is_fresh = 
+      std::filesystem::last_write_time(path, error) == entry.modified &&
+      std::filesystem::file_size(path, error) == entry.file_size;
+
+    if (is_fresh) {
+      stats.hits++;
+      recency.splice(recency.begin(), recency, slot->second.recency);
+      return entry;
+    }
+  }
+
+  stats.misses++;
+  store(path, compile(path));
+  return slots.at(path).entry;
+}
+
+void Daemon::watch(const std::string &directory) {
+  if (inotify_fd < 0) return;
+
+  uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+  std::vector<std::string> pending = {directory};
+
+  while (not pending.empty()) {
+    std::string current = pending.back();
+    pending.pop_back();
+
+    int descriptor = inotify_add_watch(inotify_fd, current.c_str(), mask);
+    if (descriptor >= 0) watches[descriptor] = current;
+
+    std::error_code error;
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    for (const auto &entry : std::filesystem::directory_iterator(current, options, error)) {
+      if (entry.is_directory(error)) pending.push_back(entry.path().string());
+    }
+  }
+}
+
+void Daemon::handle_events() {
+  alignas(inotify_event) char buffer[16384];
+  ssize_t length;
+
+  while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+    for (char *cursor = buffer; cursor < buffer + length;) {
+      const auto event = reinterpret_cast<const inotify_event *>(cursor);
+      cursor += sizeof(inotify_event) + event->len;
+
+      // Events were lost, nothing cached can be trusted any more
+      if (event->mask & IN_Q_OVERFLOW) {
+        stats.evictions += slots.size();
+        slots.clear();
+        recency.clear();
+        memory = 0;
+        continue;
+      }
+
+      if (event->mask & IN_IGNORED) {
+        watches.erase(event->wd);
+        continue;
+      }
+
+      if (event->len == 0 || watches.find(event->wd) == watches.end()) continue;
+
+      std::filesystem::path path = std::filesystem::path(watches[event->wd]) / event->name;
+
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) watch(path.string());
+        continue;
+      }
+
+      if (path.extension() != ".pino") continue;
+
+      if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        evict(path.string());
+      } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        store(path.string(), compile(path.string()));
+        stats.recompiles++;
+      }
+    }
+  }
+}
+
+std::string Daemon::handle_request(const std::string &request) {
+  if (request == "stats") {
+    size_t lookups = stats.hits + stats.misses;
+    char rate[32];
+    snprintf(rate, sizeof(rate), "%.3f", lookups ? double(stats.hits) / lookups : 0.0);
+
+    return 
+      "ok\n"
+      "hits " + std::to_string(stats.hits) + "\n"
+      "misses " + std::to_string(stats.misses) + "\n"
+      "hit_rate " + rate + "\n"
+      "recompiles " + std::to_string(stats.recompiles) + "\n"
+      "evictions " + std::to_string(stats.evictions) + "\n"
+      "entries " + std::to_string(slots.size()) + "\n"
+      "memory " + std::to_string(memory) + "\n"
+      "memory_limit " + std::to_string(memory_limit) + "\n";
+  }
+
+  if (request == "shutdown") {
+    running = false;
+    return "ok\n";
+  }
+
+  if (request.rfind("compile ", 0) == 0) {
+    std::string path = request.substr(8);
+    const Entry &entry = lookup(path);
+
+    if (entry.compiled) return "ok\n" + entry.output;
+
+    std::string response = "error\n";
+    for (const Diagnostic &diagnostic : entry.diagnostics) {
+      if (diagnostic.severity == Diagnostic::Severity::NOTE) continue;
+      response += path + ": " + diagnostic.message + "\n";
+    }
+    return response;
+  }
+
+  return "error\nUnknown Request '" + request + "'\n";
+}
+
+// Writes all of data, false if the peer went away
+static bool send_all(int fd, const std::string &data) {
+  for (size_t sent = 0; sent < data.size();) {
+    ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) return false;
+    sent += count;
+  }
+
+  return true;
+}
+
+static bool make_address(const std::string &socket_path, sockaddr_un &address) {
+  address = {};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) return false;
+
+  std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+  return true;
+}
+
+int Daemon::serve(const std::vector<std::string> &roots) {
+  sockaddr_un address;
+  if (not make_address(socket_path, address)) {
+    println("Socket path too long '" + socket_path + "'");
+    return 2;
+  }
+
+  int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  unlink(socket_path.c_str());
+
+  if (
+    listener < 0 || 
+    bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+    listen(listener, 64) < 0
+  ) {
+    println("Unable to listen on '" + socket_path + "'");
+    if (listener >= 0) close(listener);
+    return 2;
+  }
+
+  for (const std::string &root : roots) {
+    watch(std::filesystem::absolute(root).lexically_normal().string());
+  }
+
+  println("Listening on " + socket_path);
+  running = true;
+
+  while (running) {
+    pollfd requests[2] = {{listener, POLLIN, 0}, {inotify_fd, POLLIN, 0}};
+    if (poll(requests, inotify_fd >= 0 ? 2 : 1, -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    if (inotify_fd >= 0 && requests[1].revents & POLLIN) handle_events();
+    if (not (requests[0].revents & POLLIN)) continue;
+
+    int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) continue;
+
+    // A client that stalls mid request can't hold the daemon up for long
+    timeval timeout = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[512];
+    ssize_t count;
+
+    while (request.find('\n') == std::string::npos && request.size() < DAEMON_REQUEST_LIMIT) {
+      count = recv(client, buffer, sizeof(buffer), 0);
+      if (count < 0 && errno == EINTR) continue;
+      if (count <= 0) break;
+      request.append(buffer, count);
+    }
+
+    if (request.find('\n') != std::string::npos) {
+      send_all(client, handle_request(request.substr(0, request.find('\n'))));
+    }
+
+    close(client);
+  }
+
+  close(listener);
+  unlink(socket_path.c_str());
+  return 0;
+}
+
+int Daemon::run(const std::vector<std::string> &arguments) {
+  std::string socket_path = get_default_socket();
+  size_t memory_limit = DAEMON_DEFAULT_MEMORY;
+  std::vector<std::string> roots;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    bool has_value = i + 1 < arguments.size();
+
+    if (arguments[i] == "--socket" && has_value) {
+      socket_path = arguments[++i];
+    } else if (arguments[i] == "--memory" && has_value) {
+      const std::string &megabytes = arguments[++i];
+      bool is_valid = not megabytes.empty() && std::all_of(megabytes.begin(), megabytes.end(), isdigit);
+
+      try {
+        if (is_valid) memory_limit = std::stoul(megabytes);
+      } catch (const std::out_of_range &) {
+        is_valid = false;
+      }
+
+      if (not is_valid || memory_limit > SIZE_MAX >> 20) {
+        println("Invalid memory limit '" + megabytes + "'");
+        return 2;
+      }
+    } else {
+      roots.push_back(arguments[i]);
+    }
+  }
+
+  if (roots.empty()) roots.push_back(".");
+
+  Daemon daemon(socket_path, memory_limit * 1024 * 1024);
+  return daemon.serve(roots);
+}
+
+int Daemon::request(const std::vector<std::string> &arguments) {
+  std::string socket_path = get_default_socket();
+  std::vector<std::string> words;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    if (arguments[i] == "--socket" && i + 1 < arguments.size()) {
+      socket_path = arguments[++i];
+    } else {
+      words.push_back(arguments[i]);
+    }
+  }
+
+  if (words.empty()) {
+    println("Expected a request: compile <file>, stats or shutdown");
+    return 2;
+  }
+
+  // The daemon runs elsewhere, so files are named by absolute path
+  if (words[0] == "compile" && words.size() == 2) {
+    words[1] = std::filesystem::absolute(words[1]).lexically_normal().string();
+  }
+
+  sockaddr_un address;
+  int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (
+    server < 0 ||
+    not make_address(socket_path, address) ||
+    connect(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+  ) {
+    println("No daemon listening on '" + socket_path + "'");
+    if (server >= 0) close(server);
+    return 2;
+  }
+
+  send_all(server, Utils::join(words, " ") + "\n");
+
+  std::string response;
+  char buffer[65536];
+  ssize_t count;
+
+  while ((count = recv(server, buffer, sizeof(buffer), 0)) != 0) {
+    if (count < 0 && errno == EINTR) continue;
+    if (count < 0) break;
+    response.append(buffer, count);
+  }
+
+  close(server);
+
+  size_t status_end = response.find('\n');
+  if (status_end == std::string::npos) {
+    println("Malformed response from the daemon");
+    return 2;
+  }
+
+  printsln(response.substr(status_end + 1));
+  return response.compare(0, status_end, "ok") == 0 ? 0 : 1;
+}
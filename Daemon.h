@@ -0,0 +1,80 @@
+#pragma once
+
+#include <filesystem>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Session.cpp"
+
+// A long lived compiler answering requests on a Unix socket. Every file it
+// compiled is kept with its tokens, tree, diagnostics and output until the
+// memory budget forces the least recently used ones out, and files that change
+// under the watched roots are compiled again before anyone asks for them.
+class Daemon {
+  public:
+    struct Entry {
+      Stream stream;
+      Statement program;
+      std::vector<Diagnostic> diagnostics;
+      std::string output;
+      bool compiled;
+      std::filesystem::file_time_type modified;
+      uintmax_t file_size;
+      size_t bytes;
+    };
+
+    struct Stats {
+      size_t hits;
+      size_t misses;
+      size_t recompiles;
+      size_t evictions;
+    };
+
+  private:
+    struct Slot {
+      Entry entry;
+      std::list<std::string>::iterator recency;
+    };
+
+    std::string socket_path;
+    size_t memory_limit;
+    size_t memory;
+    Stats stats;
+    bool running;
+
+    Session session;
+    // Most recently used first
+    std::list<std::string> recency;
+    std::unordered_map<std::string, Slot> slots;
+
+    int inotify_fd;
+    std::unordered_map<int, std::string> watches;
+
+    Entry compile(const std::string &path);
+    void store(const std::string &path, Entry entry);
+    void evict(const std::string &path);
+    const Entry &lookup(const std::string &path);
+
+    void watch(const std::string &directory);
+    void handle_events();
+
+    std::string handle_request(const std::string &request);
+
+  public:
+    Daemon(const std::string &socket_path, size_t memory_limit);
+    ~Daemon();
+
+    Daemon(const Daemon &) = delete;
+    Daemon &operator=(const Daemon &) = delete;
+
+    int serve(const std::vector<std::string> &roots);
+
+    static std::string get_default_socket();
+
+    // daemon [--socket PATH] [--memory MB] [path...]
+    static int run(const std::vector<std::string> &arguments);
+
+    // client [--socket PATH] compile <file> | stats | shutdown
+    static int request(const std::vector<std::string> &arguments);
+};
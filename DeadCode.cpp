@@ -0,0 +1,458 @@
+#pragma once
+
+#include "DeadCode.h"
+#include "Parser.cpp"
+#include "Fold.cpp"
+
+void DeadCode::add_references(const Typing &typing, std::set<std::string> &names) {
+  std::vector<const Typing *> pending = {&typing};
+
+  while (not pending.empty()) {
+    const Typing *current = pending.back();
+    pending.pop_back();
+
+    if (not current->value.empty()) names.insert(current->value);
+    for (const Typing &child : current->children) pending.push_back(&child);
+  }
+}
+
+void DeadCode::add_references(const Statement *node, std::set<std::string> &names) {
+  std::vector<const Statement *> pending = {node};
+
+  while (not pending.empty()) {
+    const Statement *current = pending.back();
+    pending.pop_back();
+
+    if (current->kind == Statement::Kind::EXPRESSION) {
+      auto expression = static_cast<const Expression *>(current);
+
+      switch (expression->variant) {
+        case Expression::Variant::IDENTIFIER:
+        case Expression::Variant::FUNCTION_CALL:
+          names.insert(expression->value);
+          break;
+        case Expression::Variant::BLOCK:
+          add_references(static_cast<const Block *>(expression)->typing, names);
+          break;
+        case Expression::Variant::LITERAL:
+          if (expression->literal == Token::Literal::STRING) {
+            for (const std::string &name : static_cast<const String *>(expression)->get_injections()) {
+              names.insert(name);
+            }
+          } else if (expression->literal == Token::Literal::STRUCT) {
+            // Properties are named after fields, but may stand for a name of the same spelling
+            auto object = static_cast<const Object *>(expression);
+            names.insert(object->name);
+            for (const auto &property : object->properties) names.insert(property->name);
+          } else if (expression->literal == Token::Literal::ARRAY) {
+            add_references(static_cast<const Array *>(expression)->typing, names);
+          }
+          break;
+        default:
+          break;
+      }
+    } else if (current->type == Statement::Type::VARIABLE_DECLARATION || current->type == Statement::Type::CONSTANT_DECLARATION) {
+      add_references(static_cast<const Variable *>(current)->typing, names);
+    } else if (current->type == Statement::Type::FUNCTION_DECLARATION) {
+      add_references(static_cast<const Function *>(current)->typing, names);
+    }
+
+    std::vector<const Statement *> nodes = Optimizer::get_nodes(current);
+    pending.insert(pending.end(), nodes.begin(), nodes.end());
+  }
+}
+
+bool DeadCode::is_terminal(const Statement *statement) {
+  std::vector<const Statement *> pending = {statement};
+
+  // Every path through the statement has to end in a jump
+  while (not pending.empty()) {
+    const Statement *current = pending.back();
+    pending.pop_back();
+
+    if (current->kind != Statement::Kind::STATEMENT) return false;
+
+    switch (current->type) {
+      case Statement::Type::RETURN_STATEMENT:
+      case Statement::Type::BREAK_STATEMENT:
+      case Statement::Type::CONTINUE_STATEMENT:
+        break;
+      case Statement::Type::IF_STATEMENT: {
+        auto conditional = static_cast<const If *>(current);
+        if (not conditional->else_block || conditional->children.empty()) return false;
+
+        pending.push_back(conditional->children.back().get());
+
+        const Else *otherwise = conditional->else_block.get();
+        if (otherwise->is_else_if) {
+          pending.push_back(otherwise->children.front().get());
+        } else if (otherwise->children.empty()) {
+          return false;
+        } else {
+          pending.push_back(otherwise->children.back().get());
+        }
+
+        break;
+      }
+      case Statement::Type::MATCH_STATEMENT: {
+        // Without an else arm a subject matching no arm gets past it
+        const Statement *last = current->children.back().get();
+        if (last->type != Statement::Type::ELSE_STATEMENT) return false;
+
+        for (const auto &arm : current->children) {
+          if (arm->children.empty()) return false;
+          pending.push_back(arm->children.back().get());
+        }
+
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool DeadCode::has_declarations(const std::vector<std::unique_ptr<Statement>> &statements) {
+  return std::any_of(statements.begin(), statements.end(), [](const auto &statement) {
+    return
+      statement->kind == Statement::Kind::STATEMENT && (
+        statement->type == Statement::Type::VARIABLE_DECLARATION ||
+        statement->type == Statement::Type::CONSTANT_DECLARATION ||
+        statement->type == Statement::Type::FUNCTION_DECLARATION ||
+        statement->type == Statement::Type::STRUCT_DECLARATION ||
+        statement->type == Statement::Type::ENUM_DECLARATION
+      );
+  });
+}
+
+std::vector<DeadCode::Body> DeadCode::get_bodies(Statement &program) {
+  std::vector<Body> bodies = {{&program.children, nullptr, true}};
+  std::vector<std::pair<Statement *, Statement *>> pending;
+
+  for (auto child = program.children.rbegin(); child != program.children.rend(); child++) {
+    pending.push_back({child->get(), nullptr});
+  }
+
+  while (not pending.empty()) {
+    auto [node, function] = pending.back();
+    pending.pop_back();
+
+    bool is_function =
+      node->kind == Statement::Kind::EXPRESSION ?
+        static_cast<Expression *>(node)->variant == Expression::Variant::LITERAL &&
+        static_cast<Expression *>(node)->literal == Token::Literal::LAMBDA :
+        node->type == Statement::Type::FUNCTION_DECLARATION;
+
+    if (is_function) function = node;
+
+    // Match arms are bodies of their own, the match's children aren't
+    bool has_body =
+      is_function || (
+        node->kind == Statement::Kind::STATEMENT && (
+          node->type == Statement::Type::IF_STATEMENT ||
+          node->type == Statement::Type::WHEN_STATEMENT ||
+          node->type == Statement::Type::LOOP_STATEMENT ||
+          (node->type == Statement::Type::ELSE_STATEMENT && not static_cast<Else *>(node)->is_else_if)
+        )
+      );
+
+    if (has_body) bodies.push_back({&node->children, function, false});
+
+    std::vector<Statement *> nodes = Optimizer::get_nodes(node);
+    for (auto child = nodes.rbegin(); child != nodes.rend(); child++) pending.push_back({*child, function});
+  }
+
+  return bodies;
+}
+
+void DeadCode::discard(std::vector<std::unique_ptr<Statement>> &statements, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) Optimizer::forget(statements[i].get(), typings);
+
+  statements.erase(statements.begin() + begin, statements.begin() + end);
+  changes += end - begin;
+}
+
+bool DeadCode::prune_if(Body &body, size_t index) {
+  auto &statements = *body.statements;
+  Statement *statement = statements[index].get();
+  if (statement->kind != Statement::Kind::STATEMENT || statement->type != Statement::Type::IF_STATEMENT) return false;
+
+  auto conditional = static_cast<If *>(statement);
+  std::optional<Fold::Constant> constant = Fold::get_constant(conditional->condition.get());
+  if (not constant) return false;
+
+  bool is_taken = Fold::is_truthy(*constant);
+  Else *otherwise = conditional->else_block.get();
+
+  // if false {} else if c {} is if c {}
+  if (not is_taken && otherwise && otherwise->is_else_if) {
+    std::unique_ptr<Statement> nested = std::move(otherwise->children.front());
+    Optimizer::forget(statement, typings);
+    statements[index] = std::move(nested);
+    changes++;
+    return true;
+  }
+
+  std::vector<std::unique_ptr<Statement>> *taken =
+    is_taken ? &conditional->children :
+    otherwise ? &otherwise->children :
+    nullptr;
+
+  if (not taken) {
+    if (statements.size() == 1 && not body.may_empty) return false;
+
+    discard(statements, index, index + 1);
+    return true;
+  }
+
+  // Declarations are scoped to the body in C++, so one with any stays where it is
+  if (taken->empty() || has_declarations(*taken)) {
+    if (not is_taken || not otherwise) return false;
+
+    Optimizer::forget(otherwise, typings);
+    conditional->else_block = nullptr;
+    changes++;
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Statement>> spliced = std::move(*taken);
+  Optimizer::forget(statement, typings);
+
+  statements.erase(statements.begin() + index);
+  statements.insert(
+    statements.begin() + index,
+    std::make_move_iterator(spliced.begin()),
+    std::make_move_iterator(spliced.end())
+  );
+
+  changes++;
+  return true;
+}
+
+bool DeadCode::prune_loop(Body &body, size_t index) {
+  auto &statements = *body.statements;
+  Statement *statement = statements[index].get();
+  if (statement->kind != Statement::Kind::STATEMENT || statement->type != Statement::Type::LOOP_STATEMENT) return false;
+
+  auto loop = static_cast<For *>(statement);
+  const Expression *count =
+    loop->variant == For::Variant::TIMES ? loop->index.get() :
+    loop->variant == For::Variant::FOR_IN ? loop->limit.get() :
+    nullptr;
+
+  if (not count) return false;
+
+  // Ranges up to zero or below are empty
+  std::optional<Fold::Constant> constant = Fold::get_constant(count);
+  if (not constant || constant->literal != Token::Literal::INTEGER || constant->integer > 0) return false;
+  if (statements.size() == 1 && not body.may_empty) return false;
+
+  discard(statements, index, index + 1);
+  return true;
+}
+
+void DeadCode::prune_body(Body &body) {
+  auto &statements = *body.statements;
+
+  for (size_t i = 0; i < statements.size(); i++) {
+    while (i < statements.size() && (prune_if(body, i) || prune_loop(body, i))) {}
+    if (i >= statements.size()) break;
+
+    if (is_terminal(statements[i].get())) {
+      discard(statements, i + 1, statements.size());
+      break;
+    }
+  }
+}
+
+void DeadCode::prune_locals(Statement &program) {
+  // Names read anywhere in each function, the functions nested in it included
+  std::map<const Statement *, std::set<std::string>> read;
+
+  for (Body &body : get_bodies(program)) {
+    if (not body.function) continue;
+
+    auto names = read.find(body.function);
+    if (names == read.end()) {
+      names = read.emplace(body.function, std::set<std::string>()).first;
+      add_references(body.function, names->second);
+    }
+
+    auto &statements = *body.statements;
+
+    for (size_t i = 0; i < statements.size() && statements.size() > 1;) {
+      const Statement *statement = statements[i].get();
+
+      bool is_unread = false;
+      if (statement->kind == Statement::Kind::STATEMENT && statement->type == Statement::Type::VARIABLE_DECLARATION) {
+        auto variable = static_cast<const Variable *>(statement);
+
+        // Anything but a literal could have effects of its own
+        is_unread =
+          variable->value &&
+          Fold::get_constant(variable->value.get()) &&
+          not names->second.count(variable->name);
+      }
+
+      if (is_unread) {
+        discard(statements, i, i + 1);
+      } else {
+        i++;
+      }
+    }
+  }
+}
+
+bool DeadCode::is_reached(const Declaration &declaration) const {
+  if (not declaration.owner.empty() && not reached.count(declaration.owner)) return false;
+  if (reached.count(declaration.name)) return true;
+
+  return std::any_of(declaration.aliases.begin(), declaration.aliases.end(), [this](const std::string &alias) {
+    return reached.count(alias) > 0;
+  });
+}
+
+void DeadCode::prune_declarations(Statement &program) {
+  auto &statements = program.children;
+
+  for (size_t i = 0; i < statements.size();) {
+    Statement *statement = statements[i].get();
+    Declaration declaration;
+    std::vector<std::unique_ptr<Function>> *methods = nullptr;
+
+    if (statement->kind != Statement::Kind::STATEMENT) {
+      i++;
+      continue;
+    }
+
+    switch (statement->type) {
+      case Statement::Type::FUNCTION_DECLARATION:
+        declaration.name = static_cast<Function *>(statement)->name;
+        break;
+      case Statement::Type::STRUCT_DECLARATION: {
+        auto type = static_cast<Struct *>(statement);
+        declaration.name = type->name;
+        methods = &type->methods;
+        break;
+      }
+      case Statement::Type::ENUM_DECLARATION: {
+        auto type = static_cast<Enum *>(statement);
+        declaration.name = type->name;
+        declaration.aliases = type->values;
+        methods = &type->methods;
+        break;
+      }
+      default:
+        i++;
+        continue;
+    }
+
+    if (not is_reached(declaration)) {
+      discard(statements, i, i + 1);
+      continue;
+    }
+
+    for (size_t j = 0; methods && j < methods->size();) {
+      Function *method = (*methods)[j].get();
+
+      if (is_reached({method->name, declaration.name})) {
+        j++;
+        continue;
+      }
+
+      Optimizer::forget(method, typings);
+      methods->erase(methods->begin() + j);
+      changes++;
+    }
+
+    i++;
+  }
+}
+
+void DeadCode::survey(const Statement &program) {
+  for (const auto &child : program.children) {
+    if (child->kind != Statement::Kind::STATEMENT) {
+      add_references(child.get(), roots);
+      continue;
+    }
+
+    switch (child->type) {
+      case Statement::Type::FUNCTION_DECLARATION: {
+        Declaration declaration = {static_cast<const Function *>(child.get())->name};
+        add_references(child.get(), declaration.references);
+        declarations.push_back(std::move(declaration));
+        break;
+      }
+      case Statement::Type::STRUCT_DECLARATION: {
+        auto type = static_cast<const Struct *>(child.get());
+        Declaration declaration = {type->name};
+        for (const auto &field : type->fields) add_references(field.get(), declaration.references);
+        declarations.push_back(std::move(declaration));
+
+        for (const auto &method : type->methods) {
+          Declaration entry = {method->name, type->name};
+          add_references(method.get(), entry.references);
+          declarations.push_back(std::move(entry));
+        }
+
+        break;
+      }
+      case Statement::Type::ENUM_DECLARATION: {
+        auto type = static_cast<const Enum *>(child.get());
+        declarations.push_back({type->name, "", type->values});
+
+        for (const auto &method : type->methods) {
+          Declaration entry = {method->name, type->name};
+          add_references(method.get(), entry.references);
+          declarations.push_back(std::move(entry));
+        }
+
+        break;
+      }
+      default:
+        add_references(child.get(), roots);
+        break;
+    }
+  }
+}
+
+void DeadCode::end_survey() {
+  reached = roots;
+  std::vector<bool> is_expanded(declarations.size(), false);
+  bool is_growing = true;
+
+  // Declarations reached add what they mention, until nothing new is reached
+  while (is_growing) {
+    is_growing = false;
+
+    for (size_t i = 0; i < declarations.size(); i++) {
+      if (is_expanded[i] || not is_reached(declarations[i])) continue;
+
+      is_expanded[i] = true;
+      is_growing = true;
+
+      reached.insert(declarations[i].name);
+      reached.insert(declarations[i].references.begin(), declarations[i].references.end());
+    }
+  }
+
+  is_surveyed = true;
+}
+
+size_t DeadCode::run(Statement &program, Context &context) {
+  typings = context.typings;
+  changes = 0;
+
+  if (is_surveyed) prune_declarations(program);
+
+  // Inside out, so a body ends in the jump it always takes by the time the one around it is pruned
+  std::vector<Body> bodies = get_bodies(program);
+  for (auto body = bodies.rbegin(); body != bodies.rend(); body++) prune_body(*body);
+
+  prune_locals(program);
+
+  typings = nullptr;
+  return changes;
+}
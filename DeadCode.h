@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Optimizer.h"
+#include "Fold.h"
+
+// Drops what can never run: statements after one that always returns, breaks
+// or continues, branches of ifs on a constant and loops run no times. Vals in
+// functions that nothing reads are dropped too, and with the whole program
+// surveyed, the functions, structs, enums and methods no top level statement
+// reaches. A body is never left empty, as Python would not take it
+class DeadCode : public Pass {
+  private:
+    // A list of statements between braces, or the top level statement at hand
+    struct Body {
+      std::vector<std::unique_ptr<Statement>> *statements;
+      // The function or lambda the body is in, null outside of them
+      Statement *function;
+      bool may_empty;
+    };
+
+    // A top level declaration, or a method of one, and the names it mentions
+    struct Declaration {
+      std::string name;
+      // The struct or enum of a method
+      std::string owner = {};
+      // Other names it is reached by, an enum's values
+      std::vector<std::string> aliases = {};
+      std::set<std::string> references = {};
+    };
+
+    std::vector<Declaration> declarations;
+    // Names mentioned by the top level statements that aren't declarations
+    std::set<std::string> roots;
+    std::set<std::string> reached;
+    bool is_surveyed = false;
+    Typings *typings = nullptr;
+    size_t changes = 0;
+
+    // Whether control never gets past the statement. Bodies are pruned inside
+    // out, so one that always ends in a jump ends with it
+    static bool is_terminal(const Statement *statement);
+    static bool has_declarations(const std::vector<std::unique_ptr<Statement>> &statements);
+
+    // The bodies under the program, each before the ones it holds
+    static std::vector<Body> get_bodies(Statement &program);
+
+    void discard(std::vector<std::unique_ptr<Statement>> &statements, size_t begin, size_t end);
+    // Whether the statement at the index was rewritten, to be looked at again
+    bool prune_if(Body &body, size_t index);
+    bool prune_loop(Body &body, size_t index);
+    void prune_body(Body &body);
+    void prune_locals(Statement &program);
+    void prune_declarations(Statement &program);
+
+    bool is_reached(const Declaration &declaration) const;
+
+  public:
+    // Every name the node and what it owns mention, types included
+    static void add_references(const Statement *node, std::set<std::string> &names);
+    static void add_references(const Typing &typing, std::set<std::string> &names);
+
+    void survey(const Statement &program) override;
+    void end_survey() override;
+
+    size_t run(Statement &program, Context &context) override;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Diagnostic.h"
+
+Diagnostic Diagnostic::from_exception(Stage stage, const std::exception &error) {
+  std::string message = error.what();
+  Severity severity = Severity::INTERNAL;
+
+  if (message.rfind("USER: ", 0) == 0) {
+    severity = Severity::USER;
+    message = message.substr(6);
+  } else if (message.rfind("DEV: ", 0) == 0) {
+    message = message.substr(5);
+  }
+
+  std::optional<size_t> line;
+  if (const auto source_error = dynamic_cast<const SourceError *>(&error)) {
+    line = source_error->line;
+  }
+
+  return {stage, severity, message, line};
+}
+
+Diagnostics::Diagnostics(bool echo) : echo(echo) {}
+
+void Diagnostics::report(
+  Diagnostic::Stage stage,
+  const std::string &message,
+  Diagnostic::Severity severity,
+  std::optional<size_t> line
+) {
+  entries.push_back({stage, severity, message, line});
+  if (echo) println(message);
+}
+
+void Diagnostics::report(Diagnostic::Stage stage, const std::exception &error) {
+  entries.push_back(Diagnostic::from_exception(stage, error));
+  if (echo) println(error.what());
+}
+
+bool Diagnostics::has_errors() const {
+  return std::any_of(entries.begin(), entries.end(), [](const Diagnostic &diagnostic) {
+    return diagnostic.severity != Diagnostic::Severity::NOTE;
+  });
+}
+
+void Diagnostics::clear() {
+  entries.clear();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Lexer.h"
+
+class Diagnostic {
+  public:
+    enum class Stage {
+      LEX,
+      PARSE,
+      CHECK,
+      OPTIMIZE,
+      EMIT,
+    };
+
+    // USER errors come from the source, INTERNAL ones are compiler bugs (DEV:)
+    // and a NOTE marks something a stage skipped without failing
+    enum class Severity {
+      USER,
+      INTERNAL,
+      NOTE,
+    };
+
+    Stage stage;
+    Severity severity;
+    std::string message;
+    // Zero based, missing when the error can't be tied to a line
+    std::optional<size_t> line;
+
+    static Diagnostic from_exception(Stage stage, const std::exception &error);
+};
+
+// Where a compilation reports its diagnostics, optionally echoing them as they arrive
+class Diagnostics {
+  public:
+    std::vector<Diagnostic> entries;
+    bool echo;
+
+    Diagnostics(bool echo = true);
+
+    void report(
+      Diagnostic::Stage stage,
+      const std::string &message,
+      Diagnostic::Severity severity = Diagnostic::Severity::USER,
+      std::optional<size_t> line = std::nullopt
+    );
+    void report(Diagnostic::Stage stage, const std::exception &error);
+
+    bool has_errors() const;
+    void clear();
+};
@@ -4,6 +4,20 @@
 #include "Enum.h"
 #include "Function.cpp"
 
+Enum::Enum() {
+  kind = Kind::STATEMENT;
+  type = Type::ENUM_DECLARATION;
+}
+
+Enum::~Enum() {
+  dismantle();
+}
+
+void Enum::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, methods);
+  Statement::release(pending);
+}
+
 PeekPtr<Enum> Enum::build(Stream &stream, const size_t &start_index) {
   PeekPtr<Enum> result;
 
@@ -37,6 +51,7 @@ PeekPtr<Enum> Enum::build(Stream &stream, const size_t &start_index) {
 
     if (next.data.kind == Token::Kind::KEYWORD) {
       PeekPtr<Function> method = Function::build(stream, next.end_index);
+      method.data->line = next.data.line;
 
       result.data->methods.push_back(std::move(method.data));
       index = method.end_index;
@@ -66,28 +81,29 @@ PeekPtr<Enum> Enum::build(Stream &stream, const size_t &start_index) {
     }
 
     result.data->values.push_back(next.data.data);
+    result.data->value_lines.push_back(next.data.line);
     index = next.end_index;
   }
 
   throw std::runtime_error("USER: Unterminated Enum " + name.data.data + " Declaration");
 }
 
-void Enum::print(size_t indent) const {
+void Enum::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
 
-  println(indentation + "Enum: " + name + " {");
-  println(indentation+ "  values: {");
+  printer.line(indentation + "Enum: " + name + " {");
+  printer.line(indentation+ "  values: {");
   for (const std::string &value : values) {
-    println(indentation + "    " + value);
+    printer.line(indentation + "    " + value);
   }
-  println(indentation + "  }");
+  printer.line(indentation + "  }");
   if (not methods.empty()) {
-    println(indentation + "  methods: {");
+    printer.line(indentation + "  methods: {");
     for (const auto &fun : methods) {
-      fun->print(indent + 2);
+      printer.child(fun.get(), indent + 2);
     }
-    println(indentation + "  }");
+    printer.line(indentation + "  }");
   }
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
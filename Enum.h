@@ -6,12 +6,19 @@
 
 class Enum : public Statement {
   public:
-    Type type = Type::ENUM_DECLARATION;
     std::string name;
     std::vector<std::string> values;
+    // Source line of each value
+    std::vector<size_t> value_lines;
     std::vector<std::unique_ptr<Function>> methods;
 
+    Enum();
+
+    ~Enum() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static PeekPtr<Enum> build(Stream &stream, const size_t &start_index);
 
-    virtual void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
\ No newline at end of file
@@ -9,7 +9,7 @@
 
 class Variable;
 
-std::map<Expression::Variant, std::string> EXPRESSION_TYPE_NAME = {
+const std::map<Expression::Variant, std::string> EXPRESSION_TYPE_NAME = {
   {Expression::Variant::LITERAL, "Literal"},
   {Expression::Variant::IDENTIFIER, "Identifier"},
   {Expression::Variant::BINARY, ""},
@@ -22,14 +22,22 @@ Expression::Expression() {
   kind = Kind::EXPRESSION;
 }
 
+Expression::~Expression() {
+  dismantle();
+}
+
+void Expression::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, arguments);
+  Statement::release(pending);
+}
+
 bool Expression::is_expression(Stream &stream, const size_t &start_index) {
   return 
     Block::is_block(stream, start_index) ||
-    stream.is_next(start_index, [](const Token token) {
+    stream.is_next(start_index, [](const Token &token) {
       return token.is_given_kind(Token::Kind::IDENTIFIER, Token::Kind::LITERAL);
     }) || 
-    Function::is_lambda(stream, start_index) ||
-    BinaryExpression::is_binary_expression(stream, start_index);
+    Function::is_lambda(stream, start_index);
 }
 
 PeekPtr<Expression> Expression::build(
@@ -43,10 +51,13 @@ PeekPtr<Expression> Expression::build(
     throw std::runtime_error("DEV: Not an Expression");
   }
 
+  const size_t line = stream.get_next(start_index).line;
+
   if (Block::is_block(stream, start_index)) {
     PeekPtr<Block> block = Block::build(stream, start_index);
 
     result.data = std::move(block.data);
+    result.data->line = line;
     result.end_index = block.end_index;
 
     return result;
@@ -54,15 +65,15 @@ PeekPtr<Expression> Expression::build(
 
   if (BinaryExpression::is_binary_expression(stream, start_index) && with_binary) {
     PeekPtr<BinaryExpression> child = BinaryExpression::build(stream, start_index);
-    result.data->value = child.data->value;
     result.data = std::move(child.data);
+    result.data->line = line;
     result.end_index = child.end_index;
   } else {
     if (Function::is_lambda(stream, start_index)) {
       PeekPtr<Lambda> lambda = Function::build_as_lambda(stream, start_index);
 
-      result.data->value = lambda.data->value;
       result.data = std::move(lambda.data);
+      result.data->line = line;
       result.end_index = lambda.end_index;
       
       return result;
@@ -76,25 +87,24 @@ PeekPtr<Expression> Expression::build(
       if (is_arr_literal) {
         PeekPtr<Array> child = Array::build(stream, start_index);
 
-        result.data->value = child.data->value;
         result.data = std::move(child.data);
         result.end_index = child.end_index;
       } else if (is_struct_literal) {
         PeekPtr<Object> child = Struct::build_as_struct_literal(stream, start_index);
 
-        result.data->value = child.data->value;
         result.data = std::move(child.data);
         result.end_index = child.end_index;
       } else {
         PeekPtr<Expression> child = Function::build_as_fn_call(stream, start_index);
 
-        result.data->value = child.data->value;
         result.data = std::move(child.data);
         result.end_index = child.end_index;
       }
 
+      result.data->line = line;
+
       // <fn call/struct literal> <operator> <expression>
-      bool is_incomplete = stream.is_next(result.end_index, [](const Token token) {
+      bool is_incomplete = stream.is_next(result.end_index, [](const Token &token) {
         return Token::is_binary_operator(token.data);
       });
 
@@ -109,16 +119,18 @@ PeekPtr<Expression> Expression::build(
       return result;
     }
 
-    Token next = stream.get_next(start_index);
+    const Token &next = stream.get_next(start_index);
 
     if (next.is_given_literal(Token::Literal::STRING)) {
-      result.data = std::move(String::create(next));
+      result.data = String::create(next);
     } else {
       result.data->variant = 
       next.kind == Token::Kind::IDENTIFIER ? Variant::IDENTIFIER : Variant::LITERAL;
       result.data->literal = next.literal;
       result.data->value = next.data;
     }
+
+    result.data->line = line;
     
     result.end_index = start_index + 1;
   }
@@ -126,28 +138,28 @@ PeekPtr<Expression> Expression::build(
   return result;
 }
 
-void Expression::print(size_t indent) const {
+void Expression::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
 
   if (variant == Variant::FUNCTION_CALL) {
-    println(indentation + "Function Call {");
-    println(indentation + "  name: " + value);
+    printer.line(indentation + "Function Call {");
+    printer.line(indentation + "  name: " + value);
     
     if (not arguments.empty()) {
-      println(indentation + "  arguments: [");
+      printer.line(indentation + "  arguments: [");
       for (const std::unique_ptr<Expression> &argument : arguments) {
-        argument->print(indent + 2);
+        printer.child(argument.get(), indent + 2);
       }
-      println(indentation + "  ]");
+      printer.line(indentation + "  ]");
     }
 
-    println(indentation + "}");
+    printer.line(indentation + "}");
     return;
   }
 
-  println(indentation + "Expression {");
-  println(indentation + "  value: " + value);
-  println(indentation + "}");
+  printer.line(indentation + "Expression {");
+  printer.line(indentation + "  value: " + value);
+  printer.line(indentation + "}");
 }
 
 std::string Expression::to_string(size_t indent) const {
@@ -172,10 +184,46 @@ std::string Expression::to_string(size_t indent) const {
   return EXPRESSION_TYPE_NAME.at(variant) + " { " + value + " }";
 }
 
+bool Expression::is_binary() const {
+  return 
+    variant == Variant::BINARY || 
+    variant == Variant::ASSIGNMENT || 
+    variant == Variant::PROPERTY_ACCESS;
+}
+
+std::string Expression::to_source() const {
+  std::string output;
+  write_source(output);
+  return output;
+}
+
+void Expression::write_source(std::string &output) const {
+  output += value;
+
+  if (variant == Variant::FUNCTION_CALL) {
+    output += "(";
+    for (size_t i = 0; i < arguments.size(); i++) {
+      if (i > 0) output += ", ";
+      arguments[i]->write_source(output);
+    }
+    output += ")";
+  }
+}
+
+BinaryExpression::~BinaryExpression() {
+  dismantle();
+}
+
+void BinaryExpression::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, left);
+  hand_over(pending, right);
+  Expression::release(pending);
+}
+
 bool BinaryExpression::is_binary_expression(Stream &stream, const size_t &start_index) {
   return 
   Expression::is_expression(stream, start_index) &&
-  stream.is_next(start_index + 1, [](const Token token) {
+  stream.is_next(start_index + 1, [](const Token &token) {
     return Token::is_binary_operator(token.data);
   });
 }
@@ -187,93 +235,153 @@ PeekPtr<BinaryExpression> BinaryExpression::build(
 ) {
   PeekPtr<BinaryExpression> result;
 
-  if (with_left) {
-    PeekPtr<Expression> left = Expression::build(stream, start_index, false);
-    result.data->value = left.data->value;
-    result.data->left = std::move(left.data);
-    result.end_index = left.end_index;
-  }
+  // Operator chains are collected in a loop and then folded into the same
+  // right leaning tree, so long chains don't recurse once per operator
+  std::vector<std::unique_ptr<BinaryExpression>> links;
+  size_t index = start_index;
+  bool has_left = with_left;
 
-  Peek<Token> operation = stream.peek(start_index + with_left, [](const Token token) {
-    return Token::is_binary_operator(token.data);
-  });
+  while (true) {
+    auto link = std::make_unique<BinaryExpression>();
 
-  if (Utils::any_of(operation.data.data, { "=", "+=", "-=", "*=", "/=", "%=" })) {
-    result.data->variant = Expression::Variant::ASSIGNMENT;
-  } else if (operation.data.data == ":") {
-    result.data->variant = Expression::Variant::PROPERTY_ACCESS;
-  } else {
-    result.data->variant = Expression::Variant::BINARY;
+    if (has_left) {
+      PeekPtr<Expression> left = Expression::build(stream, index, false);
+      link->left = std::move(left.data);
+    }
+
+    Peek<Token> operation = stream.peek(index + has_left, [](const Token &token) {
+      return Token::is_binary_operator(token.data);
+    });
+
+    if (Utils::any_of(operation.data.data, { "=", "+=", "-=", "*=", "/=", "%=" })) {
+      link->variant = Expression::Variant::ASSIGNMENT;
+    } else if (operation.data.data == ":") {
+      link->variant = Expression::Variant::PROPERTY_ACCESS;
+    } else {
+      link->variant = Expression::Variant::BINARY;
+    }
+
+    link->operation = operation.data.data;
+    link->line = operation.data.line;
+    links.push_back(std::move(link));
+    index = operation.end_index;
+
+    bool is_chained = 
+      not Block::is_block(stream, index) && 
+      BinaryExpression::is_binary_expression(stream, index);
+
+    if (not is_chained) break;
+    has_left = true;
   }
 
-  result.data->operation = operation.data.data;
-  result.data->value += " " + operation.data.data;
-  result.end_index = operation.end_index;
+  PeekPtr<Expression> right = Expression::build(stream, index);
+  std::unique_ptr<Expression> tail = std::move(right.data);
+
+  for (size_t i = links.size() - 1; i > 0; i--) {
+    links[i]->right = std::move(tail);
+    tail = std::move(links[i]);
+  }
 
-  PeekPtr<Expression> right = Expression::build(stream, operation.end_index);
-  result.data->value += " " + right.data->value;
-  result.data->right = std::move(right.data);
+  links[0]->right = std::move(tail);
+  result.data = std::move(links[0]);
   result.end_index = right.end_index;
 
   return result;
 }
 
-void BinaryExpression::print(size_t indent) const {
+void BinaryExpression::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
 
-  println(indentation + "Binary Expression {");
+  printer.line(indentation + "Binary Expression {");
   
   if (variant != Expression::Variant::BINARY) {
     std::string name = EXPRESSION_TYPE_NAME.at(variant);
-    println(indentation + "  variant: " + name);
+    printer.line(indentation + "  variant: " + name);
   }  
 
-  println(indentation + "  left: " + left->to_string(indent + 1));
-  println(indentation + "  operation: " + operation);
-  println(indentation + "  right: " + right->to_string(indent + 1));
-  println(indentation + "}");
+  printer.line(indentation + "  left: " + left->to_string(indent + 1));
+  printer.line(indentation + "  operation: " + operation);
+  printer.line(indentation + "  right: " + right->to_string(indent + 1));
+  printer.line(indentation + "}");
 }
 
 std::string BinaryExpression::to_string(size_t indent) const {
-  std::string indentation = Utils::get_indent(indent);
   std::string result;
+  size_t depth = indent;
+  const BinaryExpression *node = this;
 
-  result += "Binary Expression {\n";
-  
-  if (variant != Expression::Variant::BINARY) {
-    std::string name = EXPRESSION_TYPE_NAME.at(variant);
-    result += indentation + "  variant: " + name + "\n";
+  // Walks the right leaning spine of a chain instead of recursing into it
+  while (true) {
+    std::string indentation = Utils::get_indent(depth);
+
+    result += "Binary Expression {\n";
+    
+    if (node->variant != Expression::Variant::BINARY) {
+      std::string name = EXPRESSION_TYPE_NAME.at(node->variant);
+      result += indentation + "  variant: " + name + "\n";
+    }
+
+    result += indentation + "  left: " + node->left->to_string(depth + 1) + "\n";
+    result += indentation + "  operation: " + node->operation + "\n";
+    result += indentation + "  right: ";
+
+    if (not node->right->is_binary()) {
+      result += node->right->to_string(depth + 1);
+      break;
+    }
+
+    node = static_cast<const BinaryExpression *>(node->right.get());
+    depth++;
   }
 
-  result += indentation + "  left: " + left->to_string(indent + 1) + "\n";
-  result += indentation + "  operation: " + operation + "\n";
-  result += indentation + "  right: " + right->to_string(indent + 1) + "\n";
-  result += indentation + "}";
+  for (size_t level = depth + 1; level-- > indent;) {
+    result += "\n" + Utils::get_indent(level) + "}";
+  }
 
   return result;
 }
 
-std::unique_ptr<String> String::create(Token &literal) {
+void BinaryExpression::write_source(std::string &output) const {
+  const Expression *node = this;
+
+  while (node->is_binary()) {
+    auto binary = static_cast<const BinaryExpression *>(node);
+    binary->left->write_source(output);
+
+    if (binary->variant == Expression::Variant::PROPERTY_ACCESS) {
+      output += binary->operation;
+    } else {
+      output += " " + binary->operation + " ";
+    }
+
+    node = binary->right.get();
+  }
+
+  node->write_source(output);
+}
+
+std::unique_ptr<String> String::create(const Token &literal) {
   std::unique_ptr<String> str = std::make_unique<String>();
   
-  str->literal = std::move(literal.literal);
-  str->injections = std::move(literal.injections);
+  str->literal = literal.literal;
+  str->segments = literal.segments;
   str->variant = Expression::Variant::LITERAL;
-  str->value = std::move(literal.data);
+  str->value = literal.data;
 
   return str;
 }
 
-void String::print(size_t indent) const {
+void String::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
 
-  println(indentation + "String {");
-  println(indentation + "  value: " + value);
+  printer.line(indentation + "String {");
+  printer.line(indentation + "  value: " + value);
   
+  std::vector<std::string> injections = get_injections();
   if (not injections.empty()) {
-    println(indentation + "  injections: [" + Utils::join(injections, ", ") + "]");
+    printer.line(indentation + "  injections: [" + Utils::join(injections, ", ") + "]");
   }
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
 std::string String::to_string(size_t indent) const {
@@ -283,10 +391,27 @@ std::string String::to_string(size_t indent) const {
   result += "String {\n";
   result += indentation + "  value: " + value + "\n";
   
+  std::vector<std::string> injections = get_injections();
   if (not injections.empty()) {
     result += indentation + "  injections: [" + Utils::join(injections, ", ") + "]\n";
   }
   result += indentation + "}";
 
   return result;
+}
+
+std::vector<std::string> String::get_injections() const {
+  std::vector<std::string> injections;
+
+  for (const Segment &segment : segments) {
+    if (segment.kind == Segment::Kind::INJECTION) {
+      injections.push_back(value.substr(segment.start, segment.length));
+    }
+  }
+
+  return injections;
+}
+
+void String::write_source(std::string &output) const {
+  output += "\"" + value + "\"";
 }
\ No newline at end of file
@@ -23,19 +23,30 @@ class Expression : public Statement {
     };
 
     Variant variant;
-    Token::Literal literal;
+    Token::Literal literal = Token::Literal::UNKNOWN;
     std::string value;
     std::vector<std::unique_ptr<Expression>> arguments;
 
     Expression();
 
+    ~Expression() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static bool is_expression(Stream &stream, const size_t &start_index);
 
     static PeekPtr<Expression> build(Stream &stream, const size_t &start_index, const bool &with_binary = true);
 
-    void print(size_t indent = 0) const override;
+    void describe(Printer &printer, size_t indent) const override;
 
     virtual std::string to_string(size_t indent = 0) const;
+
+    bool is_binary() const;
+
+    // Source text is rendered on demand instead of being stored on every node
+    std::string to_source() const;
+
+    virtual void write_source(std::string &output) const;
 };
 
 class BinaryExpression : public Expression {
@@ -44,6 +55,10 @@ class BinaryExpression : public Expression {
     std::unique_ptr<Expression> right;
     std::string operation;
 
+    ~BinaryExpression() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static bool is_binary_expression(Stream &stream, const size_t &start_index);
 
     static PeekPtr<BinaryExpression> build(
@@ -52,9 +67,11 @@ class BinaryExpression : public Expression {
       const bool &with_left = true 
     );
 
-    void print(size_t indent = 0) const override;
+    void describe(Printer &printer, size_t indent) const override;
 
     virtual std::string to_string(size_t indent = 0) const;
+
+    void write_source(std::string &output) const override;
 };
 
 // Struct Literal
@@ -63,15 +80,21 @@ class Object : public Expression {
     std::string name;
     std::vector<std::unique_ptr<Variable>> properties;
 
+    ~Object() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static Peek<MapPtr<Expression>> get_given_properties(
       Stream &stream,
       const size_t &start_index,
       const std::vector<std::string> &properties
     );
 
-    void print(size_t indent = 0) const override;
+    void describe(Printer &printer, size_t indent) const override;
 
     virtual std::string to_string(size_t indent = 0) const;
+
+    void write_source(std::string &output) const override;
 };
 
 class Array : public Expression {
@@ -80,13 +103,19 @@ class Array : public Expression {
     std::unique_ptr<Expression> len;
     std::unique_ptr<Expression> init;
 
+    ~Array() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static bool is_arr_literal(Stream &stream, const size_t &start_index);
 
     static PeekPtr<Array> build(Stream &stream, const size_t &start_index);
 
-    void print(size_t indent = 0) const override;
+    void describe(Printer &printer, size_t indent) const override;
 
     virtual std::string to_string(size_t indent = 0) const;
+
+    void write_source(std::string &output) const override;
 };
 
 class Block : public Expression {
@@ -99,27 +128,39 @@ class Block : public Expression {
 
     static PeekPtr<Block> build(Stream &stream, const size_t &start_index);
 
-    void print(size_t indent = 0) const override;
+    void describe(Printer &printer, size_t indent) const override;
 
     virtual std::string to_string(size_t indent = 0) const;
+
+    void write_source(std::string &output) const override;
 };
 
 class Lambda : public Expression {
   public:
     std::vector<std::unique_ptr<Variable>> parameters;
     
-    void print(size_t indent = 0) const override;
+    ~Lambda() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
+    void describe(Printer &printer, size_t indent) const override;
 
     virtual std::string to_string(size_t indent = 0) const;
+
+    void write_source(std::string &output) const override;
 };
 
 class String : public Expression {
   public:
-    std::vector<std::string> injections;
+    std::vector<Segment> segments;
 
-    static std::unique_ptr<String> create(Token &literal);
+    static std::unique_ptr<String> create(const Token &literal);
 
-    void print(size_t indent = 0) const override;
+    std::vector<std::string> get_injections() const;
+
+    void describe(Printer &printer, size_t indent) const override;
     
     virtual std::string to_string(size_t indent = 0) const;
+
+    void write_source(std::string &output) const override;
 };
\ No newline at end of file
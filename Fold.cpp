@@ -0,0 +1,899 @@
+#pragma once
+
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include "Fold.h"
+#include "Parser.cpp"
+
+// Python's, assignments aside, which are never folded into
+const std::map<std::string, int> FOLD_PRECEDENCE = {
+  {"or", 1},
+  {"and", 2},
+  {"==", 3}, {"!=", 3}, {"<", 3}, {"<=", 3}, {">", 3}, {">=", 3},
+  {"+", 4}, {"-", 4},
+  {"*", 5}, {"/", 5}, {"%", 5},
+};
+
+// Comparisons chain in Python, a < b < c being a < b and b < c
+const int FOLD_COMPARISON = 3;
+
+// Past this integers aren't all exact as doubles, which mixed arithmetic is done in
+const long long FOLD_EXACT_INTEGER = 1LL << 53;
+
+// Longest string a val is copied to the places reading it at
+const size_t FOLD_TEXT_LIMIT = 256;
+
+const size_t FOLD_NO_TERM = SIZE_MAX;
+
+// The shortest digits that read back the same, laid out like Python's repr
+static std::string format_float(double value) {
+  char buffer[32];
+  char *end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+  std::string text(buffer, end);
+  size_t mark = text.find('e');
+  int exponent = std::stoi(text.substr(mark + 1));
+
+  if (exponent < -4 || exponent >= 16) return text;
+
+  bool is_negative = text[0] == '-';
+  std::string digits;
+  for (size_t i = is_negative; i < mark; i++) {
+    if (text[i] != '.') digits += text[i];
+  }
+
+  std::string result = is_negative ? "-" : "";
+
+  if (exponent < 0) return result + "0." + std::string(-exponent - 1, '0') + digits;
+
+  size_t whole = exponent + 1;
+  if (digits.size() < whole) digits.append(whole - digits.size(), '0');
+  result.append(digits, 0, whole);
+  result += '.';
+  result += digits.size() > whole ? digits.substr(whole) : "0";
+  return result;
+}
+
+std::optional<Fold::Constant> Fold::get_constant(const Expression *expression) {
+  if (expression->variant != Expression::Variant::LITERAL) return std::nullopt;
+
+  Constant constant;
+  constant.literal = expression->literal;
+  const std::string &value = expression->value;
+
+  switch (expression->literal) {
+    case Token::Literal::INTEGER: {
+      auto [pointer, error] = std::from_chars(value.data(), value.data() + value.size(), constant.integer);
+      if (error != std::errc() || pointer != value.data() + value.size()) return std::nullopt;
+      return constant;
+    }
+    case Token::Literal::FLOAT: {
+      char *end = nullptr;
+      constant.number = std::strtod(value.c_str(), &end);
+      if (value.empty() || end != value.c_str() + value.size()) return std::nullopt;
+      if (not std::isfinite(constant.number)) return std::nullopt;
+      return constant;
+    }
+    case Token::Literal::BOOLEAN:
+      constant.boolean = value == "true";
+      return constant;
+    case Token::Literal::STRING: {
+      auto literal = static_cast<const String *>(expression);
+
+      for (const Segment &segment : literal->segments) {
+        if (segment.kind == Segment::Kind::INJECTION) return std::nullopt;
+      }
+
+      constant.text = value;
+      return constant;
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+std::unique_ptr<Expression> Fold::create_literal(const Constant &constant, size_t line) {
+  std::unique_ptr<Expression> literal;
+
+  if (constant.literal == Token::Literal::STRING) {
+    Token token;
+    token.kind = Token::Kind::LITERAL;
+    token.literal = Token::Literal::STRING;
+    token.data = constant.text;
+    if (not constant.text.empty()) token.segments.push_back({Segment::Kind::TEXT, 0, constant.text.size()});
+    literal = String::create(token);
+  } else {
+    literal = std::make_unique<Expression>();
+    literal->variant = Expression::Variant::LITERAL;
+    literal->literal = constant.literal;
+    literal->value =
+      constant.literal == Token::Literal::INTEGER ? std::to_string(constant.integer) :
+      constant.literal == Token::Literal::FLOAT ? format_float(constant.number) :
+      constant.boolean ? "true" : "false";
+  }
+
+  literal->line = line;
+  return literal;
+}
+
+std::string Fold::format(const Constant &constant) {
+  switch (constant.literal) {
+    case Token::Literal::INTEGER:
+      return std::to_string(constant.integer);
+    case Token::Literal::FLOAT:
+      return format_float(constant.number);
+    case Token::Literal::BOOLEAN:
+      return constant.boolean ? "True" : "False";
+    default:
+      return constant.text;
+  }
+}
+
+bool Fold::is_truthy(const Constant &constant) {
+  switch (constant.literal) {
+    case Token::Literal::INTEGER:
+      return constant.integer != 0;
+    case Token::Literal::FLOAT:
+      return constant.number != 0;
+    case Token::Literal::BOOLEAN:
+      return constant.boolean;
+    default:
+      return not constant.text.empty();
+  }
+}
+
+std::optional<bool> Fold::compare(const std::string &operation, const Constant &left, const Constant &right) {
+  auto order = [&operation](auto a, auto b) -> std::optional<bool> {
+    if (operation == "==") return a == b;
+    if (operation == "!=") return a != b;
+    if (operation == "<") return a < b;
+    if (operation == "<=") return a <= b;
+    if (operation == ">") return a > b;
+    if (operation == ">=") return a >= b;
+    return std::nullopt;
+  };
+
+  auto is_number = [](const Constant &constant) {
+    return constant.literal == Token::Literal::INTEGER || constant.literal == Token::Literal::FLOAT;
+  };
+
+  if (left.literal == Token::Literal::INTEGER && right.literal == Token::Literal::INTEGER) {
+    return order(left.integer, right.integer);
+  }
+
+  if (is_number(left) && is_number(right)) {
+    // Python compares an integer with a float exactly, which a double only does this far
+    auto as_double = [](const Constant &constant) -> std::optional<double> {
+      if (constant.literal == Token::Literal::FLOAT) return constant.number;
+      if (std::llabs(constant.integer) > FOLD_EXACT_INTEGER) return std::nullopt;
+      return static_cast<double>(constant.integer);
+    };
+
+    std::optional<double> a = as_double(left);
+    std::optional<double> b = as_double(right);
+    if (not a || not b) return std::nullopt;
+
+    return order(*a, *b);
+  }
+
+  if (left.literal == Token::Literal::STRING && right.literal == Token::Literal::STRING) {
+    // Escapes would have to be read to know the characters compared
+    if (left.text.find('\\') != std::string::npos || right.text.find('\\') != std::string::npos) {
+      return std::nullopt;
+    }
+
+    return order(left.text, right.text);
+  }
+
+  if (left.literal == Token::Literal::BOOLEAN && right.literal == Token::Literal::BOOLEAN) {
+    if (operation != "==" && operation != "!=") return std::nullopt;
+    return order(left.boolean, right.boolean);
+  }
+
+  return std::nullopt;
+}
+
+std::optional<Fold::Constant> Fold::evaluate(const std::string &operation, const Constant &left, const Constant &right) {
+  Constant result;
+
+  if (FOLD_PRECEDENCE.at(operation) == FOLD_COMPARISON) {
+    std::optional<bool> outcome = compare(operation, left, right);
+    if (not outcome) return std::nullopt;
+
+    result.literal = Token::Literal::BOOLEAN;
+    result.boolean = *outcome;
+    return result;
+  }
+
+  if (left.literal == Token::Literal::STRING && right.literal == Token::Literal::STRING) {
+    // A trailing backslash would escape whatever came after it
+    if (operation != "+" || (not left.text.empty() && left.text.back() == '\\')) return std::nullopt;
+
+    result.literal = Token::Literal::STRING;
+    result.text = left.text + right.text;
+    return result;
+  }
+
+  if (left.literal == Token::Literal::INTEGER && right.literal == Token::Literal::INTEGER) {
+    long long a = left.integer;
+    long long b = right.integer;
+    result.literal = Token::Literal::INTEGER;
+
+    // Python's integers don't overflow, so results past 64 bits are left to run time
+    bool is_overflowing = false;
+
+    if (operation == "+") {
+      is_overflowing = __builtin_add_overflow(a, b, &result.integer);
+    } else if (operation == "-") {
+      is_overflowing = __builtin_sub_overflow(a, b, &result.integer);
+    } else if (operation == "*") {
+      is_overflowing = __builtin_mul_overflow(a, b, &result.integer);
+    } else if (operation == "%") {
+      if (b == 0) return std::nullopt;
+
+      // Takes the sign of the divisor
+      result.integer = b == -1 ? 0 : a % b;
+      if (result.integer != 0 && (result.integer < 0) != (b < 0)) result.integer += b;
+    } else if (operation == "/") {
+      if (b == 0 || std::llabs(a) > FOLD_EXACT_INTEGER || std::llabs(b) > FOLD_EXACT_INTEGER) return std::nullopt;
+
+      result.literal = Token::Literal::FLOAT;
+      result.number = static_cast<double>(a) / static_cast<double>(b);
+      return result;
+    } else {
+      return std::nullopt;
+    }
+
+    if (is_overflowing || result.integer == LLONG_MIN) return std::nullopt;
+    return result;
+  }
+
+  bool is_numeric =
+    (left.literal == Token::Literal::INTEGER || left.literal == Token::Literal::FLOAT) &&
+    (right.literal == Token::Literal::INTEGER || right.literal == Token::Literal::FLOAT);
+
+  if (not is_numeric) return std::nullopt;
+
+  double a = left.literal == Token::Literal::FLOAT ? left.number : static_cast<double>(left.integer);
+  double b = right.literal == Token::Literal::FLOAT ? right.number : static_cast<double>(right.integer);
+  result.literal = Token::Literal::FLOAT;
+
+  if (operation == "+") {
+    result.number = a + b;
+  } else if (operation == "-") {
+    result.number = a - b;
+  } else if (operation == "*") {
+    result.number = a * b;
+  } else if (operation == "/") {
+    if (b == 0) return std::nullopt;
+    result.number = a / b;
+  } else if (operation == "%") {
+    if (b == 0) return std::nullopt;
+
+    // As CPython's float remainder, zero keeping the sign of the divisor
+    result.number = std::fmod(a, b);
+    if (result.number != 0) {
+      if ((b < 0) != (result.number < 0)) result.number += b;
+    } else {
+      result.number = std::copysign(0.0, b);
+    }
+  } else {
+    return std::nullopt;
+  }
+
+  // inf and nan can't be written as literals
+  if (not std::isfinite(result.number)) return std::nullopt;
+  return result;
+}
+
+void Fold::count_declarations(
+  const std::vector<Statement *> &body,
+  std::map<std::string, size_t> &declared
+) {
+  std::vector<Statement *> pending(body.rbegin(), body.rend());
+
+  auto push = [&pending](Statement *node) {
+    if (node) pending.push_back(node);
+  };
+
+  while (not pending.empty()) {
+    Statement *node = pending.back();
+    pending.pop_back();
+
+    if (node->kind == Statement::Kind::EXPRESSION) {
+      auto expression = static_cast<Expression *>(node);
+
+      if (expression->variant == Expression::Variant::ASSIGNMENT) {
+        auto assignment = static_cast<BinaryExpression *>(expression);
+        if (assignment->left->variant == Expression::Variant::IDENTIFIER) declared[assignment->left->value]++;
+      }
+
+      if (expression->variant == Expression::Variant::LITERAL) {
+        // Lambdas and comprehensions are scopes of their own
+        if (expression->literal == Token::Literal::LAMBDA) continue;
+
+        if (expression->literal == Token::Literal::ARRAY) {
+          push(static_cast<Array *>(expression)->len.get());
+          continue;
+        }
+
+        // Properties name fields rather than declaring anything
+        if (expression->literal == Token::Literal::STRUCT) {
+          for (auto &property : static_cast<Object *>(expression)->properties) push(property->value.get());
+          continue;
+        }
+      }
+    } else {
+      switch (node->type) {
+        case Statement::Type::VARIABLE_DECLARATION:
+          declared[static_cast<Variable *>(node)->name]++;
+          break;
+        case Statement::Type::FUNCTION_DECLARATION:
+          declared[static_cast<Function *>(node)->name]++;
+          continue;
+        case Statement::Type::STRUCT_DECLARATION:
+          declared[static_cast<Struct *>(node)->name]++;
+          continue;
+        case Statement::Type::ENUM_DECLARATION:
+          declared[static_cast<Enum *>(node)->name]++;
+          continue;
+        case Statement::Type::LOOP_STATEMENT: {
+          auto loop = static_cast<For *>(node);
+          if (loop->variant != For::Variant::FOR_IN) break;
+
+          declared[loop->index->value]++;
+          push(loop->limit.get());
+          for (auto child = loop->children.rbegin(); child != loop->children.rend(); child++) push(child->get());
+          continue;
+        }
+        default:
+          break;
+      }
+    }
+
+    std::vector<Statement *> nodes = Optimizer::get_nodes(node);
+    pending.insert(pending.end(), nodes.rbegin(), nodes.rend());
+  }
+}
+
+size_t Fold::open_frame(size_t parent, const std::vector<std::string> &names, const std::vector<Statement *> &body) {
+  Frame frame;
+  frame.parent = parent;
+
+  for (const std::string &name : names) frame.declared[name]++;
+  count_declarations(body, frame.declared);
+
+  frames.push_back(std::move(frame));
+  return frames.size() - 1;
+}
+
+const Fold::Constant *Fold::resolve(const std::string &name, size_t frame) const {
+  while (true) {
+    const Frame &current = frames[frame];
+
+    auto constant = current.constants.find(name);
+    if (constant != current.constants.end()) return &constant->second;
+    if (current.declared.count(name) || frame == 0) return nullptr;
+
+    frame = current.parent;
+  }
+}
+
+void Fold::bind(Variable *variable, size_t frame) {
+  if (not variable->is_constant || not variable->value) return;
+  if (frames[frame].declared[variable->name] != 1) return;
+
+  std::optional<Constant> constant = get_constant(variable->value.get());
+  if (not constant) return;
+  if (constant->literal == Token::Literal::STRING && constant->text.size() > FOLD_TEXT_LIMIT) return;
+
+  frames[frame].constants[variable->name] = *constant;
+
+  // Initialisers the checker couldn't type have a type now
+  if (typings) {
+    auto typing = typings->find(variable);
+    if (typing != typings->end() && typing->second.data == Token::Literal::UNKNOWN) {
+      typing->second = Typing::create(constant->literal);
+    }
+  }
+}
+
+void Fold::fold_injections(String *literal, size_t frame) {
+  bool has_constants = false;
+
+  for (const Segment &segment : literal->segments) {
+    if (segment.kind != Segment::Kind::INJECTION) continue;
+    if (resolve(literal->value.substr(segment.start, segment.length), frame)) has_constants = true;
+  }
+
+  if (not has_constants) return;
+
+  // Injected constants become text, merged with the text around them
+  std::string value;
+  std::vector<Segment> segments;
+
+  auto add_text = [&](const std::string &text) {
+    if (text.empty()) return;
+
+    if (not segments.empty() && segments.back().kind == Segment::Kind::TEXT) {
+      segments.back().length += text.size();
+    } else {
+      segments.push_back({Segment::Kind::TEXT, value.size(), text.size()});
+    }
+
+    value += text;
+  };
+
+  for (const Segment &segment : literal->segments) {
+    std::string text = literal->value.substr(segment.start, segment.length);
+
+    if (segment.kind == Segment::Kind::TEXT) {
+      add_text(text);
+      continue;
+    }
+
+    if (const Constant *constant = resolve(text, frame)) {
+      add_text(format(*constant));
+      changes++;
+      continue;
+    }
+
+    value += '#';
+    segments.push_back({Segment::Kind::INJECTION, value.size(), text.size()});
+    value += text;
+  }
+
+  literal->value = std::move(value);
+  literal->segments = std::move(segments);
+}
+
+void Fold::fold_chain(std::unique_ptr<Expression> &slot) {
+  // An operand with the members read off it, or operators over the terms before it
+  struct Term {
+    size_t begin;
+    size_t end;
+    std::vector<size_t> operands = {};
+    std::optional<Constant> value = {};
+    // The operand an and / or comes down to
+    size_t forward = FOLD_NO_TERM;
+  };
+
+  std::vector<const Expression *> nodes;
+  std::vector<std::string> operations;
+
+  const Expression *node = slot.get();
+  while (node->is_binary()) {
+    auto binary = static_cast<const BinaryExpression *>(node);
+    nodes.push_back(binary->left.get());
+    operations.push_back(binary->operation);
+    node = binary->right.get();
+  }
+
+  nodes.push_back(node);
+
+  std::vector<Term> terms;
+  std::vector<size_t> values;
+  // Operators waiting for their right operand, by the index of the operation
+  std::vector<size_t> waiting;
+  bool is_changed = false;
+
+  auto precedence = [&operations](size_t operation) {
+    auto found = FOLD_PRECEDENCE.find(operations[operation]);
+    return found == FOLD_PRECEDENCE.end() ? -1 : found->second;
+  };
+
+  auto push_term = [&](size_t begin) {
+    size_t end = begin + 1;
+    while (end < nodes.size() && operations[end - 1] == ":") end++;
+
+    Term term = {begin, end};
+    if (end == begin + 1) term.value = get_constant(nodes[begin]);
+
+    terms.push_back(std::move(term));
+    values.push_back(terms.size() - 1);
+    return end;
+  };
+
+  // Comparisons waiting next to each other make one chain, reduced at once
+  auto reduce = [&]() {
+    size_t count = 1;
+
+    if (precedence(waiting.back()) == FOLD_COMPARISON) {
+      while (count < waiting.size() && precedence(waiting[waiting.size() - count - 1]) == FOLD_COMPARISON) count++;
+    }
+
+    std::vector<size_t> operations_of(waiting.end() - count, waiting.end());
+    std::vector<size_t> operands(values.end() - count - 1, values.end());
+    waiting.resize(waiting.size() - count);
+    values.resize(values.size() - count - 1);
+
+    Term term = {terms[operands.front()].begin, terms[operands.back()].end, operands};
+    const std::string &operation = operations[operations_of.front()];
+    const std::optional<Constant> &left = terms[operands[0]].value;
+    const std::optional<Constant> &right = terms[operands[1]].value;
+
+    if (operation == "and" || operation == "or") {
+      // Python hands back the operand that decided, without reading the other
+      if (left && is_truthy(*left) == (operation == "or")) {
+        term.value = left;
+      } else if (left) {
+        term.forward = operands[1];
+        term.value = right;
+      }
+    } else if (precedence(operations_of.front()) == FOLD_COMPARISON) {
+      bool is_known = true;
+      bool outcome = true;
+
+      for (size_t i = 0; i < count && is_known; i++) {
+        const std::optional<Constant> &a = terms[operands[i]].value;
+        const std::optional<Constant> &b = terms[operands[i + 1]].value;
+        std::optional<bool> result = a && b ? compare(operations[operations_of[i]], *a, *b) : std::nullopt;
+
+        is_known = result.has_value();
+        outcome = outcome && result.value_or(false);
+      }
+
+      if (is_known) {
+        term.value = Constant();
+        term.value->literal = Token::Literal::BOOLEAN;
+        term.value->boolean = outcome;
+      }
+    } else if (left && right) {
+      term.value = evaluate(operation, *left, *right);
+    }
+
+    is_changed = is_changed || term.value || term.forward != FOLD_NO_TERM;
+    terms.push_back(std::move(term));
+    values.push_back(terms.size() - 1);
+  };
+
+  size_t index = push_term(0);
+
+  while (index < nodes.size()) {
+    size_t operation = index - 1;
+    int current = precedence(operation);
+
+    // Assignments are only ever folded on the right of them
+    if (current < 0) return;
+
+    while (not waiting.empty() && precedence(waiting.back()) >= current) {
+      if (precedence(waiting.back()) == FOLD_COMPARISON && current == FOLD_COMPARISON) break;
+      reduce();
+    }
+
+    waiting.push_back(operation);
+    index = push_term(index);
+  }
+
+  while (not waiting.empty()) reduce();
+
+  if (not is_changed) return;
+
+  // Laid out flat again, each folded term as a literal in its place, which
+  // Python reads with the same grouping as before
+  std::vector<std::unique_ptr<Expression>> owned;
+  std::vector<size_t> lines;
+
+  std::unique_ptr<Expression> rest = std::move(slot);
+  while (rest->is_binary()) {
+    auto binary = static_cast<BinaryExpression *>(rest.get());
+    owned.push_back(std::move(binary->left));
+    lines.push_back(binary->line);
+    std::unique_ptr<Expression> right = std::move(binary->right);
+    rest = std::move(right);
+  }
+
+  owned.push_back(std::move(rest));
+
+  std::vector<std::unique_ptr<Expression>> operands;
+  std::vector<size_t> between;
+  std::vector<size_t> pending = {values.back()};
+
+  while (not pending.empty()) {
+    size_t at = pending.back();
+    pending.pop_back();
+
+    // Operators go between the terms laid out so far and the next one
+    if (at >= terms.size()) {
+      between.push_back(at - terms.size());
+      continue;
+    }
+
+    const Term &term = terms[at];
+
+    if (term.value && not term.operands.empty()) {
+      operands.push_back(create_literal(*term.value, nodes[term.begin]->line));
+      changes++;
+    } else if (term.forward != FOLD_NO_TERM) {
+      pending.push_back(term.forward);
+      changes++;
+    } else if (term.operands.empty()) {
+      for (size_t i = term.begin; i < term.end; i++) {
+        if (i > term.begin) between.push_back(i - 1);
+        operands.push_back(std::move(owned[i]));
+      }
+    } else {
+      for (size_t i = term.operands.size(); i-- > 0;) {
+        pending.push_back(term.operands[i]);
+        if (i > 0) pending.push_back(terms.size() + terms[term.operands[i - 1]].end - 1);
+      }
+    }
+  }
+
+  std::unique_ptr<Expression> tail = std::move(operands.back());
+
+  for (size_t i = between.size(); i-- > 0;) {
+    auto link = std::make_unique<BinaryExpression>();
+    link->operation = operations[between[i]];
+    link->variant = link->operation == ":" ? Expression::Variant::PROPERTY_ACCESS : Expression::Variant::BINARY;
+    link->line = lines[between[i]];
+    link->left = std::move(operands[i]);
+    link->right = std::move(tail);
+    tail = std::move(link);
+  }
+
+  slot = std::move(tail);
+}
+
+void Fold::expand_expression(Pending &item, std::vector<Pending> &pending) {
+  auto expression = static_cast<Expression *>(item.node);
+  size_t frame = item.frame;
+
+  if (expression->is_binary()) {
+    std::vector<std::unique_ptr<Expression> *> slots;
+    std::vector<std::string> operations;
+    std::vector<BinaryExpression *> links;
+
+    Expression *node = expression;
+    while (node->is_binary()) {
+      auto binary = static_cast<BinaryExpression *>(node);
+      links.push_back(binary);
+      slots.push_back(&binary->left);
+      operations.push_back(binary->operation);
+      node = binary->right.get();
+    }
+
+    slots.push_back(&links.back()->right);
+
+    // Only what is assigned is folded, never what it is assigned to
+    size_t target = 0;
+    for (size_t i = 0; i < links.size(); i++) {
+      if (links[i]->variant == Expression::Variant::ASSIGNMENT) target = i + 1;
+    }
+
+    std::unique_ptr<Expression> *folded = target > 0 ? &links[target - 1]->right : item.slot;
+    if (folded && target < operations.size()) {
+      pending.push_back({nullptr, nullptr, frame, [this, folded]() { fold_chain(*folded); }});
+    }
+
+    // Members, the operands they are read off and targets are names, not values
+    for (size_t i = slots.size(); i-- > 0;) {
+      bool is_member = i > 0 && operations[i - 1] == ":";
+      bool is_owner = i < operations.size() && operations[i] == ":";
+      bool is_value = i >= target && not is_member && not is_owner;
+      pending.push_back({slots[i]->get(), is_value ? slots[i] : nullptr, frame});
+    }
+
+    return;
+  }
+
+  switch (expression->variant) {
+    case Expression::Variant::IDENTIFIER: {
+      if (not item.slot) break;
+
+      if (const Constant *constant = resolve(expression->value, frame)) {
+        *item.slot = create_literal(*constant, expression->line);
+        changes++;
+      }
+
+      break;
+    }
+    case Expression::Variant::FUNCTION_CALL: {
+      for (auto argument = expression->arguments.rbegin(); argument != expression->arguments.rend(); argument++) {
+        pending.push_back({argument->get(), &*argument, frame});
+      }
+
+      break;
+    }
+    case Expression::Variant::BLOCK: {
+      for (auto child = expression->children.rbegin(); child != expression->children.rend(); child++) {
+        pending.push_back({child->get(), nullptr, frame});
+      }
+
+      break;
+    }
+    case Expression::Variant::LITERAL: {
+      if (expression->literal == Token::Literal::STRING) {
+        fold_injections(static_cast<String *>(expression), frame);
+      } else if (expression->literal == Token::Literal::ARRAY) {
+        auto array = static_cast<Array *>(expression);
+
+        if (array->init) {
+          size_t inner = open_frame(frame, {"it"}, {array->init.get()});
+          pending.push_back({array->init.get(), &array->init, inner});
+        }
+
+        if (array->len) pending.push_back({array->len.get(), &array->len, frame});
+      } else if (expression->literal == Token::Literal::STRUCT) {
+        auto object = static_cast<Object *>(expression);
+
+        for (auto property = object->properties.rbegin(); property != object->properties.rend(); property++) {
+          Variable *variable = property->get();
+          if (variable->value) pending.push_back({variable->value.get(), &variable->value, frame});
+        }
+      } else if (expression->literal == Token::Literal::LAMBDA) {
+        auto lambda = static_cast<Lambda *>(expression);
+        std::vector<std::string> names;
+        std::vector<Statement *> body;
+
+        for (const auto &parameter : lambda->parameters) names.push_back(parameter->name);
+        for (const auto &child : lambda->children) body.push_back(child.get());
+
+        size_t inner = open_frame(frame, names, body);
+        for (auto child = lambda->children.rbegin(); child != lambda->children.rend(); child++) {
+          pending.push_back({child->get(), nullptr, inner});
+        }
+
+        // Defaults are read where the lambda is made
+        for (auto parameter = lambda->parameters.rbegin(); parameter != lambda->parameters.rend(); parameter++) {
+          Variable *variable = parameter->get();
+          if (variable->value) pending.push_back({variable->value.get(), &variable->value, frame});
+        }
+      }
+
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void Fold::expand_statement(Pending &item, std::vector<Pending> &pending) {
+  Statement *node = item.node;
+  size_t frame = item.frame;
+
+  auto push_children = [&](Statement *parent, size_t inner) {
+    for (auto child = parent->children.rbegin(); child != parent->children.rend(); child++) {
+      pending.push_back({child->get(), nullptr, inner});
+    }
+  };
+
+  auto push_value = [&](std::unique_ptr<Expression> &value) {
+    if (value) pending.push_back({value.get(), &value, frame});
+  };
+
+  // Parameters are declared in the function, their defaults read around it
+  auto push_function = [&](Function *function, size_t outer) {
+    std::vector<std::string> names;
+    std::vector<Statement *> body;
+
+    for (const auto &parameter : function->parameters) names.push_back(parameter->name);
+    for (const auto &child : function->children) body.push_back(child.get());
+
+    push_children(function, open_frame(outer, names, body));
+
+    for (auto parameter = function->parameters.rbegin(); parameter != function->parameters.rend(); parameter++) {
+      push_value((*parameter)->value);
+    }
+  };
+
+  switch (node->type) {
+    case Statement::Type::VARIABLE_DECLARATION:
+    case Statement::Type::CONSTANT_DECLARATION: {
+      auto variable = static_cast<Variable *>(node);
+      pending.push_back({nullptr, nullptr, frame, [this, variable, frame]() { bind(variable, frame); }});
+      push_value(variable->value);
+      break;
+    }
+    case Statement::Type::FUNCTION_DECLARATION:
+      push_function(static_cast<Function *>(node), frame);
+      break;
+    case Statement::Type::STRUCT_DECLARATION: {
+      // Methods read the fields by name
+      auto declaration = static_cast<Struct *>(node);
+      std::vector<std::string> names;
+      for (const auto &field : declaration->fields) names.push_back(field->name);
+
+      size_t inner = open_frame(frame, names, {});
+      for (auto method = declaration->methods.rbegin(); method != declaration->methods.rend(); method++) {
+        push_function(method->get(), inner);
+      }
+
+      for (auto field = declaration->fields.rbegin(); field != declaration->fields.rend(); field++) {
+        push_value((*field)->value);
+      }
+
+      break;
+    }
+    case Statement::Type::ENUM_DECLARATION: {
+      // As do methods the values
+      auto declaration = static_cast<Enum *>(node);
+      size_t inner = open_frame(frame, declaration->values, {});
+
+      for (auto method = declaration->methods.rbegin(); method != declaration->methods.rend(); method++) {
+        push_function(method->get(), inner);
+      }
+
+      break;
+    }
+    case Statement::Type::IF_STATEMENT: {
+      auto statement = static_cast<If *>(node);
+      if (statement->else_block) pending.push_back({statement->else_block.get(), nullptr, frame});
+      push_children(statement, frame);
+      push_value(statement->condition);
+      break;
+    }
+    case Statement::Type::MATCH_STATEMENT: {
+      auto match = static_cast<Match *>(node);
+      push_children(match, frame);
+      push_value(match->condition);
+      break;
+    }
+    case Statement::Type::WHEN_STATEMENT: {
+      auto when = static_cast<When *>(node);
+      push_children(when, frame);
+      for (auto condition = when->conditions.rbegin(); condition != when->conditions.rend(); condition++) {
+        push_value(*condition);
+      }
+
+      break;
+    }
+    case Statement::Type::LOOP_STATEMENT: {
+      auto loop = static_cast<For *>(node);
+      push_children(loop, frame);
+
+      // The index of a for in loop is the name it declares
+      if (loop->variant == For::Variant::TIMES) push_value(loop->index);
+      if (loop->variant == For::Variant::FOR_IN) push_value(loop->limit);
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT:
+      push_value(static_cast<Jump *>(node)->value);
+      break;
+    case Statement::Type::IMPORT_STATEMENT:
+      // Whatever the module exports may rebind names
+      frames[0].constants.clear();
+      break;
+    default:
+      push_children(node, frame);
+      break;
+  }
+}
+
+size_t Fold::run(Statement &program, Context &context) {
+  typings = context.typings;
+  changes = 0;
+  frames.resize(1);
+
+  // A name declared again at the top level is no longer a constant
+  std::map<std::string, size_t> declared;
+  std::vector<Statement *> body;
+  for (const auto &child : program.children) body.push_back(child.get());
+  count_declarations(body, declared);
+
+  for (const auto &[name, count] : declared) {
+    frames[0].declared[name] += count;
+    if (frames[0].declared[name] > 1) frames[0].constants.erase(name);
+  }
+
+  std::vector<Pending> pending;
+  for (auto child = program.children.rbegin(); child != program.children.rend(); child++) {
+    pending.push_back({child->get(), nullptr, 0});
+  }
+
+  while (not pending.empty()) {
+    Pending item = std::move(pending.back());
+    pending.pop_back();
+
+    if (item.action) {
+      item.action();
+    } else if (item.node->kind == Statement::Kind::EXPRESSION) {
+      expand_expression(item, pending);
+    } else {
+      expand_statement(item, pending);
+    }
+  }
+
+  typings = nullptr;
+  return changes;
+}
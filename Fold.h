@@ -0,0 +1,82 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Optimizer.h"
+#include "Expression.h"
+
+// Evaluates operators on values known at compile time the way Python would, and
+// puts the value of each val initialised to one in place of the names reading
+// it, string injections included. Whatever could come out differently at run
+// time, or would raise there, is left as it was written
+class Fold : public Pass {
+  public:
+    // A value known at compile time. Strings keep the escapes they were written with
+    struct Constant {
+      Token::Literal literal;
+      long long integer = 0;
+      double number = 0;
+      bool boolean = false;
+      std::string text;
+    };
+
+    // The value of a literal, if it has one that can be folded
+    static std::optional<Constant> get_constant(const Expression *expression);
+    // As Python's bool() sees the value
+    static bool is_truthy(const Constant &constant);
+
+    // Counts the names a body declares, leaving out the scopes nested in it
+    static void count_declarations(
+      const std::vector<Statement *> &body,
+      std::map<std::string, size_t> &declared
+    );
+
+  private:
+    // A function, lambda or comprehension, or the members of a struct or enum.
+    // The names declared in one hide the constants of the frames around it
+    struct Frame {
+      size_t parent = 0;
+      // A val is only constant when its name is declared once in the frame
+      std::map<std::string, size_t> declared;
+      std::map<std::string, Constant> constants;
+    };
+
+    // A node still to be folded, or what to do once the ones it owns are done
+    struct Pending {
+      Statement *node = nullptr;
+      // Where the node is owned, when it is an expression that may be replaced
+      std::unique_ptr<Expression> *slot = nullptr;
+      size_t frame = 0;
+      std::function<void()> action = {};
+    };
+
+    // The frame of the module outlives the top level statement being folded
+    std::vector<Frame> frames = {Frame()};
+    Typings *typings = nullptr;
+    size_t changes = 0;
+
+    static std::unique_ptr<Expression> create_literal(const Constant &constant, size_t line);
+    // As Python's str() shows the value
+    static std::string format(const Constant &constant);
+
+    static std::optional<bool> compare(const std::string &operation, const Constant &left, const Constant &right);
+    static std::optional<Constant> evaluate(const std::string &operation, const Constant &left, const Constant &right);
+
+    size_t open_frame(size_t parent, const std::vector<std::string> &names, const std::vector<Statement *> &body);
+    const Constant *resolve(const std::string &name, size_t frame) const;
+    void bind(Variable *variable, size_t frame);
+
+    void fold_injections(String *literal, size_t frame);
+    // Regroups a chain by precedence as Python reads it, replacing what can be evaluated
+    void fold_chain(std::unique_ptr<Expression> &slot);
+
+    void expand_expression(Pending &item, std::vector<Pending> &pending);
+    void expand_statement(Pending &item, std::vector<Pending> &pending);
+
+  public:
+    size_t run(Statement &program, Context &context) override;
+};
@@ -3,7 +3,17 @@
 #include "For.h"
 #include "Parser.h"
 
-PeekPtr<For> For::build(Stream &stream, const size_t &start_index) {
+For::~For() {
+  dismantle();
+}
+
+void For::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, index);
+  hand_over(pending, limit);
+  Statement::release(pending);
+}
+
+PeekPtr<For> For::build_header(Stream &stream, const size_t &start_index) {
   PeekPtr<For> result;
 
   Token keyword = stream[start_index];
@@ -11,16 +21,13 @@ PeekPtr<For> For::build(Stream &stream, const size_t &start_index) {
     throw std::runtime_error("DEV: Expected 'for' keyword");
   }
 
-  Token next = stream.get_next(start_index);
+  result.data->type = Statement::Type::LOOP_STATEMENT;
+  const Token &next = stream.get_next(start_index);
 
   // for {}
   if (next.is_given_marker(Marker::LEFT_BRACE)) {
-    PeekVectorPtr<Statement> body = Parser::build_block(stream, start_index + 1);
-
-    result.data->type = Statement::Type::LOOP_STATEMENT;
     result.data->variant = For::Variant::INFINITE;
-    result.data->children = std::move(body.data);
-    result.end_index = body.end_index;
+    result.end_index = start_index + 1;
     return result;
   }
 
@@ -42,43 +49,49 @@ PeekPtr<For> For::build(Stream &stream, const size_t &start_index) {
     result.data->variant = For::Variant::TIMES;
   }
 
-  PeekVectorPtr<Statement> body = Parser::build_block(stream, result.end_index + 1);
-  result.data->type = Statement::Type::LOOP_STATEMENT;
+  result.end_index += 1;
+  return result;
+}
+
+PeekPtr<For> For::build(Stream &stream, const size_t &start_index) {
+  PeekPtr<For> result = build_header(stream, start_index);
+  PeekVectorPtr<Statement> body = Parser::build_block(stream, result.end_index);
+
   result.data->children = std::move(body.data);
   result.end_index = body.end_index;
 
   return result;
 }
 
-void For::print(size_t indent) const {
+void For::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "For {");
+  printer.line(indentation + "For {");
 
   if (variant == Variant::INFINITE) {
-    println(indentation + "  variant: Infinite");
+    printer.line(indentation + "  variant: Infinite");
   } else if (variant == Variant::TIMES) {
-    println(indentation + "  variant: Times");
+    printer.line(indentation + "  variant: Times");
   } else {
-    println(indentation + "  variant: For");
+    printer.line(indentation + "  variant: For");
   }
 
   if (index) {
-    println(indentation + "  Index {");
-    index->print(indent + 2);
-    println(indentation + "  }");
+    printer.line(indentation + "  Index {");
+    printer.child(index.get(), indent + 2);
+    printer.line(indentation + "  }");
   }
 
   if (limit) {
-    println(indentation + "  Limit {");
-    limit->print(indent + 2);
-    println(indentation + "  }");
+    printer.line(indentation + "  Limit {");
+    printer.child(limit.get(), indent + 2);
+    printer.line(indentation + "  }");
   }
 
   if (not children.empty()) {
-    println(indentation + "  children: [");
-    for (const auto &child : children) child->print(indent + 2);
-    println(indentation + "  ]");
+    printer.line(indentation + "  children: [");
+    for (const auto &child : children) printer.child(child.get(), indent + 2);
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
\ No newline at end of file
@@ -19,7 +19,13 @@ class For : public Statement {
     std::unique_ptr<Expression> limit;
     Variant variant;
 
+    ~For() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
+    // Parses up to the opening brace of the body
+    static PeekPtr<For> build_header(Stream &stream, const size_t &start_index);
     static PeekPtr<For> build(Stream &stream, const size_t &start_index);
 
-    virtual void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
\ No newline at end of file
@@ -11,6 +11,15 @@ Function::Function() {
   typing.value = "void";
 }
 
+Function::~Function() {
+  dismantle();
+}
+
+void Function::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, parameters);
+  Statement::release(pending);
+}
+
 bool Function::is_fn_call(Stream &stream, const size_t &start_index) {
   return 
     stream.is_next(start_index, [](const Token &token) {
@@ -159,7 +168,7 @@ Peek<Typing> Function::build_as_fn_type(Stream &stream, const size_t &start_inde
 PeekPtr<Lambda> Function::build_as_lambda(Stream &stream, const size_t &start_index) {
   PeekPtr<Lambda> result;
 
-  Token keyword = stream.get_next(start_index);
+  const Token &keyword = stream.get_next(start_index);
 
   if (not keyword.is_given_keyword(Keyword::FUNCTION)) {
     throw std::runtime_error("DEV: Expected 'fn' keyword");
@@ -213,32 +222,33 @@ PeekPtr<Lambda> Function::build_as_lambda(Stream &stream, const size_t &start_in
   return result;
 }
 
-void Function::print(size_t indent) const {
+void Function::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Function {");
-  println(indentation + "  name: " + name);
+  printer.line(indentation + "Function {");
+  printer.line(indentation + "  name: " + name);
+  if (is_native) printer.line(indentation + "  native: true");
   
   if (not parameters.empty()) {
-    println(indentation + "  parameters: [");
+    printer.line(indentation + "  parameters: [");
 
     for (const std::unique_ptr<Variable> &parameter : parameters) {
-      parameter->print(indent + 2);
+      printer.child(parameter.get(), indent + 2);
     }
 
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
   if (not children.empty()) {
-    println(indentation + "  body: [");
+    printer.line(indentation + "  body: [");
 
     for (const std::unique_ptr<Statement> &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
 
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
 PeekPtr<Expression> Function::build_as_fn_call(Stream &stream, const size_t &start_index) {
@@ -257,7 +267,7 @@ PeekPtr<Expression> Function::build_as_fn_call(Stream &stream, const size_t &sta
   size_t index = opening.end_index;
 
   while (index < stream.size()) {
-    Token next = stream.get_next(index);
+    const Token &next = stream.get_next(index);
 
     if (next.is_given_marker(Marker::COMMA)) {
       index++;
@@ -271,41 +281,52 @@ PeekPtr<Expression> Function::build_as_fn_call(Stream &stream, const size_t &sta
       return result;
     }
 
-    if (Expression::is_expression(stream, index)) {
-      PeekPtr<Expression> argument = Expression::build(stream, index);
-      result.data->arguments.push_back(std::move(argument.data));
-      index = argument.end_index;
+    if (not Expression::is_expression(stream, index)) {
+      throw std::runtime_error("USER: Unexpected Token '" + next.data + "' in Function Call " + name.data.data);
     }
+
+    PeekPtr<Expression> argument = Expression::build(stream, index);
+    result.data->arguments.push_back(std::move(argument.data));
+    index = argument.end_index;
   }
 
   throw std::runtime_error("USER: Unterminated Function Call " + name.data.data);
 }
 
-void Lambda::print(size_t indent) const {
+Lambda::~Lambda() {
+  dismantle();
+}
+
+void Lambda::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, parameters);
+  Expression::release(pending);
+}
+
+void Lambda::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Lambda {");
+  printer.line(indentation + "Lambda {");
   
   if (not parameters.empty()) {
-    println(indentation + "  parameters: [");
+    printer.line(indentation + "  parameters: [");
 
     for (const std::unique_ptr<Variable> &parameter : parameters) {
-      parameter->print(indent + 2);
+      printer.child(parameter.get(), indent + 2);
     }
 
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
   if (not children.empty()) {
-    println(indentation + "  body: [");
+    printer.line(indentation + "  body: [");
 
     for (const std::unique_ptr<Statement> &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
 
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
 
 std::string Lambda::to_string(size_t indent) const {
@@ -334,3 +355,18 @@ std::string Lambda::to_string(size_t indent) const {
   result += indentation + "}";
   return result;
 }
+
+void Lambda::write_source(std::string &output) const {
+  output += "fn";
+
+  if (not parameters.empty()) {
+    output += " (";
+    for (size_t i = 0; i < parameters.size(); i++) {
+      if (i > 0) output += ", ";
+      output += parameters[i]->name;
+    }
+    output += ")";
+  }
+
+  output += " { ... }";
+}
\ No newline at end of file
@@ -11,9 +11,15 @@ class Function : public Statement {
     std::string name;
     std::vector<std::unique_ptr<Variable>> parameters;
     Typing typing;
+    // Marked @native, so it is compiled to machine code rather than to Python
+    bool is_native = false;
 
     Function();
 
+    ~Function() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static bool is_fn_call(Stream &stream, const size_t &start_index);
 
     static bool is_lambda(Stream &stream, const size_t &start_index);
@@ -26,5 +32,5 @@ class Function : public Statement {
     
     static PeekPtr<Lambda> build_as_lambda(Stream &stream, const size_t &start_index);
 
-    virtual void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
\ No newline at end of file
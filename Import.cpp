@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Utils.h"
+#include "Import.h"
+
+Import::Import() {
+  kind = Kind::STATEMENT;
+  type = Type::IMPORT_STATEMENT;
+}
+
+PeekPtr<Import> Import::build(Stream &stream, const size_t &start_index) {
+  PeekPtr<Import> result;
+
+  if (not stream.at(start_index).is_given_keyword(Keyword::IMPORT)) {
+    throw std::runtime_error("DEV: Expected 'import' keyword");
+  }
+
+  Peek<Token> module = stream.peek(start_index, [](const Token &token) {
+    return token.is_given_literal(Token::Literal::STRING);
+  });
+
+  const std::string &path = module.data.data;
+  const std::vector<Segment> &segments = module.data.segments;
+  bool is_injected = std::any_of(segments.begin(), segments.end(), [](const Segment &segment) {
+    return segment.kind == Segment::Kind::INJECTION;
+  });
+
+  // Modules never reach outside the project root
+  if (
+    path.empty() || is_injected || path.front() == '/' || path.back() == '/' ||
+    ("/" + path + "/").find("/../") != std::string::npos ||
+    ("/" + path + "/").find("/./") != std::string::npos
+  ) {
+    throw std::runtime_error("USER: Invalid Module Path '" + path + "'");
+  }
+
+  result.data->module = path;
+  result.end_index = module.end_index;
+  return result;
+}
+
+void Import::describe(Printer &printer, size_t indent) const {
+  std::string indentation = Utils::get_indent(indent);
+  printer.line(indentation + "Import: " + module);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Utils.h"
+#include "Statement.h"
+
+// import "<module>", where the module is the path of a source from the project
+// root without its .pino extension
+class Import : public Statement {
+  public:
+    std::string module;
+
+    Import();
+
+    static PeekPtr<Import> build(Stream &stream, const size_t &start_index);
+
+    void describe(Printer &printer, size_t indent) const override;
+};
@@ -0,0 +1,463 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Index.h"
+#include "Build.cpp"
+
+const char INDEX_MAGIC[8] = {'P', 'I', 'N', 'O', 'I', 'D', 'X', '\0'};
+
+const std::map<Symbols::Kind, std::string> SYMBOL_KIND_NAMES = {
+  {Symbols::Kind::CONSTANT, "constant"},
+  {Symbols::Kind::VARIABLE, "variable"},
+  {Symbols::Kind::FUNCTION, "function"},
+  {Symbols::Kind::STRUCT, "struct"},
+  {Symbols::Kind::ENUM, "enum"},
+  {Symbols::Kind::FIELD, "field"},
+  {Symbols::Kind::METHOD, "method"},
+  {Symbols::Kind::VALUE, "value"},
+};
+
+template <typename T>
+static void append_records(std::string &output, const std::vector<T> &records) {
+  output.append(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(T));
+}
+
+std::string Index::Table::serialise() const {
+  std::string strings;
+  auto intern = [&](const std::string &text) {
+    uint32_t offset = strings.size();
+    strings += text;
+    strings += '\0';
+    return offset;
+  };
+
+  std::vector<File> file_records;
+  for (const auto &[hash, path] : files) {
+    file_records.push_back({hash, intern(path), 0});
+  }
+
+  std::vector<Symbol> symbol_records;
+  std::vector<Occurrence> occurrence_records;
+
+  for (const auto &[name, occurrences] : symbols) {
+    uint32_t first = occurrence_records.size();
+    symbol_records.push_back({intern(name), first, static_cast<uint32_t>(occurrences.size()), 0});
+    occurrence_records.insert(occurrence_records.end(), occurrences.begin(), occurrences.end());
+  }
+
+  Header header = {};
+  std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+  header.version = VERSION;
+  header.file_count = file_records.size();
+  header.symbol_count = symbol_records.size();
+  header.occurrence_count = occurrence_records.size();
+  header.string_size = strings.size();
+
+  std::string output(reinterpret_cast<const char *>(&header), sizeof(header));
+  append_records(output, file_records);
+  append_records(output, symbol_records);
+  append_records(output, occurrence_records);
+  output += strings;
+  return output;
+}
+
+Index::Mapping::Mapping(const std::string &path) : data(nullptr), size(0) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+
+  struct stat status;
+  if (fstat(fd, &status) == 0 && status.st_size > 0) {
+    void *mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapped != MAP_FAILED) {
+      data = static_cast<const char *>(mapped);
+      size = status.st_size;
+    }
+  }
+
+  close(fd);
+}
+
+Index::Mapping::~Mapping() {
+  if (data) munmap(const_cast<char *>(data), size);
+}
+
+bool Index::Mapping::is_valid() const {
+  if (not data || size < sizeof(Header)) return false;
+
+  const Header &header = this->header();
+  if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0) return false;
+  if (header.version != VERSION) return false;
+
+  size_t expected =
+    sizeof(Header) +
+    header.file_count * sizeof(File) +
+    header.symbol_count * sizeof(Symbol) +
+    header.occurrence_count * sizeof(Occurrence) +
+    header.string_size;
+
+  return expected == size && (header.string_size == 0 || data[size - 1] == '\0');
+}
+
+const Index::Header &Index::Mapping::header() const {
+  return *reinterpret_cast<const Header *>(data);
+}
+
+const Index::File *Index::Mapping::files() const {
+  return reinterpret_cast<const File *>(data + sizeof(Header));
+}
+
+const Index::Symbol *Index::Mapping::symbols() const {
+  return reinterpret_cast<const Symbol *>(files() + header().file_count);
+}
+
+const Index::Occurrence *Index::Mapping::occurrences() const {
+  return reinterpret_cast<const Occurrence *>(symbols() + header().symbol_count);
+}
+
+const char *Index::Mapping::string(uint32_t offset) const {
+  const char *strings = reinterpret_cast<const char *>(occurrences() + header().occurrence_count);
+  return offset < header().string_size ? strings + offset : "";
+}
+
+const Index::Symbol *Index::Mapping::find(const std::string &name) const {
+  const Symbol *first = symbols();
+  const Symbol *last = first + header().symbol_count;
+
+  const Symbol *found = std::lower_bound(first, last, name, [&](const Symbol &symbol, const std::string &name) {
+    return name.compare(string(symbol.name)) > 0;
+  });
+
+  if (found == last || name != string(found->name)) return nullptr;
+  return found;
+}
+
+Index::Table Index::build(const std::string &path, const std::string &source) {
+  Table table;
+  table.files.push_back({Utils::hash(source), path});
+
+  Stream stream = Lexer::lex_source(source);
+  Statement program = Parser::build_program(stream);
+  Diagnostics diagnostics(false);
+  Symbols symbols;
+
+  try {
+    Checker checker(program, &diagnostics, &symbols);
+  } catch (const std::exception &) {
+    // An invalid program still has symbols worth finding
+  }
+
+  // Symbols only know their line, the column comes from the matching token on it
+  std::map<std::pair<size_t, std::string>, std::vector<uint32_t>> columns;
+  for (const Token &token : stream) {
+    if (token.kind == Token::Kind::IDENTIFIER) columns[{token.line, token.data}].push_back(token.column);
+
+    // Injections are named inside the string, after its opening quote
+    for (const Segment &segment : token.segments) {
+      if (segment.kind != Segment::Kind::INJECTION) continue;
+      std::string name = token.data.substr(segment.start, segment.length);
+      columns[{token.line, name}].push_back(token.column + 1 + segment.start);
+    }
+  }
+
+  // Definitions take matching tokens from the start of the line and references from
+  // its end, which places both sides of val x = x
+  std::map<std::pair<size_t, std::string>, size_t> taken_from_start;
+  std::map<std::pair<size_t, std::string>, size_t> taken_from_end;
+
+  auto locate = [&](size_t line, const std::string &name, bool is_definition) -> uint32_t {
+    auto found = columns.find({line, name});
+    if (found == columns.end()) return 0;
+
+    const std::vector<uint32_t> &candidates = found->second;
+    size_t &taken = (is_definition ? taken_from_start : taken_from_end)[{line, name}];
+    size_t index = std::min(taken++, candidates.size() - 1);
+    return is_definition ? candidates[index] : candidates[candidates.size() - 1 - index];
+  };
+
+  auto get_name = [&](const Symbols::Definition &definition) {
+    return definition.owner.empty() ? definition.name : definition.owner + ":" + definition.name;
+  };
+
+  // Occurrences keep the Symbols index of their definition until they are in order
+  std::map<std::string, std::vector<std::pair<Occurrence, size_t>>> pending;
+
+  for (size_t i = 0; i < symbols.definitions.size(); i++) {
+    const Symbols::Definition &definition = symbols.definitions[i];
+    Occurrence occurrence = {
+      0,
+      static_cast<uint32_t>(definition.line),
+      locate(definition.line, definition.name, true),
+      static_cast<uint16_t>(definition.kind),
+      static_cast<uint16_t>(Role::DEFINITION),
+      NONE
+    };
+    pending[get_name(definition)].push_back({occurrence, i});
+  }
+
+  for (const Symbols::Reference &reference : symbols.references) {
+    const Symbols::Definition &definition = symbols.definitions[reference.definition];
+    Occurrence occurrence = {
+      0,
+      static_cast<uint32_t>(reference.line),
+      locate(reference.line, reference.name, false),
+      static_cast<uint16_t>(definition.kind),
+      static_cast<uint16_t>(Role::REFERENCE),
+      NONE
+    };
+    pending[get_name(definition)].push_back({occurrence, reference.definition});
+  }
+
+  for (auto &[name, occurrences] : pending) {
+    std::stable_sort(occurrences.begin(), occurrences.end(), [](const auto &left, const auto &right) {
+      if (left.first.line != right.first.line) return left.first.line < right.first.line;
+      return left.first.column < right.first.column;
+    });
+
+    std::map<size_t, uint32_t> positions;
+    for (size_t i = 0; i < occurrences.size(); i++) {
+      if (occurrences[i].first.role == static_cast<uint16_t>(Role::DEFINITION)) {
+        positions[occurrences[i].second] = i;
+      }
+    }
+
+    std::vector<Occurrence> &target = table.symbols[name];
+    for (auto &[occurrence, definition] : occurrences) {
+      if (occurrence.role == static_cast<uint16_t>(Role::REFERENCE)) {
+        occurrence.definition = positions.at(definition);
+      }
+
+      target.push_back(occurrence);
+    }
+  }
+
+  return table;
+}
+
+void Index::merge(Table &table, const Mapping &mapping) {
+  uint32_t first_file = table.files.size();
+  const Header &header = mapping.header();
+
+  for (uint32_t i = 0; i < header.file_count; i++) {
+    const File &file = mapping.files()[i];
+    table.files.push_back({file.hash, mapping.string(file.path)});
+  }
+
+  for (uint32_t i = 0; i < header.symbol_count; i++) {
+    const Symbol &symbol = mapping.symbols()[i];
+    std::vector<Occurrence> &target = table.symbols[mapping.string(symbol.name)];
+    uint32_t first_occurrence = target.size();
+
+    for (uint32_t j = 0; j < symbol.count; j++) {
+      Occurrence occurrence = mapping.occurrences()[symbol.first + j];
+      occurrence.file += first_file;
+      if (occurrence.definition != NONE) occurrence.definition += first_occurrence;
+      target.push_back(occurrence);
+    }
+  }
+}
+
+static std::string get_project_path(const std::string &directory) {
+  return (std::filesystem::path(directory) / "project.idx").string();
+}
+
+int Index::run(const std::vector<std::string> &arguments) {
+  namespace fs = std::filesystem;
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point start = Clock::now();
+  std::string directory = ".pino-index";
+  std::vector<std::string> paths;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    if (arguments[i] == "--index" && i + 1 < arguments.size()) {
+      directory = arguments[++i];
+      continue;
+    }
+
+    paths.push_back(arguments[i]);
+  }
+
+  if (paths.empty()) paths.push_back(".");
+
+  struct Unit {
+    std::string source_path;
+    std::string index_path;
+    std::string source;
+    bool is_current;
+    std::string error;
+  };
+
+  std::vector<Unit> units;
+  std::vector<size_t> stale;
+
+  try {
+    fs::create_directories(fs::path(directory) / "files");
+
+    for (const std::string &source_path : Build::discover(paths)) {
+      std::string absolute = fs::absolute(source_path).lexically_normal().string();
+      std::string index_path = (fs::path(directory) / "files" / (Utils::to_hex(Utils::hash(absolute)) + ".idx")).string();
+
+      Unit unit = {source_path, index_path, Utils::read_file(source_path), false, ""};
+
+      // A file is indexed again only once its content hashes differently
+      Mapping mapping(index_path);
+      unit.is_current =
+        mapping.is_valid() &&
+        mapping.header().file_count == 1 &&
+        mapping.files()[0].hash == Utils::hash(unit.source) &&
+        source_path == mapping.string(mapping.files()[0].path);
+
+      if (unit.is_current) unit.source.clear();
+      else stale.push_back(units.size());
+
+      units.push_back(std::move(unit));
+    }
+  } catch (const std::exception &error) {
+    println(error.what());
+    return 2;
+  }
+
+  size_t workers = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), stale.size()));
+  Pool pool(workers, stale.size());
+
+  auto work = [&](size_t worker) {
+    size_t job;
+
+    while (pool.next(worker, job)) {
+      Unit &unit = units[stale[job]];
+      Table table;
+
+      try {
+        table = build(unit.source_path, unit.source);
+      } catch (const std::exception &error) {
+        // Kept as an empty index, so the file isn't parsed again until it changes
+        unit.error = Diagnostic::from_exception(Diagnostic::Stage::PARSE, error).message;
+        table = Table();
+        table.files.push_back({Utils::hash(unit.source), unit.source_path});
+      }
+
+      try {
+        Utils::write_file_atomic(unit.index_path, table.serialise());
+      } catch (const std::exception &error) {
+        unit.error = error.what();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t worker = 1; worker < workers; worker++) {
+    threads.emplace_back(work, worker);
+  }
+
+  if (not stale.empty()) work(0);
+  for (std::thread &thread : threads) thread.join();
+
+  // Indexes of files no longer in the project are dropped
+  std::set<std::string> kept;
+  for (const Unit &unit : units) kept.insert(fs::path(unit.index_path).filename().string());
+
+  for (const auto &entry : fs::directory_iterator(fs::path(directory) / "files")) {
+    if (not kept.count(entry.path().filename().string())) fs::remove(entry.path());
+  }
+
+  Table project;
+  for (const Unit &unit : units) {
+    if (not unit.error.empty()) println(unit.source_path + ": " + unit.error);
+
+    Mapping mapping(unit.index_path);
+    if (mapping.is_valid()) merge(project, mapping);
+  }
+
+  std::string serialised = project.serialise();
+
+  try {
+    Utils::write_file_atomic(get_project_path(directory), serialised);
+  } catch (const std::exception &error) {
+    println(error.what());
+    return 2;
+  }
+
+  char line[160];
+  snprintf(
+    line, sizeof(line), "Indexed %zu files, %zu reparsed, %zu symbols, %zu bytes in %.3f ms",
+    units.size(), stale.size(), project.symbols.size(), serialised.size(),
+    std::chrono::duration<double>(Clock::now() - start).count() * 1000
+  );
+  println(line);
+
+  return 0;
+}
+
+int Index::query(const std::vector<std::string> &arguments) {
+  using Clock = std::chrono::steady_clock;
+
+  std::string directory = ".pino-index";
+  std::string name;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    if (arguments[i] == "--index" && i + 1 < arguments.size()) {
+      directory = arguments[++i];
+      continue;
+    }
+
+    name = arguments[i];
+  }
+
+  if (name.empty()) {
+    println("Usage: references [--index DIR] NAME, members as Owner:member");
+    return 2;
+  }
+
+  Clock::time_point start = Clock::now();
+  Mapping mapping(get_project_path(directory));
+
+  if (not mapping.is_valid()) {
+    println("No index in '" + directory + "', run the index command first");
+    return 2;
+  }
+
+  const Symbol *symbol = mapping.find(name);
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (not symbol) {
+    println("No symbol named '" + name + "'");
+    return 1;
+  }
+
+  const Occurrence *occurrences = mapping.occurrences() + symbol->first;
+
+  auto get_location = [&](const Occurrence &occurrence) {
+    const File &file = mapping.files()[occurrence.file];
+    return
+      std::string(mapping.string(file.path)) + ":" +
+      std::to_string(occurrence.line + 1) + ":" + std::to_string(occurrence.column + 1);
+  };
+
+  std::map<uint32_t, std::vector<uint32_t>> uses;
+  for (uint32_t i = 0; i < symbol->count; i++) {
+    if (occurrences[i].definition != NONE) uses[occurrences[i].definition].push_back(i);
+  }
+
+  // Each definition is followed by the uses that resolved to it
+  for (uint32_t i = 0; i < symbol->count; i++) {
+    const Occurrence &definition = occurrences[i];
+    if (definition.role != static_cast<uint16_t>(Role::DEFINITION)) continue;
+
+    const std::string &kind = SYMBOL_KIND_NAMES.at(static_cast<Symbols::Kind>(definition.kind));
+    println(get_location(definition) + ": " + kind + " " + name);
+
+    for (uint32_t use : uses[i]) println("  " + get_location(occurrences[use]));
+  }
+
+  char line[96];
+  snprintf(line, sizeof(line), "%u occurrences, found in %.1f us", symbol->count, seconds * 1e6);
+  std::cerr << line << std::endl;
+
+  return 0;
+}
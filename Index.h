@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Checker.h"
+
+// Definitions and use sites of every symbol, stored so that a mapped file is
+// queried in place. Each source gets its own index, named after its path and
+// reused while the source hashes the same; the project index is merged from
+// those without parsing anything again.
+//
+// Layout: Header, File[file_count], Symbol[symbol_count] sorted by name,
+// Occurrence[occurrence_count], then the NUL terminated strings.
+class Index {
+  public:
+    static const uint32_t VERSION = 2;
+    static const uint32_t NONE = UINT32_MAX;
+
+    enum class Role : uint16_t {
+      DEFINITION,
+      REFERENCE,
+    };
+
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t file_count;
+      uint32_t symbol_count;
+      uint32_t occurrence_count;
+      uint32_t string_size;
+      uint32_t reserved;
+    };
+
+    struct File {
+      uint64_t hash;
+      uint32_t path;
+      uint32_t reserved;
+    };
+
+    // Every occurrence of one name, members named "Owner:member"
+    struct Symbol {
+      uint32_t name;
+      uint32_t first;
+      uint32_t count;
+      uint32_t reserved;
+    };
+
+    // Lines and columns are zero based, columns in bytes
+    struct Occurrence {
+      uint32_t file;
+      uint32_t line;
+      uint32_t column;
+      // A Symbols::Kind, the kind of the definition for references
+      uint16_t kind;
+      uint16_t role;
+      // Position of the definition within the symbol's occurrences, NONE for definitions
+      uint32_t definition;
+    };
+
+    // An index while it is being put together
+    struct Table {
+      std::vector<std::pair<uint64_t, std::string>> files;
+      std::map<std::string, std::vector<Occurrence>> symbols;
+
+      std::string serialise() const;
+    };
+
+    // A read only view of an index file
+    class Mapping {
+      const char *data;
+      size_t size;
+
+      public:
+        explicit Mapping(const std::string &path);
+        ~Mapping();
+
+        Mapping(const Mapping &) = delete;
+        Mapping &operator=(const Mapping &) = delete;
+
+        // False when the file is missing, truncated or from another version
+        bool is_valid() const;
+
+        const Header &header() const;
+        const File *files() const;
+        const Symbol *symbols() const;
+        const Occurrence *occurrences() const;
+        const char *string(uint32_t offset) const;
+
+        // Binary search over the sorted symbol table
+        const Symbol *find(const std::string &name) const;
+    };
+
+    static Table build(const std::string &path, const std::string &source);
+
+    // Appends every file of a mapped index to the table
+    static void merge(Table &table, const Mapping &mapping);
+
+    // index [--index DIR] [path...]
+    static int run(const std::vector<std::string> &arguments);
+
+    // references [--index DIR] NAME
+    static int query(const std::vector<std::string> &arguments);
+};
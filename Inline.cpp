@@ -0,0 +1,822 @@
+#pragma once
+
+#include "Inline.h"
+#include "Parser.cpp"
+#include "Fold.cpp"
+
+// Nodes in the value of a function small enough to copy to every call
+const size_t INLINE_SIZE_LIMIT = 16;
+
+// Nodes the calls inlined into one top level statement may add in all
+const size_t INLINE_GROWTH_LIMIT = 512;
+
+// Below every operator Python reads, ':' binding tighter than any
+const int INLINE_ASSIGNMENT = 0;
+const int INLINE_MEMBER = 6;
+const int INLINE_UNKNOWN = 100;
+
+// No operator on that side
+const int INLINE_NO_NEIGHBOUR = -1;
+
+int Inline::get_precedence(const std::string &operation) {
+  auto found = FOLD_PRECEDENCE.find(operation);
+  if (found != FOLD_PRECEDENCE.end()) return found->second;
+
+  if (operation == ":") return INLINE_MEMBER;
+  if (Utils::any_of(operation, { "=", "+=", "-=", "*=", "/=", "%=" })) return INLINE_ASSIGNMENT;
+  return INLINE_UNKNOWN;
+}
+
+std::vector<std::string> Inline::get_operations(const Expression *expression) {
+  std::vector<std::string> operations;
+
+  while (expression->is_binary()) {
+    auto binary = static_cast<const BinaryExpression *>(expression);
+    operations.push_back(binary->operation);
+    expression = binary->right.get();
+  }
+
+  return operations;
+}
+
+bool Inline::fits(const std::vector<std::string> &operations, int left, int right) {
+  for (const std::string &operation : operations) {
+    int precedence = get_precedence(operation);
+    if (precedence <= INLINE_ASSIGNMENT || precedence >= INLINE_UNKNOWN) return false;
+
+    // Python groups to the left, so only an equal operator on the right reads
+    // the same, and even then not a comparison, which would chain instead
+    if (precedence <= left) return false;
+    if (precedence < right || (precedence == right && precedence == FOLD_COMPARISON)) return false;
+  }
+
+  return true;
+}
+
+std::unique_ptr<Expression> Inline::clone(const Expression *expression, size_t line) {
+  std::unique_ptr<Expression> root;
+  std::vector<std::pair<const Expression *, std::unique_ptr<Expression> *>> pending = {{expression, &root}};
+
+  while (not pending.empty()) {
+    auto [source, target] = pending.back();
+    pending.pop_back();
+
+    std::unique_ptr<Expression> copy;
+
+    if (source->is_binary()) {
+      auto binary = static_cast<const BinaryExpression *>(source);
+      auto link = std::make_unique<BinaryExpression>();
+      link->operation = binary->operation;
+      pending.push_back({binary->right.get(), &link->right});
+      pending.push_back({binary->left.get(), &link->left});
+      copy = std::move(link);
+    } else if (source->variant == Expression::Variant::LITERAL && source->literal == Token::Literal::STRING) {
+      auto text = std::make_unique<String>();
+      text->segments = static_cast<const String *>(source)->segments;
+      copy = std::move(text);
+    } else {
+      copy = std::make_unique<Expression>();
+    }
+
+    copy->variant = source->variant;
+    copy->literal = source->literal;
+    copy->value = source->value;
+    copy->line = line;
+
+    copy->arguments.resize(source->arguments.size());
+    for (size_t i = source->arguments.size(); i-- > 0;) {
+      pending.push_back({source->arguments[i].get(), &copy->arguments[i]});
+    }
+
+    *target = std::move(copy);
+  }
+
+  return root;
+}
+
+bool Inline::is_trivial(const Expression *expression) {
+  if (not expression->arguments.empty() || not expression->children.empty()) return false;
+  if (expression->variant == Expression::Variant::IDENTIFIER) return true;
+  if (expression->variant != Expression::Variant::LITERAL) return false;
+
+  switch (expression->literal) {
+    case Token::Literal::INTEGER:
+    case Token::Literal::FLOAT:
+    case Token::Literal::BOOLEAN:
+      return true;
+    case Token::Literal::STRING:
+      return static_cast<const String *>(expression)->get_injections().empty();
+    default:
+      return false;
+  }
+}
+
+bool Inline::has_call(const Statement *node) {
+  std::vector<const Statement *> pending = {node};
+
+  while (not pending.empty()) {
+    const Statement *current = pending.back();
+    pending.pop_back();
+
+    bool is_call =
+      current->kind == Statement::Kind::EXPRESSION &&
+      static_cast<const Expression *>(current)->variant == Expression::Variant::FUNCTION_CALL;
+
+    if (is_call) return true;
+
+    std::vector<const Statement *> nodes = Optimizer::get_nodes(current);
+    pending.insert(pending.end(), nodes.begin(), nodes.end());
+  }
+
+  return false;
+}
+
+bool Inline::is_read_only(const Expression *expression, const Predicate &is_stable) {
+  std::vector<const Statement *> pending = {expression};
+
+  while (not pending.empty()) {
+    auto node = static_cast<const Expression *>(pending.back());
+    pending.pop_back();
+
+    if (node->is_binary()) {
+      // A field may be set through another name for what holds it
+      if (static_cast<const BinaryExpression *>(node)->operation == ":") return false;
+    } else if (node->variant == Expression::Variant::IDENTIFIER) {
+      if (not is_stable(node->value)) return false;
+    } else if (node->variant == Expression::Variant::LITERAL && node->literal == Token::Literal::STRING) {
+      for (const std::string &injection : static_cast<const String *>(node)->get_injections()) {
+        if (not is_stable(injection)) return false;
+      }
+    } else if (not is_trivial(node)) {
+      return false;
+    }
+
+    std::vector<const Statement *> nodes = Optimizer::get_nodes(node);
+    pending.insert(pending.end(), nodes.begin(), nodes.end());
+  }
+
+  return true;
+}
+
+std::optional<Inline::Callee> Inline::create_callee(
+  const std::string &name,
+  const std::vector<std::unique_ptr<Variable>> &parameters,
+  const std::vector<std::unique_ptr<Statement>> &body
+) {
+  if (body.size() != 1) return std::nullopt;
+
+  const Statement *statement = body.front().get();
+  if (statement->kind != Statement::Kind::STATEMENT || statement->type != Statement::Type::RETURN_STATEMENT) {
+    return std::nullopt;
+  }
+
+  const Expression *value = static_cast<const Jump *>(statement)->value.get();
+  if (not value) return std::nullopt;
+
+  Callee callee;
+
+  for (const auto &parameter : parameters) {
+    // Defaults would be evaluated where the function is made
+    if (parameter->value) return std::nullopt;
+
+    callee.parameters.push_back(parameter->name);
+    callee.is_float.push_back(parameter->typing.data == Token::Literal::FLOAT);
+  }
+
+  auto is_parameter = [&callee](const std::string &name) {
+    return Utils::any_of(name, callee.parameters);
+  };
+
+  // Each node with whether it is a member read off the operand before it
+  std::vector<std::pair<const Expression *, bool>> pending = {{value, false}};
+
+  while (not pending.empty()) {
+    auto [node, is_member] = pending.back();
+    pending.pop_back();
+
+    if (++callee.size > INLINE_SIZE_LIMIT) return std::nullopt;
+    if (not node->children.empty()) return std::nullopt;
+
+    if (node->is_binary()) {
+      auto binary = static_cast<const BinaryExpression *>(node);
+      int precedence = get_precedence(binary->operation);
+      if (precedence <= INLINE_ASSIGNMENT || precedence >= INLINE_UNKNOWN) return std::nullopt;
+
+      pending.push_back({binary->right.get(), binary->operation == ":"});
+      pending.push_back({binary->left.get(), is_member});
+      continue;
+    }
+
+    // Fields may be read, but a method could change what it is called on
+    if (is_member) {
+      if (node->variant != Expression::Variant::IDENTIFIER) return std::nullopt;
+      continue;
+    }
+
+    switch (node->variant) {
+      case Expression::Variant::IDENTIFIER:
+        if (not is_parameter(node->value)) callee.names.insert(node->value);
+        break;
+      case Expression::Variant::FUNCTION_CALL:
+        if (node->value == name) return std::nullopt;
+        if (not is_parameter(node->value)) callee.names.insert(node->value);
+
+        for (const auto &argument : node->arguments) pending.push_back({argument.get(), false});
+        break;
+      case Expression::Variant::LITERAL:
+        if (node->literal == Token::Literal::STRING) {
+          // Injections name what they read, which arguments can't stand in for
+          for (const std::string &injection : static_cast<const String *>(node)->get_injections()) {
+            if (is_parameter(injection)) return std::nullopt;
+            callee.names.insert(injection);
+          }
+        } else if (
+          node->literal != Token::Literal::INTEGER &&
+          node->literal != Token::Literal::FLOAT &&
+          node->literal != Token::Literal::BOOLEAN
+        ) {
+          return std::nullopt;
+        }
+
+        break;
+      default:
+        return std::nullopt;
+    }
+  }
+
+  callee.value = clone(value, value->line);
+  return callee;
+}
+
+std::vector<Inline::Occurrence> Inline::find_occurrences(
+  std::unique_ptr<Expression> &root,
+  const std::vector<std::string> &parameters
+) {
+  std::vector<Occurrence> occurrences;
+  std::vector<Occurrence> pending = {{&root, false, INLINE_NO_NEIGHBOUR, INLINE_NO_NEIGHBOUR, true}};
+
+  auto find = [&parameters](const std::string &name) {
+    return std::find(parameters.begin(), parameters.end(), name) - parameters.begin();
+  };
+
+  // Outer nodes are found before the ones they hold
+  while (not pending.empty()) {
+    Occurrence item = pending.back();
+    pending.pop_back();
+
+    Expression *node =
+      item.is_left ? static_cast<BinaryExpression *>(item.slot->get())->left.get() : item.slot->get();
+
+    if (node->is_binary()) {
+      std::vector<std::unique_ptr<Expression> *> holders;
+      std::unique_ptr<Expression> *holder = item.slot;
+
+      while ((*holder)->is_binary()) {
+        holders.push_back(holder);
+        holder = &static_cast<BinaryExpression *>(holder->get())->right;
+      }
+
+      auto operation = [&holders](size_t index) -> const std::string & {
+        return static_cast<BinaryExpression *>(holders[index]->get())->operation;
+      };
+
+      for (size_t i = holders.size() + 1; i-- > 0;) {
+        // Members are names of fields, never parameters
+        if (i > 0 && operation(i - 1) == ":") continue;
+
+        int left = i > 0 ? get_precedence(operation(i - 1)) : item.left;
+        int right = i < holders.size() ? get_precedence(operation(i)) : item.right;
+
+        if (i < holders.size()) {
+          pending.push_back({holders[i], true, left, right, item.is_spine});
+        } else {
+          pending.push_back({holder, false, left, right, item.is_spine});
+        }
+      }
+
+      continue;
+    }
+
+    size_t parameter = find(node->value);
+
+    if (node->variant == Expression::Variant::IDENTIFIER && parameter < parameters.size()) {
+      item.parameter = parameter;
+      item.is_call = false;
+      occurrences.push_back(item);
+    } else if (node->variant == Expression::Variant::FUNCTION_CALL) {
+      if (parameter < parameters.size()) {
+        item.parameter = parameter;
+        item.is_call = true;
+        occurrences.push_back(item);
+      }
+
+      for (auto argument = node->arguments.rbegin(); argument != node->arguments.rend(); argument++) {
+        pending.push_back({&*argument, false, INLINE_NO_NEIGHBOUR, INLINE_NO_NEIGHBOUR, false});
+      }
+    }
+  }
+
+  return occurrences;
+}
+
+void Inline::place(const Occurrence &occurrence, std::unique_ptr<Expression> replacement) {
+  if (not occurrence.is_left) {
+    *occurrence.slot = std::move(replacement);
+    return;
+  }
+
+  auto link = static_cast<BinaryExpression *>(occurrence.slot->get());
+
+  if (not replacement->is_binary()) {
+    link->left = std::move(replacement);
+    return;
+  }
+
+  // Chains lean right, so one put on the left is laid out in front of the link,
+  // which takes its last operand
+  auto last = static_cast<BinaryExpression *>(replacement.get());
+  while (last->right->is_binary()) last = static_cast<BinaryExpression *>(last->right.get());
+
+  link->left = std::move(last->right);
+  last->right = std::move(*occurrence.slot);
+  *occurrence.slot = std::move(replacement);
+}
+
+std::unique_ptr<Expression> Inline::expand(
+  const Callee &callee,
+  std::vector<std::unique_ptr<Expression>> &arguments,
+  int left,
+  int right,
+  size_t line,
+  const Predicate &is_stable
+) {
+  size_t count = callee.parameters.size();
+  if (arguments.size() != count) return nullptr;
+
+  std::unique_ptr<Expression> value = clone(callee.value.get(), line);
+  std::vector<bool> is_called(count, false);
+
+  // Lambdas given for the parameters called go in first, inner calls before
+  // the ones holding them
+  std::vector<Occurrence> occurrences = find_occurrences(value, callee.parameters);
+
+  for (auto occurrence = occurrences.rbegin(); occurrence != occurrences.rend(); occurrence++) {
+    if (not occurrence->is_call) continue;
+
+    const Expression *argument = arguments[occurrence->parameter].get();
+    if (argument->variant != Expression::Variant::LITERAL || argument->literal != Token::Literal::LAMBDA) return nullptr;
+
+    auto lambda = static_cast<const Lambda *>(argument);
+    std::optional<Callee> inner = create_callee("", lambda->parameters, lambda->children);
+    if (not inner) return nullptr;
+
+    // What the lambda reads is what its names mean where it was written
+    for (const std::string &name : inner->names) {
+      if (Utils::any_of(name, callee.parameters)) return nullptr;
+    }
+
+    Expression *call =
+      occurrence->is_left ?
+        static_cast<BinaryExpression *>(occurrence->slot->get())->left.get() :
+        occurrence->slot->get();
+
+    // Its arguments are read off the parameters, which are looked at once they are in
+    auto is_parameter = [&callee](const std::string &name) { return Utils::any_of(name, callee.parameters); };
+    std::unique_ptr<Expression> result =
+      expand(*inner, call->arguments, occurrence->left, occurrence->right, line, is_parameter);
+    if (not result) return nullptr;
+
+    place(*occurrence, std::move(result));
+    is_called[occurrence->parameter] = true;
+  }
+
+  occurrences = find_occurrences(value, callee.parameters);
+  std::vector<size_t> uses(count, 0);
+
+  for (const Occurrence &occurrence : occurrences) {
+    if (occurrence.is_call) return nullptr;
+    uses[occurrence.parameter]++;
+  }
+
+  bool has_calls = has_call(value.get());
+  bool has_short_circuit = false;
+  bool has_names = false;
+
+  std::vector<const Statement *> pending = {value.get()};
+  while (not pending.empty()) {
+    auto node = static_cast<const Expression *>(pending.back());
+    pending.pop_back();
+
+    if (node->is_binary()) {
+      const std::string &operation = static_cast<const BinaryExpression *>(node)->operation;
+      has_short_circuit = has_short_circuit || operation == "and" || operation == "or";
+    } else if (node->variant == Expression::Variant::IDENTIFIER) {
+      has_names = has_names || not Utils::any_of(node->value, callee.parameters);
+    } else if (node->variant == Expression::Variant::LITERAL && node->literal == Token::Literal::STRING) {
+      has_names = has_names || not static_cast<const String *>(node)->get_injections().empty();
+    }
+
+    std::vector<const Statement *> nodes = Optimizer::get_nodes(node);
+    pending.insert(pending.end(), nodes.begin(), nodes.end());
+  }
+
+  // Arguments with effects of their own, which have to stay in order
+  std::vector<size_t> effectful;
+
+  for (size_t i = 0; i < count; i++) {
+    const Expression *argument = arguments[i].get();
+    bool is_lambda = argument->variant == Expression::Variant::LITERAL && argument->literal == Token::Literal::LAMBDA;
+
+    // The C++ backend would have converted an int to the float parameter
+    if (callee.is_float[i] && uses[i] > 0) {
+      bool is_float = argument->variant == Expression::Variant::LITERAL && argument->literal == Token::Literal::FLOAT;
+      if (not is_float) return nullptr;
+    }
+
+    for (const Occurrence &occurrence : occurrences) {
+      if (occurrence.parameter != i) continue;
+      if (not fits(get_operations(argument), occurrence.left, occurrence.right)) return nullptr;
+    }
+
+    if (is_called[i] || uses[i] == 0) {
+      // Making a lambda does nothing else, anything other than a plain read may raise
+      if (is_lambda || is_trivial(argument)) continue;
+      return nullptr;
+    }
+
+    // Read after the calls in the value, which must not be able to change it,
+    // where it was read before them
+    if (has_calls && (is_lambda || not is_read_only(argument, is_stable))) return nullptr;
+    if (is_trivial(argument)) continue;
+
+    // Evaluated once, and for sure, as it was before the call
+    if (uses[i] > 1 || has_short_circuit) return nullptr;
+    if (has_call(argument)) effectful.push_back(i);
+  }
+
+  if (not effectful.empty()) {
+    // Nothing read before it that it could change
+    if (effectful.size() > 1 || has_calls || has_names) return nullptr;
+
+    for (size_t i = 0; i < count; i++) {
+      if (i == effectful.front() || uses[i] == 0) continue;
+      if (not is_read_only(arguments[i].get(), [](const std::string &) { return false; })) return nullptr;
+    }
+  }
+
+  // The value is read between the operators around the call, with what went
+  // in place of the parameters on its outermost chain laid out in it
+  std::vector<std::string> operations = get_operations(value.get());
+  for (const Occurrence &occurrence : occurrences) {
+    if (not occurrence.is_spine) continue;
+
+    std::vector<std::string> inner = get_operations(arguments[occurrence.parameter].get());
+    operations.insert(operations.end(), inner.begin(), inner.end());
+  }
+
+  if (not fits(operations, left, right)) return nullptr;
+
+  for (auto occurrence = occurrences.rbegin(); occurrence != occurrences.rend(); occurrence++) {
+    std::unique_ptr<Expression> &argument = arguments[occurrence->parameter];
+
+    if (uses[occurrence->parameter] == 1) {
+      place(*occurrence, std::move(argument));
+    } else {
+      place(*occurrence, clone(argument.get(), argument->line));
+    }
+  }
+
+  return value;
+}
+
+size_t Inline::open_frame(size_t parent, const std::vector<std::string> &names, const std::vector<Statement *> &body) {
+  Frame frame;
+  frame.parent = parent;
+  frame.is_native = frames[parent].is_native;
+  frame.declared.insert(names.begin(), names.end());
+
+  std::map<std::string, size_t> declared;
+  Fold::count_declarations(body, declared);
+  for (const auto &[name, count] : declared) frame.declared.insert(name);
+
+  frames.push_back(std::move(frame));
+  return frames.size() - 1;
+}
+
+bool Inline::is_hidden(const std::string &name, size_t frame) const {
+  while (frame != 0) {
+    if (frames[frame].declared.count(name)) return true;
+    frame = frames[frame].parent;
+  }
+
+  return false;
+}
+
+bool Inline::is_local(const std::string &name, size_t frame) const {
+  while (frame != 0) {
+    if (frames[frame].declared.count(name)) return not frames[frame].is_members;
+    frame = frames[frame].parent;
+  }
+
+  return false;
+}
+
+void Inline::inline_call(const Occurrence &at, size_t frame) {
+  Expression *call = at.is_left ? static_cast<BinaryExpression *>(at.slot->get())->left.get() : at.slot->get();
+
+  auto found = callees.find(call->value);
+  if (found == callees.end() || frames[frame].is_native) return;
+
+  const Callee &callee = found->second;
+  if (growth + callee.size > INLINE_GROWTH_LIMIT) return;
+
+  // The function and what it reads have to mean the same here as at the top level
+  if (is_hidden(call->value, frame)) return;
+  for (const std::string &name : callee.names) {
+    if (is_hidden(name, frame)) return;
+  }
+
+  auto is_stable = [this, frame](const std::string &name) { return is_local(name, frame); };
+  std::unique_ptr<Expression> value = expand(callee, call->arguments, at.left, at.right, call->line, is_stable);
+  if (not value) return;
+
+  // The call goes with the arguments the value had no use for
+  Optimizer::forget(call, typings);
+  place(at, std::move(value));
+
+  growth += callee.size;
+  changes++;
+}
+
+void Inline::record(Statement &program) {
+  for (const auto &child : program.children) {
+    if (child->kind != Statement::Kind::STATEMENT) continue;
+
+    if (child->type != Statement::Type::FUNCTION_DECLARATION) {
+      if (child->type == Statement::Type::VARIABLE_DECLARATION) callees.erase(static_cast<Variable *>(child.get())->name);
+      continue;
+    }
+
+    auto function = static_cast<Function *>(child.get());
+    std::optional<Callee> callee =
+      function->is_native ? std::nullopt : create_callee(function->name, function->parameters, function->children);
+
+    if (callee) {
+      callees[function->name] = std::move(*callee);
+    } else {
+      callees.erase(function->name);
+    }
+  }
+}
+
+void Inline::expand_expression(Pending &item, std::vector<Pending> &pending) {
+  auto expression = static_cast<Expression *>(item.node);
+  size_t frame = item.frame;
+
+  auto push_value = [&](std::unique_ptr<Expression> &value, size_t inner) {
+    if (value) pending.push_back({value.get(), {&value, false, INLINE_NO_NEIGHBOUR, INLINE_NO_NEIGHBOUR}, inner});
+  };
+
+  if (expression->is_binary()) {
+    std::vector<std::unique_ptr<Expression> *> holders;
+    std::vector<BinaryExpression *> links;
+
+    std::unique_ptr<Expression> *holder = item.at.slot;
+    Expression *node = expression;
+
+    while (node->is_binary()) {
+      auto binary = static_cast<BinaryExpression *>(node);
+      holders.push_back(holder);
+      links.push_back(binary);
+      holder = &binary->right;
+      node = binary->right.get();
+    }
+
+    // Only what is assigned is a value, never what it is assigned to
+    size_t target = 0;
+    for (size_t i = 0; i < links.size(); i++) {
+      if (links[i]->variant == Expression::Variant::ASSIGNMENT) target = i + 1;
+    }
+
+    for (size_t i = links.size() + 1; i-- > 0;) {
+      Expression *operand = i < links.size() ? links[i]->left.get() : node;
+      int left = i > 0 ? get_precedence(links[i - 1]->operation) : item.at.left;
+      int right = i < links.size() ? get_precedence(links[i]->operation) : item.at.right;
+
+      // A member call is a method, which names nothing at the top level
+      bool is_member = i > 0 && links[i - 1]->operation == ":";
+      bool is_value = i >= target && not is_member;
+
+      Occurrence at = {nullptr, false, left, right};
+      if (is_value && i < links.size()) at = {holders[i], true, left, right};
+      if (is_value && i == links.size()) at = {holder, false, left, right};
+
+      pending.push_back({operand, at, frame});
+    }
+
+    return;
+  }
+
+  switch (expression->variant) {
+    case Expression::Variant::FUNCTION_CALL: {
+      if (item.at.slot) {
+        Occurrence at = item.at;
+        pending.push_back({nullptr, {}, frame, [this, at, frame]() { inline_call(at, frame); }});
+      }
+
+      for (auto argument = expression->arguments.rbegin(); argument != expression->arguments.rend(); argument++) {
+        push_value(*argument, frame);
+      }
+
+      break;
+    }
+    case Expression::Variant::BLOCK: {
+      for (auto child = expression->children.rbegin(); child != expression->children.rend(); child++) {
+        pending.push_back({child->get(), {}, frame});
+      }
+
+      break;
+    }
+    case Expression::Variant::LITERAL: {
+      if (expression->literal == Token::Literal::ARRAY) {
+        auto array = static_cast<Array *>(expression);
+        if (array->init) push_value(array->init, open_frame(frame, {"it"}, {array->init.get()}));
+        push_value(array->len, frame);
+      } else if (expression->literal == Token::Literal::STRUCT) {
+        auto object = static_cast<Object *>(expression);
+
+        for (auto property = object->properties.rbegin(); property != object->properties.rend(); property++) {
+          push_value((*property)->value, frame);
+        }
+      } else if (expression->literal == Token::Literal::LAMBDA) {
+        auto lambda = static_cast<Lambda *>(expression);
+        std::vector<std::string> names;
+        std::vector<Statement *> body;
+
+        for (const auto &parameter : lambda->parameters) names.push_back(parameter->name);
+        for (const auto &child : lambda->children) body.push_back(child.get());
+
+        size_t inner = open_frame(frame, names, body);
+        for (auto child = lambda->children.rbegin(); child != lambda->children.rend(); child++) {
+          pending.push_back({child->get(), {}, inner});
+        }
+
+        for (auto parameter = lambda->parameters.rbegin(); parameter != lambda->parameters.rend(); parameter++) {
+          push_value((*parameter)->value, frame);
+        }
+      }
+
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void Inline::expand_statement(Pending &item, std::vector<Pending> &pending) {
+  Statement *node = item.node;
+  size_t frame = item.frame;
+
+  auto push_children = [&](Statement *parent, size_t inner) {
+    for (auto child = parent->children.rbegin(); child != parent->children.rend(); child++) {
+      pending.push_back({child->get(), {}, inner});
+    }
+  };
+
+  auto push_value = [&](std::unique_ptr<Expression> &value) {
+    if (value) pending.push_back({value.get(), {&value, false, INLINE_NO_NEIGHBOUR, INLINE_NO_NEIGHBOUR}, frame});
+  };
+
+  auto push_function = [&](Function *function, size_t outer) {
+    std::vector<std::string> names;
+    std::vector<Statement *> body;
+
+    for (const auto &parameter : function->parameters) names.push_back(parameter->name);
+    for (const auto &child : function->children) body.push_back(child.get());
+
+    size_t inner = open_frame(outer, names, body);
+    frames[inner].is_native = frames[inner].is_native || function->is_native;
+    push_children(function, inner);
+
+    for (auto parameter = function->parameters.rbegin(); parameter != function->parameters.rend(); parameter++) {
+      push_value((*parameter)->value);
+    }
+  };
+
+  // Methods read the fields, values and other methods by name
+  auto open_members = [&](const std::vector<std::string> &fields, const std::vector<std::unique_ptr<Function>> &methods) {
+    std::vector<std::string> names = fields;
+    for (const auto &method : methods) names.push_back(method->name);
+
+    size_t inner = open_frame(frame, names, {});
+    frames[inner].is_members = true;
+    return inner;
+  };
+
+  switch (node->type) {
+    case Statement::Type::VARIABLE_DECLARATION:
+    case Statement::Type::CONSTANT_DECLARATION:
+      push_value(static_cast<Variable *>(node)->value);
+      break;
+    case Statement::Type::FUNCTION_DECLARATION:
+      push_function(static_cast<Function *>(node), frame);
+      break;
+    case Statement::Type::STRUCT_DECLARATION: {
+      auto declaration = static_cast<Struct *>(node);
+      std::vector<std::string> fields;
+      for (const auto &field : declaration->fields) fields.push_back(field->name);
+
+      size_t inner = open_members(fields, declaration->methods);
+      for (auto method = declaration->methods.rbegin(); method != declaration->methods.rend(); method++) {
+        push_function(method->get(), inner);
+      }
+
+      for (auto field = declaration->fields.rbegin(); field != declaration->fields.rend(); field++) {
+        push_value((*field)->value);
+      }
+
+      break;
+    }
+    case Statement::Type::ENUM_DECLARATION: {
+      auto declaration = static_cast<Enum *>(node);
+      size_t inner = open_members(declaration->values, declaration->methods);
+
+      for (auto method = declaration->methods.rbegin(); method != declaration->methods.rend(); method++) {
+        push_function(method->get(), inner);
+      }
+
+      break;
+    }
+    case Statement::Type::IF_STATEMENT: {
+      auto statement = static_cast<If *>(node);
+      if (statement->else_block) pending.push_back({statement->else_block.get(), {}, frame});
+      push_children(statement, frame);
+      push_value(statement->condition);
+      break;
+    }
+    case Statement::Type::MATCH_STATEMENT: {
+      auto match = static_cast<Match *>(node);
+      push_children(match, frame);
+      push_value(match->condition);
+      break;
+    }
+    case Statement::Type::WHEN_STATEMENT: {
+      auto when = static_cast<When *>(node);
+      push_children(when, frame);
+      for (auto condition = when->conditions.rbegin(); condition != when->conditions.rend(); condition++) {
+        push_value(*condition);
+      }
+
+      break;
+    }
+    case Statement::Type::LOOP_STATEMENT: {
+      auto loop = static_cast<For *>(node);
+      push_children(loop, frame);
+
+      if (loop->variant == For::Variant::TIMES) push_value(loop->index);
+      if (loop->variant == For::Variant::FOR_IN) push_value(loop->limit);
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT:
+      push_value(static_cast<Jump *>(node)->value);
+      break;
+    case Statement::Type::IMPORT_STATEMENT:
+      // Whatever the module exports may rebind names
+      callees.clear();
+      break;
+    default:
+      push_children(node, frame);
+      break;
+  }
+}
+
+size_t Inline::run(Statement &program, Context &context) {
+  typings = context.typings;
+  changes = 0;
+  growth = 0;
+  frames = {Frame()};
+
+  std::vector<Pending> pending;
+  for (auto child = program.children.rbegin(); child != program.children.rend(); child++) {
+    pending.push_back({child->get(), {}, 0});
+  }
+
+  while (not pending.empty()) {
+    Pending item = std::move(pending.back());
+    pending.pop_back();
+
+    if (item.action) {
+      item.action();
+    } else if (item.node->kind == Statement::Kind::EXPRESSION) {
+      expand_expression(item, pending);
+    } else {
+      expand_statement(item, pending);
+    }
+  }
+
+  // Functions declared here are inlined into the statements after it
+  record(program);
+
+  typings = nullptr;
+  return changes;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Optimizer.h"
+#include "Fold.h"
+
+// Puts what a small top level function returns in place of the calls to it,
+// its parameters replaced by the arguments, when Python would read the result
+// the same way and nothing is evaluated more often or in another order. A
+// lambda passed as a literal to a parameter that is only called is inlined
+// into the body the same way. Recursive functions never are, and a budget on
+// the size of each function and on the growth of each statement bounds the bloat
+class Inline : public Pass {
+  private:
+    // A function or lambda whose whole body returns a value
+    struct Callee {
+      std::vector<std::string> parameters;
+      // Floats are converted to on the way in by the C++ backend
+      std::vector<bool> is_float;
+      std::unique_ptr<Expression> value;
+      // Names the value reads besides the parameters
+      std::set<std::string> names;
+      size_t size = 0;
+    };
+
+    // Where a parameter is read or called in a copy of a value, and the
+    // operators next to it
+    struct Occurrence {
+      std::unique_ptr<Expression> *slot = nullptr;
+      // The slot holds the link whose left operand the occurrence is
+      bool is_left = false;
+      int left = {};
+      int right = {};
+      // On the outermost chain of the value, so the operators of what
+      // replaces it become the value's own
+      bool is_spine = false;
+      size_t parameter = 0;
+      bool is_call = false;
+    };
+
+    // A function, lambda, comprehension or the members of a struct or enum,
+    // whose names hide those of the module from a value inlined in it
+    struct Frame {
+      size_t parent = 0;
+      std::set<std::string> declared;
+      // Calls in a @native function are compiled to C++ on their own
+      bool is_native = false;
+      // Fields and values, which can be set through what holds them
+      bool is_members = false;
+    };
+
+    // A node still to be looked at, or a call to try once its arguments were
+    struct Pending {
+      Statement *node = nullptr;
+      // Where the node is owned, with a null slot when it may not be replaced
+      Occurrence at;
+      size_t frame = 0;
+      std::function<void()> action = {};
+    };
+
+    using Predicate = std::function<bool(const std::string &)>;
+
+    // Functions declared before the top level statement at hand
+    std::map<std::string, Callee> callees;
+    std::vector<Frame> frames;
+    // Nodes the calls inlined into the statement at hand added
+    size_t growth = 0;
+    Typings *typings = nullptr;
+    size_t changes = 0;
+
+    static int get_precedence(const std::string &operation);
+    static std::vector<std::string> get_operations(const Expression *expression);
+    // Whether operators laid out flat between the neighbours are read as one operand
+    static bool fits(const std::vector<std::string> &operations, int left, int right);
+
+    static std::unique_ptr<Expression> clone(const Expression *expression, size_t line);
+    static bool is_trivial(const Expression *expression);
+    static bool has_call(const Statement *node);
+    // Whether the expression only reads literals and the names given
+    static bool is_read_only(const Expression *expression, const Predicate &is_stable);
+
+    // The callee a value makes, if it is small and plain enough to be copied
+    static std::optional<Callee> create_callee(
+      const std::string &name,
+      const std::vector<std::unique_ptr<Variable>> &parameters,
+      const std::vector<std::unique_ptr<Statement>> &body
+    );
+
+    static std::vector<Occurrence> find_occurrences(
+      std::unique_ptr<Expression> &root,
+      const std::vector<std::string> &parameters
+    );
+
+    static void place(const Occurrence &occurrence, std::unique_ptr<Expression> replacement);
+
+    // The value of a call between the given operators, taking the arguments
+    // only when it can be made. Arguments may only be read after a call when
+    // they read stable names, which no call can set
+    static std::unique_ptr<Expression> expand(
+      const Callee &callee,
+      std::vector<std::unique_ptr<Expression>> &arguments,
+      int left,
+      int right,
+      size_t line,
+      const Predicate &is_stable
+    );
+
+    size_t open_frame(size_t parent, const std::vector<std::string> &names, const std::vector<Statement *> &body);
+    bool is_hidden(const std::string &name, size_t frame) const;
+    // Declared in a function, lambda or comprehension around the frame
+    bool is_local(const std::string &name, size_t frame) const;
+
+    void inline_call(const Occurrence &at, size_t frame);
+    void record(Statement &program);
+
+    void expand_expression(Pending &item, std::vector<Pending> &pending);
+    void expand_statement(Pending &item, std::vector<Pending> &pending);
+
+  public:
+    size_t run(Statement &program, Context &context) override;
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Utils.h"
+#include "Interface.h"
+
+const std::map<Scope::Entity, std::string> INTERFACE_KEYWORDS = {
+  {Scope::Entity::FUNCTION, "fn"},
+  {Scope::Entity::STRUCT, "struct"},
+  {Scope::Entity::ENUM, "enum"},
+  {Scope::Entity::FIELD, "field"},
+  {Scope::Entity::METHOD, "method"},
+  {Scope::Entity::VALUE, "value"},
+};
+
+// <literal> <length>:<value> <child count> <child>...
+void write_typing(const Typing &typing, std::string &output) {
+  output += std::to_string(static_cast<int>(typing.data)) + " ";
+  output += std::to_string(typing.value.size()) + ":" + typing.value;
+  output += " " + std::to_string(typing.children.size());
+
+  for (const Typing &child : typing.children) {
+    output += " ";
+    write_typing(child, output);
+  }
+}
+
+bool read_typing(std::istream &input, Typing &typing) {
+  int literal;
+  size_t length;
+  size_t count;
+
+  if (not (input >> literal >> length) || input.get() != ':') return false;
+  if (literal < 0 || literal > static_cast<int>(Token::Literal::UNKNOWN)) return false;
+
+  typing.data = static_cast<Token::Literal>(literal);
+  typing.value.resize(length);
+  if (not input.read(typing.value.data(), length) || not (input >> count)) return false;
+
+  typing.children.resize(count);
+  for (Typing &child : typing.children) {
+    if (not read_typing(input, child)) return false;
+  }
+
+  return true;
+}
+
+Interface Interface::from_program(const Statement &program) {
+  Interface interface;
+
+  for (const auto &child : program.children) {
+    if (child->kind != Statement::Kind::STATEMENT) continue;
+
+    switch (child->type) {
+      case Statement::Type::FUNCTION_DECLARATION: {
+        const auto function = static_cast<const Function*>(child.get());
+        interface.exports.push_back({Scope::Entity::FUNCTION, function->name, function->typing, {}});
+      } break;
+      case Statement::Type::STRUCT_DECLARATION: {
+        const auto structure = static_cast<const Struct*>(child.get());
+        Typing typing = Typing::create(Token::Literal::STRUCT);
+        typing.value = structure->name;
+
+        Export declaration = {Scope::Entity::STRUCT, structure->name, typing, {}};
+
+        for (const auto &field : structure->fields) {
+          declaration.members.push_back({Scope::Entity::FIELD, field->name, field->typing});
+        }
+
+        for (const auto &method : structure->methods) {
+          declaration.members.push_back({Scope::Entity::METHOD, method->name, method->typing});
+        }
+
+        interface.exports.push_back(std::move(declaration));
+      } break;
+      case Statement::Type::ENUM_DECLARATION: {
+        const auto enumeration = static_cast<const Enum*>(child.get());
+        Typing typing = Typing::create(Token::Literal::UNKNOWN);
+        typing.value = enumeration->name;
+
+        Export declaration = {Scope::Entity::ENUM, enumeration->name, typing, {}};
+
+        for (const std::string &value : enumeration->values) {
+          declaration.members.push_back({Scope::Entity::VALUE, value, typing});
+        }
+
+        for (const auto &method : enumeration->methods) {
+          declaration.members.push_back({Scope::Entity::METHOD, method->name, method->typing});
+        }
+
+        interface.exports.push_back(std::move(declaration));
+      } break;
+      default: break;
+    }
+  }
+
+  return interface;
+}
+
+std::string Interface::serialise_exports() const {
+  std::string output;
+
+  for (const Export &declaration : exports) {
+    output += INTERFACE_KEYWORDS.at(declaration.entity) + " " + declaration.name + " ";
+    write_typing(declaration.typing, output);
+    output += "\n";
+
+    for (const Member &member : declaration.members) {
+      output += "  " + INTERFACE_KEYWORDS.at(member.entity) + " " + member.name + " ";
+      write_typing(member.typing, output);
+      output += "\n";
+    }
+  }
+
+  return output;
+}
+
+uint64_t Interface::get_hash() const {
+  return Utils::hash(serialise_exports());
+}
+
+std::string Interface::serialise() const {
+  std::string exported = serialise_exports();
+  std::string output = "pino-interface " + std::to_string(VERSION) + "\n";
+
+  output += "hash " + Utils::to_hex(Utils::hash(exported)) + "\n";
+  output += "source " + Utils::to_hex(source_hash) + "\n";
+
+  for (const auto &[module, hash] : imports) {
+    output += "import " + Utils::to_hex(hash) + " " + module + "\n";
+  }
+
+  return output + exported;
+}
+
+std::optional<Interface> Interface::parse(const std::string &text) {
+  Interface interface;
+  std::istringstream input(text);
+  std::string line;
+  std::string expected_hash;
+
+  auto read_hex = [](const std::string &hex, uint64_t &value) {
+    if (hex.size() != 16 || not std::all_of(hex.begin(), hex.end(), isxdigit)) return false;
+    value = std::stoull(hex, nullptr, 16);
+    return true;
+  };
+
+  if (not std::getline(input, line) || line != "pino-interface " + std::to_string(VERSION)) {
+    return std::nullopt;
+  }
+
+  while (std::getline(input, line)) {
+    std::istringstream fields(line);
+    std::string keyword;
+    fields >> keyword;
+
+    if (keyword == "hash") {
+      fields >> expected_hash;
+      continue;
+    }
+
+    if (keyword == "source") {
+      std::string hex;
+      fields >> hex;
+      if (not read_hex(hex, interface.source_hash)) return std::nullopt;
+      continue;
+    }
+
+    if (keyword == "import") {
+      std::string hex;
+      std::string module;
+      uint64_t hash;
+
+      fields >> hex;
+      fields.get();
+      std::getline(fields, module);
+      if (not read_hex(hex, hash) || module.empty()) return std::nullopt;
+
+      interface.imports[module] = hash;
+      continue;
+    }
+
+    auto entity = std::find_if(INTERFACE_KEYWORDS.begin(), INTERFACE_KEYWORDS.end(), [&](const auto &entry) {
+      return entry.second == keyword;
+    });
+    if (entity == INTERFACE_KEYWORDS.end()) return std::nullopt;
+
+    std::string name;
+    Typing typing;
+    if (not (fields >> name) || not read_typing(fields, typing)) return std::nullopt;
+
+    bool is_member = 
+      entity->first == Scope::Entity::FIELD || 
+      entity->first == Scope::Entity::METHOD || 
+      entity->first == Scope::Entity::VALUE;
+
+    if (not is_member) {
+      interface.exports.push_back({entity->first, name, typing, {}});
+      continue;
+    }
+
+    // Members belong to the struct or enum right above them
+    if (interface.exports.empty() || interface.exports.back().entity == Scope::Entity::FUNCTION) {
+      return std::nullopt;
+    }
+
+    interface.exports.back().members.push_back({entity->first, name, typing});
+  }
+
+  if (expected_hash != Utils::to_hex(interface.get_hash())) return std::nullopt;
+
+  return interface;
+}
+
+void Interface::declare(Scope &scope) const {
+  for (const Export &declaration : exports) {
+    scope.append(declaration.name, declaration.typing, declaration.entity);
+
+    for (const Member &member : declaration.members) {
+      scope.append(declaration.name + ":" + member.name, member.typing, member.entity);
+    }
+  }
+}
+
+std::string Interface::get_path(const std::string &module) {
+  return module + ".pinoi";
+}
+
+Interfaces::Interfaces(const std::string &root) : root(root) {}
+
+void Interfaces::add(const std::string &module, Interface interface) {
+  std::lock_guard<std::mutex> lock(mutex);
+  modules[module] = std::move(interface);
+}
+
+const Interface *Interfaces::find(const std::string &module) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = modules.find(module);
+
+  if (found == modules.end()) {
+    std::optional<Interface> interface;
+    std::string path = (std::filesystem::path(root) / Interface::get_path(module)).string();
+
+    try {
+      interface = Interface::parse(Utils::read_file(path));
+    } catch (const std::exception &) {}
+
+    found = modules.emplace(module, std::move(interface)).first;
+  }
+
+  return found->second ? &*found->second : nullptr;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Checker.h"
+
+// What a module shows the modules importing it: the signatures of its top level
+// functions, structs and enums. It is written beside the source as
+// <module>.pinoi along with the hashes the module was compiled against, so
+// dependents are checked without reading its source and a build can tell what
+// needs compiling again without reading any source but the changed ones.
+class Interface {
+  std::string serialise_exports() const;
+
+  public:
+    static const uint32_t VERSION = 1;
+
+    struct Member {
+      Scope::Entity entity;
+      std::string name;
+      Typing typing;
+    };
+
+    struct Export {
+      Scope::Entity entity;
+      std::string name;
+      Typing typing;
+      // Fields and methods of structs, values and methods of enums
+      std::vector<Member> members;
+    };
+
+    uint64_t source_hash = 0;
+    // Interface hash of every import as it was when this module was compiled
+    std::map<std::string, uint64_t> imports;
+    std::vector<Export> exports;
+
+    static Interface from_program(const Statement &program);
+
+    // Covers the exports alone, so edits that dependents can't see leave it alone
+    uint64_t get_hash() const;
+
+    std::string serialise() const;
+
+    // Nothing for files from another version, cut short or edited by hand
+    static std::optional<Interface> parse(const std::string &text);
+
+    // Brings every export into scope as if it had been declared there
+    void declare(Scope &scope) const;
+
+    static std::string get_path(const std::string &module);
+};
+
+// Interfaces by module, read from beside the sources the first time they are asked for
+class Interfaces {
+  std::string root;
+  std::mutex mutex;
+  std::map<std::string, std::optional<Interface>> modules;
+
+  public:
+    explicit Interfaces(const std::string &root = ".");
+
+    // Replaces whatever was known about the module
+    void add(const std::string &module, Interface interface);
+
+    // Nothing when the module has no readable interface
+    const Interface *find(const std::string &module);
+};
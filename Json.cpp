@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include "Json.h"
+
+Json::Json() : kind(Kind::NUL), boolean(false), number(0) {}
+Json::Json(bool boolean) : kind(Kind::BOOLEAN), boolean(boolean), number(0) {}
+Json::Json(int number) : kind(Kind::NUMBER), boolean(false), number(number) {}
+Json::Json(size_t number) : kind(Kind::NUMBER), boolean(false), number(number) {}
+Json::Json(double number) : kind(Kind::NUMBER), boolean(false), number(number) {}
+Json::Json(const char *string) : kind(Kind::STRING), boolean(false), number(0), string(string) {}
+Json::Json(const std::string &string) : kind(Kind::STRING), boolean(false), number(0), string(string) {}
+
+Json Json::make_array() {
+  Json json;
+  json.kind = Kind::ARRAY;
+  return json;
+}
+
+Json Json::make_object() {
+  Json json;
+  json.kind = Kind::OBJECT;
+  return json;
+}
+
+bool Json::is_null() const {
+  return kind == Kind::NUL;
+}
+
+const Json &Json::operator[](const std::string &key) const {
+  static const Json missing;
+  auto value = object.find(key);
+  return value == object.end() ? missing : value->second;
+}
+
+const Json &Json::operator[](size_t index) const {
+  static const Json missing;
+  return index < array.size() ? array[index] : missing;
+}
+
+Json &Json::set(const std::string &key, Json value) {
+  kind = Kind::OBJECT;
+  object[key] = std::move(value);
+  return *this;
+}
+
+Json &Json::push(Json value) {
+  kind = Kind::ARRAY;
+  array.push_back(std::move(value));
+  return *this;
+}
+
+size_t Json::as_size() const {
+  return kind == Kind::NUMBER && number > 0 ? static_cast<size_t>(number) : 0;
+}
+
+static void dump_string(std::string &output, const std::string &string) {
+  const char *hex = "0123456789abcdef";
+  output += '"';
+
+  for (unsigned char character : string) {
+    switch (character) {
+      case '"': output += "\\\""; break;
+      case '\\': output += "\\\\"; break;
+      case '\n': output += "\\n"; break;
+      case '\r': output += "\\r"; break;
+      case '\t': output += "\\t"; break;
+      default:
+        if (character < 0x20) {
+          output += "\\u00";
+          output += hex[character >> 4];
+          output += hex[character & 15];
+        } else output += character;
+    }
+  }
+
+  output += '"';
+}
+
+void Json::dump(std::string &output) const {
+  switch (kind) {
+    case Kind::NUL:
+      output += "null";
+      break;
+    case Kind::BOOLEAN:
+      output += boolean ? "true" : "false";
+      break;
+    case Kind::NUMBER: {
+      if (number == std::floor(number) && std::fabs(number) < 1e15) {
+        output += std::to_string(static_cast<long long>(number));
+      } else {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", number);
+        output += buffer;
+      }
+      break;
+    }
+    case Kind::STRING:
+      dump_string(output, string);
+      break;
+    case Kind::ARRAY: {
+      output += '[';
+      for (size_t i = 0; i < array.size(); i++) {
+        if (i > 0) output += ',';
+        array[i].dump(output);
+      }
+      output += ']';
+      break;
+    }
+    case Kind::OBJECT: {
+      output += '{';
+      bool is_first = true;
+      for (const auto &[key, value] : object) {
+        if (not is_first) output += ',';
+        is_first = false;
+        dump_string(output, key);
+        output += ':';
+        value.dump(output);
+      }
+      output += '}';
+      break;
+    }
+  }
+}
+
+std::string Json::dump() const {
+  std::string output;
+  dump(output);
+  return output;
+}
+
+// Values nest through an explicit stack, like the rest of the front end
+Json Json::parse(const std::string &text) {
+  size_t index = 0;
+
+  auto skip_whitespace = [&]() {
+    while (index < text.size() && std::isspace(static_cast<unsigned char>(text[index]))) index++;
+  };
+
+  auto expect = [&](char character) {
+    skip_whitespace();
+    if (index >= text.size() || text[index] != character) {
+      throw std::runtime_error("DEV: Malformed JSON, expected '" + std::string(1, character) + "'");
+    }
+    index++;
+  };
+
+  auto append_utf8 = [](std::string &output, unsigned code) {
+    if (code < 0x80) {
+      output += static_cast<char>(code);
+    } else if (code < 0x800) {
+      output += static_cast<char>(0xC0 | (code >> 6));
+      output += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      output += static_cast<char>(0xE0 | (code >> 12));
+      output += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      output += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      output += static_cast<char>(0xF0 | (code >> 18));
+      output += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      output += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      output += static_cast<char>(0x80 | (code & 0x3F));
+    }
+  };
+
+  auto parse_hex = [&]() {
+    if (index + 4 > text.size()) throw std::runtime_error("DEV: Malformed JSON escape");
+    unsigned code = std::stoul(text.substr(index, 4), nullptr, 16);
+    index += 4;
+    return code;
+  };
+
+  auto parse_string = [&]() {
+    expect('"');
+    std::string output;
+
+    while (index < text.size() && text[index] != '"') {
+      char character = text[index++];
+      if (character != '\\') {
+        output += character;
+        continue;
+      }
+
+      if (index >= text.size()) break;
+      char escape = text[index++];
+
+      switch (escape) {
+        case 'n': output += '\n'; break;
+        case 'r': output += '\r'; break;
+        case 't': output += '\t'; break;
+        case 'b': output += '\b'; break;
+        case 'f': output += '\f'; break;
+        case 'u': {
+          unsigned code = parse_hex();
+          // Characters outside the basic plane come as surrogate pairs
+          if (code >= 0xD800 && code < 0xDC00 && text.compare(index, 2, "\\u") == 0) {
+            index += 2;
+            code = 0x10000 + ((code - 0xD800) << 10) + (parse_hex() - 0xDC00);
+          }
+          append_utf8(output, code);
+          break;
+        }
+        default: output += escape;
+      }
+    }
+
+    expect('"');
+    return output;
+  };
+
+  // Containers still being filled, with the key awaiting a value in objects
+  std::vector<std::pair<Json, std::string>> open;
+
+  while (true) {
+    skip_whitespace();
+    if (index >= text.size()) throw std::runtime_error("DEV: Malformed JSON, unexpected end");
+
+    Json value;
+    bool is_complete = true;
+    char character = text[index];
+
+    if (character == '{' || character == '[') {
+      index++;
+      open.push_back({character == '{' ? make_object() : make_array(), ""});
+      skip_whitespace();
+
+      char closing = character == '{' ? '}' : ']';
+      if (index < text.size() && text[index] == closing) {
+        index++;
+        value = std::move(open.back().first);
+        open.pop_back();
+      } else {
+        is_complete = false;
+        if (character == '{') {
+          open.back().second = parse_string();
+          expect(':');
+        }
+      }
+    } else if (character == '"') {
+      value = Json(parse_string());
+    } else if (text.compare(index, 4, "true") == 0) {
+      value = Json(true);
+      index += 4;
+    } else if (text.compare(index, 5, "false") == 0) {
+      value = Json(false);
+      index += 5;
+    } else if (text.compare(index, 4, "null") == 0) {
+      index += 4;
+    } else {
+      const char *start = text.c_str() + index;
+      char *end = nullptr;
+      double number = std::strtod(start, &end);
+      if (end == start) throw std::runtime_error("DEV: Malformed JSON value");
+
+      value = Json(number);
+      index += end - start;
+    }
+
+    if (not is_complete) continue;
+
+    // Hands the finished value to its container, closing every container it completes
+    while (true) {
+      if (open.empty()) return value;
+
+      auto &[container, key] = open.back();
+      if (container.kind == Kind::OBJECT) container.object[key] = std::move(value);
+      else container.array.push_back(std::move(value));
+
+      skip_whitespace();
+      if (index >= text.size()) throw std::runtime_error("DEV: Malformed JSON, unexpected end");
+
+      if (text[index] == ',') {
+        index++;
+        if (container.kind == Kind::OBJECT) {
+          key = parse_string();
+          expect(':');
+        }
+        break;
+      }
+
+      char closing = container.kind == Kind::OBJECT ? '}' : ']';
+      expect(closing);
+
+      value = std::move(container);
+      open.pop_back();
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Just enough JSON for the language server protocol
+class Json {
+  public:
+    enum class Kind {
+      NUL,
+      BOOLEAN,
+      NUMBER,
+      STRING,
+      ARRAY,
+      OBJECT,
+    };
+
+    Kind kind;
+    bool boolean;
+    double number;
+    std::string string;
+    std::vector<Json> array;
+    std::map<std::string, Json> object;
+
+    Json();
+    Json(bool boolean);
+    Json(int number);
+    Json(size_t number);
+    Json(double number);
+    Json(const char *string);
+    Json(const std::string &string);
+
+    static Json make_array();
+    static Json make_object();
+
+    bool is_null() const;
+
+    // Missing keys and out of range items read as null
+    const Json &operator[](const std::string &key) const;
+    const Json &operator[](size_t index) const;
+
+    Json &set(const std::string &key, Json value);
+    Json &push(Json value);
+
+    size_t as_size() const;
+
+    std::string dump() const;
+    void dump(std::string &output) const;
+
+    static Json parse(const std::string &text);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Utils.h"
+#include "Jump.h"
+#include "Expression.cpp"
+
+const std::map<Keyword, Statement::Type> JUMP_TYPES = {
+  {Keyword::RETURN, Statement::Type::RETURN_STATEMENT},
+  {Keyword::BREAK, Statement::Type::BREAK_STATEMENT},
+  {Keyword::CONTINUE, Statement::Type::CONTINUE_STATEMENT},
+};
+
+const std::map<Statement::Type, std::string> JUMP_NAMES = {
+  {Statement::Type::RETURN_STATEMENT, "Return"},
+  {Statement::Type::BREAK_STATEMENT, "Break"},
+  {Statement::Type::CONTINUE_STATEMENT, "Continue"},
+};
+
+Jump::~Jump() {
+  dismantle();
+}
+
+void Jump::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, value);
+  Statement::release(pending);
+}
+
+PeekPtr<Jump> Jump::build(Stream &stream, const size_t &start_index) {
+  PeekPtr<Jump> result;
+
+  const Token &keyword = stream.at(start_index);
+  auto type = keyword.kind == Token::Kind::KEYWORD 
+    ? JUMP_TYPES.find(Token::get_keyword(keyword.data)) 
+    : JUMP_TYPES.end();
+
+  if (type == JUMP_TYPES.end()) {
+    throw std::runtime_error("DEV: Expected 'return', 'break' or 'continue' keyword");
+  }
+
+  result.data->kind = Kind::STATEMENT;
+  result.data->type = type->second;
+  result.end_index = start_index;
+
+  // return <value>, a value on a later line is a statement of its own
+  bool has_value = 
+    type->second == Type::RETURN_STATEMENT &&
+    start_index + 1 < stream.size() &&
+    stream[start_index + 1].line == keyword.line &&
+    Expression::is_expression(stream, start_index);
+
+  if (has_value) {
+    PeekPtr<Expression> value = Expression::build(stream, start_index);
+    result.data->value = std::move(value.data);
+    result.end_index = value.end_index;
+  }
+
+  return result;
+}
+
+void Jump::describe(Printer &printer, size_t indent) const {
+  std::string indentation = Utils::get_indent(indent);
+
+  if (not value) {
+    printer.line(indentation + JUMP_NAMES.at(type));
+    return;
+  }
+
+  printer.line(indentation + JUMP_NAMES.at(type) + " {");
+  printer.child(value.get(), indent + 1);
+  printer.line(indentation + "}");
+}
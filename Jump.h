@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Utils.h"
+#include "Statement.h"
+#include "Expression.h"
+
+// return [<value>], break and continue, told apart by their type
+class Jump : public Statement {
+  public:
+    // Only a return may carry one, written on the same line as the keyword
+    std::unique_ptr<Expression> value;
+
+    ~Jump() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
+    static PeekPtr<Jump> build(Stream &stream, const size_t &start_index);
+
+    void describe(Printer &printer, size_t indent) const override;
+};
@@ -0,0 +1,535 @@
+#pragma once
+
+#include "LanguageServer.h"
+#include "Json.cpp"
+#include "Session.cpp"
+
+const std::vector<std::string> SEMANTIC_TOKEN_TYPES = {
+  "keyword",
+  "variable",
+  "function",
+  "string",
+  "number",
+  "operator",
+  "type",
+};
+
+Document::Document() : diagnostics(false), version(0), parsed_chunks(0), next_id(0) {}
+
+Document::Line Document::lex_line(const std::string &text) {
+  Line line;
+  line.text = text;
+  line.id = next_id++;
+  line.depth_change = 0;
+  line.is_continued = false;
+  line.is_continuation = false;
+  line.is_unindented_statement = false;
+
+  try {
+    line.tokens = Lexer::lex_ln(text);
+  } catch (const std::runtime_error &error) {
+    line.error = error.what();
+    return line;
+  }
+
+  for (const Token &token : line.tokens) {
+    if (token.is_given_marker(Marker::LEFT_BRACE, Marker::LEFT_PARENTHESIS)) line.depth_change++;
+    if (token.is_given_marker(Marker::RIGHT_BRACE, Marker::RIGHT_PARENTHESIS)) line.depth_change--;
+  }
+
+  if (not line.tokens.empty()) {
+    const Token &first = line.tokens.front();
+    const Token &last = line.tokens.back();
+
+    // Lines that can't start a statement, like else or + 2, carry on the one above,
+    // as do the lines after one ending in an operator
+    line.is_continuation =
+      first.is_given_kind(Token::Kind::OPERATOR, Token::Kind::MARKER) ||
+      (first.is_given_kind(Token::Kind::KEYWORD) && first.is_given_keyword(Keyword::ELSE));
+    line.is_continued =
+      Token::is_binary_operator(last.data) ||
+      last.is_given_kind(Token::Kind::OPERATOR) ||
+      last.is_given_marker(Marker::COMMA);
+    line.is_unindented_statement =
+      first.column == 0 && first.is_given_kind(Token::Kind::KEYWORD) && not line.is_continuation;
+  }
+
+  return line;
+}
+
+void Document::open(const std::string &text) {
+  lines.clear();
+  chunks.clear();
+
+  size_t start = 0;
+  while (true) {
+    size_t end = text.find('\n', start);
+    lines.push_back(lex_line(text.substr(start, end == std::string::npos ? std::string::npos : end - start)));
+    if (end == std::string::npos) break;
+    start = end + 1;
+  }
+
+  analyse();
+}
+
+void Document::edit(
+  size_t start_line,
+  size_t start_column,
+  size_t end_line,
+  size_t end_column,
+  const std::string &text
+) {
+  if (lines.empty()) lines.push_back(lex_line(""));
+
+  start_line = std::min(start_line, lines.size() - 1);
+  end_line = std::min(std::max(end_line, start_line), lines.size() - 1);
+  start_column = std::min(start_column, lines[start_line].text.size());
+  end_column = std::min(end_column, lines[end_line].text.size());
+
+  std::string replaced =
+    lines[start_line].text.substr(0, start_column) + text + lines[end_line].text.substr(end_column);
+
+  std::vector<Line> inserted;
+  size_t start = 0;
+  while (true) {
+    size_t end = replaced.find('\n', start);
+    inserted.push_back(lex_line(replaced.substr(start, end == std::string::npos ? std::string::npos : end - start)));
+    if (end == std::string::npos) break;
+    start = end + 1;
+  }
+
+  lines.erase(lines.begin() + start_line, lines.begin() + end_line + 1);
+  lines.insert(
+    lines.begin() + start_line,
+    std::make_move_iterator(inserted.begin()),
+    std::make_move_iterator(inserted.end())
+  );
+}
+
+std::unique_ptr<Document::Chunk> Document::build_chunk(size_t first_line, std::vector<uint64_t> ids) {
+  auto chunk = std::make_unique<Chunk>();
+  chunk->ids = std::move(ids);
+  chunk->first_line = first_line;
+  parsed_chunks++;
+
+  for (size_t i = 0; i < chunk->ids.size(); i++) {
+    const Line &line = lines[first_line + i];
+
+    if (line.error) {
+      chunk->error = Diagnostic{
+        Diagnostic::Stage::LEX, Diagnostic::Severity::INTERNAL, *line.error, i
+      };
+      return chunk;
+    }
+
+    for (Token token : line.tokens) {
+      token.line = i;
+      chunk->stream.push_back(std::move(token));
+    }
+  }
+
+  try {
+    chunk->program = Parser::build_program(chunk->stream);
+  } catch (const std::exception &error) {
+    chunk->error = Diagnostic::from_exception(Diagnostic::Stage::PARSE, error);
+    chunk->program = Statement();
+  }
+
+  return chunk;
+}
+
+void Document::analyse() {
+  diagnostics.clear();
+  symbols.clear();
+
+  std::unordered_map<uint64_t, std::unique_ptr<Chunk>> previous;
+  for (std::unique_ptr<Chunk> &chunk : chunks) {
+    uint64_t first_id = chunk->ids.empty() ? UINT64_MAX : chunk->ids.front();
+    previous[first_id] = std::move(chunk);
+  }
+  chunks.clear();
+
+  // A chunk is reused when it still spans exactly the same unchanged lines
+  auto close_chunk = [&](size_t first, size_t last) {
+    auto reused = previous.find(first < last ? lines[first].id : UINT64_MAX);
+
+    if (reused != previous.end() && reused->second->ids.size() == last - first) {
+      const std::vector<uint64_t> &ids = reused->second->ids;
+      size_t i = 0;
+      while (i < ids.size() && ids[i] == lines[first + i].id) i++;
+
+      if (i == ids.size()) {
+        reused->second->first_line = first;
+        chunks.push_back(std::move(reused->second));
+        previous.erase(reused);
+        return;
+      }
+    }
+
+    std::vector<uint64_t> ids;
+    for (size_t i = first; i < last; i++) ids.push_back(lines[i].id);
+    chunks.push_back(build_chunk(first, std::move(ids)));
+  };
+
+  int depth = 0;
+  for (const Line &line : lines) depth = std::max(0, depth + line.depth_change);
+
+  // While a bracket is left open, unindented statements are taken to start afresh,
+  // so that one half typed call doesn't swallow the rest of the document
+  bool is_balanced = depth == 0;
+
+  // New chunks start on lines at depth zero that don't carry on the one before
+  depth = 0;
+  bool is_continued = false;
+  size_t first = 0;
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    const Line &line = lines[i];
+    bool is_start =
+      depth == 0 && not is_continued && not line.tokens.empty() && not line.is_continuation;
+
+    if (not is_balanced && not is_start && line.is_unindented_statement) {
+      is_start = true;
+      depth = 0;
+    }
+
+    if (is_start && i > first) {
+      close_chunk(first, i);
+      first = i;
+    }
+
+    depth = std::max(0, depth + line.depth_change);
+    if (not line.tokens.empty()) is_continued = line.is_continued;
+  }
+
+  close_chunk(first, lines.size());
+
+  std::vector<Checker::Piece> pieces;
+  for (const std::unique_ptr<Chunk> &chunk : chunks) {
+    if (chunk->error) {
+      Diagnostic diagnostic = *chunk->error;
+      if (diagnostic.line) diagnostic.line = *diagnostic.line + chunk->first_line;
+      diagnostics.entries.push_back(diagnostic);
+      continue;
+    }
+
+    pieces.push_back({&chunk->program, chunk->first_line, &chunk->summary});
+  }
+
+  try {
+    Checker checker(pieces, &diagnostics, &symbols);
+  } catch (const std::exception &) {
+    // The checker has already reported why it gave up
+  }
+}
+
+const Token *Document::find_token(size_t line, size_t column) const {
+  if (line >= lines.size()) return nullptr;
+
+  for (const Token &token : lines[line].tokens) {
+    if (column >= token.column && column <= token.column + token.length) return &token;
+  }
+
+  return nullptr;
+}
+
+const Symbols::Definition *Document::resolve(size_t line, size_t column) const {
+  const Token *token = find_token(line, column);
+  if (not token || token->kind != Token::Kind::IDENTIFIER) return nullptr;
+
+  // A scan per request is cheaper than an index rebuilt on every keystroke
+  for (const Symbols::Reference &reference : symbols.references) {
+    if (reference.line == line && reference.name == token->data) {
+      return &symbols.definitions[reference.definition];
+    }
+  }
+
+  // The cursor may be on the declaration itself
+  for (const Symbols::Definition &definition : symbols.definitions) {
+    if (definition.line == line && definition.name == token->data) return &definition;
+  }
+
+  return nullptr;
+}
+
+Json Document::get_semantic_tokens() const {
+  auto get_type = [&](const Stream &tokens, size_t index) -> int {
+    const Token &token = tokens[index];
+
+    switch (token.kind) {
+      case Token::Kind::KEYWORD:
+        return 0;
+      case Token::Kind::OPERATOR:
+        return 5;
+      case Token::Kind::LITERAL: {
+        if (token.literal == Token::Literal::STRING) return 3;
+        if (token.literal == Token::Literal::BOOLEAN) return 0;
+        if (token.literal == Token::Literal::ARRAY) return 6;
+        return 4;
+      }
+      case Token::Kind::IDENTIFIER: {
+        bool is_call =
+          index + 1 < tokens.size() &&
+          tokens[index + 1].is_given_marker(Marker::LEFT_PARENTHESIS);
+        if (is_call) return 2;
+        if (std::isupper(static_cast<unsigned char>(token.data[0]))) return 6;
+        return 1;
+      }
+      default:
+        return -1;
+    }
+  };
+
+  size_t count = 0;
+  for (const Line &line : lines) count += line.tokens.size();
+
+  Json data = Json::make_array();
+  data.array.reserve(5 * count);
+  size_t previous_line = 0;
+  size_t previous_column = 0;
+
+  for (size_t line = 0; line < lines.size(); line++) {
+    const Stream &tokens = lines[line].tokens;
+
+    for (size_t i = 0; i < tokens.size(); i++) {
+      int type = get_type(tokens, i);
+      if (type < 0) continue;
+
+      size_t delta_line = line - previous_line;
+      size_t delta_column = delta_line == 0 ? tokens[i].column - previous_column : tokens[i].column;
+
+      data.push(delta_line);
+      data.push(delta_column);
+      data.push(tokens[i].length);
+      data.push(type);
+      data.push(0);
+
+      previous_line = line;
+      previous_column = tokens[i].column;
+    }
+  }
+
+  return data;
+}
+
+LanguageServer::LanguageServer() : is_shutdown(false) {}
+
+void LanguageServer::send(const Json &message) {
+  std::string body = message.dump();
+  std::cout << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+  std::cout.flush();
+}
+
+static Json make_position(size_t line, size_t character) {
+  return Json::make_object().set("line", line).set("character", character);
+}
+
+static Json make_range(size_t line, size_t start, size_t end) {
+  return Json::make_object()
+    .set("start", make_position(line, start))
+    .set("end", make_position(line, end));
+}
+
+void LanguageServer::publish_diagnostics(const std::string &uri, const Document &document) {
+  Json diagnostics = Json::make_array();
+
+  for (const Diagnostic &diagnostic : document.diagnostics.entries) {
+    if (diagnostic.severity == Diagnostic::Severity::NOTE) continue;
+
+    size_t line = diagnostic.line.value_or(0);
+    size_t start = 0;
+    size_t end = 0;
+
+    if (line < document.lines.size()) {
+      const Document::Line &source = document.lines[line];
+      end = source.text.size();
+      if (not source.tokens.empty()) start = source.tokens.front().column;
+    }
+
+    diagnostics.push(Json::make_object()
+      .set("range", make_range(line, start, end))
+      .set("severity", 1)
+      .set("source", "pino")
+      .set("message", diagnostic.message)
+    );
+  }
+
+  send(Json::make_object()
+    .set("jsonrpc", "2.0")
+    .set("method", "textDocument/publishDiagnostics")
+    .set("params", Json::make_object()
+      .set("uri", uri)
+      .set("version", document.version)
+      .set("diagnostics", diagnostics)
+    )
+  );
+}
+
+std::optional<Json> LanguageServer::handle(const Json &message) {
+  const std::string &method = message["method"].string;
+  const Json &params = message["params"];
+  Json result;
+
+  if (method == "initialize") {
+    Json legend = Json::make_object()
+      .set("tokenTypes", Json::make_array())
+      .set("tokenModifiers", Json::make_array());
+    for (const std::string &type : SEMANTIC_TOKEN_TYPES) legend.object["tokenTypes"].push(type);
+
+    result = Json::make_object().set("capabilities", Json::make_object()
+      // 2 is incremental synchronisation
+      .set("textDocumentSync", 2)
+      .set("hoverProvider", true)
+      .set("definitionProvider", true)
+      .set("semanticTokensProvider", Json::make_object()
+        .set("legend", legend)
+        .set("full", true)
+      )
+    );
+  } else if (method == "shutdown") {
+    is_shutdown = true;
+  } else if (method == "textDocument/didOpen") {
+    const Json &item = params["textDocument"];
+    Document &document = documents[item["uri"].string];
+    document.version = static_cast<int>(item["version"].number);
+    document.open(item["text"].string);
+    publish_diagnostics(item["uri"].string, document);
+  } else if (method == "textDocument/didChange") {
+    const std::string &uri = params["textDocument"]["uri"].string;
+    auto found = documents.find(uri);
+    if (found == documents.end()) return std::nullopt;
+
+    Document &document = found->second;
+    document.version = static_cast<int>(params["textDocument"]["version"].number);
+
+    for (const Json &change : params["contentChanges"].array) {
+      const Json &range = change["range"];
+
+      if (range.is_null()) {
+        document.open(change["text"].string);
+        continue;
+      }
+
+      document.edit(
+        range["start"]["line"].as_size(), range["start"]["character"].as_size(),
+        range["end"]["line"].as_size(), range["end"]["character"].as_size(),
+        change["text"].string
+      );
+    }
+
+    document.analyse();
+    publish_diagnostics(uri, document);
+  } else if (method == "textDocument/didClose") {
+    documents.erase(params["textDocument"]["uri"].string);
+  } else if (
+    method == "textDocument/hover" ||
+    method == "textDocument/definition" ||
+    method == "textDocument/semanticTokens/full"
+  ) {
+    const std::string &uri = params["textDocument"]["uri"].string;
+    auto found = documents.find(uri);
+
+    if (found != documents.end() && method == "textDocument/semanticTokens/full") {
+      result = Json::make_object().set("data", found->second.get_semantic_tokens());
+    } else if (found != documents.end()) {
+      const Document &document = found->second;
+      size_t line = params["position"]["line"].as_size();
+      size_t column = params["position"]["character"].as_size();
+      const Symbols::Definition *definition = document.resolve(line, column);
+
+      if (definition && method == "textDocument/hover") {
+        std::string value = "```\n" + definition->name + ": " + definition->typing.to_string() + "```";
+        result = Json::make_object().set("contents", Json::make_object()
+          .set("kind", "markdown")
+          .set("value", value)
+        );
+      } else if (definition) {
+        size_t start = 0;
+        if (definition->line < document.lines.size()) {
+          for (const Token &token : document.lines[definition->line].tokens) {
+            if (token.data == definition->name) {
+              start = token.column;
+              break;
+            }
+          }
+        }
+
+        result = Json::make_object()
+          .set("uri", uri)
+          .set("range", make_range(definition->line, start, start + definition->name.size()));
+      }
+    }
+  } else if (message["id"].is_null()) {
+    // Notifications we don't know about are dropped
+    return std::nullopt;
+  } else {
+    return Json::make_object()
+      .set("jsonrpc", "2.0")
+      .set("id", message["id"])
+      .set("error", Json::make_object()
+        .set("code", -32601)
+        .set("message", "Unsupported method '" + method + "'")
+      );
+  }
+
+  if (message["id"].is_null()) return std::nullopt;
+
+  return Json::make_object()
+    .set("jsonrpc", "2.0")
+    .set("id", message["id"])
+    .set("result", result);
+}
+
+int LanguageServer::serve() {
+  std::ios::sync_with_stdio(false);
+  std::string header;
+
+  while (true) {
+    size_t length = 0;
+    bool has_length = false;
+
+    // Headers end with an empty line
+    while (std::getline(std::cin, header)) {
+      if (not header.empty() && header.back() == '\r') header.pop_back();
+      if (header.empty()) break;
+
+      if (header.rfind("Content-Length:", 0) == 0) {
+        length = std::stoul(header.substr(15));
+        has_length = true;
+      }
+    }
+
+    if (not std::cin) return is_shutdown ? 0 : 1;
+    if (not has_length) continue;
+
+    std::string body(length, '\0');
+    if (not std::cin.read(&body[0], length)) return is_shutdown ? 0 : 1;
+
+    Json message;
+    try {
+      message = Json::parse(body);
+    } catch (const std::exception &error) {
+      send(Json::make_object()
+        .set("jsonrpc", "2.0")
+        .set("id", Json())
+        .set("error", Json::make_object().set("code", -32700).set("message", error.what()))
+      );
+      continue;
+    }
+
+    if (message["method"].string == "exit") return is_shutdown ? 0 : 1;
+
+    try {
+      std::optional<Json> response = handle(message);
+      if (response) send(*response);
+    } catch (const std::exception &error) {
+      if (message["id"].is_null()) continue;
+
+      send(Json::make_object()
+        .set("jsonrpc", "2.0")
+        .set("id", message["id"])
+        .set("error", Json::make_object().set("code", -32603).set("message", error.what()))
+      );
+    }
+  }
+}
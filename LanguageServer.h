@@ -0,0 +1,87 @@
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include "Json.h"
+#include "Session.cpp"
+
+// An open file, kept as lexed lines and independently parsed top level chunks.
+// An edit relexes only the lines it touches and reparses only the chunks made
+// of those lines; the checker then walks only the chunks whose trees or global
+// names changed, replaying what it found in every other one.
+class Document {
+  public:
+    struct Line {
+      std::string text;
+      Stream tokens;
+      std::optional<std::string> error;
+      // Changes every time the line is lexed again
+      uint64_t id;
+      int depth_change;
+      bool is_continued;
+      bool is_continuation;
+      bool is_unindented_statement;
+    };
+
+    struct Chunk {
+      std::vector<uint64_t> ids;
+      size_t first_line;
+      Stream stream;
+      Statement program;
+      // Line numbers relative to first_line
+      std::optional<Diagnostic> error;
+      // Left by the checker, and reused while the names it read stay the same
+      std::optional<Summary> summary;
+    };
+
+    std::vector<Line> lines;
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    Diagnostics diagnostics;
+    Symbols symbols;
+    int version;
+    size_t parsed_chunks;
+
+    Document();
+
+    void open(const std::string &text);
+
+    // Replaces the text between two zero based positions, columns in bytes
+    void edit(
+      size_t start_line, 
+      size_t start_column, 
+      size_t end_line, 
+      size_t end_column, 
+      const std::string &text
+    );
+
+    void analyse();
+
+    const Token *find_token(size_t line, size_t column) const;
+
+    // The definition of the identifier under the given position
+    const Symbols::Definition *resolve(size_t line, size_t column) const;
+
+    // Every token in the LSP relative encoding, types indexed into SEMANTIC_TOKEN_TYPES
+    Json get_semantic_tokens() const;
+
+  private:
+    uint64_t next_id;
+
+    Line lex_line(const std::string &text);
+    std::unique_ptr<Chunk> build_chunk(size_t first_line, std::vector<uint64_t> ids);
+};
+
+// Speaks the language server protocol over stdin and stdout
+class LanguageServer {
+  std::map<std::string, Document> documents;
+  bool is_shutdown;
+
+  std::optional<Json> handle(const Json &message);
+  void publish_diagnostics(const std::string &uri, const Document &document);
+  void send(const Json &message);
+
+  public:
+    LanguageServer();
+
+    int serve();
+};
@@ -1,10 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <sstream>
 #include "Lexer.h"
 #include "Utils.h"
 
-std::map<Token::Kind, std::string> KIND = {
+const std::map<Token::Kind, std::string> KIND = {
   {Token::Kind::IDENTIFIER, "Identifier"},
   {Token::Kind::LITERAL, "Literal"},
   {Token::Kind::MARKER, "Marker"},
@@ -17,7 +18,7 @@ std::string get_kind_name(Token::Kind kind) {
 }
 
 // Stores only single character operator
-std::map<char, Operator> CHAR_OPERATOR = {
+const std::map<char, Operator> CHAR_OPERATOR = {
   {'=', Operator::ASSIGN},
   {'+', Operator::ADDITION},
   {'-', Operator::SUBTRACTION},
@@ -30,7 +31,7 @@ std::map<char, Operator> CHAR_OPERATOR = {
 };
 
 // Stores only multiple character operator
-std::map<std::string, Operator> LONG_OPERATOR = {
+const std::map<std::string, Operator> LONG_OPERATOR = {
   {"and", Operator::AND},
   {"or", Operator::OR},
   {"not", Operator::NOT},
@@ -46,7 +47,7 @@ std::map<std::string, Operator> LONG_OPERATOR = {
 };
 
 // Stores them all and is used for checking
-std::map<std::string, Operator> OPERATOR = {
+const std::map<std::string, Operator> OPERATOR = {
   {"=", Operator::ASSIGN},
   {"+", Operator::ADDITION},
   {"-", Operator::SUBTRACTION},
@@ -69,7 +70,7 @@ std::map<std::string, Operator> OPERATOR = {
   {"%=", Operator::ASSIGN_MODULUS},
 };
 
-std::map<std::string, BinaryOperator> BINARY_OPERATOR = {
+const std::map<std::string, BinaryOperator> BINARY_OPERATOR = {
   {"=", BinaryOperator::ASSIGN},
   {"+", BinaryOperator::ADDITION},
   {"-", BinaryOperator::SUBTRACTION},
@@ -92,7 +93,7 @@ std::map<std::string, BinaryOperator> BINARY_OPERATOR = {
   {"%=", BinaryOperator::ASSIGN_MODULUS},
 };
 
-std::map<std::string, Keyword> KEYWORD = {
+const std::map<std::string, Keyword> KEYWORD = {
   {"var", Keyword::VAR},
   {"val", Keyword::VAL},
   {"enum", Keyword::ENUM},
@@ -109,9 +110,11 @@ std::map<std::string, Keyword> KEYWORD = {
   {"when", Keyword::WHEN},
   {"block", Keyword::BLOCK},
   {"give", Keyword::GIVE},
+  {"import", Keyword::IMPORT},
+  {"@native", Keyword::NATIVE},
 };
 
-std::map<char, Marker> MARKER = {
+const std::map<char, Marker> MARKER = {
   {'"', Marker::STR_QUOTE},
   {'#', Marker::STR_INJECTION},
   {'}', Marker::RIGHT_BRACE},
@@ -266,8 +269,21 @@ bool is_next(const std::string &line, const size_t start_index, std::function<bo
   return predicate(line[start_index + 1]);
 }
 
+std::vector<std::string> Token::get_injections() const {
+  std::vector<std::string> injections;
+
+  for (const Segment &segment : segments) {
+    if (segment.kind == Segment::Kind::INJECTION) {
+      injections.push_back(data.substr(segment.start, segment.length));
+    }
+  }
+
+  return injections;
+}
+
 void Token::print() const {
   std::string kind = get_kind_name(this->kind);
+  std::vector<std::string> injections = get_injections();
 
   if (injections.empty()) {
     println(kind + " { data: " + data + " }");
@@ -279,7 +295,7 @@ void Token::print() const {
   }
 }
 
-Token Stream::get_next(const size_t &start_index) const {
+const Token &Stream::get_next(const size_t &start_index) const {
   if (start_index + 1 >= size()) {
     throw std::runtime_error("DEV: Out of Range");
   }
@@ -287,7 +303,7 @@ Token Stream::get_next(const size_t &start_index) const {
   return at(start_index + 1);
 }
 
-bool Stream::is_previous(const size_t start_index, std::function<bool(const Token)> predicate) const {
+bool Stream::is_previous(const size_t start_index, std::function<bool(const Token &)> predicate) const {
   if (start_index == 0) {
     return false;
   }
@@ -303,7 +319,7 @@ bool Stream::is_next(const size_t start_index, Keyword keyword) const {
   return at(start_index + 1).is_given_keyword(keyword);
 }
 
-bool Stream::is_next(const size_t start_index, std::function<bool(const Token)> predicate) const {
+bool Stream::is_next(const size_t start_index, std::function<bool(const Token &)> predicate) const {
   if (start_index + 1 >= size()) {
     return false;
   }
@@ -313,7 +329,7 @@ bool Stream::is_next(const size_t start_index, std::function<bool(const Token)>
 
 Peek<Token> Stream::peek(
   const size_t &start_index,
-  const std::function<bool(const Token)> predicate
+  const std::function<bool(const Token &)> predicate
 ) const {
   Peek<Token> result;
 
@@ -326,11 +342,9 @@ Peek<Token> Stream::peek(
   if (predicate(result.data)) {
     result.end_index = start_index + 1;
   } else {
-    println("Unexpected Token: ");
-    result.data.print();
-    println("Previous Token");
-    at(start_index).print();
-    throw std::runtime_error("DEV: Unexepected Token");
+    throw std::runtime_error(
+      "DEV: Unexpected Token '" + result.data.data + "' after '" + at(start_index).data + "'"
+    );
   }
 
   return result;
@@ -372,54 +386,49 @@ Peek<Token> Lexer::handle_arr_literal(const std::string &line, const size_t star
   return result;
 }
 
-Peek<std::string> Lexer::handle_str_injection(const std::string &line, size_t start_index) {
-  Peek<std::string> result;
-  std::string injection;
+// Returns the index of the last identifier character following the '#'
+size_t Lexer::handle_str_injection(const std::string &line, size_t start_index) {
+  size_t index = start_index + 1;
 
-  for (size_t i = start_index + 1; i < line.size(); i++) {
-    const char character = line[i];
-
-    if (not Token::is_valid_id_char(character)) {
-      result.data = std::move(injection);
-      result.end_index = i - 1;
-      return result;
-    }
+  while (index < line.size() && Token::is_valid_id_char(line[index])) index++;
 
-    injection += character;
-  }
-
-  result.end_index = line.size() - 1;
-  return result;
+  return index - 1;
 }
 
 Result Lexer::handle_str_literal(const std::string &line, size_t start_index) {
   Result result;
-  std::string literal;
+  // Segment offsets are relative to the first character after the opening quote
+  const size_t offset = start_index + 1;
+  size_t text_start = offset;
 
-  for (size_t i = start_index + 1; i < line.size(); i++) {
+  auto push_segment = [&](Segment::Kind kind, size_t start, size_t end) {
+    if (kind == Segment::Kind::TEXT && start == end) return;
+    result.data.segments.push_back({kind, start - offset, end - start});
+  };
+
+  for (size_t i = offset; i < line.size(); i++) {
     const char character = line[i];
 
     if (character == '"') {
+      push_segment(Segment::Kind::TEXT, text_start, i);
       result.data.kind = Token::Kind::LITERAL;
       result.data.literal = Token::Literal::STRING;
-      result.data.data = std::move(literal);
+      result.data.data = line.substr(offset, i - offset);
       result.end_index = i;
       return result;
     }
 
-    literal += character;
-
     if (character == '#') {
       bool is_next_alpha = is_next(line, i, [](char character) {
         return std::isalpha(character);
       });
 
       if (is_next_alpha) {
-        Peek<std::string> injection = handle_str_injection(line, i);
-        result.data.injections.push_back(injection.data);
-        literal += injection.data;
-        i = injection.end_index;
-        continue;
+        size_t end_index = handle_str_injection(line, i);
+        push_segment(Segment::Kind::TEXT, text_start, i);
+        push_segment(Segment::Kind::INJECTION, i + 1, end_index + 1);
+        text_start = end_index + 1;
+        i = end_index;
       }
     }
   }
@@ -460,6 +469,19 @@ Token Lexer::handle_buffer(std::string &buffer) {
 Stream Lexer::lex_ln(std::string line) {
   Stream stream;
   std::string buffer;
+  size_t buffer_start = 0;
+
+  // Tokens remember where they were found, in bytes from the start of the line
+  auto push = [&stream](Token token, size_t start, size_t end) {
+    token.column = start;
+    token.length = end - start;
+    stream.push_back(std::move(token));
+  };
+
+  auto flush = [&](size_t end) {
+    if (buffer.empty()) return;
+    push(handle_buffer(buffer), buffer_start, end);
+  };
 
   line += ' ';
   
@@ -468,9 +490,7 @@ Stream Lexer::lex_ln(std::string line) {
 
     if (Token::is_operator(character)) {
       // <buffer> <operator>
-      if (not buffer.empty()) {
-        stream.push_back(handle_buffer(buffer));
-      }
+      flush(i);
 
       bool is_next_operator = is_next(line, i , [](const char &character) {
         return Token::is_operator(character);
@@ -484,49 +504,44 @@ Stream Lexer::lex_ln(std::string line) {
           throw std::runtime_error("DEV: Invalid Binary Operator (" + binary + ")");
         }
 
-        stream.push_back(handle_buffer(binary));
+        push(handle_buffer(binary), i, i + 2);
         i++;
       } else {
         Token token;
         token.kind = Token::Kind::OPERATOR;
         token.data = std::string(1, character);
-        stream.push_back(token);
+        push(token, i, i + 1);
       }
 
       continue;
     }
 
     if (Utils::is_whitespace(character)) {
-      if (buffer.empty()) continue;
-
-      stream.push_back(handle_buffer(buffer));
-
+      flush(i);
       continue;
     }
 
     if (Token::is_marker(character)) {
-      if (not buffer.empty()) {
-        stream.push_back(handle_buffer(buffer));
-      }
+      flush(i);
 
       Marker marker = Token::get_marker(character);
 
       switch (marker) {
         case Marker::STR_QUOTE: {
           Result result = handle_str_literal(line, i);
-          stream.push_back(result.data);
+          push(result.data, i, result.end_index + 1);
           i = result.end_index;
           break;
         }
         case Marker::LEFT_BRACKET: {
           Peek<Token> result = handle_arr_literal(line, i);
-          stream.push_back(result.data);
+          push(result.data, i, result.end_index + 1);
           i = result.end_index;
           break;
         }
         default: {
           Token token(character);
-          stream.push_back(token);
+          push(token, i, i + 1);
           break;
         }
       }
@@ -534,19 +549,96 @@ Stream Lexer::lex_ln(std::string line) {
       continue;
     }
 
+    if (buffer.empty()) buffer_start = i;
     buffer += character;
   }
 
   return stream;
 }
 
+void Lexer::append_ln(Stream &stream, const std::string &line, size_t number) {
+  Stream line_stream;
+
+  try {
+    line_stream = lex_ln(line);
+  } catch (const std::runtime_error &error) {
+    throw SourceError(error.what(), number);
+  }
+
+  for (Token &token : line_stream) {
+    token.line = number;
+    stream.push_back(std::move(token));
+  }
+}
+
 Stream Lexer::lex_file(const std::string &file_path) {
   Stream stream;
+  size_t number = 0;
   
   Utils::each_line(file_path, [&](const std::string &line) {
-    Stream line_stream = lex_ln(line);
-    stream.insert(stream.end(), line_stream.begin(), line_stream.end());
+    append_ln(stream, line, number++);
   });
 
   return stream;
-}
\ No newline at end of file
+}
+
+Stream Lexer::lex_source(const std::string &source) {
+  Stream stream;
+  std::istringstream input(source);
+  std::string line;
+  size_t number = 0;
+
+  while (std::getline(input, line)) {
+    append_ln(stream, line, number++);
+  }
+
+  return stream;
+}
+
+void Lexer::lex_each(std::istream &input, const std::function<void(Stream &)> &handle) {
+  Stream stream;
+  std::string line;
+  size_t number = 0;
+  // Brackets left open by the statement being read
+  long depth = 0;
+
+  auto flush = [&]() {
+    if (stream.empty()) return;
+
+    handle(stream);
+    stream.clear();
+  };
+
+  while (std::getline(input, line)) {
+    Stream next;
+    append_ln(next, line, number++);
+    if (next.empty()) continue;
+
+    // A statement also goes on past a line ending in an operator, a comma or an
+    // annotation, and into a line that can't start a statement of its own, one
+    // opening with else, an operator or a bracket
+    bool is_continued =
+      depth > 0 ||
+      next.front().is_given_kind(Token::Kind::OPERATOR, Token::Kind::MARKER) ||
+      next.front().is_given_keyword(Keyword::ELSE) ||
+      (not stream.empty() && (
+        stream.back().is_given_kind(Token::Kind::OPERATOR) ||
+        stream.back().is_given_keyword(Keyword::NATIVE) ||
+        stream.back().is_given_marker(Marker::COMMA, Marker::COLON)
+      ));
+
+    if (not is_continued) flush();
+
+    for (Token &token : next) {
+      if (token.is_given_marker(Marker::LEFT_BRACE, Marker::LEFT_PARENTHESIS, Marker::LEFT_BRACKET)) depth++;
+      if (token.is_given_marker(Marker::RIGHT_BRACE, Marker::RIGHT_PARENTHESIS, Marker::RIGHT_BRACKET)) depth--;
+
+      stream.push_back(std::move(token));
+    }
+
+    // Stray closing brackets are left for the parser to report
+    depth = std::max(depth, 0L);
+  }
+
+  flush();
+}
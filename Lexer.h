@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <stdexcept>
 
 enum class Operator {
   ASSIGN,
@@ -70,6 +71,8 @@ enum class Keyword {
   WHEN,
   BLOCK,
   GIVE,
+  IMPORT,
+  NATIVE,
 };
 
 enum class Marker {
@@ -85,6 +88,19 @@ enum class Marker {
   COLON,
 };
 
+// A run of a string literal, either plain text or an injected identifier,
+// kept as offsets into the literal so the lexer copies the text only once
+struct Segment {
+  enum class Kind {
+    TEXT,
+    INJECTION,
+  };
+
+  Kind kind;
+  size_t start;
+  size_t length;
+};
+
 class Token {
   public:
     enum class Kind {
@@ -113,9 +129,13 @@ class Token {
     };
 
     std::string data;
-    Kind kind;
-    Literal literal;
-    std::vector<std::string> injections;
+    Kind kind = Kind::IDENTIFIER;
+    Literal literal = Literal::UNKNOWN;
+    std::vector<Segment> segments;
+    // Zero based position in the source, the column and length are in bytes
+    size_t line = 0;
+    size_t column = 0;
+    size_t length = 0;
 
     Token() = default;
 
@@ -136,6 +156,8 @@ class Token {
 
     bool is_given_operator(const Operator &op) const;
 
+    std::vector<std::string> get_injections() const;
+
     static Marker get_marker(const char character);
 
     static Operator get_operator(const std::string &buffer);
@@ -169,20 +191,28 @@ class Stream : public std::vector<Token> {
   public:
     Stream() = default;
 
-    Token get_next(const size_t &start_index) const;
+    const Token &get_next(const size_t &start_index) const;
 
-    bool is_previous(const size_t start_index, std::function<bool(const Token)> predicate) const;
+    bool is_previous(const size_t start_index, std::function<bool(const Token &)> predicate) const;
 
-    bool is_next(const size_t start_index, std::function<bool(const Token)> predicate) const;
+    bool is_next(const size_t start_index, std::function<bool(const Token &)> predicate) const;
     bool is_next(const size_t start_index, Keyword keyword) const;
 
-    Peek<Token> peek(const size_t &start_index, const std::function<bool(const Token)> predicate) const;
+    Peek<Token> peek(const size_t &start_index, const std::function<bool(const Token &)> predicate) const;
     Peek<Token> peek(const size_t &start_index, Token::Kind kind) const;
     Peek<Token> peek(const size_t &start_index, Marker marker) const;
 
     void print() const;
 };
 
+// An error that knows the zero based source line it was raised on
+class SourceError : public std::runtime_error {
+  public:
+    size_t line;
+
+    SourceError(const std::string &message, size_t line) : std::runtime_error(message), line(line) {}
+};
+
 struct Result {
   Token data;
   size_t end_index;
@@ -193,12 +223,22 @@ class Lexer {
 
   static Peek<Token> handle_arr_literal(const std::string &line, const size_t start_index);
 
-  static Peek<std::string> handle_str_injection(const std::string &line, const size_t start_index);
+  static size_t handle_str_injection(const std::string &line, const size_t start_index);
 
   static Result handle_str_literal(const std::string &line, const size_t start_index);
 
   public:
     static Stream lex_ln(std::string line);
+
+    // Lexes one line onto the end of stream, its tokens marked with the line number
+    static void append_ln(Stream &stream, const std::string &line, size_t number);
     
     static Stream lex_file(const std::string &line);
+
+    // Same as lex_file for a program already held in memory
+    static Stream lex_source(const std::string &source);
+
+    // Lexes a program one top level statement at a time, handing each over once
+    // its brackets close
+    static void lex_each(std::istream &input, const std::function<void(Stream &)> &handle);
 };
@@ -0,0 +1,63 @@
+#include "Library.h"
+#include "Session.cpp"
+
+struct pino_session {
+  Session session;
+};
+
+pino_session *pino_session_create(void) {
+  try {
+    return new pino_session();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void pino_session_destroy(pino_session *session) {
+  delete session;
+}
+
+int pino_compile(pino_session *session, const char *source, size_t length) {
+  // Nothing may unwind past the C boundary
+  try {
+    return session->session.compile(std::string(source, length)) ? 1 : 0;
+  } catch (...) {
+    session->session.diagnostics.entries.push_back({
+      Diagnostic::Stage::EMIT, Diagnostic::Severity::INTERNAL, "Unknown Failure"
+    });
+    return 0;
+  }
+}
+
+const char *pino_output(const pino_session *session) {
+  return session->session.output.c_str();
+}
+
+size_t pino_output_length(const pino_session *session) {
+  return session->session.output.size();
+}
+
+size_t pino_diagnostic_count(const pino_session *session) {
+  return session->session.diagnostics.entries.size();
+}
+
+// Out of range indices give -1 or NULL rather than throwing into the caller
+static const Diagnostic *get_diagnostic(const pino_session *session, size_t index) {
+  const auto &entries = session->session.diagnostics.entries;
+  return index < entries.size() ? &entries[index] : nullptr;
+}
+
+int pino_diagnostic_stage(const pino_session *session, size_t index) {
+  const Diagnostic *diagnostic = get_diagnostic(session, index);
+  return diagnostic ? static_cast<int>(diagnostic->stage) : -1;
+}
+
+int pino_diagnostic_severity(const pino_session *session, size_t index) {
+  const Diagnostic *diagnostic = get_diagnostic(session, index);
+  return diagnostic ? static_cast<int>(diagnostic->severity) : -1;
+}
+
+const char *pino_diagnostic_message(const pino_session *session, size_t index) {
+  const Diagnostic *diagnostic = get_diagnostic(session, index);
+  return diagnostic ? diagnostic->message.c_str() : nullptr;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+
+// C interface of the compiler, built as a shared library with
+//   g++ -std=c++17 -O2 -shared -fPIC Library.cpp -o libpino.so
+// Strings handed out belong to the session and stay valid until its next compile
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct pino_session pino_session;
+
+enum pino_stage {
+  PINO_STAGE_LEX,
+  PINO_STAGE_PARSE,
+  PINO_STAGE_CHECK,
+  PINO_STAGE_EMIT,
+};
+
+enum pino_severity {
+  PINO_SEVERITY_USER,
+  PINO_SEVERITY_INTERNAL,
+  PINO_SEVERITY_NOTE,
+};
+
+pino_session *pino_session_create(void);
+void pino_session_destroy(pino_session *session);
+
+// Compiles length bytes of source, returns 1 on success and 0 if there are errors
+int pino_compile(pino_session *session, const char *source, size_t length);
+
+const char *pino_output(const pino_session *session);
+size_t pino_output_length(const pino_session *session);
+
+size_t pino_diagnostic_count(const pino_session *session);
+int pino_diagnostic_stage(const pino_session *session, size_t index);
+int pino_diagnostic_severity(const pino_session *session, size_t index);
+const char *pino_diagnostic_message(const pino_session *session, size_t index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,972 @@
+#pragma once
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include "Machine.h"
+#include "Bytecode.cpp"
+#include "Parser.cpp"
+#include "Checker.cpp"
+
+// Registers of every call in flight, deep recursion fails instead of growing it
+const size_t MACHINE_STACK_SIZE = 1 << 20;
+// Printed text is written out in pieces of about this size
+const size_t MACHINE_OUTPUT_BUFFER = 64 << 10;
+
+const std::vector<std::string> OP_NAMES = {
+  "LOAD_CONSTANT", "MOVE", "GET_GLOBAL", "SET_GLOBAL", "GET_CAPTURE",
+  "ADD", "SUBTRACT", "MULTIPLY", "DIVIDE", "MODULO",
+  "EQUAL", "NOT_EQUAL", "LESS", "LESS_EQUAL", "MORE", "MORE_EQUAL",
+  "JUMP", "JUMP_IF_FALSE", "JUMP_IF_TRUE", "NEXT",
+  "CALL_DIRECT", "CALL", "BUILT_IN", "CLOSURE", "CONCAT",
+  "NEW_LIST", "PUSH", "INDEX", "LENGTH", "RETURN", "RETURN_NONE",
+};
+
+Value Value::of_boolean(bool boolean) {
+  Value value;
+  value.kind = Kind::BOOLEAN;
+  value.boolean = boolean;
+  return value;
+}
+
+Value Value::of_integer(int64_t integer) {
+  Value value;
+  value.kind = Kind::INTEGER;
+  value.integer = integer;
+  return value;
+}
+
+Value Value::of_float(double real) {
+  Value value;
+  value.kind = Kind::FLOAT;
+  value.real = real;
+  return value;
+}
+
+Value Value::of_text(const Text *text) {
+  Value value;
+  value.kind = Kind::TEXT;
+  value.text = text;
+  return value;
+}
+
+Value Value::of_list(List *list) {
+  Value value;
+  value.kind = Kind::LIST;
+  value.list = list;
+  return value;
+}
+
+Value Value::of_function(uint32_t function) {
+  Value value;
+  value.kind = Kind::FUNCTION;
+  value.function = function;
+  return value;
+}
+
+Value Value::of_closure(const Closure *closure) {
+  Value value;
+  value.kind = Kind::CLOSURE;
+  value.closure = closure;
+  return value;
+}
+
+Arena::~Arena() {
+  for (List *list : lists) list->~List();
+}
+
+void *Arena::allocate(size_t size) {
+  size = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+  // Anything bigger than a block gets one of its own, leaving the current one be
+  if (size > BLOCK_SIZE) {
+    blocks.emplace_back(new char[size]);
+    return blocks.back().get();
+  }
+
+  if (size > left) {
+    blocks.emplace_back(new char[BLOCK_SIZE]);
+    cursor = blocks.back().get();
+    left = BLOCK_SIZE;
+  }
+
+  void *memory = cursor;
+  cursor += size;
+  left -= size;
+  return memory;
+}
+
+const Text *Arena::make_text(const char *data, size_t size) {
+  char *memory = static_cast<char *>(allocate(sizeof(Text) + size));
+  std::memcpy(memory + sizeof(Text), data, size);
+  return new (memory) Text{size, memory + sizeof(Text)};
+}
+
+const Text *Arena::make_text(const std::string &text) {
+  return make_text(text.data(), text.size());
+}
+
+List *Arena::make_list() {
+  List *list = new (allocate(sizeof(List))) List();
+  lists.push_back(list);
+  return list;
+}
+
+const Closure *Arena::make_closure(uint32_t prototype, const Value *captures, size_t count) {
+  Value *copied = static_cast<Value *>(allocate(sizeof(Value) * count));
+  std::copy(captures, captures + count, copied);
+  return new (allocate(sizeof(Closure))) Closure{prototype, copied};
+}
+
+Machine::Machine(std::FILE *sink) : sink(sink) {
+  // Pages are only backed once a call first reaches them, so a deep stack
+  // costs nothing at startup
+  void *memory = mmap(
+    nullptr, MACHINE_STACK_SIZE * sizeof(Value), PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0
+  );
+  if (memory == MAP_FAILED) throw std::runtime_error("DEV: Unable to map the stack");
+
+  stack = static_cast<Value *>(memory);
+}
+
+Machine::~Machine() {
+  munmap(stack, MACHINE_STACK_SIZE * sizeof(Value));
+}
+
+void Machine::flush() {
+  std::fwrite(output.data(), 1, output.size(), sink);
+  std::fflush(sink);
+  output.clear();
+}
+
+bool Machine::is_truthy(const Value &value) {
+  switch (value.kind) {
+    case Value::Kind::NONE:
+      return false;
+    case Value::Kind::BOOLEAN:
+      return value.boolean;
+    case Value::Kind::INTEGER:
+      return value.integer != 0;
+    case Value::Kind::FLOAT:
+      return value.real != 0;
+    case Value::Kind::TEXT:
+      return value.text->size > 0;
+    case Value::Kind::LIST:
+      return not value.list->values.empty();
+    default:
+      return true;
+  }
+}
+
+// Booleans count as the integers they are in Python
+static bool is_number(const Value &value) {
+  return
+    value.kind == Value::Kind::INTEGER ||
+    value.kind == Value::Kind::FLOAT ||
+    value.kind == Value::Kind::BOOLEAN;
+}
+
+static double get_float(const Value &value) {
+  if (value.kind == Value::Kind::FLOAT) return value.real;
+  return value.kind == Value::Kind::BOOLEAN ? value.boolean : static_cast<double>(value.integer);
+}
+
+static int64_t get_integer(const Value &value) {
+  return value.kind == Value::Kind::BOOLEAN ? value.boolean : value.integer;
+}
+
+bool Machine::is_equal(const Value &left, const Value &right) {
+  if (is_number(left) && is_number(right)) {
+    if (left.kind == Value::Kind::FLOAT || right.kind == Value::Kind::FLOAT) {
+      return get_float(left) == get_float(right);
+    }
+
+    return get_integer(left) == get_integer(right);
+  }
+
+  if (left.kind != right.kind) return false;
+
+  switch (left.kind) {
+    case Value::Kind::NONE:
+      return true;
+    case Value::Kind::TEXT:
+      return
+        left.text->size == right.text->size &&
+        std::memcmp(left.text->data, right.text->data, left.text->size) == 0;
+    case Value::Kind::LIST: {
+      const auto &lefts = left.list->values;
+      const auto &rights = right.list->values;
+      if (lefts.size() != rights.size()) return false;
+
+      for (size_t i = 0; i < lefts.size(); i++) {
+        if (not is_equal(lefts[i], rights[i])) return false;
+      }
+
+      return true;
+    }
+    case Value::Kind::FUNCTION:
+      return left.function == right.function;
+    default:
+      return left.closure == right.closure;
+  }
+}
+
+// The shortest digits that read back the same, laid out like Python's repr
+static void write_float(std::string &out, double value) {
+  if (std::isnan(value)) { out += "nan"; return; }
+  if (std::isinf(value)) { out += value < 0 ? "-inf" : "inf"; return; }
+
+  char buffer[32];
+  char *end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+  std::string text(buffer, end);
+  size_t mark = text.find('e');
+  int exponent = std::stoi(text.substr(mark + 1));
+
+  if (exponent < -4 || exponent >= 16) { out += text; return; }
+
+  bool is_negative = text[0] == '-';
+  std::string digits;
+  for (size_t i = is_negative; i < mark; i++) {
+    if (text[i] != '.') digits += text[i];
+  }
+
+  if (is_negative) out += '-';
+
+  if (exponent < 0) {
+    out += "0." + std::string(-exponent - 1, '0') + digits;
+    return;
+  }
+
+  size_t whole = exponent + 1;
+  if (digits.size() < whole) digits.append(whole - digits.size(), '0');
+  out.append(digits, 0, whole);
+  out += '.';
+  out += digits.size() > whole ? digits.substr(whole) : "0";
+}
+
+void Machine::write(std::string &out, const Value &value) {
+  switch (value.kind) {
+    case Value::Kind::NONE:
+      out += "None";
+      break;
+    case Value::Kind::BOOLEAN:
+      out += value.boolean ? "True" : "False";
+      break;
+    case Value::Kind::INTEGER: {
+      char buffer[24];
+      out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value.integer).ptr);
+      break;
+    }
+    case Value::Kind::FLOAT:
+      write_float(out, value.real);
+      break;
+    case Value::Kind::TEXT:
+      out.append(value.text->data, value.text->size);
+      break;
+    case Value::Kind::LIST: {
+      out += '[';
+
+      for (size_t i = 0; i < value.list->values.size(); i++) {
+        if (i > 0) out += ", ";
+        repr(out, value.list->values[i]);
+      }
+
+      out += ']';
+      break;
+    }
+    default:
+      out += "<function>";
+  }
+}
+
+void Machine::repr(std::string &out, const Value &value) {
+  if (value.kind != Value::Kind::TEXT) {
+    write(out, value);
+    return;
+  }
+
+  out += '\'';
+
+  for (size_t i = 0; i < value.text->size; i++) {
+    char character = value.text->data[i];
+    if (character == '\n') { out += "\\n"; continue; }
+    if (character == '\t') { out += "\\t"; continue; }
+    if (character == '\\' || character == '\'') out += '\\';
+    out += character;
+  }
+
+  out += '\'';
+}
+
+Value Machine::add(const Value &left, const Value &right) {
+  if (left.kind == Value::Kind::TEXT && right.kind == Value::Kind::TEXT) {
+    std::string joined(left.text->data, left.text->size);
+    joined.append(right.text->data, right.text->size);
+    return Value::of_text(arena.make_text(joined));
+  }
+
+  if (left.kind == Value::Kind::LIST && right.kind == Value::Kind::LIST) {
+    List *list = arena.make_list();
+    list->values = left.list->values;
+    list->values.insert(list->values.end(), right.list->values.begin(), right.list->values.end());
+    return Value::of_list(list);
+  }
+
+  return arithmetic(Op::ADD, left, right);
+}
+
+Value Machine::arithmetic(Op op, const Value &left, const Value &right) {
+  if (not is_number(left) || not is_number(right)) {
+    throw std::runtime_error("USER: Unsupported Operand Types for " + OP_NAMES[static_cast<size_t>(op)]);
+  }
+
+  bool is_float = left.kind == Value::Kind::FLOAT || right.kind == Value::Kind::FLOAT;
+
+  if (op == Op::DIVIDE) {
+    if (get_float(right) == 0) throw std::runtime_error("USER: Division by Zero");
+    return Value::of_float(get_float(left) / get_float(right));
+  }
+
+  if (is_float) {
+    double a = get_float(left);
+    double b = get_float(right);
+
+    switch (op) {
+      case Op::ADD:
+        return Value::of_float(a + b);
+      case Op::SUBTRACT:
+        return Value::of_float(a - b);
+      case Op::MULTIPLY:
+        return Value::of_float(a * b);
+      default: {
+        if (b == 0) throw std::runtime_error("USER: Float Modulo by Zero");
+        // The result takes the sign of the divisor, as in Python
+        double remainder = std::fmod(a, b);
+        if (remainder != 0 && (remainder < 0) != (b < 0)) remainder += b;
+        return Value::of_float(remainder);
+      }
+    }
+  }
+
+  int64_t a = get_integer(left);
+  int64_t b = get_integer(right);
+  int64_t result;
+  bool is_overflow = false;
+
+  // Integers don't grow past 64 bits here as they do in Python
+  switch (op) {
+    case Op::ADD:
+      is_overflow = __builtin_add_overflow(a, b, &result);
+      break;
+    case Op::SUBTRACT:
+      is_overflow = __builtin_sub_overflow(a, b, &result);
+      break;
+    case Op::MULTIPLY:
+      is_overflow = __builtin_mul_overflow(a, b, &result);
+      break;
+    default: {
+      if (b == 0) throw std::runtime_error("USER: Integer Modulo by Zero");
+      // The smallest integer over -1 traps, and every remainder over it is 0
+      if (b == -1) return Value::of_integer(0);
+
+      int64_t remainder = a % b;
+      if (remainder != 0 && (remainder < 0) != (b < 0)) remainder += b;
+      return Value::of_integer(remainder);
+    }
+  }
+
+  if (is_overflow) throw std::runtime_error("USER: Integer Overflow");
+  return Value::of_integer(result);
+}
+
+Value Machine::compare(Op op, const Value &left, const Value &right) {
+  if (op == Op::EQUAL) return Value::of_boolean(is_equal(left, right));
+  if (op == Op::NOT_EQUAL) return Value::of_boolean(not is_equal(left, right));
+
+  int order = 0;
+
+  if (is_number(left) && is_number(right)) {
+    if (left.kind == Value::Kind::FLOAT || right.kind == Value::Kind::FLOAT) {
+      double a = get_float(left);
+      double b = get_float(right);
+      order = a < b ? -1 : a > b ? 1 : 0;
+    } else {
+      int64_t a = get_integer(left);
+      int64_t b = get_integer(right);
+      order = a < b ? -1 : a > b ? 1 : 0;
+    }
+  } else if (left.kind == Value::Kind::TEXT && right.kind == Value::Kind::TEXT) {
+    std::string_view a(left.text->data, left.text->size);
+    std::string_view b(right.text->data, right.text->size);
+    order = a.compare(b);
+  } else {
+    throw std::runtime_error("USER: Unsupported Operand Types for " + OP_NAMES[static_cast<size_t>(op)]);
+  }
+
+  switch (op) {
+    case Op::LESS:
+      return Value::of_boolean(order < 0);
+    case Op::LESS_EQUAL:
+      return Value::of_boolean(order <= 0);
+    case Op::MORE:
+      return Value::of_boolean(order > 0);
+    default:
+      return Value::of_boolean(order >= 0);
+  }
+}
+
+Value Machine::call_built_in(uint8_t built_in, const Value *arguments, size_t count) {
+  auto expect = [&](size_t expected) {
+    if (count != expected) {
+      throw std::runtime_error("USER: Expected " + std::to_string(expected) + " Arguments");
+    }
+  };
+
+  switch (static_cast<BuiltIn>(built_in)) {
+    case BuiltIn::PRINTLN: {
+      for (size_t i = 0; i < count; i++) {
+        if (i > 0) output += ' ';
+        write(output, arguments[i]);
+      }
+
+      output += '\n';
+      if (output.size() >= MACHINE_OUTPUT_BUFFER) flush();
+      return Value();
+    }
+    case BuiltIn::READLN: {
+      if (count > 0) write(output, arguments[0]);
+      // Prompts have to be out before the program waits on input
+      flush();
+
+      std::string line;
+      std::getline(std::cin, line);
+      return Value::of_text(arena.make_text(line));
+    }
+    case BuiltIn::STR: {
+      expect(1);
+      if (arguments[0].kind == Value::Kind::TEXT) return arguments[0];
+
+      std::string text;
+      write(text, arguments[0]);
+      return Value::of_text(arena.make_text(text));
+    }
+    case BuiltIn::INT: {
+      expect(1);
+      const Value &value = arguments[0];
+
+      if (value.kind == Value::Kind::FLOAT) return Value::of_integer(static_cast<int64_t>(value.real));
+      if (is_number(value)) return Value::of_integer(get_integer(value));
+
+      if (value.kind == Value::Kind::TEXT) {
+        std::string text(value.text->data, value.text->size);
+        size_t begin = text.find_first_not_of(" \t\n");
+        size_t end = text.find_last_not_of(" \t\n");
+        int64_t integer = 0;
+
+        if (begin != std::string::npos) {
+          const char *first = text.data() + begin + (text[begin] == '+');
+          const char *last = text.data() + end + 1;
+          auto [pointer, error] = std::from_chars(first, last, integer);
+          if (error == std::errc() && pointer == last) return Value::of_integer(integer);
+        }
+
+        throw std::runtime_error("USER: Invalid Literal for int(): '" + text + "'");
+      }
+
+      throw std::runtime_error("USER: Cannot Convert to int");
+    }
+    case BuiltIn::FLOAT: {
+      expect(1);
+      const Value &value = arguments[0];
+
+      if (is_number(value)) return Value::of_float(get_float(value));
+
+      if (value.kind == Value::Kind::TEXT) {
+        std::string text(value.text->data, value.text->size);
+
+        try {
+          size_t used = 0;
+          double real = std::stod(text, &used);
+          if (text.find_first_not_of(" \t\n", used) == std::string::npos) return Value::of_float(real);
+        } catch (const std::exception &) {
+        }
+
+        throw std::runtime_error("USER: Invalid Literal for float(): '" + text + "'");
+      }
+
+      throw std::runtime_error("USER: Cannot Convert to float");
+    }
+    case BuiltIn::BOOL: {
+      expect(1);
+      return Value::of_boolean(is_truthy(arguments[0]));
+    }
+    default: {
+      expect(1);
+      if (arguments[0].kind == Value::Kind::TEXT) return Value::of_integer(arguments[0].text->size);
+      if (arguments[0].kind == Value::Kind::LIST) return Value::of_integer(arguments[0].list->values.size());
+
+      throw std::runtime_error("USER: Object Has No len()");
+    }
+  }
+}
+
+std::string Machine::disassemble(const Program &program) {
+  std::string text;
+
+  for (size_t index = 0; index < program.prototypes.size(); index++) {
+    const Prototype &prototype = program.prototypes[index];
+    text +=
+      "fn " + std::to_string(index) + " " + prototype.name +
+      " (" + std::to_string(prototype.parameters) + " parameters, " +
+      std::to_string(prototype.registers) + " registers)\n";
+
+    for (size_t i = 0; i < prototype.code.size(); i++) {
+      const Instruction &instruction = prototype.code[i];
+      char line[96];
+      snprintf(
+        line, sizeof(line), "  %4zu  %-14s %5u %5u %5u   ; line %zu\n",
+        i, OP_NAMES[static_cast<size_t>(instruction.op)].c_str(),
+        instruction.a, instruction.b, instruction.c, prototype.lines[i] + 1
+      );
+      text += line;
+    }
+
+    for (size_t i = 0; i < prototype.constants.size(); i++) {
+      std::string constant;
+      repr(constant, prototype.constants[i]);
+      text += "  k" + std::to_string(i) + " = " + constant + "\n";
+    }
+
+    text += "\n";
+  }
+
+  return text;
+}
+
+void Machine::execute(const Program &program) {
+  this->program = &program;
+  globals.assign(program.globals.size(), Value());
+  frames.clear();
+
+  const Prototype *prototype = &program.prototypes.front();
+  const Instruction *ip = prototype->code.data();
+  const Value *constants = prototype->constants.data();
+  const Closure *closure = nullptr;
+  Value *registers = stack;
+  Value *limit = stack + MACHINE_STACK_SIZE;
+
+  if (prototype->registers > MACHINE_STACK_SIZE) throw SourceError("USER: Stack Overflow", 0);
+
+  // Every handler picks up its own instruction and moves ip past it
+  #if defined(__GNUC__)
+    static void *const LABELS[] = {
+      &&LOAD_CONSTANT, &&MOVE, &&GET_GLOBAL, &&SET_GLOBAL, &&GET_CAPTURE,
+      &&ADD, &&SUBTRACT, &&MULTIPLY, &&DIVIDE, &&MODULO,
+      &&EQUAL, &&NOT_EQUAL, &&LESS, &&LESS_EQUAL, &&MORE, &&MORE_EQUAL,
+      &&JUMP, &&JUMP_IF_FALSE, &&JUMP_IF_TRUE, &&NEXT,
+      &&CALL_DIRECT, &&CALL, &&BUILT_IN, &&CLOSURE, &&CONCAT,
+      &&NEW_LIST, &&PUSH, &&INDEX, &&LENGTH, &&RETURN, &&RETURN_NONE,
+    };
+    #define DISPATCH() goto *LABELS[static_cast<size_t>(ip->op)]
+    #define HANDLE(name) case Op::name: name:
+  #else
+    #define DISPATCH() goto dispatch
+    #define HANDLE(name) case Op::name:
+  #endif
+
+  #define TARGET(instruction) (static_cast<size_t>(instruction.b) | static_cast<size_t>(instruction.c) << 16)
+
+  // Integer operands take the inline path, everything else the general one
+  // An integer result past 64 bits is left to arithmetic, which raises
+  #define ARITHMETIC(name, checked) \
+    HANDLE(name) { \
+      const Instruction instruction = *ip++; \
+      const Value &left = registers[instruction.b]; \
+      const Value &right = registers[instruction.c]; \
+      int64_t result; \
+      bool is_integer = left.kind == Value::Kind::INTEGER && right.kind == Value::Kind::INTEGER; \
+      if (is_integer && not checked(left.integer, right.integer, &result)) { \
+        registers[instruction.a] = Value::of_integer(result); \
+      } else { \
+        registers[instruction.a] = arithmetic(Op::name, left, right); \
+      } \
+      DISPATCH(); \
+    }
+
+  #define COMPARISON(name, symbol) \
+    HANDLE(name) { \
+      const Instruction instruction = *ip++; \
+      const Value &left = registers[instruction.b]; \
+      const Value &right = registers[instruction.c]; \
+      if (left.kind == Value::Kind::INTEGER && right.kind == Value::Kind::INTEGER) { \
+        registers[instruction.a] = Value::of_boolean(left.integer symbol right.integer); \
+      } else { \
+        registers[instruction.a] = compare(Op::name, left, right); \
+      } \
+      DISPATCH(); \
+    }
+
+  auto enter = [&](const Prototype *callee, Value *base, const Closure *captured, uint16_t result) {
+    if (base + callee->registers > limit) throw std::runtime_error("USER: Stack Overflow");
+
+    frames.push_back({prototype, ip, registers, closure, result});
+    prototype = callee;
+    constants = callee->constants.data();
+    closure = captured;
+    registers = base;
+    ip = callee->code.data();
+  };
+
+  auto leave = [&](const Value &result) {
+    Frame frame = frames.back();
+    frames.pop_back();
+
+    prototype = frame.prototype;
+    constants = prototype->constants.data();
+    closure = frame.closure;
+    registers = frame.registers;
+    ip = frame.ip;
+    registers[frame.result] = result;
+  };
+
+  try {
+    DISPATCH();
+
+    #if not defined(__GNUC__)
+      dispatch:
+    #endif
+    switch (ip->op) {
+      HANDLE(LOAD_CONSTANT) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = constants[instruction.b];
+        DISPATCH();
+      }
+      HANDLE(MOVE) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = registers[instruction.b];
+        DISPATCH();
+      }
+      HANDLE(GET_GLOBAL) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = globals[instruction.b];
+        DISPATCH();
+      }
+      HANDLE(SET_GLOBAL) {
+        const Instruction instruction = *ip++;
+        globals[instruction.b] = registers[instruction.a];
+        DISPATCH();
+      }
+      HANDLE(GET_CAPTURE) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = closure->captures[instruction.b];
+        DISPATCH();
+      }
+      HANDLE(ADD) {
+        const Instruction instruction = *ip++;
+        const Value &left = registers[instruction.b];
+        const Value &right = registers[instruction.c];
+
+        int64_t result;
+        bool is_integer = left.kind == Value::Kind::INTEGER && right.kind == Value::Kind::INTEGER;
+
+        if (is_integer && not __builtin_add_overflow(left.integer, right.integer, &result)) {
+          registers[instruction.a] = Value::of_integer(result);
+        } else {
+          registers[instruction.a] = add(left, right);
+        }
+
+        DISPATCH();
+      }
+      ARITHMETIC(SUBTRACT, __builtin_sub_overflow)
+      ARITHMETIC(MULTIPLY, __builtin_mul_overflow)
+      HANDLE(DIVIDE) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = arithmetic(Op::DIVIDE, registers[instruction.b], registers[instruction.c]);
+        DISPATCH();
+      }
+      HANDLE(MODULO) {
+        const Instruction instruction = *ip++;
+        const Value &left = registers[instruction.b];
+        const Value &right = registers[instruction.c];
+
+        if (left.kind == Value::Kind::INTEGER && right.kind == Value::Kind::INTEGER && right.integer > 0) {
+          int64_t remainder = left.integer % right.integer;
+          registers[instruction.a] = Value::of_integer(remainder < 0 ? remainder + right.integer : remainder);
+        } else {
+          registers[instruction.a] = arithmetic(Op::MODULO, left, right);
+        }
+
+        DISPATCH();
+      }
+      HANDLE(EQUAL) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = Value::of_boolean(is_equal(registers[instruction.b], registers[instruction.c]));
+        DISPATCH();
+      }
+      HANDLE(NOT_EQUAL) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = Value::of_boolean(not is_equal(registers[instruction.b], registers[instruction.c]));
+        DISPATCH();
+      }
+      COMPARISON(LESS, <)
+      COMPARISON(LESS_EQUAL, <=)
+      COMPARISON(MORE, >)
+      COMPARISON(MORE_EQUAL, >=)
+      HANDLE(JUMP) {
+        ip = prototype->code.data() + TARGET((*ip));
+        DISPATCH();
+      }
+      HANDLE(JUMP_IF_FALSE) {
+        const Instruction instruction = *ip++;
+        const Value &condition = registers[instruction.a];
+        bool is_true = condition.kind == Value::Kind::BOOLEAN ? condition.boolean : is_truthy(condition);
+        if (not is_true) ip = prototype->code.data() + TARGET(instruction);
+        DISPATCH();
+      }
+      HANDLE(JUMP_IF_TRUE) {
+        const Instruction instruction = *ip++;
+        const Value &condition = registers[instruction.a];
+        bool is_true = condition.kind == Value::Kind::BOOLEAN ? condition.boolean : is_truthy(condition);
+        if (is_true) ip = prototype->code.data() + TARGET(instruction);
+        DISPATCH();
+      }
+      HANDLE(NEXT) {
+        const Instruction instruction = *ip++;
+        int64_t &counter = registers[instruction.a].integer;
+        const Value &subject = registers[instruction.a + 1];
+
+        if (subject.kind == Value::Kind::INTEGER) {
+          if (counter < subject.integer) {
+            registers[instruction.a + 2] = Value::of_integer(counter++);
+          } else {
+            ip = prototype->code.data() + TARGET(instruction);
+          }
+        } else if (subject.kind == Value::Kind::LIST) {
+          if (counter < static_cast<int64_t>(subject.list->values.size())) {
+            registers[instruction.a + 2] = subject.list->values[counter++];
+          } else {
+            ip = prototype->code.data() + TARGET(instruction);
+          }
+        } else if (subject.kind == Value::Kind::TEXT) {
+          if (counter < static_cast<int64_t>(subject.text->size)) {
+            registers[instruction.a + 2] = Value::of_text(arena.make_text(subject.text->data + counter++, 1));
+          } else {
+            ip = prototype->code.data() + TARGET(instruction);
+          }
+        } else {
+          throw std::runtime_error("USER: Object Is Not Iterable");
+        }
+
+        DISPATCH();
+      }
+      HANDLE(CALL_DIRECT) {
+        const Instruction instruction = *ip++;
+        enter(&program.prototypes[instruction.c], registers + instruction.b, nullptr, instruction.a);
+        DISPATCH();
+      }
+      HANDLE(CALL) {
+        const Instruction instruction = *ip++;
+        const Value &callee = registers[instruction.b];
+        const Closure *captured = nullptr;
+        uint32_t index = 0;
+
+        if (callee.kind == Value::Kind::FUNCTION) {
+          index = callee.function;
+        } else if (callee.kind == Value::Kind::CLOSURE) {
+          captured = callee.closure;
+          index = captured->prototype;
+        } else {
+          throw std::runtime_error("USER: Object Is Not Callable");
+        }
+
+        const Prototype &target = program.prototypes[index];
+        Value *arguments = registers + instruction.b + 1;
+
+        if (instruction.c > target.parameters) {
+          throw std::runtime_error(
+            "USER: " + target.name + " Takes " + std::to_string(target.parameters) + " Arguments"
+          );
+        }
+
+        // Parameters left out take their defaults
+        for (size_t i = instruction.c; i < target.parameters; i++) {
+          if (target.defaults[i].kind == Value::Kind::NONE) {
+            throw std::runtime_error("USER: Missing Argument to " + target.name);
+          }
+
+          arguments[i] = target.defaults[i];
+        }
+
+        enter(&target, arguments, captured, instruction.a);
+        DISPATCH();
+      }
+      HANDLE(BUILT_IN) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = call_built_in(instruction.c & 0xff, registers + instruction.b, instruction.c >> 8);
+        DISPATCH();
+      }
+      HANDLE(CLOSURE) {
+        const Instruction instruction = *ip++;
+        const Prototype &lambda = program.prototypes[instruction.b];
+        registers[instruction.a] = Value::of_closure(
+          arena.make_closure(instruction.b, registers + instruction.c, lambda.captures)
+        );
+        DISPATCH();
+      }
+      HANDLE(CONCAT) {
+        const Instruction instruction = *ip++;
+        std::string text;
+
+        for (uint16_t i = 0; i < instruction.c; i++) {
+          write(text, registers[instruction.b + i]);
+        }
+
+        registers[instruction.a] = Value::of_text(arena.make_text(text));
+        DISPATCH();
+      }
+      HANDLE(NEW_LIST) {
+        const Instruction instruction = *ip++;
+        List *list = arena.make_list();
+        const Value &size = registers[instruction.b];
+
+        if (instruction.c && size.kind == Value::Kind::INTEGER && size.integer > 0) {
+          list->values.reserve(size.integer);
+        }
+
+        registers[instruction.a] = Value::of_list(list);
+        DISPATCH();
+      }
+      HANDLE(PUSH) {
+        const Instruction instruction = *ip++;
+        const Value &list = registers[instruction.a];
+        if (list.kind != Value::Kind::LIST) throw std::runtime_error("USER: Object Has No push()");
+
+        list.list->values.push_back(registers[instruction.b]);
+        DISPATCH();
+      }
+      HANDLE(INDEX) {
+        const Instruction instruction = *ip++;
+        const Value &list = registers[instruction.b];
+        const Value &index = registers[instruction.c];
+
+        if (list.kind != Value::Kind::LIST) throw std::runtime_error("USER: Object Has No at()");
+        if (index.kind != Value::Kind::INTEGER) throw std::runtime_error("USER: List Indices Must Be Integers");
+
+        int64_t size = list.list->values.size();
+        int64_t position = index.integer < 0 ? index.integer + size : index.integer;
+        if (position < 0 || position >= size) throw std::runtime_error("USER: List Index Out of Range");
+
+        registers[instruction.a] = list.list->values[position];
+        DISPATCH();
+      }
+      HANDLE(LENGTH) {
+        const Instruction instruction = *ip++;
+        registers[instruction.a] = call_built_in(static_cast<uint8_t>(BuiltIn::LEN), registers + instruction.b, 1);
+        DISPATCH();
+      }
+      HANDLE(RETURN) {
+        const Instruction instruction = *ip++;
+        if (frames.empty()) goto finished;
+
+        leave(registers[instruction.a]);
+        DISPATCH();
+      }
+      HANDLE(RETURN_NONE) {
+        ip++;
+        if (frames.empty()) goto finished;
+
+        leave(Value());
+        DISPATCH();
+      }
+    }
+
+    finished:;
+  } catch (const std::exception &error) {
+    flush();
+
+    // ip has always moved past the instruction that threw
+    size_t index = ip - prototype->code.data();
+    size_t line = prototype->lines[index > 0 ? index - 1 : 0];
+    throw SourceError(error.what(), line);
+  }
+
+  #undef DISPATCH
+  #undef HANDLE
+  #undef TARGET
+  #undef ARITHMETIC
+  #undef COMPARISON
+
+  flush();
+}
+
+int Machine::run(const std::vector<std::string> &arguments) {
+  std::string source_path;
+  bool is_dump = false;
+
+  for (const std::string &argument : arguments) {
+    if (argument == "--dump") {
+      is_dump = true;
+      continue;
+    }
+
+    source_path = argument;
+  }
+
+  if (source_path.empty()) {
+    println("Usage: run [--dump] SOURCE");
+    return 2;
+  }
+
+  Diagnostics diagnostics(false);
+  Program program;
+
+  try {
+    Statement parsed = Parser::parse(source_path);
+
+    Checker checker(&diagnostics);
+    checker.declare_ahead(Interface::from_program(parsed));
+    checker.check(parsed);
+
+    if (not diagnostics.has_errors()) {
+      Bytecode compiler(&diagnostics);
+      program = compiler.compile(parsed);
+    }
+  } catch (const std::exception &error) {
+    diagnostics.report(Diagnostic::Stage::PARSE, error);
+  }
+
+  bool failed = false;
+
+  for (const Diagnostic &diagnostic : diagnostics.entries) {
+    if (diagnostic.severity == Diagnostic::Severity::NOTE) continue;
+
+    std::string location = diagnostic.line ? ":" + std::to_string(*diagnostic.line + 1) : "";
+    println(source_path + location + ": " + diagnostic.message);
+    failed = true;
+  }
+
+  if (failed) return 1;
+
+  if (is_dump) {
+    std::cout << disassemble(program);
+    return 0;
+  }
+
+  Machine machine;
+
+  try {
+    machine.execute(program);
+  } catch (const SourceError &error) {
+    std::string message = error.what();
+    if (message.rfind("USER: ", 0) == 0) message = message.substr(6);
+
+    println(source_path + ":" + std::to_string(error.line + 1) + ": " + message);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Utils.h"
+
+// Strings never change once made, so they are handed around by pointer
+struct Text {
+  size_t size;
+  const char *data;
+};
+
+struct List;
+struct Closure;
+
+// A value in a register, tagged with what it holds. Strings, lists and
+// closures live in the arena, everything else in the value itself
+struct Value {
+  enum class Kind : uint8_t {
+    NONE,
+    BOOLEAN,
+    INTEGER,
+    FLOAT,
+    TEXT,
+    LIST,
+    // A top level or lambda body that captured nothing, by prototype
+    FUNCTION,
+    CLOSURE,
+  };
+
+  Kind kind = Kind::NONE;
+
+  union {
+    bool boolean;
+    int64_t integer;
+    double real;
+    const Text *text;
+    List *list;
+    uint32_t function;
+    const Closure *closure;
+  };
+
+  Value() : integer(0) {}
+
+  static Value of_boolean(bool boolean);
+  static Value of_integer(int64_t integer);
+  static Value of_float(double real);
+  static Value of_text(const Text *text);
+  static Value of_list(List *list);
+  static Value of_function(uint32_t function);
+  static Value of_closure(const Closure *closure);
+};
+
+// Lists are shared by reference, as in the Python output
+struct List {
+  std::vector<Value> values;
+};
+
+// A lambda with the values it captured, copied when it was made
+struct Closure {
+  uint32_t prototype;
+  const Value *captures;
+};
+
+// Hands out memory for everything a program makes and frees it all at once
+// when the program is done, so nothing is counted or collected while it runs
+class Arena {
+  static const size_t BLOCK_SIZE = 64 << 10;
+
+  std::vector<std::unique_ptr<char[]>> blocks;
+  char *cursor = nullptr;
+  size_t left = 0;
+  // The only things allocated here that own memory of their own
+  std::vector<List *> lists;
+
+  void *allocate(size_t size);
+
+  public:
+    Arena() = default;
+    ~Arena();
+
+    Arena(Arena &&) = default;
+    Arena &operator=(Arena &&) = default;
+
+    const Text *make_text(const char *data, size_t size);
+    const Text *make_text(const std::string &text);
+    List *make_list();
+    const Closure *make_closure(uint32_t prototype, const Value *captures, size_t count);
+};
+
+// Operands are registers of the running function unless noted
+enum class Op : uint8_t {
+  // a = constants[b]
+  LOAD_CONSTANT,
+  // a = b
+  MOVE,
+  // a = globals[b], then globals[b] = a
+  GET_GLOBAL,
+  SET_GLOBAL,
+  // a = captures[b] of the running closure
+  GET_CAPTURE,
+  // a = b <op> c
+  ADD,
+  SUBTRACT,
+  MULTIPLY,
+  DIVIDE,
+  MODULO,
+  EQUAL,
+  NOT_EQUAL,
+  LESS,
+  LESS_EQUAL,
+  MORE,
+  MORE_EQUAL,
+  // To the instruction at b | c << 16, when a is falsy or truthy for the conditional ones
+  JUMP,
+  JUMP_IF_FALSE,
+  JUMP_IF_TRUE,
+  // a is a counter, a + 1 an int or list to count through and a + 2 gets the
+  // next element, jumps to b | c << 16 once there are none left
+  NEXT,
+  // a = prototypes[c](b, b + 1, ...) with every parameter given
+  CALL_DIRECT,
+  // a = b(b + 1, ..., b + c)
+  CALL,
+  // a = built in c & 0xff called with c >> 8 arguments from b on
+  BUILT_IN,
+  // a = the lambda prototypes[b] capturing c, c + 1, ...
+  CLOSURE,
+  // a = the c values from b on joined into one string
+  CONCAT,
+  // a = an empty list, with room for b elements when c is set
+  NEW_LIST,
+  // a:push(b)
+  PUSH,
+  // a = b:at(c)
+  INDEX,
+  // a = len(b)
+  LENGTH,
+  RETURN,
+  RETURN_NONE,
+};
+
+// Called through BUILT_IN, one for each of BUILT_IN_FN
+enum class BuiltIn : uint8_t {
+  PRINTLN,
+  READLN,
+  STR,
+  INT,
+  FLOAT,
+  BOOL,
+  LEN,
+};
+
+struct Instruction {
+  Op op;
+  uint16_t a;
+  uint16_t b;
+  uint16_t c;
+};
+
+// A compiled function, the top level being the first of the program
+struct Prototype {
+  std::string name;
+  uint16_t parameters = 0;
+  uint16_t captures = 0;
+  // Parameters, locals and temporaries together
+  uint16_t registers = 0;
+  std::vector<Instruction> code;
+  // Zero based source line of each instruction
+  std::vector<size_t> lines;
+  std::vector<Value> constants;
+  // One per parameter, NONE when it has to be given
+  std::vector<Value> defaults;
+};
+
+struct Program {
+  std::vector<Prototype> prototypes;
+  std::vector<std::string> globals;
+  // Holds the strings among the constants
+  Arena arena;
+};
+
+// Runs bytecode straight from the parsed program, without Python. Dispatch is
+// threaded through a table of labels where the compiler allows it
+class Machine {
+  // A call waiting on the one above it to return
+  struct Frame {
+    const Prototype *prototype;
+    const Instruction *ip;
+    Value *registers;
+    const Closure *closure;
+    uint16_t result;
+  };
+
+  const Program *program = nullptr;
+  // Registers of every call in flight, each call's starting where its arguments are
+  Value *stack;
+  std::vector<Value> globals;
+  std::vector<Frame> frames;
+  Arena arena;
+  std::FILE *sink;
+  // Printed text waiting to be written out
+  std::string output;
+
+  void flush();
+
+  Value add(const Value &left, const Value &right);
+  Value arithmetic(Op op, const Value &left, const Value &right);
+  Value compare(Op op, const Value &left, const Value &right);
+  Value call_built_in(uint8_t built_in, const Value *arguments, size_t count);
+
+  public:
+    explicit Machine(std::FILE *sink = stdout);
+    ~Machine();
+
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
+
+    static bool is_truthy(const Value &value);
+    static bool is_equal(const Value &left, const Value &right);
+
+    // How println shows a value, and how it shows one inside a list
+    static void write(std::string &out, const Value &value);
+    static void repr(std::string &out, const Value &value);
+
+    static std::string disassemble(const Program &program);
+
+    // Runs the top level of the program to its end. Errors are thrown as a
+    // SourceError on the line that raised them
+    void execute(const Program &program);
+
+    // run [--dump] SOURCE
+    static int run(const std::vector<std::string> &arguments);
+};
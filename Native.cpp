@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Native.h"
+#include "CppTranspiler.cpp"
+
+const std::vector<std::string> NATIVE_COMPILER = {"g++", "-std=c++17", "-O2", "-shared", "-fPIC"};
+
+// How each kind of result a native function reports is read back in Python
+const std::string NATIVE_RESULTS =
+  "(None, _pino_ctypes.c_longlong, _pino_ctypes.c_double, _pino_ctypes.c_bool)";
+
+std::string Native::get_cache_directory() {
+  if (const char *cache = std::getenv("PINO_CACHE")) return cache;
+  if (const char *cache = std::getenv("XDG_CACHE_HOME")) return std::string(cache) + "/pino";
+  if (const char *home = std::getenv("HOME")) return std::string(home) + "/.cache/pino";
+
+  return (std::filesystem::temp_directory_path() / "pino").string();
+}
+
+std::string Native::build(const Function *function) {
+  Diagnostics diagnostics(false);
+  CppTranspiler transpiler(&diagnostics);
+  std::string source = transpiler.emit_native(function);
+
+  if (not diagnostics.entries.empty()) {
+    throw SourceError(
+      "USER: Native Function '" + function->name + "' Uses " + diagnostics.entries.front().message,
+      function->line
+    );
+  }
+
+  std::string directory = get_cache_directory();
+  std::string base = directory + "/" + function->name + "-" + Utils::to_hex(Utils::hash(source + Utils::join(NATIVE_COMPILER, " ")));
+  std::string library_path = base + ".so";
+
+  if (std::filesystem::exists(library_path)) return library_path;
+
+  std::filesystem::create_directories(directory);
+
+  // Built beside where it goes and renamed into place, so a library is never seen half written
+  std::string source_path = Utils::get_temporary_path(base) + ".cpp";
+  std::string temporary_path = Utils::get_temporary_path(base) + ".so";
+  std::string log_path = Utils::get_temporary_path(base) + ".log";
+  Utils::write_file(source_path, source);
+
+  // Run without a shell, so a path is never read as anything but a path
+  std::vector<std::string> command = NATIVE_COMPILER;
+  command.insert(command.end(), {source_path, "-o", temporary_path});
+
+  std::vector<char *> arguments;
+  for (std::string &argument : command) arguments.push_back(argument.data());
+  arguments.push_back(nullptr);
+
+  int log = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  pid_t child = log < 0 ? -1 : fork();
+
+  if (child == 0) {
+    dup2(log, STDERR_FILENO);
+    execvp(arguments.front(), arguments.data());
+    _exit(127);
+  }
+
+  if (log >= 0) close(log);
+
+  int status = 0;
+  bool is_built =
+    child > 0 &&
+    waitpid(child, &status, 0) == child &&
+    WIFEXITED(status) &&
+    WEXITSTATUS(status) == 0;
+
+  std::string first;
+  if (not is_built) {
+    std::istringstream log(Utils::read_file(log_path));
+    std::string line;
+
+    while (std::getline(log, line)) {
+      if (line.find("error") == std::string::npos) continue;
+      first = line.substr(line.find("error"));
+      break;
+    }
+  }
+
+  std::filesystem::remove(source_path);
+  std::filesystem::remove(log_path);
+
+  if (not is_built) {
+    std::filesystem::remove(temporary_path);
+    throw SourceError("USER: Native Build Of '" + function->name + "' Failed: " + first, function->line);
+  }
+
+  std::filesystem::rename(temporary_path, library_path);
+  return library_path;
+}
+
+std::string Native::get_imports() {
+  return "import array as _pino_array\nimport ctypes as _pino_ctypes\nimport sys as _pino_sys\n";
+}
+
+std::string Native::emit_stub(const Function *function, const std::string &library_path) {
+  std::string symbol = "_pino_" + function->name;
+  std::string library = symbol + "_library";
+
+  std::string quoted;
+  for (char character : library_path) {
+    if (character == '\\' || character == '"') quoted += '\\';
+    quoted += character;
+  }
+
+  std::vector<std::string> names;
+  std::vector<std::string> types;
+  std::vector<std::string> arguments;
+  std::string packing;
+
+  for (const auto &parameter : function->parameters) {
+    const std::string &name = parameter->name;
+    const Typing &typing = parameter->typing;
+    names.push_back(name);
+
+    if (typing.data == Token::Literal::ARRAY && not typing.children.empty()) {
+      std::string code = typing.children.front().data == Token::Literal::FLOAT ? "d" : "q";
+      packing += "    if not isinstance(" + name + ", _pino_array.array) or " + name + ".typecode != \"" + code + "\":\n";
+      packing += "        " + name + " = _pino_array.array(\"" + code + "\", " + name + ")\n";
+      types.push_back("_pino_ctypes.c_void_p");
+      types.push_back("_pino_ctypes.c_longlong");
+      arguments.push_back(name + ".buffer_info()[0]");
+      arguments.push_back("len(" + name + ")");
+      continue;
+    }
+
+    types.push_back(
+      typing.data == Token::Literal::FLOAT ? "_pino_ctypes.c_double" :
+      typing.data == Token::Literal::BOOLEAN ? "_pino_ctypes.c_bool" :
+      "_pino_ctypes.c_longlong"
+    );
+    arguments.push_back(name);
+  }
+
+  std::string output;
+  output += library + " = _pino_ctypes.CDLL(\"" + quoted + "\")\n";
+  output += symbol + " = " + library + ".pino_" + function->name + "\n";
+  output += symbol + ".argtypes = [" + Utils::join(types, ", ") + "]\n";
+  output += symbol + ".restype = " + NATIVE_RESULTS + "[";
+  output += "_pino_ctypes.c_int.in_dll(" + library + ", \"pino_" + function->name + "_kind\").value]\n\n";
+
+  output += "def " + function->name + "(" + Utils::join(names, ", ") + "):\n";
+  output += packing;
+  output += "    _pino_sys.stdout.flush()\n";
+  output += "    return " + symbol + "(" + Utils::join(arguments, ", ") + ")\n";
+  return output;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include "Utils.h"
+#include "Function.h"
+
+// Builds @native functions into shared libraries with g++ and emits the Python
+// that loads them through ctypes. Libraries are cached by the hash of their
+// source, so a function is only built again once it changed
+class Native {
+  public:
+    // $PINO_CACHE, else pino under $XDG_CACHE_HOME or ~/.cache, else the temporary directory
+    static std::string get_cache_directory();
+
+    // The path of the library holding the function, built unless it already
+    // was. Throws a SourceError on its line when g++ rejects it
+    static std::string build(const Function *function);
+
+    // The modules the stubs load libraries with, imported once per output
+    // ahead of its first stub
+    static std::string get_imports();
+
+    // Loads the library once when the module is imported, and defines the
+    // function under its own name. Arrays go over as the buffer of an
+    // array.array, which lists are packed into first
+    static std::string emit_stub(const Function *function, const std::string &library_path);
+};
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <chrono>
+#include "Optimizer.h"
+#include "Parser.cpp"
+#include "Fold.cpp"
+#include "DeadCode.cpp"
+#include "Inline.cpp"
+#include "TailCall.cpp"
+
+// Passes in the order they run, each from the level given up
+const std::vector<Optimizer::Registration> OPTIMIZER_PASSES = {
+  {"inline", 2, []() { return std::unique_ptr<Pass>(new Inline()); }},
+  {"fold", 1, []() { return std::unique_ptr<Pass>(new Fold()); }},
+  {"dce", 1, []() { return std::unique_ptr<Pass>(new DeadCode()); }},
+  {"tailcall", 1, []() { return std::unique_ptr<Pass>(new TailCall()); }},
+};
+
+const std::vector<std::string> OPTIMIZER_ASSIGNMENTS = { "=", "+=", "-=", "*=", "/=", "%=" };
+
+Optimizer::Optimizer(int level, bool is_verifying, bool is_whole_program) :
+  level(level),
+  is_verifying(is_verifying),
+  is_whole_program(is_whole_program) {
+  for (const Registration &registration : OPTIMIZER_PASSES) {
+    if (registration.level > level) continue;
+
+    passes.push_back(registration.create());
+    statistics.push_back({registration.name});
+  }
+}
+
+bool Optimizer::parse_level(const std::string &flag, int &level) {
+  if (flag.size() != 3 || flag.compare(0, 2, "-O") != 0) return false;
+  if (flag[2] < '0' || flag[2] > '0' + MAX_LEVEL) return false;
+
+  level = flag[2] - '0';
+  return true;
+}
+
+std::vector<Statement *> Optimizer::get_nodes(Statement *node) {
+  std::vector<Statement *> nodes;
+
+  auto add = [&nodes](Statement *child) {
+    if (child) nodes.push_back(child);
+  };
+
+  auto add_all = [&add](auto &children) {
+    for (auto &child : children) add(child.get());
+  };
+
+  if (node->kind == Statement::Kind::EXPRESSION) {
+    auto expression = static_cast<Expression *>(node);
+
+    if (expression->is_binary()) {
+      auto binary = static_cast<BinaryExpression *>(expression);
+      add(binary->left.get());
+      add(binary->right.get());
+    } else if (expression->variant == Expression::Variant::LITERAL) {
+      if (expression->literal == Token::Literal::ARRAY) {
+        auto array = static_cast<Array *>(expression);
+        add(array->len.get());
+        add(array->init.get());
+      } else if (expression->literal == Token::Literal::STRUCT) {
+        add_all(static_cast<Object *>(expression)->properties);
+      } else if (expression->literal == Token::Literal::LAMBDA) {
+        add_all(static_cast<Lambda *>(expression)->parameters);
+      }
+    }
+
+    add_all(expression->arguments);
+    add_all(expression->children);
+    return nodes;
+  }
+
+  switch (node->type) {
+    case Statement::Type::VARIABLE_DECLARATION:
+    case Statement::Type::CONSTANT_DECLARATION:
+      add(static_cast<Variable *>(node)->value.get());
+      break;
+    case Statement::Type::FUNCTION_DECLARATION:
+      add_all(static_cast<Function *>(node)->parameters);
+      break;
+    case Statement::Type::STRUCT_DECLARATION: {
+      auto declaration = static_cast<Struct *>(node);
+      add_all(declaration->fields);
+      add_all(declaration->methods);
+      break;
+    }
+    case Statement::Type::ENUM_DECLARATION:
+      add_all(static_cast<Enum *>(node)->methods);
+      break;
+    case Statement::Type::IF_STATEMENT:
+      add(static_cast<If *>(node)->condition.get());
+      break;
+    case Statement::Type::MATCH_STATEMENT:
+      add(static_cast<Match *>(node)->condition.get());
+      break;
+    case Statement::Type::WHEN_STATEMENT:
+      add_all(static_cast<When *>(node)->conditions);
+      break;
+    case Statement::Type::LOOP_STATEMENT: {
+      auto loop = static_cast<For *>(node);
+      add(loop->index.get());
+      add(loop->limit.get());
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT:
+    case Statement::Type::BREAK_STATEMENT:
+    case Statement::Type::CONTINUE_STATEMENT:
+      add(static_cast<Jump *>(node)->value.get());
+      break;
+    default:
+      break;
+  }
+
+  add_all(node->children);
+  if (node->type == Statement::Type::IF_STATEMENT) add(static_cast<If *>(node)->else_block.get());
+
+  return nodes;
+}
+
+std::vector<const Statement *> Optimizer::get_nodes(const Statement *node) {
+  std::vector<Statement *> nodes = get_nodes(const_cast<Statement *>(node));
+  return std::vector<const Statement *>(nodes.begin(), nodes.end());
+}
+
+void Optimizer::forget(const Statement *node, Typings *typings) {
+  if (not typings) return;
+
+  std::vector<const Statement *> pending = {node};
+
+  while (not pending.empty()) {
+    const Statement *current = pending.back();
+    pending.pop_back();
+
+    typings->erase(current);
+
+    std::vector<const Statement *> nodes = get_nodes(current);
+    pending.insert(pending.end(), nodes.begin(), nodes.end());
+  }
+}
+
+void Optimizer::verify(const Statement &program, const std::string &pass) const {
+  auto fail = [&pass](const Statement *node, const std::string &message) {
+    throw SourceError(
+      "DEV: Pass '" + pass + "' Broke the Tree: " + message,
+      node->line
+    );
+  };
+
+  auto has_null = [](const auto &nodes) {
+    return std::any_of(nodes.begin(), nodes.end(), [](const auto &node) { return not node; });
+  };
+
+  std::vector<const Statement *> pending = {&program};
+
+  while (not pending.empty()) {
+    const Statement *node = pending.back();
+    pending.pop_back();
+
+    if (has_null(node->children)) fail(node, "Missing Child");
+
+    if (node->kind == Statement::Kind::EXPRESSION) {
+      auto expression = static_cast<const Expression *>(node);
+      if (has_null(expression->arguments)) fail(node, "Missing Argument");
+
+      if (expression->is_binary()) {
+        auto binary = static_cast<const BinaryExpression *>(expression);
+        if (not binary->left || not binary->right) fail(node, "Missing Operand of '" + binary->operation + "'");
+        // Chains lean right, which every emitter unrolls them by
+        if (binary->left->is_binary()) fail(node, "Left Leaning '" + binary->operation + "'");
+
+        Expression::Variant variant =
+          Utils::any_of(binary->operation, OPTIMIZER_ASSIGNMENTS) ? Expression::Variant::ASSIGNMENT :
+          binary->operation == ":" ? Expression::Variant::PROPERTY_ACCESS :
+          Expression::Variant::BINARY;
+
+        if (binary->variant != variant) fail(node, "Wrong Variant for '" + binary->operation + "'");
+      } else if (expression->variant == Expression::Variant::IDENTIFIER) {
+        if (expression->value.empty()) fail(node, "Unnamed Identifier");
+      } else if (expression->variant == Expression::Variant::FUNCTION_CALL) {
+        if (expression->value.empty()) fail(node, "Unnamed Call");
+      } else if (expression->variant == Expression::Variant::LITERAL) {
+        if (expression->literal == Token::Literal::ARRAY) {
+          auto array = static_cast<const Array *>(expression);
+          if (array->init && not array->len) fail(node, "Array Element Without Length");
+        } else if (expression->literal == Token::Literal::STRUCT) {
+          if (has_null(static_cast<const Object *>(expression)->properties)) fail(node, "Missing Property");
+        } else if (expression->literal == Token::Literal::LAMBDA) {
+          if (has_null(static_cast<const Lambda *>(expression)->parameters)) fail(node, "Missing Parameter");
+        }
+      }
+    } else {
+      switch (node->type) {
+        case Statement::Type::VARIABLE_DECLARATION:
+        case Statement::Type::CONSTANT_DECLARATION: {
+          auto variable = static_cast<const Variable *>(node);
+          if (variable->name.empty()) fail(node, "Unnamed Variable");
+          if (variable->is_constant && not variable->is_field && not variable->value) fail(node, "Constant Without Value");
+          break;
+        }
+        case Statement::Type::FUNCTION_DECLARATION: {
+          auto function = static_cast<const Function *>(node);
+          if (function->name.empty()) fail(node, "Unnamed Function");
+          if (has_null(function->parameters)) fail(node, "Missing Parameter");
+          break;
+        }
+        case Statement::Type::STRUCT_DECLARATION: {
+          auto declaration = static_cast<const Struct *>(node);
+          if (has_null(declaration->fields) || has_null(declaration->methods)) fail(node, "Missing Member");
+          break;
+        }
+        case Statement::Type::ENUM_DECLARATION: {
+          auto declaration = static_cast<const Enum *>(node);
+          if (has_null(declaration->methods)) fail(node, "Missing Method");
+          if (declaration->value_lines.size() != declaration->values.size()) fail(node, "Enum Values Out of Step");
+          break;
+        }
+        case Statement::Type::IF_STATEMENT: {
+          auto statement = static_cast<const If *>(node);
+          if (not statement->condition) fail(node, "If Without Condition");
+          if (statement->else_block && statement->else_block->is_match_else) fail(node, "Match Else on If");
+          break;
+        }
+        case Statement::Type::ELSE_STATEMENT: {
+          auto statement = static_cast<const Else *>(node);
+
+          bool is_nested_if =
+            statement->children.size() == 1 &&
+            statement->children.front()->type == Statement::Type::IF_STATEMENT;
+
+          if (statement->is_else_if && not is_nested_if) fail(node, "Else If Without Its If");
+          break;
+        }
+        case Statement::Type::MATCH_STATEMENT: {
+          auto match = static_cast<const Match *>(node);
+          if (not match->condition) fail(node, "Match Without Condition");
+          if (match->children.empty()) fail(node, "Empty Match");
+
+          for (size_t i = 0; i < match->children.size(); i++) {
+            const Statement *arm = match->children[i].get();
+            bool is_when = arm->type == Statement::Type::WHEN_STATEMENT;
+
+            bool is_last_else =
+              arm->type == Statement::Type::ELSE_STATEMENT &&
+              static_cast<const Else *>(arm)->is_match_else &&
+              i + 1 == match->children.size();
+
+            if (not is_when && not is_last_else) fail(arm, "Match Arm Is Neither When Nor a Final Else");
+          }
+
+          break;
+        }
+        case Statement::Type::WHEN_STATEMENT: {
+          auto when = static_cast<const When *>(node);
+          if (when->conditions.empty() || has_null(when->conditions)) fail(node, "When Without Conditions");
+          break;
+        }
+        case Statement::Type::LOOP_STATEMENT: {
+          auto loop = static_cast<const For *>(node);
+
+          bool is_shaped =
+            loop->variant == For::Variant::INFINITE ? not loop->index && not loop->limit :
+            loop->variant == For::Variant::TIMES ? loop->index && not loop->limit :
+            loop->index && loop->limit;
+
+          if (not is_shaped) fail(node, "Loop Fields Don't Match Its Variant");
+          break;
+        }
+        case Statement::Type::BREAK_STATEMENT:
+        case Statement::Type::CONTINUE_STATEMENT:
+          if (static_cast<const Jump *>(node)->value) fail(node, "Valued break or continue");
+          break;
+        default:
+          break;
+      }
+    }
+
+    std::vector<const Statement *> nodes = get_nodes(node);
+    pending.insert(pending.end(), nodes.rbegin(), nodes.rend());
+  }
+}
+
+bool Optimizer::is_surveying() const {
+  return is_whole_program && not passes.empty();
+}
+
+void Optimizer::survey(const Statement &program) {
+  for (const auto &pass : passes) pass->survey(program);
+}
+
+void Optimizer::end_survey() {
+  for (const auto &pass : passes) pass->end_survey();
+}
+
+void Optimizer::optimize(Statement &program, Typings *typings) {
+  Pass::Context context = {level, typings};
+
+  for (size_t i = 0; i < passes.size(); i++) {
+    auto start = std::chrono::steady_clock::now();
+    size_t changes = passes[i]->run(program, context);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    statistics[i].runs += 1;
+    statistics[i].changes += changes;
+    statistics[i].seconds += elapsed.count();
+
+    if (is_verifying) verify(program, statistics[i].name);
+  }
+}
+
+int Optimizer::get_level() const {
+  return level;
+}
+
+const std::vector<Optimizer::Statistics> &Optimizer::get_statistics() const {
+  return statistics;
+}
+
+std::string Optimizer::describe_statistics() const {
+  std::string result;
+  char line[128];
+
+  snprintf(line, sizeof(line), "-O%d: %zu passes\n", level, statistics.size());
+  result += line;
+
+  for (const Statistics &pass : statistics) {
+    snprintf(
+      line, sizeof(line), "  %-12s %8zu runs %8zu changes %10.3f ms\n",
+      pass.name.c_str(), pass.runs, pass.changes, pass.seconds * 1000
+    );
+    result += line;
+  }
+
+  return result;
+}
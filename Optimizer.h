@@ -0,0 +1,92 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Statement.h"
+#include "Checker.h"
+
+// One rewrite of the checked tree. A file is handed over a top level statement
+// at a time and in order, so a pass keeps what it learned of the statements
+// before the one it is given
+class Pass {
+  public:
+    // What the pass is run with besides the statement
+    struct Context {
+      int level;
+      // Types the checker settled on, kept in step with the declarations a pass adds or drops
+      Typings *typings;
+    };
+
+    virtual ~Pass() = default;
+
+    // Rewrites the program in place, returning how many changes were made
+    virtual size_t run(Statement &program, Context &context) = 0;
+
+    // With --whole-program every top level statement of the file is shown to
+    // the pass before any is run, the end only being announced when all were
+    virtual void survey(const Statement & /* program */) {}
+    virtual void end_survey() {}
+};
+
+// Runs the passes of an -O level between checking and emitting, in the order
+// of the table they are registered in, timing each and optionally checking
+// that the tree still holds what the emitters rely on after every one of them
+class Optimizer {
+  public:
+    // A pass and the lowest level it runs at
+    struct Registration {
+      std::string name;
+      int level;
+      std::function<std::unique_ptr<Pass>()> create;
+    };
+
+    // What a pass did over every statement it was given
+    struct Statistics {
+      std::string name;
+      size_t runs = 0;
+      size_t changes = 0;
+      double seconds = 0;
+    };
+
+    static const int MAX_LEVEL = 2;
+
+  private:
+    int level;
+    bool is_verifying;
+    bool is_whole_program;
+    std::vector<std::unique_ptr<Pass>> passes;
+    std::vector<Statistics> statistics;
+
+    // Throws a DEV: error naming the pass when the tree breaks an invariant
+    void verify(const Statement &program, const std::string &pass) const;
+
+  public:
+    Optimizer(int level = 0, bool is_verifying = false, bool is_whole_program = false);
+
+    // -O0, -O1 or -O2
+    static bool parse_level(const std::string &flag, int &level);
+
+    // The nodes a node owns directly, in the order they are written, missing
+    // the optional ones it doesn't have
+    static std::vector<Statement *> get_nodes(Statement *node);
+    static std::vector<const Statement *> get_nodes(const Statement *node);
+
+    // Drops the types of a node about to be freed and of everything it owns
+    static void forget(const Statement *node, Typings *typings);
+
+    // Whether the file is to be surveyed whole before its statements are optimized
+    bool is_surveying() const;
+    void survey(const Statement &program);
+    void end_survey();
+
+    void optimize(Statement &program, Typings *typings = nullptr);
+
+    int get_level() const;
+    const std::vector<Statistics> &get_statistics() const;
+
+    // A line per pass with its runs, changes and time, for --pass-stats
+    std::string describe_statistics() const;
+};
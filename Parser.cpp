@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <exception>
+#include <thread>
 #include "Parser.h"
 #include "Lexer.cpp"
 #include "Enum.cpp"
@@ -9,11 +12,39 @@
 #include "Struct.cpp"
 #include "Variable.cpp"
 #include "Conditional.cpp"
+#include "Import.cpp"
+#include "Jump.cpp"
+#include "Ring.cpp"
+
+// Statements the lexer may get ahead of the parser by
+const size_t PIPELINE_CAPACITY = 256;
+
+// Unwinds the lexer once the parser has stopped taking statements
+struct Cancelled {};
 
 PeekVectorPtr<Statement> Parser::build_block(
   Stream &stream, 
   const size_t &start_index,
   bool is_main_program
+) {
+  size_t cursor = start_index;
+
+  try {
+    return build_statements(stream, start_index, is_main_program, cursor);
+  } catch (const SourceError &) {
+    throw;
+  } catch (const std::runtime_error &error) {
+    // Errors are pinned to the line of the statement being built when they surfaced
+    size_t line = stream.empty() ? 0 : stream.at(std::min(cursor, stream.size() - 1)).line;
+    throw SourceError(error.what(), line);
+  }
+}
+
+PeekVectorPtr<Statement> Parser::build_statements(
+  Stream &stream, 
+  const size_t &start_index,
+  bool is_main_program,
+  size_t &cursor
 ) {
   if (not is_main_program) {
     if (not stream.at(start_index).is_given_marker(Marker::LEFT_BRACE)) { 
@@ -23,41 +54,76 @@ PeekVectorPtr<Statement> Parser::build_block(
 
   PeekVectorPtr<Statement> block;
 
-  for (size_t i = start_index + not is_main_program; i < stream.size(); i++) {
-    Token token = stream[i];
+  // Bodies of if, else and for are parsed on an explicit stack of open statements
+  // so deeply nested programs don't grow the native stack
+  std::vector<Statement *> open;
+
+  auto get_target = [&]() -> std::vector<std::unique_ptr<Statement>> & {
+    return open.empty() ? block.data : open.back()->children;
+  };
+
+  size_t i = start_index + not is_main_program;
+
+  auto append = [&](std::unique_ptr<Statement> node) {
+    node->line = stream[i].line;
+    get_target().push_back(std::move(node));
+  };
+
+  for (; i < stream.size(); i++) {
+    const Token &token = stream[i];
+    cursor = i;
 
     if (token.kind == Token::Kind::KEYWORD) {
       Keyword keyword = Token::get_keyword(token.data);
 
       if (keyword == Keyword::ENUM) {
         PeekPtr<Enum> enumeration = Enum::build(stream, i);
-        block.data.push_back(std::move(enumeration.data));
+        append(std::move(enumeration.data));
         i = enumeration.end_index;
       }
 
       if (keyword == Keyword::FOR) {
-        PeekPtr<For> loop = For::build(stream, i);
-        block.data.push_back(std::move(loop.data));
+        PeekPtr<For> loop = For::build_header(stream, i);
+        expect_body(stream, loop.end_index);
+        Statement *owner = loop.data.get();
+        append(std::move(loop.data));
+        open.push_back(owner);
         i = loop.end_index;
+        continue;
       }
 
       if (keyword == Keyword::FUNCTION) {
         if (Function::is_lambda(stream, i - 1)) {
           PeekPtr<Lambda> lambda = Function::build_as_lambda(stream, i - 1);
-          block.data.push_back(std::move(lambda.data));
+          append(std::move(lambda.data));
           i = lambda.end_index;
           continue;
         }
 
         PeekPtr<Function> function = Function::build(stream, i);
-        block.data.push_back(std::move(function.data));
+        append(std::move(function.data));
+        i = function.end_index;
+      }
+
+      if (keyword == Keyword::NATIVE) {
+        if (not stream.is_next(i, Keyword::FUNCTION) || Function::is_lambda(stream, i)) {
+          throw std::runtime_error("USER: Expected a function declaration after '@native'");
+        }
+
+        PeekPtr<Function> function = Function::build(stream, i + 1);
+        function.data->is_native = true;
+        append(std::move(function.data));
         i = function.end_index;
       }
 
       if (keyword == Keyword::IF) {
-        PeekPtr<If> condition = If::build(stream, i);
-        block.data.push_back(std::move(condition.data));
+        PeekPtr<If> condition = If::build_header(stream, i);
+        expect_body(stream, condition.end_index);
+        Statement *owner = condition.data.get();
+        append(std::move(condition.data));
+        open.push_back(owner);
         i = condition.end_index;
+        continue;
       } 
 
       if (keyword == Keyword::ELSE) {
@@ -66,19 +132,31 @@ PeekVectorPtr<Statement> Parser::build_block(
 
       if (keyword == Keyword::MATCH) {
         PeekPtr<Match> match = Match::build(stream, i);
-        block.data.push_back(std::move(match.data));
+        append(std::move(match.data));
         i = match.end_index;
       }
 
       if (keyword == Keyword::STRUCT) {
         PeekPtr<Struct> structure = Struct::build(stream, i);
-        block.data.push_back(std::move(structure.data));
+        append(std::move(structure.data));
         i = structure.end_index;
       }
 
+      if (keyword == Keyword::IMPORT) {
+        PeekPtr<Import> import = Import::build(stream, i);
+        append(std::move(import.data));
+        i = import.end_index;
+      }
+
+      if (keyword == Keyword::RETURN || keyword == Keyword::BREAK || keyword == Keyword::CONTINUE) {
+        PeekPtr<Jump> jump = Jump::build(stream, i);
+        append(std::move(jump.data));
+        i = jump.end_index;
+      }
+
       if (keyword == Keyword::VAR || keyword == Keyword::VAL) {
         PeekPtr<Variable> variable = Variable::build(stream, i);
-        block.data.push_back(std::move(variable.data));
+        append(std::move(variable.data));
         i = variable.end_index;
       }
     }
@@ -86,18 +164,33 @@ PeekVectorPtr<Statement> Parser::build_block(
     if (token.is_given_kind(Token::Kind::IDENTIFIER, Token::Kind::LITERAL)) {
       if (Expression::is_expression(stream, i - 1)) {
         PeekPtr<Expression> expression = Expression::build(stream, i - 1);
-        block.data.push_back(std::move(expression.data));
+        append(std::move(expression.data));
         i = expression.end_index;
       }
     }
 
     if (token.is_given_marker(Marker::RIGHT_BRACE)) {
-      block.end_index = i;
-      return block;
+      if (open.empty()) {
+        block.end_index = i;
+        return block;
+      }
+
+      Statement *closed = open.back();
+      open.pop_back();
+
+      // if { <body> } else if { <body> } else { <body> }
+      if (closed->type == Statement::Type::IF_STATEMENT && stream.is_next(i, Keyword::ELSE)) {
+        PeekPtr<Else> else_block = Else::build_header(stream, i + 1);
+        expect_body(stream, else_block.end_index);
+        Statement *owner = else_block.data->get_body_owner();
+        static_cast<If *>(closed)->else_block = std::move(else_block.data);
+        open.push_back(owner);
+        i = else_block.end_index;
+      }
     }
   }
 
-  if (not is_main_program) {
+  if (not is_main_program || not open.empty()) {
     throw std::runtime_error("USER: Block not closed");
   }
 
@@ -105,13 +198,71 @@ PeekVectorPtr<Statement> Parser::build_block(
   return block;
 }
 
-Statement Parser::parse(const std::string &file_path) {
+void Parser::expect_body(Stream &stream, const size_t &index) {
+  if (index >= stream.size() || not stream.at(index).is_given_marker(Marker::LEFT_BRACE)) { 
+    throw std::runtime_error("DEV: Block not opened");
+  }
+}
+
+Statement Parser::build_program(Stream &stream) {
   Statement program;
-  Stream stream = Lexer::lex_file(file_path);
   PeekVectorPtr<Statement> block = build_block(stream, 0, true);
   
   program.children = std::move(block.data);
   program.kind = Statement::Kind::PROGRAM;
 
   return program;
-}
\ No newline at end of file
+}
+
+Statement Parser::parse(const std::string &file_path) {
+  Stream stream = Lexer::lex_file(file_path);
+  return build_program(stream);
+}
+
+void Parser::parse_each(
+  std::istream &input, 
+  const std::function<void(Statement &)> &handle, 
+  bool is_pipelined
+) {
+  if (not is_pipelined) {
+    Lexer::lex_each(input, [&](Stream &stream) {
+      Statement program = build_program(stream);
+      handle(program);
+    });
+    return;
+  }
+
+  Ring<Stream> ring(PIPELINE_CAPACITY);
+  std::atomic<bool> cancelled(false);
+  std::exception_ptr lexer_error;
+
+  // Lexer errors are raised once everything lexed before them has been handled
+  std::thread lexer([&]() {
+    try {
+      Lexer::lex_each(input, [&](Stream &stream) {
+        if (not ring.push(std::move(stream), cancelled)) throw Cancelled();
+      });
+    } catch (const Cancelled &) {
+    } catch (...) {
+      lexer_error = std::current_exception();
+    }
+
+    ring.close();
+  });
+
+  try {
+    Stream stream;
+
+    while (ring.pop(stream)) {
+      Statement program = build_program(stream);
+      handle(program);
+    }
+  } catch (...) {
+    cancelled = true;
+    lexer.join();
+    throw;
+  }
+
+  lexer.join();
+  if (lexer_error) std::rethrow_exception(lexer_error);
+}
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <functional>
+#include <istream>
 #include <memory>
 #include "Lexer.cpp"
 #include "Statement.cpp"
 
 class Parser {
+  static void expect_body(Stream &stream, const size_t &index);
+
+  static PeekVectorPtr<Statement> build_statements(
+    Stream &stream, 
+    const size_t &start_index, 
+    bool is_main_program,
+    size_t &cursor
+  );
+
   public:
     static PeekVectorPtr<Statement> build_block(
       Stream &stream, 
@@ -12,5 +23,16 @@ class Parser {
       bool is_main_program = false
     );
     
+    static Statement build_program(Stream &stream);
+
     static Statement parse(const std::string &file_path);
+
+    // Reads a program one top level statement at a time and hands each over as a
+    // program of its own, so only a few are held at once. Pipelined, the lexer
+    // runs ahead on a thread of its own and passes statements over a ring
+    static void parse_each(
+      std::istream &input, 
+      const std::function<void(Statement &)> &handle, 
+      bool is_pipelined = false
+    );
 };
\ No newline at end of file
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <atomic>
+#include <sys/stat.h>
+#include <thread>
+#include "Pipeline.h"
+#include "Ring.cpp"
+#include "Parser.cpp"
+#include "Checker.cpp"
+#include "Transpiler.cpp"
+#include "CppTranspiler.cpp"
+#include "Pyc.cpp"
+#include "Optimizer.cpp"
+
+// Statements each stage may get ahead of the next by
+const size_t STAGE_CAPACITY = 64;
+// Checked statements gathered per job before they are emitted in parallel
+const size_t EMIT_BATCH_PER_JOB = 4 * PARALLEL_EMIT_MINIMUM;
+
+// Words a top level declaration starts with
+const std::vector<std::string> SCAN_DECLARATIONS = {"fn", "@native", "struct", "enum"};
+
+Interface Pipeline::scan(std::istream &input) {
+  Interface declared;
+  std::string line;
+  std::string declaration;
+  // Brackets left open, counted as the lexer does but without lexing every line
+  long depth = 0;
+  bool is_declaration = false;
+
+  auto starts_with = [&line](size_t start, const std::string &word) {
+    size_t end = start + word.size();
+    return line.compare(start, word.size(), word) == 0 && (end == line.size() || not Token::is_valid_id_char(line[end]));
+  };
+
+  while (std::getline(input, line)) {
+    size_t start = line.find_first_not_of(" \t");
+
+    if (depth == 0 && start != std::string::npos) {
+      is_declaration = std::any_of(SCAN_DECLARATIONS.begin(), SCAN_DECLARATIONS.end(), [&](const std::string &word) {
+        return starts_with(start, word);
+      });
+    }
+
+    if (is_declaration) declaration += line + "\n";
+
+    bool is_string = false;
+    for (char character : line) {
+      if (character == '"') is_string = not is_string;
+      if (is_string) continue;
+
+      if (character == '{' || character == '(' || character == '[') depth++;
+      if (character == '}' || character == ')' || character == ']') depth--;
+    }
+
+    depth = std::max(depth, 0L);
+    if (depth > 0 || not is_declaration) continue;
+
+    try {
+      Stream stream = Lexer::lex_source(declaration);
+      Interface exported = Interface::from_program(Parser::build_program(stream));
+
+      for (Interface::Export &entry : exported.exports) declared.exports.push_back(std::move(entry));
+    } catch (const std::exception &) {
+    }
+
+    declaration.clear();
+    is_declaration = false;
+  }
+
+  input.clear();
+  input.seekg(0);
+  return declared;
+}
+
+bool Pipeline::compile(
+  const std::string &source_path,
+  const std::string &output_path,
+  Diagnostics &diagnostics,
+  Interfaces *interfaces,
+  Interface *interface,
+  bool is_pipelined,
+  Target target,
+  Pyc::Version python,
+  Optimizer *optimizer,
+  size_t jobs
+) {
+  std::ifstream input(source_path);
+  if (not input) throw std::runtime_error("USER: Unable to read '" + source_path + "'");
+
+  std::string temporary_path = Utils::get_temporary_path(output_path);
+  std::ofstream output(temporary_path, std::ios::binary);
+  if (not output) throw std::runtime_error("USER: Unable to write '" + output_path + "'");
+
+  // Findings of the statement at hand, notes are dropped once it is done so
+  // that they don't pile up over the file
+  Diagnostics checked(false);
+  Diagnostics emitted(false);
+  Checker checker(&checked, nullptr, interfaces);
+  Transpiler transpiler(
+    &emitted,
+    target == Target::CYTHON ? Transpiler::Mode::CYTHON :
+    target == Target::MYPYC ? Transpiler::Mode::ANNOTATED :
+    Transpiler::Mode::PYTHON
+  );
+  CppTranspiler native(&emitted);
+  Pyc bytecode(python, &emitted);
+  bool failed = false;
+
+  // Declarations are only known to be unused once every statement of the file was
+  // seen. Syntax errors are left to be reported when the file is parsed for real
+  if (optimizer && optimizer->is_surveying()) {
+    try {
+      Parser::parse_each(input, [&](Statement &program) { optimizer->survey(program); });
+      optimizer->end_survey();
+    } catch (const std::exception &) {
+    }
+
+    input.clear();
+    input.seekg(0);
+  }
+
+  checker.declare_ahead(scan(input));
+
+  if (target == Target::CPP) output << CppTranspiler::get_header();
+  if (target == Target::CYTHON) output << Transpiler::get_header(Transpiler::Mode::CYTHON);
+  if (target == Target::PYC) bytecode.begin(source_path);
+
+  auto keep = [&](std::vector<Diagnostic> &entries) {
+    for (Diagnostic &diagnostic : entries) {
+      if (diagnostic.severity == Diagnostic::Severity::NOTE) continue;
+
+      failed = true;
+      diagnostics.entries.push_back(std::move(diagnostic));
+    }
+
+    entries.clear();
+  };
+
+  // Only the Python emitters split a program between jobs, and they need enough
+  // statements at once to, so those are gathered into a batch first
+  bool is_batched = jobs > 1 && target != Target::CPP && target != Target::PYC;
+  Statement batch;
+  Typings batch_typings;
+
+  auto flush = [&]() {
+    if (batch.children.empty()) return;
+
+    transpiler.set_typings(&batch_typings);
+    output << transpiler.emit(batch, jobs);
+    batch.children.clear();
+    batch_typings.clear();
+    keep(emitted.entries);
+  };
+
+  auto check = [&](Item &item) {
+    item.stage = Diagnostic::Stage::CHECK;
+    checker.record(&item.typings);
+    checker.check(item.program);
+    checker.record(nullptr);
+    item.failed = checker.has_failed();
+    item.diagnostics = std::move(checked.entries);
+    checked.clear();
+
+    // Passes may rely on the program being well typed
+    if (optimizer && not item.failed) {
+      item.stage = Diagnostic::Stage::OPTIMIZE;
+      optimizer->optimize(item.program, &item.typings);
+    }
+  };
+
+  auto finish = [&](Item &item) {
+    bool has_findings = item.failed || std::any_of(
+      item.diagnostics.begin(), item.diagnostics.end(),
+      [](const Diagnostic &diagnostic) { return diagnostic.severity != Diagnostic::Severity::NOTE; }
+    );
+
+    // What emitting the batch finds comes before the findings of later statements
+    if (has_findings) {
+      item.stage = Diagnostic::Stage::EMIT;
+      flush();
+    }
+
+    keep(item.diagnostics);
+    failed = failed || item.failed;
+
+    // Later statements are still checked, but there is no point emitting them
+    if (failed) return;
+
+    if (interface) {
+      Interface exported = Interface::from_program(item.program);
+      for (Interface::Export &declaration : exported.exports) {
+        interface->exports.push_back(std::move(declaration));
+      }
+    }
+
+    item.stage = Diagnostic::Stage::EMIT;
+
+    if (target == Target::PYC) {
+      // The module is one code object, only written out once it is whole
+      bytecode.add(item.program);
+    } else if (is_batched) {
+      for (auto &child : item.program.children) batch.children.push_back(std::move(child));
+      batch_typings.merge(item.typings);
+      if (batch.children.size() >= jobs * EMIT_BATCH_PER_JOB) flush();
+    } else {
+      transpiler.set_typings(&item.typings);
+      output << (target == Target::CPP ? native.emit(item.program) : transpiler.emit(item.program));
+    }
+
+    keep(emitted.entries);
+  };
+
+  if (not is_pipelined) {
+    Item item;
+
+    try {
+      Parser::parse_each(input, [&](Statement &program) {
+        item = Item();
+        item.program = std::move(program);
+        check(item);
+        finish(item);
+        item = Item();
+      });
+
+      item.stage = Diagnostic::Stage::EMIT;
+      if (not failed) flush();
+    } catch (const std::exception &error) {
+      keep(checked.entries);
+      keep(emitted.entries);
+      diagnostics.report(item.stage, error);
+      failed = true;
+    }
+  } else {
+    Ring<Item> parsed(STAGE_CAPACITY);
+    Ring<Item> verified(STAGE_CAPACITY);
+    std::atomic<bool> cancelled(false);
+
+    // Errors travel down the stages as items of their own, so everything before
+    // them is reported first
+    auto fail = [&](Ring<Item> &ring, Item &item) {
+      item.error = std::current_exception();
+      ring.push(std::move(item), cancelled);
+    };
+
+    std::thread parser([&]() {
+      Item item;
+
+      try {
+        Parser::parse_each(input, [&](Statement &program) {
+          Item parsed_item;
+          parsed_item.program = std::move(program);
+          if (not parsed.push(std::move(parsed_item), cancelled)) throw Cancelled();
+        }, true);
+      } catch (const Cancelled &) {
+      } catch (...) {
+        fail(parsed, item);
+      }
+
+      parsed.close();
+    });
+
+    std::thread verifier([&]() {
+      Item item;
+
+      while (parsed.pop(item)) {
+        if (item.error) {
+          verified.push(std::move(item), cancelled);
+          break;
+        }
+
+        try {
+          check(item);
+        } catch (...) {
+          item.diagnostics = std::move(checked.entries);
+          fail(verified, item);
+          break;
+        }
+
+        if (not verified.push(std::move(item), cancelled)) break;
+      }
+
+      verified.close();
+    });
+
+    Item item;
+
+    try {
+      while (verified.pop(item)) {
+        if (item.error) {
+          keep(item.diagnostics);
+          std::rethrow_exception(item.error);
+        }
+
+        finish(item);
+      }
+
+      item.stage = Diagnostic::Stage::EMIT;
+      if (not failed) flush();
+    } catch (const std::exception &error) {
+      keep(emitted.entries);
+      diagnostics.report(item.stage, error);
+      failed = true;
+    }
+
+    // Stages still running after an error are waiting on a full queue
+    cancelled = true;
+    parser.join();
+    verifier.join();
+  }
+
+  if (target == Target::CPP) output << CppTranspiler::get_footer();
+
+  if (target == Target::PYC && not failed) {
+    struct stat source;
+    stat(source_path.c_str(), &source);
+    output << bytecode.finish(source.st_mtime, source.st_size);
+  }
+
+  output.close();
+
+  if (failed || not output) {
+    std::filesystem::remove(temporary_path);
+    return false;
+  }
+
+  std::filesystem::rename(temporary_path, output_path);
+  return true;
+}
+
+int Pipeline::run(const std::vector<std::string> &arguments) {
+  std::string source_path;
+  std::string output_path;
+  bool is_pipelined = false;
+  Target target = Target::PYTHON;
+  Pyc::Version python = Pyc::Version::PYTHON_3_11;
+  int level = 0;
+  bool is_verifying = false;
+  bool has_statistics = false;
+  bool is_whole_program = false;
+  size_t jobs = 1;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    if (arguments[i] == "--pipelined") {
+      is_pipelined = true;
+      continue;
+    }
+
+    if (Optimizer::parse_level(arguments[i], level)) continue;
+
+    if (arguments[i].rfind("-j", 0) == 0) {
+      std::string count = arguments[i].size() > 2 ? arguments[i].substr(2) : "";
+      if (count.empty() && i + 1 < arguments.size()) count = arguments[++i];
+
+      if (count.empty() || not std::all_of(count.begin(), count.end(), isdigit) || std::stoul(count) == 0) {
+        println("Invalid job count '" + count + "'");
+        return 2;
+      }
+
+      jobs = std::stoul(count);
+      continue;
+    }
+
+    if (arguments[i] == "--verify-passes") {
+      is_verifying = true;
+      continue;
+    }
+
+    if (arguments[i] == "--whole-program") {
+      is_whole_program = true;
+      continue;
+    }
+
+    if (arguments[i] == "--pass-stats") {
+      has_statistics = true;
+      continue;
+    }
+
+    if (arguments[i] == "--cpp") {
+      target = Target::CPP;
+      continue;
+    }
+
+    if (arguments[i] == "--cython") {
+      target = Target::CYTHON;
+      continue;
+    }
+
+    if (arguments[i] == "--mypyc") {
+      target = Target::MYPYC;
+      continue;
+    }
+
+    if (arguments[i] == "--pyc") {
+      target = Target::PYC;
+      continue;
+    }
+
+    if (arguments[i] == "--python" && i + 1 < arguments.size()) {
+      if (not Pyc::parse_version(arguments[++i], python)) {
+        println("Unsupported Python version '" + arguments[i] + "', expected 3.11 or 3.12");
+        return 2;
+      }
+
+      continue;
+    }
+
+    if (arguments[i] == "-o" && i + 1 < arguments.size()) {
+      output_path = arguments[++i];
+      continue;
+    }
+
+    source_path = arguments[i];
+  }
+
+  if (source_path.empty()) {
+    println(
+      "Usage: compile [--pipelined] [-j JOBS] [-O0 | -O1 | -O2] [--whole-program] [--verify-passes] [--pass-stats] "
+      "[--cpp | --cython | --mypyc | --pyc [--python VERSION]] SOURCE [-o OUTPUT]"
+    );
+    return 2;
+  }
+
+  if (output_path.empty()) {
+    std::string extension =
+      target == Target::CPP ? ".cpp" :
+      target == Target::CYTHON ? ".pyx" :
+      target == Target::PYC ? ".pyc" :
+      ".py";
+    output_path = std::filesystem::path(source_path).replace_extension(extension).string();
+  }
+
+  Diagnostics diagnostics(false);
+  Optimizer optimizer(level, is_verifying, is_whole_program);
+  bool compiled = false;
+
+  try {
+    compiled = compile(
+      source_path, output_path, diagnostics, nullptr, nullptr, is_pipelined, target, python, &optimizer, jobs
+    );
+  } catch (const std::exception &error) {
+    println(error.what());
+    return 2;
+  }
+
+  for (const Diagnostic &diagnostic : diagnostics.entries) {
+    if (diagnostic.severity == Diagnostic::Severity::NOTE) continue;
+
+    std::string location = diagnostic.line ? ":" + std::to_string(*diagnostic.line + 1) : "";
+    println(source_path + location + ": " + diagnostic.message);
+  }
+
+  if (has_statistics) printsln(optimizer.describe_statistics());
+
+  return compiled ? 0 : 1;
+}
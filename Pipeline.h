@@ -0,0 +1,74 @@
+#pragma once
+
+#include <exception>
+#include <string>
+#include <vector>
+#include "Diagnostic.h"
+#include "Statement.h"
+#include "Checker.h"
+#include "Pyc.h"
+#include "Optimizer.h"
+
+class Interface;
+class Interfaces;
+
+// Compiles a file one top level statement at a time: each is parsed, checked
+// against the declarations before it and the signatures of those below, emitted and written out, then freed, so
+// memory follows the largest statement rather than the size of the file
+class Pipeline {
+  // A statement on its way through the stages, or the error that ended them
+  struct Item {
+    Statement program;
+    // What checking found, handed on so it is reported in source order
+    std::vector<Diagnostic> diagnostics;
+    bool failed = false;
+    std::exception_ptr error;
+    Diagnostic::Stage stage = Diagnostic::Stage::PARSE;
+    // Types of its declarations, for the typed targets
+    Typings typings;
+  };
+
+  // Signatures of the top level functions, structs and enums of a file, read
+  // before it is compiled so bodies can call what is declared below them. Only
+  // the statements declaring them are lexed and parsed, and errors are left to
+  // the compile
+  static Interface scan(std::istream &input);
+
+  public:
+    // What the file is compiled to
+    enum class Target {
+      PYTHON,
+      // A C++17 program with its runtime, for g++ to build
+      CPP,
+      // Cython typed from what the checker found, for cythonize
+      CYTHON,
+      // Python annotated from what the checker found, for mypyc
+      MYPYC,
+      // A CPython code object for the version given, marshalled as a .pyc
+      PYC,
+    };
+
+    // The output is only put in place once the whole file compiled. Exports of
+    // the file are added to the interface when one is given. Pipelined, every
+    // stage runs on a thread of its own, so that statement N is emitted while
+    // N + 1 is checked and N + 2 parsed, with bounded queues between them.
+    // Checked statements go through the optimizer's passes when one is given.
+    // With more than one job, the Python emitters get them in batches they split
+    // between that many threads
+    static bool compile(
+      const std::string &source_path,
+      const std::string &output_path,
+      Diagnostics &diagnostics,
+      Interfaces *interfaces = nullptr,
+      Interface *interface = nullptr,
+      bool is_pipelined = false,
+      Target target = Target::PYTHON,
+      Pyc::Version python = Pyc::Version::PYTHON_3_11,
+      Optimizer *optimizer = nullptr,
+      size_t jobs = 1
+    );
+
+    // compile [--pipelined] [-j JOBS] [-O0 | -O1 | -O2] [--verify-passes] [--pass-stats]
+    //   [--cpp | --cython | --mypyc | --pyc [--python VERSION]] SOURCE [-o OUTPUT]
+    static int run(const std::vector<std::string> &arguments);
+};
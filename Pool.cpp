@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Pool.h"
+
+Pool::Pool(size_t workers, size_t jobs) {
+  // Neighbouring jobs start on the same worker
+  for (size_t worker = 0; worker < workers; worker++) {
+    queues.push_back(std::make_unique<Queue>());
+
+    for (size_t job = worker * jobs / workers; job < (worker + 1) * jobs / workers; job++) {
+      queues.back()->jobs.push_back(job);
+    }
+  }
+}
+
+bool Pool::take(size_t worker, size_t &job) {
+  Queue &queue = *queues[worker];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.jobs.empty()) return false;
+
+  job = queue.jobs.back();
+  queue.jobs.pop_back();
+  return true;
+}
+
+bool Pool::steal(size_t worker, size_t &job) {
+  for (size_t offset = 1; offset < queues.size(); offset++) {
+    Queue &victim = *queues[(worker + offset) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.jobs.empty()) continue;
+
+    job = victim.jobs.front();
+    victim.jobs.pop_front();
+    return true;
+  }
+
+  return false;
+}
+
+bool Pool::next(size_t worker, size_t &job) {
+  // No job is ever added once the pool is running, so empty queues stay empty
+  return take(worker, job) || steal(worker, job);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Every worker owns a deque of jobs, takes from its back and steals from the
+// front of the others once it runs dry
+class Pool {
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues;
+
+  bool take(size_t worker, size_t &job);
+  bool steal(size_t worker, size_t &job);
+
+  public:
+    Pool(size_t workers, size_t jobs);
+
+    // False once every queue is empty
+    bool next(size_t worker, size_t &job);
+};
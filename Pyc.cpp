@@ -0,0 +1,1372 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include "Pyc.h"
+#include "Parser.cpp"
+#include "Checker.cpp"
+
+// Opcode numbers and inline cache entries of each version, as its dis module
+// gives them. Ops a version doesn't have are missing from its table
+const std::map<Pyc::Version, Pyc::Dialect> PYC_DIALECTS = {
+  {Pyc::Version::PYTHON_3_11, {"3.11", std::string("\xa7\x0d\x0d\x0a", 4), {
+    {Pyc::Op::POP_TOP, {1, 0}}, {Pyc::Op::PUSH_NULL, {2, 0}},
+    {Pyc::Op::COPY, {120, 0}}, {Pyc::Op::SWAP, {99, 0}},
+    {Pyc::Op::LOAD_CONST, {100, 0}}, {Pyc::Op::LOAD_NAME, {101, 0}}, {Pyc::Op::STORE_NAME, {90, 0}},
+    {Pyc::Op::LOAD_GLOBAL, {116, 5}}, {Pyc::Op::LOAD_FAST, {124, 0}}, {Pyc::Op::STORE_FAST, {125, 0}},
+    {Pyc::Op::LOAD_DEREF, {137, 0}}, {Pyc::Op::STORE_DEREF, {138, 0}}, {Pyc::Op::LOAD_CLOSURE, {136, 0}},
+    {Pyc::Op::MAKE_CELL, {135, 0}}, {Pyc::Op::COPY_FREE_VARS, {149, 0}},
+    {Pyc::Op::LOAD_ATTR, {106, 4}}, {Pyc::Op::STORE_ATTR, {95, 4}}, {Pyc::Op::LOAD_METHOD, {160, 10}},
+    {Pyc::Op::BINARY_OP, {122, 1}}, {Pyc::Op::COMPARE_OP, {107, 2}}, {Pyc::Op::IS_OP, {117, 0}},
+    {Pyc::Op::BUILD_LIST, {103, 0}}, {Pyc::Op::BUILD_TUPLE, {102, 0}}, {Pyc::Op::BUILD_STRING, {157, 0}},
+    {Pyc::Op::FORMAT_VALUE, {155, 0}}, {Pyc::Op::LIST_APPEND, {145, 0}},
+    {Pyc::Op::GET_ITER, {68, 0}}, {Pyc::Op::FOR_ITER, {93, 0}},
+    {Pyc::Op::JUMP_FORWARD, {110, 0}}, {Pyc::Op::JUMP_BACKWARD, {140, 0}},
+    {Pyc::Op::POP_JUMP_IF_FALSE, {114, 0}}, {Pyc::Op::POP_JUMP_IF_TRUE, {115, 0}},
+    {Pyc::Op::PRECALL, {166, 1}}, {Pyc::Op::CALL, {171, 4}}, {Pyc::Op::MAKE_FUNCTION, {132, 0}},
+    {Pyc::Op::RETURN_VALUE, {83, 0}}, {Pyc::Op::RESUME, {151, 0}}, {Pyc::Op::EXTENDED_ARG, {144, 0}},
+    {Pyc::Op::IMPORT_NAME, {108, 0}}, {Pyc::Op::IMPORT_STAR, {84, 0}},
+  }, true, false, false, false, false}},
+  // Locals are read with LOAD_FAST_CHECK, as LOAD_FAST no longer checks they were set
+  {Pyc::Version::PYTHON_3_12, {"3.12", std::string("\xcb\x0d\x0d\x0a", 4), {
+    {Pyc::Op::POP_TOP, {1, 0}}, {Pyc::Op::PUSH_NULL, {2, 0}},
+    {Pyc::Op::COPY, {120, 0}}, {Pyc::Op::SWAP, {99, 0}},
+    {Pyc::Op::LOAD_CONST, {100, 0}}, {Pyc::Op::LOAD_NAME, {101, 0}}, {Pyc::Op::STORE_NAME, {90, 0}},
+    {Pyc::Op::LOAD_GLOBAL, {116, 4}}, {Pyc::Op::LOAD_FAST, {127, 0}}, {Pyc::Op::STORE_FAST, {125, 0}},
+    {Pyc::Op::LOAD_DEREF, {137, 0}}, {Pyc::Op::STORE_DEREF, {138, 0}}, {Pyc::Op::LOAD_CLOSURE, {136, 0}},
+    {Pyc::Op::MAKE_CELL, {135, 0}}, {Pyc::Op::COPY_FREE_VARS, {149, 0}},
+    {Pyc::Op::LOAD_ATTR, {106, 9}}, {Pyc::Op::STORE_ATTR, {95, 4}},
+    {Pyc::Op::BINARY_OP, {122, 1}}, {Pyc::Op::COMPARE_OP, {107, 1}}, {Pyc::Op::IS_OP, {117, 0}},
+    {Pyc::Op::BUILD_LIST, {103, 0}}, {Pyc::Op::BUILD_TUPLE, {102, 0}}, {Pyc::Op::BUILD_STRING, {157, 0}},
+    {Pyc::Op::FORMAT_VALUE, {155, 0}}, {Pyc::Op::LIST_APPEND, {145, 0}},
+    {Pyc::Op::GET_ITER, {68, 0}}, {Pyc::Op::FOR_ITER, {93, 1}}, {Pyc::Op::END_FOR, {4, 0}},
+    {Pyc::Op::JUMP_FORWARD, {110, 0}}, {Pyc::Op::JUMP_BACKWARD, {140, 0}},
+    {Pyc::Op::POP_JUMP_IF_FALSE, {114, 0}}, {Pyc::Op::POP_JUMP_IF_TRUE, {115, 0}},
+    {Pyc::Op::CALL, {171, 3}}, {Pyc::Op::MAKE_FUNCTION, {132, 0}},
+    {Pyc::Op::RETURN_VALUE, {83, 0}}, {Pyc::Op::RESUME, {151, 0}}, {Pyc::Op::EXTENDED_ARG, {144, 0}},
+    {Pyc::Op::IMPORT_NAME, {108, 0}}, {Pyc::Op::CALL_INTRINSIC_1, {173, 0}},
+  }, false, true, true, true, true}},
+};
+
+// The instruction behind each operator, its argument and Python's precedence
+// for it. Assignments are 0 and take everything to their right, and / or
+// become jumps over their right hand side
+const std::map<std::string, std::tuple<Pyc::Op, uint32_t, int>> PYC_OPERATORS = {
+  {"=", {Pyc::Op::STORE_NAME, 0, 0}}, {"+=", {Pyc::Op::BINARY_OP, 13, 0}},
+  {"-=", {Pyc::Op::BINARY_OP, 23, 0}}, {"*=", {Pyc::Op::BINARY_OP, 18, 0}},
+  {"/=", {Pyc::Op::BINARY_OP, 24, 0}}, {"%=", {Pyc::Op::BINARY_OP, 19, 0}},
+  {"or", {Pyc::Op::POP_JUMP_IF_TRUE, 0, 1}},
+  {"and", {Pyc::Op::POP_JUMP_IF_FALSE, 0, 2}},
+  {"<", {Pyc::Op::COMPARE_OP, 0, 3}}, {"<=", {Pyc::Op::COMPARE_OP, 1, 3}},
+  {"==", {Pyc::Op::COMPARE_OP, 2, 3}}, {"!=", {Pyc::Op::COMPARE_OP, 3, 3}},
+  {">", {Pyc::Op::COMPARE_OP, 4, 3}}, {">=", {Pyc::Op::COMPARE_OP, 5, 3}},
+  {"+", {Pyc::Op::BINARY_OP, 0, 4}}, {"-", {Pyc::Op::BINARY_OP, 10, 4}},
+  {"*", {Pyc::Op::BINARY_OP, 5, 5}}, {"/", {Pyc::Op::BINARY_OP, 11, 5}}, {"%", {Pyc::Op::BINARY_OP, 6, 5}},
+};
+
+// Past 3.11 comparisons also say which outcomes are true, for a quicker branch
+const uint32_t PYC_COMPARISON_MASKS[] = {2, 10, 8, 7, 4, 12};
+
+// Kinds of the locals in a code object
+const uint8_t PYC_LOCAL = 0x20;
+const uint8_t PYC_CELL = 0x40;
+const uint8_t PYC_FREE = 0x80;
+
+// Flags of the code objects of functions and of functions inside them
+const uint32_t PYC_OPTIMIZED = 0x01;
+const uint32_t PYC_NEW_LOCALS = 0x02;
+const uint32_t PYC_NESTED = 0x10;
+
+// Code units a line table entry covers at most, and the codes of its kinds of entry
+const size_t PYC_LINE_SPAN = 8;
+const uint8_t PYC_LINE_ONLY = 13;
+const uint8_t PYC_NO_LOCATION = 15;
+
+static void put_int(std::string &out, uint32_t value) {
+  for (size_t i = 0; i < 4; i++) out += static_cast<char>(value >> (8 * i) & 0xff);
+}
+
+static void put_varint(std::string &out, uint32_t value) {
+  while (value >= 64) {
+    out += static_cast<char>(0x40 | (value & 63));
+    value >>= 6;
+  }
+
+  out += static_cast<char>(value);
+}
+
+static std::string marshal_string(const std::string &text, char type = 'u') {
+  std::string out(1, type);
+  put_int(out, text.size());
+  return out + text;
+}
+
+static std::string marshal_tuple(const std::vector<std::string> &items) {
+  std::string out = "(";
+  put_int(out, items.size());
+  for (const std::string &item : items) out += item;
+  return out;
+}
+
+static std::string marshal_names(const std::vector<std::string> &names) {
+  std::vector<std::string> items;
+  for (const std::string &name : names) items.push_back(marshal_string(name, 't'));
+  return marshal_tuple(items);
+}
+
+// Literals are as large as they are written, as in Python, so those past 32
+// bits are split into the 15 bit digits marshal keeps longs in
+static std::string marshal_integer(const std::string &decimal) {
+  int64_t small = 0;
+  const char *end = decimal.data() + decimal.size();
+  auto [pointer, error] = std::from_chars(decimal.data(), end, small);
+
+  if (error == std::errc() && pointer == end && small >= INT32_MIN && small <= INT32_MAX) {
+    std::string out = "i";
+    put_int(out, static_cast<uint32_t>(small));
+    return out;
+  }
+
+  std::vector<uint8_t> digits;
+  for (char character : decimal) {
+    if (isdigit(character)) digits.push_back(character - '0');
+  }
+
+  std::vector<uint16_t> parts;
+
+  while (not digits.empty()) {
+    std::vector<uint8_t> quotient;
+    uint32_t remainder = 0;
+
+    for (uint8_t digit : digits) {
+      remainder = remainder * 10 + digit;
+      if (not quotient.empty() || remainder >= 32768) quotient.push_back(remainder / 32768);
+      remainder %= 32768;
+    }
+
+    parts.push_back(remainder);
+    digits = std::move(quotient);
+  }
+
+  // The sign goes on the count of digits, folded constants can be negative
+  bool is_negative = not decimal.empty() && decimal.front() == '-';
+  std::string out = "l";
+  put_int(out, is_negative ? -static_cast<uint32_t>(parts.size()) : static_cast<uint32_t>(parts.size()));
+
+  for (uint16_t part : parts) {
+    out += static_cast<char>(part & 0xff);
+    out += static_cast<char>(part >> 8);
+  }
+
+  return out;
+}
+
+static std::string marshal_float(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  std::string out = "g";
+  for (size_t i = 0; i < 8; i++) out += static_cast<char>(bits >> (8 * i) & 0xff);
+  return out;
+}
+
+// Lays a chain out as its operands and the operators between them
+static void flatten(
+  const Expression *expression,
+  std::vector<const Expression *> &nodes,
+  std::vector<std::string> &operations
+) {
+  const Expression *node = expression;
+
+  while (node->is_binary()) {
+    auto binary = static_cast<const BinaryExpression *>(node);
+    nodes.push_back(binary->left.get());
+    operations.push_back(binary->operation);
+    node = binary->right.get();
+  }
+
+  nodes.push_back(node);
+}
+
+static bool is_assignment(const std::string &operation) {
+  auto found = PYC_OPERATORS.find(operation);
+  return found != PYC_OPERATORS.end() && std::get<2>(found->second) == 0;
+}
+
+Pyc::Pyc(Version version, Diagnostics *diagnostics) : dialect(&PYC_DIALECTS.at(version)) {
+  this->diagnostics = diagnostics ? diagnostics : &echoed;
+}
+
+bool Pyc::parse_version(const std::string &name, Version &version) {
+  for (const auto &[candidate, dialect] : PYC_DIALECTS) {
+    if (dialect.name != name) continue;
+
+    version = candidate;
+    return true;
+  }
+
+  return false;
+}
+
+void Pyc::report(const std::string &message, Diagnostic::Severity severity) {
+  std::optional<size_t> at;
+  if (line != NO_LINE) at = line;
+
+  diagnostics->report(Diagnostic::Stage::EMIT, message, severity, at);
+}
+
+bool Pyc::is_local(const Scope &scope, const std::string &name) const {
+  return
+    Utils::included(scope.parameters, name) ||
+    Utils::included(scope.assigned, name);
+}
+
+void Pyc::add_scopes(const Statement *statement) {
+  struct Item {
+    const Statement *node;
+    size_t scope;
+    // Read as an attribute or method of what is before it in a chain
+    bool is_member;
+  };
+
+  // The module binds its names by name at run time, so only functions keep track
+  auto use = [this](size_t scope, const std::string &name) {
+    if (scopes[scope].is_function) scopes[scope].used.insert(name);
+  };
+
+  auto assign = [this](size_t scope, const std::string &name) {
+    Scope &target = scopes[scope];
+    if (target.is_function && not is_local(target, name)) target.assigned.push_back(name);
+  };
+
+  auto open = [this](const Statement *owner, size_t parent) {
+    scopes.emplace_back();
+    scopes.back().is_function = true;
+    scopes.back().parent = parent;
+    scope_of[owner] = scopes.size() - 1;
+    return scopes.size() - 1;
+  };
+
+  std::vector<Item> pending = {{statement, 0, false}};
+
+  while (not pending.empty()) {
+    Item item = pending.back();
+    pending.pop_back();
+
+    const Statement *node = item.node;
+    size_t scope = item.scope;
+
+    auto push_children = [&](const Statement *parent, size_t inner) {
+      for (auto child = parent->children.rbegin(); child != parent->children.rend(); child++) {
+        pending.push_back({child->get(), inner, false});
+      }
+    };
+
+    if (node->kind == Statement::Kind::EXPRESSION) {
+      auto expression = static_cast<const Expression *>(node);
+
+      switch (expression->variant) {
+        case Expression::Variant::ASSIGNMENT:
+        case Expression::Variant::PROPERTY_ACCESS:
+        case Expression::Variant::BINARY: {
+          std::vector<const Expression *> nodes;
+          std::vector<std::string> operations;
+          flatten(expression, nodes, operations);
+
+          bool is_target = is_assignment(operations.front()) && nodes.front()->variant == Expression::Variant::IDENTIFIER;
+          if (is_target) assign(scope, nodes.front()->value);
+
+          for (size_t i = nodes.size(); i-- > 0;) {
+            pending.push_back({nodes[i], scope, i > 0 && operations[i - 1] == ":"});
+          }
+
+          break;
+        }
+        case Expression::Variant::IDENTIFIER: {
+          if (not item.is_member) use(scope, expression->value);
+          break;
+        }
+        case Expression::Variant::FUNCTION_CALL: {
+          if (not item.is_member) {
+            use(scope, is_built_in_fn(expression->value) ? get_built_in_fn(expression->value) : expression->value);
+          }
+
+          for (auto argument = expression->arguments.rbegin(); argument != expression->arguments.rend(); argument++) {
+            pending.push_back({argument->get(), scope, false});
+          }
+
+          break;
+        }
+        case Expression::Variant::LITERAL: {
+          if (expression->literal == Token::Literal::STRING) {
+            for (const std::string &injection : static_cast<const String *>(expression)->get_injections()) {
+              use(scope, injection);
+            }
+          } else if (expression->literal == Token::Literal::ARRAY) {
+            auto array = static_cast<const Array *>(expression);
+            if (not array->len) break;
+
+            // The length is read where the array is, the element in a comprehension of its own
+            size_t inner = open(array, scope);
+            scopes[inner].parameters.push_back(".0");
+            scopes[inner].assigned.push_back(array->init ? "it" : "_");
+
+            if (array->init) pending.push_back({array->init.get(), inner, false});
+            pending.push_back({array->len.get(), scope, false});
+          }
+
+          break;
+        }
+        default:
+          break;
+      }
+
+      continue;
+    }
+
+    switch (node->type) {
+      case Statement::Type::VARIABLE_DECLARATION:
+      case Statement::Type::CONSTANT_DECLARATION: {
+        auto variable = static_cast<const Variable *>(node);
+        assign(scope, variable->name);
+        if (variable->value) pending.push_back({variable->value.get(), scope, false});
+        break;
+      }
+      case Statement::Type::FUNCTION_DECLARATION: {
+        auto function = static_cast<const Function *>(node);
+        assign(scope, function->name);
+
+        size_t inner = open(function, scope);
+        for (const auto &parameter : function->parameters) scopes[inner].parameters.push_back(parameter->name);
+
+        push_children(function, inner);
+        break;
+      }
+      case Statement::Type::IF_STATEMENT: {
+        auto if_statement = static_cast<const If *>(node);
+        if (if_statement->else_block) pending.push_back({if_statement->else_block.get(), scope, false});
+        push_children(if_statement, scope);
+        pending.push_back({if_statement->condition.get(), scope, false});
+        break;
+      }
+      case Statement::Type::MATCH_STATEMENT: {
+        auto match = static_cast<const Match *>(node);
+        push_children(match, scope);
+        pending.push_back({match->condition.get(), scope, false});
+        break;
+      }
+      case Statement::Type::WHEN_STATEMENT: {
+        // A bare name in a case captures the subject
+        for (const auto &condition : static_cast<const When *>(node)->conditions) {
+          if (condition->variant == Expression::Variant::IDENTIFIER) assign(scope, condition->value);
+        }
+
+        push_children(node, scope);
+        break;
+      }
+      case Statement::Type::LOOP_STATEMENT: {
+        auto loop = static_cast<const For *>(node);
+        push_children(loop, scope);
+
+        if (loop->variant == For::Variant::TIMES) {
+          assign(scope, "_");
+          pending.push_back({loop->index.get(), scope, false});
+        } else if (loop->variant == For::Variant::FOR_IN) {
+          assign(scope, loop->index->value);
+          pending.push_back({loop->limit.get(), scope, false});
+        }
+
+        break;
+      }
+      case Statement::Type::RETURN_STATEMENT: {
+        auto jump = static_cast<const Jump *>(node);
+        if (jump->value) pending.push_back({jump->value.get(), scope, false});
+        break;
+      }
+      default:
+        push_children(node, scope);
+    }
+  }
+}
+
+void Pyc::resolve_scopes(size_t first) {
+  for (size_t index = first; index < scopes.size(); index++) {
+    for (const std::string &name : scopes[index].used) {
+      if (is_local(scopes[index], name)) continue;
+
+      // The innermost enclosing function that binds the name shares it as a cell
+      size_t owner = scopes[index].parent;
+      while (owner != 0 && not is_local(scopes[owner], name)) owner = scopes[owner].parent;
+      if (owner == 0) continue;
+
+      scopes[owner].cells.insert(name);
+
+      for (size_t between = index; between != owner; between = scopes[between].parent) {
+        if (not Utils::included(scopes[between].frees, name)) scopes[between].frees.push_back(name);
+      }
+    }
+  }
+}
+
+Pyc::Unit &Pyc::unit() {
+  return units.back();
+}
+
+const Pyc::Scope &Pyc::scope() {
+  return scopes[units.back().scope];
+}
+
+void Pyc::emit(Op op, uint32_t arg) {
+  Unit &current = unit();
+  current.code.push_back({op, arg, NO_LABEL, line});
+
+  int effect = 0;
+
+  switch (op) {
+    case Op::PUSH_NULL: case Op::COPY: case Op::LOAD_CONST: case Op::LOAD_NAME:
+    case Op::LOAD_FAST: case Op::LOAD_DEREF: case Op::LOAD_CLOSURE: case Op::LOAD_METHOD:
+    case Op::FOR_ITER:
+      effect = 1;
+      break;
+    case Op::LOAD_GLOBAL:
+      effect = 1 + (arg & 1);
+      break;
+    case Op::POP_TOP: case Op::STORE_NAME: case Op::STORE_FAST: case Op::STORE_DEREF:
+    case Op::BINARY_OP: case Op::COMPARE_OP: case Op::IS_OP: case Op::LIST_APPEND:
+    case Op::POP_JUMP_IF_FALSE: case Op::POP_JUMP_IF_TRUE: case Op::RETURN_VALUE:
+    case Op::IMPORT_NAME: case Op::IMPORT_STAR:
+      effect = -1;
+      break;
+    case Op::STORE_ATTR: case Op::END_FOR:
+      effect = -2;
+      break;
+    case Op::BUILD_LIST: case Op::BUILD_TUPLE: case Op::BUILD_STRING:
+      effect = 1 - static_cast<int>(arg);
+      break;
+    case Op::CALL:
+      effect = -1 - static_cast<int>(arg);
+      break;
+    case Op::MAKE_FUNCTION:
+      effect = -__builtin_popcount(arg);
+      break;
+    default:
+      break;
+  }
+
+  current.depth += effect;
+  current.max_depth = std::max(current.max_depth, current.depth);
+}
+
+void Pyc::emit_jump(Op op, size_t label) {
+  emit(op);
+  unit().code.back().label = label;
+}
+
+size_t Pyc::add_label() {
+  unit().labels.push_back(NO_LABEL);
+  return unit().labels.size() - 1;
+}
+
+void Pyc::place(size_t label) {
+  unit().labels[label] = unit().code.size();
+}
+
+void Pyc::set_depth(int depth) {
+  unit().depth = depth;
+}
+
+uint32_t Pyc::add_constant(const std::string &constant) {
+  Unit &current = unit();
+  auto found = current.constant_indices.find(constant);
+  if (found != current.constant_indices.end()) return found->second;
+
+  current.constants.push_back(constant);
+  return current.constant_indices[constant] = current.constants.size() - 1;
+}
+
+uint32_t Pyc::add_name(const std::string &name) {
+  Unit &current = unit();
+  auto found = current.name_indices.find(name);
+  if (found != current.name_indices.end()) return found->second;
+
+  current.names.push_back(name);
+  return current.name_indices[name] = current.names.size() - 1;
+}
+
+uint32_t Pyc::get_local(const std::string &name) {
+  auto found = unit().local_indices.find(name);
+  if (found == unit().local_indices.end()) throw std::runtime_error("DEV: Unbound Local '" + name + "'");
+
+  return found->second;
+}
+
+void Pyc::add_local(const std::string &name, uint8_t kind) {
+  Unit &current = unit();
+  current.local_indices[name] = current.locals.size();
+  current.locals.push_back(name);
+  current.kinds.push_back(kind);
+}
+
+void Pyc::load_name(const std::string &name) {
+  const Scope &current = scope();
+
+  if (not current.is_function) {
+    emit(Op::LOAD_NAME, add_name(name));
+  } else if (current.cells.count(name) || Utils::included(current.frees, name)) {
+    emit(Op::LOAD_DEREF, get_local(name));
+  } else if (is_local(current, name)) {
+    emit(Op::LOAD_FAST, get_local(name));
+  } else {
+    emit(Op::LOAD_GLOBAL, add_name(name) << 1);
+  }
+}
+
+void Pyc::store_name(const std::string &name) {
+  const Scope &current = scope();
+
+  if (not current.is_function) {
+    emit(Op::STORE_NAME, add_name(name));
+  } else if (current.cells.count(name)) {
+    emit(Op::STORE_DEREF, get_local(name));
+  } else {
+    emit(Op::STORE_FAST, get_local(name));
+  }
+}
+
+void Pyc::load_callable(const std::string &name) {
+  const Scope &current = scope();
+
+  // Globals are loaded with the NULL a call wants below them
+  bool is_global =
+    current.is_function &&
+    not is_local(current, name) &&
+    not Utils::included(current.frees, name);
+
+  if (is_global) {
+    emit(Op::LOAD_GLOBAL, add_name(name) << 1 | 1);
+    return;
+  }
+
+  emit(Op::PUSH_NULL);
+  load_name(name);
+}
+
+void Pyc::emit_call(size_t count) {
+  if (dialect->has_precall) emit(Op::PRECALL, count);
+  emit(Op::CALL, count);
+}
+
+std::string Pyc::assemble() {
+  const Unit &current = unit();
+  const Scope &owner = scope();
+  size_t count = current.code.size();
+
+  // The argument each instruction is written with, once the labels are known
+  std::vector<uint32_t> args(count);
+  std::vector<uint8_t> extensions(count, 0);
+  std::vector<size_t> offsets(count + 1, 0);
+
+  auto get_caches = [this](Op op) -> size_t {
+    Op written = op == Op::LOAD_METHOD && dialect->shifts_attributes ? Op::LOAD_ATTR : op;
+    auto found = dialect->opcodes.find(written);
+    if (found == dialect->opcodes.end()) throw std::runtime_error("DEV: No Opcode For Python " + dialect->name);
+
+    return found->second.second;
+  };
+
+  // Arguments past a byte take EXTENDED_ARG prefixes, which move every jump
+  // after them, so offsets are laid out again until no jump needs more
+  for (bool changed = true; changed;) {
+    changed = false;
+
+    for (size_t i = 0; i < count; i++) {
+      offsets[i + 1] = offsets[i] + 1 + extensions[i] + get_caches(current.code[i].op);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      const Instruction &instruction = current.code[i];
+      uint32_t arg = instruction.arg;
+
+      if (instruction.label != NO_LABEL) {
+        size_t target = offsets[current.labels[instruction.label]];
+        size_t after = offsets[i + 1];
+
+        if (instruction.op == Op::JUMP_BACKWARD ? target > after : target < after) {
+          throw std::runtime_error("DEV: Jump In The Wrong Direction");
+        }
+
+        arg = instruction.op == Op::JUMP_BACKWARD ? after - target : target - after;
+      } else if (instruction.op == Op::LOAD_ATTR && dialect->shifts_attributes) {
+        arg <<= 1;
+      } else if (instruction.op == Op::LOAD_METHOD && dialect->shifts_attributes) {
+        arg = arg << 1 | 1;
+      } else if (instruction.op == Op::COMPARE_OP && dialect->masks_comparisons) {
+        arg = arg << 4 | PYC_COMPARISON_MASKS[arg];
+      }
+
+      args[i] = arg;
+      uint8_t needed = arg > 0xffffff ? 3 : arg > 0xffff ? 2 : arg > 0xff ? 1 : 0;
+
+      if (needed > extensions[i]) {
+        extensions[i] = needed;
+        changed = true;
+      }
+    }
+  }
+
+  std::string code;
+  std::string lines;
+  size_t previous = current.first_line + 1;
+
+  auto add_lines = [&](size_t at, size_t length) {
+    while (length > 0) {
+      size_t span = std::min(length, PYC_LINE_SPAN);
+      length -= span;
+
+      if (at == NO_LINE) {
+        lines += static_cast<char>(0x80 | PYC_NO_LOCATION << 3 | (span - 1));
+        continue;
+      }
+
+      lines += static_cast<char>(0x80 | PYC_LINE_ONLY << 3 | (span - 1));
+
+      // Lines move by a signed amount, its sign in the lowest bit
+      int64_t delta = static_cast<int64_t>(at + 1) - static_cast<int64_t>(previous);
+      put_varint(lines, delta < 0 ? (-delta) << 1 | 1 : delta << 1);
+      previous = at + 1;
+    }
+  };
+
+  size_t run_line = count ? current.code.front().line : NO_LINE;
+  size_t run_length = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const Instruction &instruction = current.code[i];
+    Op op = instruction.op == Op::LOAD_METHOD && dialect->shifts_attributes ? Op::LOAD_ATTR : instruction.op;
+    uint8_t number = dialect->opcodes.at(op).first;
+
+    for (size_t shift = extensions[i]; shift > 0; shift--) {
+      code += static_cast<char>(dialect->opcodes.at(Op::EXTENDED_ARG).first);
+      code += static_cast<char>(args[i] >> (8 * shift) & 0xff);
+    }
+
+    code += static_cast<char>(number);
+    code += static_cast<char>(args[i] & 0xff);
+    code.append(2 * get_caches(op), '\0');
+
+    if (instruction.line != run_line) {
+      add_lines(run_line, run_length);
+      run_line = instruction.line;
+      run_length = 0;
+    }
+
+    run_length += offsets[i + 1] - offsets[i];
+  }
+
+  add_lines(run_line, run_length);
+
+  uint32_t flags = 0;
+  if (owner.is_function) flags = PYC_OPTIMIZED | PYC_NEW_LOCALS;
+  if (owner.is_function && units.size() > 2) flags |= PYC_NESTED;
+
+  std::string marshalled = "c";
+  put_int(marshalled, owner.parameters.size());
+  put_int(marshalled, 0);
+  put_int(marshalled, 0);
+  put_int(marshalled, current.max_depth);
+  put_int(marshalled, flags);
+  marshalled += marshal_string(code, 's');
+  marshalled += marshal_tuple(current.constants);
+  marshalled += marshal_names(current.names);
+  marshalled += marshal_names(current.locals);
+  marshalled += marshal_string(std::string(current.kinds.begin(), current.kinds.end()), 's');
+  marshalled += marshal_string(file_name);
+  marshalled += marshal_string(current.name, 't');
+  marshalled += marshal_string(current.qualified_name, 't');
+  put_int(marshalled, current.first_line + 1);
+  marshalled += marshal_string(lines, 's');
+  marshalled += marshal_string("", 's');
+
+  return marshalled;
+}
+
+void Pyc::handle_arr_literal(const Array *literal) {
+  if (not literal->len) {
+    emit(Op::BUILD_LIST, 0);
+    return;
+  }
+
+  // [<init> for it in range(<len>)], as a function called on the range
+  open_unit(literal, "<listcomp>");
+  size_t start = add_label();
+  size_t exit = add_label();
+
+  emit(Op::BUILD_LIST, 0);
+  emit(Op::LOAD_FAST, get_local(".0"));
+  place(start);
+  emit_jump(Op::FOR_ITER, exit);
+  store_name(literal->init ? "it" : "_");
+
+  if (literal->init) {
+    handle_expression(literal->init.get());
+  } else {
+    emit(Op::LOAD_CONST, add_constant("N"));
+  }
+
+  emit(Op::LIST_APPEND, 2);
+  emit_jump(Op::JUMP_BACKWARD, start);
+  place(exit);
+  if (dialect->has_end_for) emit(Op::END_FOR);
+
+  set_depth(1);
+  emit(Op::RETURN_VALUE);
+  close_unit();
+
+  load_callable("range");
+  handle_expression(literal->len.get());
+  emit_call(1);
+  emit(Op::GET_ITER);
+  emit_call(0);
+}
+
+void Pyc::handle_str_literal(const String *literal) {
+  bool has_injections = std::any_of(literal->segments.begin(), literal->segments.end(), [](const Segment &segment) {
+    return segment.kind == Segment::Kind::INJECTION;
+  });
+
+  if (not has_injections) {
+    emit(Op::LOAD_CONST, add_constant(marshal_string(Utils::unescape(literal->value))));
+    return;
+  }
+
+  // Formatted and joined as the f-string of the Python output would be
+  uint32_t count = 0;
+
+  for (const Segment &segment : literal->segments) {
+    std::string text = literal->value.substr(segment.start, segment.length);
+
+    if (segment.kind == Segment::Kind::INJECTION) {
+      load_name(text);
+      emit(Op::FORMAT_VALUE, 0);
+      count++;
+    } else if (not text.empty()) {
+      emit(Op::LOAD_CONST, add_constant(marshal_string(Utils::unescape(text))));
+      count++;
+    }
+  }
+
+  if (count != 1) emit(Op::BUILD_STRING, count);
+}
+
+void Pyc::handle_literal(const Expression *literal) {
+  switch (literal->literal) {
+    case Token::Literal::ARRAY:
+      handle_arr_literal(static_cast<const Array *>(literal));
+      break;
+    case Token::Literal::STRING:
+      handle_str_literal(static_cast<const String *>(literal));
+      break;
+    case Token::Literal::BOOLEAN:
+      emit(Op::LOAD_CONST, add_constant(literal->value == "true" ? "T" : "F"));
+      break;
+    case Token::Literal::INTEGER:
+      emit(Op::LOAD_CONST, add_constant(marshal_integer(literal->value)));
+      break;
+    case Token::Literal::FLOAT:
+      emit(Op::LOAD_CONST, add_constant(marshal_float(std::stod(literal->value))));
+      break;
+    default:
+      report("Expression Unsupported");
+  }
+}
+
+void Pyc::handle_call(const Expression *call) {
+  load_callable(is_built_in_fn(call->value) ? get_built_in_fn(call->value) : call->value);
+  for (const auto &argument : call->arguments) handle_expression(argument.get());
+  emit_call(call->arguments.size());
+}
+
+void Pyc::handle_member(const Expression *member) {
+  const std::string &name = is_built_in_fn(member->value) ? get_built_in_fn(member->value) : member->value;
+
+  if (member->variant == Expression::Variant::IDENTIFIER) {
+    emit(Op::LOAD_ATTR, add_name(member->value));
+    return;
+  }
+
+  if (member->variant != Expression::Variant::FUNCTION_CALL) {
+    report("Expression Unsupported");
+    return;
+  }
+
+  emit(Op::LOAD_METHOD, add_name(name));
+  for (const auto &argument : member->arguments) handle_expression(argument.get());
+  emit_call(member->arguments.size());
+}
+
+void Pyc::handle_terms(
+  const std::vector<const Expression *> &nodes,
+  const std::vector<std::string> &operations,
+  size_t begin,
+  size_t end
+) {
+  // Regrouped by precedence as Python reads the flat chain. Operands are
+  // pushed in order, so each operator folds the top two into one
+  struct Waiting {
+    Op op;
+    uint32_t arg;
+    int precedence;
+    // Where and / or land when they skip their right hand side
+    size_t label;
+  };
+
+  std::vector<Waiting> pending;
+  size_t i = begin;
+
+  // Property access binds tightest, so members are folded into their owners first
+  auto push_term = [&]() {
+    handle_expression(nodes[i]);
+
+    while (i + 1 < end && operations[i] == ":") {
+      handle_member(nodes[++i]);
+    }
+  };
+
+  auto reduce = [&]() {
+    Waiting waiting = pending.back();
+    pending.pop_back();
+
+    if (waiting.label != NO_LABEL) {
+      place(waiting.label);
+    } else {
+      emit(waiting.op, waiting.arg);
+    }
+  };
+
+  push_term();
+
+  while (i + 1 < end) {
+    auto found = PYC_OPERATORS.find(operations[i]);
+
+    if (found == PYC_OPERATORS.end() || std::get<2>(found->second) == 0) {
+      report("Expression Unsupported");
+      return;
+    }
+
+    auto [op, arg, precedence] = found->second;
+
+    while (not pending.empty() && pending.back().precedence >= precedence) {
+      // Python would compare the middle operand with both sides
+      if (op == Op::COMPARE_OP && pending.back().op == Op::COMPARE_OP) {
+        report("Chained Comparison Unsupported");
+      }
+
+      reduce();
+    }
+
+    size_t label = NO_LABEL;
+
+    if (op == Op::POP_JUMP_IF_FALSE || op == Op::POP_JUMP_IF_TRUE) {
+      label = add_label();
+      emit(Op::COPY, 1);
+      emit_jump(op, label);
+      emit(Op::POP_TOP);
+    }
+
+    pending.push_back({op, arg, precedence, label});
+    i++;
+    push_term();
+  }
+
+  while (not pending.empty()) reduce();
+}
+
+void Pyc::handle_assignment(const Expression *expression) {
+  std::vector<const Expression *> nodes;
+  std::vector<std::string> operations;
+  flatten(expression, nodes, operations);
+
+  // Everything before the operator is the target, a name or an attribute
+  size_t at = 0;
+  while (not is_assignment(operations[at])) at++;
+
+  for (size_t i = 0; i < at; i++) {
+    if (operations[i] != ":") {
+      report("Expression Unsupported");
+      return;
+    }
+  }
+
+  const Expression *target = nodes[at];
+  const std::string &operation = operations[at];
+  auto [op, arg, precedence] = PYC_OPERATORS.at(operation);
+  bool is_plain = operation == "=";
+
+  if (target->variant != Expression::Variant::IDENTIFIER) {
+    report("Expression Unsupported");
+    return;
+  }
+
+  if (at == 0) {
+    if (not is_plain) load_name(target->value);
+    handle_terms(nodes, operations, at + 1, nodes.size());
+    if (not is_plain) emit(op, arg);
+    store_name(target->value);
+    return;
+  }
+
+  uint32_t attribute = add_name(target->value);
+
+  if (is_plain) {
+    handle_terms(nodes, operations, at + 1, nodes.size());
+    handle_terms(nodes, operations, 0, at);
+    emit(Op::STORE_ATTR, attribute);
+    return;
+  }
+
+  handle_terms(nodes, operations, 0, at);
+  emit(Op::COPY, 1);
+  emit(Op::LOAD_ATTR, attribute);
+  handle_terms(nodes, operations, at + 1, nodes.size());
+  emit(op, arg);
+  emit(Op::SWAP, 2);
+  emit(Op::STORE_ATTR, attribute);
+}
+
+void Pyc::handle_expression(const Expression *expression) {
+  switch (expression->variant) {
+    case Expression::Variant::ASSIGNMENT:
+    case Expression::Variant::PROPERTY_ACCESS:
+    case Expression::Variant::BINARY: {
+      std::vector<const Expression *> nodes;
+      std::vector<std::string> operations;
+      flatten(expression, nodes, operations);
+      handle_terms(nodes, operations, 0, nodes.size());
+      break;
+    }
+    case Expression::Variant::IDENTIFIER:
+      load_name(expression->value);
+      break;
+    case Expression::Variant::LITERAL:
+      handle_literal(expression);
+      break;
+    case Expression::Variant::FUNCTION_CALL:
+      handle_call(expression);
+      break;
+    default:
+      report("Expression Unsupported");
+  }
+}
+
+void Pyc::open_unit(const Statement *owner, const std::string &name) {
+  std::string qualified_name = name;
+  if (scope().is_function) qualified_name = unit().qualified_name + ".<locals>." + name;
+
+  units.emplace_back();
+  Unit &opened = unit();
+  opened.scope = scope_of.at(owner);
+  opened.name = name;
+  opened.qualified_name = qualified_name;
+  opened.first_line = owner->line;
+  opened.outer_line = line;
+
+  const Scope &inner = scope();
+
+  // Parameters come first, then plain locals, the cells among them and what
+  // the enclosing functions share, as Python lays them out
+  for (const std::string &parameter : inner.parameters) {
+    add_local(parameter, PYC_LOCAL | (inner.cells.count(parameter) ? PYC_CELL : 0));
+  }
+
+  for (const std::string &local : inner.assigned) {
+    if (not inner.cells.count(local)) add_local(local, PYC_LOCAL);
+  }
+
+  for (const std::string &local : inner.assigned) {
+    if (inner.cells.count(local)) add_local(local, PYC_CELL);
+  }
+
+  for (const std::string &free : inner.frees) add_local(free, PYC_FREE);
+
+  line = NO_LINE;
+
+  for (size_t i = 0; i < opened.kinds.size(); i++) {
+    if (opened.kinds[i] & PYC_CELL) emit(Op::MAKE_CELL, i);
+  }
+
+  if (not inner.frees.empty()) emit(Op::COPY_FREE_VARS, inner.frees.size());
+  emit(Op::RESUME, 0);
+
+  line = owner->line;
+}
+
+void Pyc::close_unit() {
+  std::string code = assemble();
+  std::vector<std::string> frees = scope().frees;
+  line = unit().outer_line;
+  units.pop_back();
+
+  // What the function closes over is handed the cells of the one making it
+  for (const std::string &free : frees) emit(Op::LOAD_CLOSURE, get_local(free));
+  if (not frees.empty()) emit(Op::BUILD_TUPLE, frees.size());
+
+  emit(Op::LOAD_CONST, add_constant(code));
+  emit(Op::MAKE_FUNCTION, frees.empty() ? 0 : 0x08);
+}
+
+void Pyc::handle_body(const std::vector<std::unique_ptr<Statement>> &children) {
+  // Bodies are queued on an explicit stack so deeply nested programs don't recurse
+  std::vector<Pending> pending;
+  for (auto child = children.rbegin(); child != children.rend(); child++) {
+    pending.push_back({child->get(), nullptr});
+  }
+
+  while (not pending.empty()) {
+    Pending item = std::move(pending.back());
+    pending.pop_back();
+
+    std::vector<Pending> body;
+
+    if (item.action) {
+      item.action(body);
+    } else {
+      expand_statement(item.statement, body);
+    }
+
+    pending.insert(pending.end(), std::make_move_iterator(body.rbegin()), std::make_move_iterator(body.rend()));
+  }
+}
+
+void Pyc::expand_statement(const Statement *statement, std::vector<Pending> &body) {
+  line = statement->line;
+  int depth = unit().depth;
+
+  if (statement->kind == Statement::Kind::EXPRESSION) {
+    auto expression = static_cast<const Expression *>(statement);
+    std::vector<const Expression *> nodes;
+    std::vector<std::string> operations;
+    flatten(expression, nodes, operations);
+
+    if (std::any_of(operations.begin(), operations.end(), is_assignment)) {
+      handle_assignment(expression);
+      return;
+    }
+
+    handle_expression(expression);
+    emit(Op::POP_TOP);
+    return;
+  }
+
+  switch (statement->type) {
+    case Statement::Type::VARIABLE_DECLARATION:
+    case Statement::Type::CONSTANT_DECLARATION: {
+      auto variable = static_cast<const Variable *>(statement);
+
+      if (variable->value) {
+        handle_expression(variable->value.get());
+      } else {
+        emit(Op::LOAD_CONST, add_constant("N"));
+      }
+
+      store_name(variable->name);
+      break;
+    }
+    case Statement::Type::FUNCTION_DECLARATION: {
+      auto function = static_cast<const Function *>(statement);
+
+      // The Python output loads these through ctypes, which a .pyc can't build
+      if (function->is_native) {
+        report("Native Function '" + function->name + "' Unsupported");
+        break;
+      }
+
+      open_unit(function, function->name);
+      handle_body(function->children);
+      emit(Op::LOAD_CONST, add_constant("N"));
+      emit(Op::RETURN_VALUE);
+      close_unit();
+      store_name(function->name);
+      break;
+    }
+    case Statement::Type::IF_STATEMENT: {
+      expand_if(static_cast<const If *>(statement), body);
+      break;
+    }
+    case Statement::Type::MATCH_STATEMENT: {
+      expand_match(static_cast<const Match *>(statement), body);
+      break;
+    }
+    case Statement::Type::LOOP_STATEMENT: {
+      expand_loop(static_cast<const For *>(statement), body);
+      break;
+    }
+    case Statement::Type::IMPORT_STATEMENT: {
+      if (units.size() > 1) {
+        report("Import Inside a Function", Diagnostic::Severity::USER);
+        break;
+      }
+
+      std::string module = static_cast<const Import *>(statement)->module;
+      Utils::replace(module, "/", ".");
+
+      emit(Op::LOAD_CONST, add_constant(marshal_integer("0")));
+      emit(Op::LOAD_CONST, add_constant(marshal_tuple({marshal_string("*")})));
+      emit(Op::IMPORT_NAME, add_name(module));
+
+      if (dialect->imports_by_intrinsic) {
+        emit(Op::CALL_INTRINSIC_1, 2);
+        emit(Op::POP_TOP);
+      } else {
+        emit(Op::IMPORT_STAR);
+      }
+
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT: {
+      auto jump = static_cast<const Jump *>(statement);
+
+      if (units.size() == 1) {
+        report("Return Outside of a Function", Diagnostic::Severity::USER);
+        break;
+      }
+
+      // Iterators of the loops being left go first
+      for (const Loop &loop : unit().loops) {
+        if (loop.has_iterator) emit(Op::POP_TOP);
+      }
+
+      if (jump->value) {
+        handle_expression(jump->value.get());
+      } else {
+        emit(Op::LOAD_CONST, add_constant("N"));
+      }
+
+      emit(Op::RETURN_VALUE);
+      set_depth(depth);
+      break;
+    }
+    case Statement::Type::BREAK_STATEMENT:
+    case Statement::Type::CONTINUE_STATEMENT: {
+      if (unit().loops.empty()) {
+        report("Jump Outside of a Loop", Diagnostic::Severity::USER);
+        break;
+      }
+
+      Loop loop = unit().loops.back();
+
+      if (statement->type == Statement::Type::BREAK_STATEMENT) {
+        if (loop.has_iterator) emit(Op::POP_TOP);
+        emit_jump(Op::JUMP_FORWARD, loop.end);
+      } else {
+        emit_jump(Op::JUMP_BACKWARD, loop.start);
+      }
+
+      set_depth(depth);
+      break;
+    }
+    default:
+      report("Statement Unsupported");
+  }
+}
+
+void Pyc::expand_if(const If *statement, std::vector<Pending> &body) {
+  size_t otherwise = add_label();
+  handle_expression(statement->condition.get());
+  emit_jump(Op::POP_JUMP_IF_FALSE, otherwise);
+
+  for (const auto &child : statement->children) body.push_back({child.get(), nullptr});
+
+  body.push_back({nullptr, [this, statement, otherwise](std::vector<Pending> &after) {
+    const Else *else_block = statement->else_block.get();
+
+    if (not else_block) {
+      place(otherwise);
+      return;
+    }
+
+    size_t end = add_label();
+    emit_jump(Op::JUMP_FORWARD, end);
+    place(otherwise);
+
+    // An else if is compiled as the if it holds
+    const Statement *owner = else_block->get_body_owner();
+
+    if (owner != else_block) {
+      after.push_back({owner, nullptr});
+    } else {
+      for (const auto &child : else_block->children) after.push_back({child.get(), nullptr});
+    }
+
+    after.push_back({nullptr, [this, end](std::vector<Pending> &) {
+      place(end);
+    }});
+  }});
+}
+
+void Pyc::expand_match(const Match *match, std::vector<Pending> &body) {
+  // The subject stays on the stack while the arms test it, and each arm that
+  // matches drops it before its body
+  int depth = unit().depth;
+  handle_expression(match->condition.get());
+
+  size_t end = add_label();
+  bool has_else = false;
+
+  for (const auto &arm : match->children) {
+    const Statement *statement = arm.get();
+    bool is_when = statement->type == Statement::Type::WHEN_STATEMENT;
+    if (not is_when) has_else = true;
+
+    body.push_back({nullptr, [this, statement, is_when, depth, end](std::vector<Pending> &after) {
+      line = statement->line;
+      set_depth(depth + 1);
+      size_t miss = add_label();
+
+      if (is_when) {
+        size_t hit = add_label();
+
+        for (const auto &condition : static_cast<const When *>(statement)->conditions) {
+          if (condition->variant == Expression::Variant::IDENTIFIER) {
+            // Captures always match, so the arms after it never get tested
+            emit(Op::COPY, 1);
+            store_name(condition->value);
+            emit_jump(Op::JUMP_FORWARD, hit);
+            continue;
+          }
+
+          bool is_constant =
+            condition->variant == Expression::Variant::LITERAL &&
+            condition->literal != Token::Literal::ARRAY &&
+            condition->literal != Token::Literal::LAMBDA &&
+            (condition->literal != Token::Literal::STRING ||
+             static_cast<const String *>(condition.get())->get_injections().empty());
+
+          if (not is_constant) {
+            report("Pattern Unsupported");
+            continue;
+          }
+
+          emit(Op::COPY, 1);
+          handle_literal(condition.get());
+
+          // True and False are matched by identity, everything else by equality
+          if (condition->literal == Token::Literal::BOOLEAN) {
+            emit(Op::IS_OP, 0);
+          } else {
+            emit(Op::COMPARE_OP, 2);
+          }
+
+          emit_jump(Op::POP_JUMP_IF_TRUE, hit);
+        }
+
+        emit_jump(Op::JUMP_FORWARD, miss);
+        place(hit);
+      }
+
+      emit(Op::POP_TOP);
+      for (const auto &child : statement->children) after.push_back({child.get(), nullptr});
+
+      after.push_back({nullptr, [this, depth, end, miss](std::vector<Pending> &) {
+        emit_jump(Op::JUMP_FORWARD, end);
+        place(miss);
+        set_depth(depth + 1);
+      }});
+    }});
+  }
+
+  body.push_back({nullptr, [this, depth, end, has_else](std::vector<Pending> &) {
+    if (not has_else) emit(Op::POP_TOP);
+    place(end);
+    set_depth(depth);
+  }});
+}
+
+void Pyc::expand_loop(const For *loop, std::vector<Pending> &body) {
+  int depth = unit().depth;
+  size_t start = add_label();
+  size_t exit = add_label();
+  size_t end = add_label();
+  bool has_iterator = loop->variant != For::Variant::INFINITE;
+
+  if (loop->index && loop->index->literal == Token::Literal::FLOAT) {
+    report("Cannot use a float in a range loop", Diagnostic::Severity::USER);
+  }
+
+  if (loop->limit && loop->limit->literal == Token::Literal::FLOAT) {
+    report("Cannot use a float in a range loop", Diagnostic::Severity::USER);
+  }
+
+  if (has_iterator) {
+    // for _ in range(<index>), for <index> in range(<limit>) when the limit is
+    // a number and for <index> in <limit> otherwise
+    const Expression *subject = loop->variant == For::Variant::TIMES ? loop->index.get() : loop->limit.get();
+    bool is_range = loop->variant == For::Variant::TIMES || subject->literal == Token::Literal::INTEGER;
+
+    if (is_range) load_callable("range");
+    handle_expression(subject);
+    if (is_range) emit_call(1);
+    emit(Op::GET_ITER);
+
+    place(start);
+    emit_jump(Op::FOR_ITER, exit);
+    store_name(loop->variant == For::Variant::TIMES ? "_" : loop->index->value);
+  } else {
+    place(start);
+  }
+
+  unit().loops.push_back({start, end, has_iterator});
+
+  for (const auto &child : loop->children) body.push_back({child.get(), nullptr});
+
+  body.push_back({nullptr, [this, loop, depth, start, exit, end, has_iterator](std::vector<Pending> &) {
+    line = loop->line;
+    emit_jump(Op::JUMP_BACKWARD, start);
+    place(exit);
+    if (has_iterator && dialect->has_end_for) emit(Op::END_FOR);
+    place(end);
+
+    set_depth(depth);
+    unit().loops.pop_back();
+  }});
+}
+
+void Pyc::begin(const std::string &file_name) {
+  this->file_name = file_name;
+  scopes.assign(1, Scope());
+  scope_of.clear();
+  units.clear();
+
+  units.emplace_back();
+  unit().scope = 0;
+  unit().name = "<module>";
+  unit().qualified_name = "<module>";
+
+  line = NO_LINE;
+  emit(Op::RESUME, 0);
+}
+
+void Pyc::add(const Statement &program) {
+  // Scopes of the statements before are done with, as they can't be nested in
+  scopes.resize(1);
+  scope_of.clear();
+
+  for (const auto &child : program.children) add_scopes(child.get());
+  resolve_scopes(1);
+
+  handle_body(program.children);
+}
+
+std::string Pyc::finish(uint32_t source_time, uint32_t source_size) {
+  line = NO_LINE;
+  emit(Op::LOAD_CONST, add_constant("N"));
+  emit(Op::RETURN_VALUE);
+
+  std::string output = dialect->magic;
+  put_int(output, 0);
+  put_int(output, source_time);
+  put_int(output, source_size);
+  output += assemble();
+
+  units.clear();
+  return output;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <set>
+#include "Utils.h"
+#include "Diagnostic.h"
+#include "Parser.cpp"
+#include "Statement.cpp"
+
+// Compiles a checked program straight to a CPython code object and writes it
+// out as a .pyc, so that Python loads it without parsing or compiling the .py.
+// Names are bound the way Python binds them in the .py output, and every
+// instruction carries the line of the .pino statement it came from
+class Pyc {
+  public:
+    // The CPython releases whose bytecode can be written
+    enum class Version {
+      PYTHON_3_11,
+      PYTHON_3_12,
+    };
+
+    // Instructions by what they do, given their number by the version written
+    enum class Op {
+      POP_TOP,
+      PUSH_NULL,
+      COPY,
+      SWAP,
+      LOAD_CONST,
+      LOAD_NAME,
+      STORE_NAME,
+      LOAD_GLOBAL,
+      LOAD_FAST,
+      STORE_FAST,
+      LOAD_DEREF,
+      STORE_DEREF,
+      LOAD_CLOSURE,
+      MAKE_CELL,
+      COPY_FREE_VARS,
+      // The name of the attribute, shifted for the versions that want it
+      LOAD_ATTR,
+      STORE_ATTR,
+      // Loads a method and its owner, LOAD_ATTR with the low bit set past 3.11
+      LOAD_METHOD,
+      BINARY_OP,
+      COMPARE_OP,
+      IS_OP,
+      BUILD_LIST,
+      BUILD_TUPLE,
+      BUILD_STRING,
+      FORMAT_VALUE,
+      LIST_APPEND,
+      GET_ITER,
+      FOR_ITER,
+      END_FOR,
+      JUMP_FORWARD,
+      JUMP_BACKWARD,
+      POP_JUMP_IF_FALSE,
+      POP_JUMP_IF_TRUE,
+      PRECALL,
+      CALL,
+      MAKE_FUNCTION,
+      RETURN_VALUE,
+      RESUME,
+      EXTENDED_ARG,
+      IMPORT_NAME,
+      IMPORT_STAR,
+      CALL_INTRINSIC_1,
+    };
+
+    // How one version numbers and lays out its instructions
+    struct Dialect {
+      std::string name;
+      std::string magic;
+      // Each op's number and the cache entries that follow it
+      std::map<Op, std::pair<uint8_t, uint8_t>> opcodes;
+      bool has_precall;
+      bool has_end_for;
+      bool shifts_attributes;
+      bool masks_comparisons;
+      bool imports_by_intrinsic;
+    };
+
+  private:
+    // A statement still to be compiled, or what to do once its body is done
+    struct Pending {
+      const Statement *statement;
+      std::function<void(std::vector<Pending> &)> action;
+    };
+
+    // What a function, comprehension or the module does with each name it
+    // mentions, and which of them closures share with it
+    struct Scope {
+      bool is_function = false;
+      size_t parent = 0;
+      std::vector<std::string> parameters;
+      std::vector<std::string> assigned;
+      std::set<std::string> used;
+      std::set<std::string> cells;
+      // In the order the enclosing function hands them over
+      std::vector<std::string> frees;
+    };
+
+    struct Instruction {
+      Op op;
+      uint32_t arg;
+      // Jumps go to a label, resolved to an offset once the code is laid out
+      size_t label;
+      // Zero based source line, NO_LINE for the prologue
+      size_t line;
+    };
+
+    struct Loop {
+      size_t start;
+      size_t end;
+      // for loops keep their iterator on the stack, to be dropped on the way out
+      bool has_iterator;
+    };
+
+    // A code object being compiled, nested in the ones below it on the stack
+    struct Unit {
+      size_t scope;
+      std::string name;
+      std::string qualified_name;
+      size_t first_line = 0;
+      std::vector<Instruction> code;
+      std::vector<size_t> labels;
+      std::vector<std::string> constants;
+      std::map<std::string, uint32_t> constant_indices;
+      std::vector<std::string> names;
+      std::map<std::string, uint32_t> name_indices;
+      // Parameters, locals, cells and free variables, in the order Python keeps them
+      std::vector<std::string> locals;
+      std::vector<uint8_t> kinds;
+      std::map<std::string, uint32_t> local_indices;
+      std::vector<Loop> loops;
+      int depth = 0;
+      int max_depth = 0;
+      // Line of the statement the unit was opened in, restored once it closes
+      size_t outer_line = 0;
+    };
+
+    static constexpr size_t NO_LABEL = SIZE_MAX;
+    static constexpr size_t NO_LINE = SIZE_MAX;
+
+    const Dialect *dialect;
+    std::string file_name;
+    std::vector<Scope> scopes;
+    std::map<const Statement *, size_t> scope_of;
+    std::vector<Unit> units;
+    Diagnostics echoed;
+    Diagnostics *diagnostics;
+    // Line of the statement being compiled, given to every instruction of it
+    size_t line = 0;
+
+    void report(const std::string &message, Diagnostic::Severity severity = Diagnostic::Severity::INTERNAL);
+
+    // Finds the scope of every function and comprehension under a top level
+    // statement, and which of their names are cells or free variables
+    void add_scopes(const Statement *statement);
+    void resolve_scopes(size_t first);
+
+    Unit &unit();
+    const Scope &scope();
+
+    void emit(Op op, uint32_t arg = 0);
+    void emit_jump(Op op, size_t label);
+    size_t add_label();
+    void place(size_t label);
+    // Jumps away leave the stack as it was before the statement that made them
+    void set_depth(int depth);
+    uint32_t add_constant(const std::string &constant);
+    uint32_t add_name(const std::string &name);
+    uint32_t get_local(const std::string &name);
+    void add_local(const std::string &name, uint8_t kind);
+    bool is_local(const Scope &scope, const std::string &name) const;
+
+    void load_name(const std::string &name);
+    void store_name(const std::string &name);
+    void load_callable(const std::string &name);
+    void emit_call(size_t count);
+
+    // Lays out the instructions of the unit on top and marshals it
+    std::string assemble();
+
+    void handle_arr_literal(const Array *literal);
+    void handle_str_literal(const String *literal);
+    void handle_literal(const Expression *literal);
+    void handle_call(const Expression *call);
+    void handle_member(const Expression *member);
+    void handle_terms(
+      const std::vector<const Expression *> &nodes,
+      const std::vector<std::string> &operations,
+      size_t begin,
+      size_t end
+    );
+    void handle_assignment(const Expression *expression);
+    void handle_expression(const Expression *expression);
+
+    // Opens a code object for the function or comprehension owning a scope
+    void open_unit(const Statement *owner, const std::string &name);
+    // Closes the code object on top, loading the function made from it
+    void close_unit();
+
+    void handle_body(const std::vector<std::unique_ptr<Statement>> &children);
+    void expand_statement(const Statement *statement, std::vector<Pending> &body);
+    void expand_if(const If *statement, std::vector<Pending> &body);
+    void expand_match(const Match *match, std::vector<Pending> &body);
+    void expand_loop(const For *loop, std::vector<Pending> &body);
+
+  public:
+    // Unsupported nodes are printed unless a sink is given to collect them
+    Pyc(Version version = Version::PYTHON_3_11, Diagnostics *diagnostics = nullptr);
+
+    // The version named as on the command line, 3.11 or 3.12
+    static bool parse_version(const std::string &name, Version &version);
+
+    // Starts the module of the file named, as tracebacks will show it
+    void begin(const std::string &file_name);
+
+    // Compiles a run of top level statements onto the end of the module
+    void add(const Statement &program);
+
+    // The module as a .pyc, stamped with the modification time and size of its source
+    std::string finish(uint32_t source_time, uint32_t source_size);
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <thread>
+#include "Ring.h"
+
+template <typename T>
+Ring<T>::Ring(size_t capacity) : head(0), tail(0), closed(false) {
+  size_t size = 1;
+  while (size < capacity) size <<= 1;
+
+  slots.resize(size);
+  mask = size - 1;
+}
+
+template <typename T>
+bool Ring<T>::push(T &&item, const std::atomic<bool> &cancelled) {
+  size_t position = tail.load(std::memory_order_relaxed);
+
+  while (position - head.load(std::memory_order_acquire) > mask) {
+    if (cancelled.load(std::memory_order_relaxed)) return false;
+    std::this_thread::yield();
+  }
+
+  slots[position & mask] = std::move(item);
+  tail.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+void Ring<T>::close() {
+  closed.store(true, std::memory_order_release);
+}
+
+template <typename T>
+bool Ring<T>::pop(T &item) {
+  size_t position = head.load(std::memory_order_relaxed);
+
+  while (position == tail.load(std::memory_order_acquire)) {
+    // Closing comes after the last push, so a second look at the tail settles it
+    if (closed.load(std::memory_order_acquire)) {
+      if (position == tail.load(std::memory_order_acquire)) return false;
+      break;
+    }
+
+    std::this_thread::yield();
+  }
+
+  item = std::move(slots[position & mask]);
+  head.store(position + 1, std::memory_order_release);
+  return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// A bounded lock free queue between exactly one producer thread and one consumer
+// thread. Each side is the only writer of its own index, so a push or a pop is
+// an acquire load of the other side's index and a release store of its own
+template <typename T>
+class Ring {
+  std::vector<T> slots;
+  size_t mask;
+  // Kept on cache lines of their own so the two threads don't trade them back and forth
+  alignas(64) std::atomic<size_t> head;
+  alignas(64) std::atomic<size_t> tail;
+  alignas(64) std::atomic<bool> closed;
+
+  public:
+    // The capacity is rounded up to a power of two
+    explicit Ring(size_t capacity);
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    // Producer side: waits while the ring is full, which is what holds the
+    // producer back to the pace of the consumer. False once cancelled
+    bool push(T &&item, const std::atomic<bool> &cancelled);
+
+    // No more items will be pushed
+    void close();
+
+    // Consumer side: waits for the next item, false once closed and drained
+    bool pop(T &item);
+};
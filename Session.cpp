@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Session.h"
+#include "Parser.cpp"
+#include "Checker.cpp"
+#include "Transpiler.cpp"
+
+Session::Session() : transpiler(&diagnostics), diagnostics(false), compilations(0) {}
+
+bool Session::compile(const std::string &source, Interfaces *interfaces) {
+  compilations++;
+  diagnostics.clear();
+  stream.clear();
+  program = Statement();
+  output.clear();
+
+  Diagnostic::Stage stage = Diagnostic::Stage::LEX;
+
+  try {
+    stream = Lexer::lex_source(source);
+
+    stage = Diagnostic::Stage::PARSE;
+    program = Parser::build_program(stream);
+
+    stage = Diagnostic::Stage::CHECK;
+    Checker checker(program, &diagnostics, nullptr, interfaces);
+
+    stage = Diagnostic::Stage::EMIT;
+    transpiler.restart();
+    output = transpiler.emit(program);
+  } catch (const std::exception &error) {
+    // The checker has already reported why it gave up
+    if (stage != Diagnostic::Stage::CHECK || not diagnostics.has_errors()) {
+      diagnostics.report(stage, error);
+    }
+  }
+
+  return not diagnostics.has_errors();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include "Diagnostic.h"
+#include "Transpiler.cpp"
+
+// Compiles programs held in memory, keeping its buffers warm between calls
+class Session {
+  Transpiler transpiler;
+
+  public:
+    Diagnostics diagnostics;
+    // What the last compile got through, kept for callers that cache them
+    Stream stream;
+    Statement program;
+    std::string output;
+    size_t compilations;
+
+    Session();
+
+    // Runs every stage on source, false if any of them reported an error.
+    // Imports resolve against the interfaces given, or those beside the sources
+    bool compile(const std::string &source, Interfaces *interfaces = nullptr);
+};
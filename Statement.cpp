@@ -3,28 +3,88 @@
 #include <map>
 #include "Statement.h"
 
-std::map<Statement::Kind, std::string> KIND_NAME = {
+const std::map<Statement::Kind, std::string> KIND_NAME = {
   {Statement::Kind::PROGRAM, "Program"},
   {Statement::Kind::STATEMENT, "Statement"},
 }; 
 
+void Printer::line(const std::string &line) {
+  items.push_back({line, nullptr, 0});
+}
+
+void Printer::child(const Statement *child, size_t indent) {
+  items.push_back({"", child, indent});
+}
+
 Statement::Statement() {
   kind = Kind::STATEMENT;
 }
 
+Statement::~Statement() {
+  dismantle();
+}
+
+void Statement::dismantle() {
+  std::vector<std::unique_ptr<Statement>> pending;
+  release(pending);
+
+  while (not pending.empty()) {
+    std::unique_ptr<Statement> node = std::move(pending.back());
+    pending.pop_back();
+    // Once emptied the node is destroyed without recursing into its children
+    node->release(pending);
+  }
+}
+
+void Statement::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, children);
+}
+
+template <typename T>
+void Statement::hand_over(std::vector<std::unique_ptr<Statement>> &pending, std::unique_ptr<T> &node) {
+  if (node) pending.push_back(std::move(node));
+}
+
+template <typename T>
+void Statement::hand_over(
+  std::vector<std::unique_ptr<Statement>> &pending, 
+  std::vector<std::unique_ptr<T>> &nodes
+) {
+  for (auto &node : nodes) hand_over(pending, node);
+  nodes.clear();
+}
+
 void Statement::print(size_t indent) const {
+  std::vector<Printer::Item> pending = {{"", this, indent}};
+
+  while (not pending.empty()) {
+    Printer::Item item = std::move(pending.back());
+    pending.pop_back();
+
+    if (not item.child) {
+      println(item.line);
+      continue;
+    }
+
+    Printer printer;
+    item.child->describe(printer, item.indent);
+    pending.insert(pending.end(), printer.items.rbegin(), printer.items.rend());
+  }
+}
+
+void Statement::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
   std::string name = KIND_NAME.at(kind);
 
-  println(indentation + name + " {");
+  printer.line(indentation + name + " {");
 
   if (children.size() > 0) {
-    println(indentation + "  children: [");
+    printer.line(indentation + "  children: [");
     for (const auto &child : children) {
-      child->print(indent + 2);
+      printer.child(child.get(), indent + 2);
     }
-    println(indentation + "  ]");
+    printer.line(indentation + "  ]");
   }
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
\ No newline at end of file
@@ -4,6 +4,23 @@
 #include <memory>
 #include "Lexer.h"
 
+class Statement;
+
+// Collects the lines of a node and the children to be expanded in their place
+class Printer {
+  public:
+    struct Item {
+      std::string line;
+      const Statement *child;
+      size_t indent;
+    };
+
+    std::vector<Item> items;
+
+    void line(const std::string &line);
+    void child(const Statement *child, size_t indent);
+};
+
 class Statement {
   public:
     enum class Kind {
@@ -24,13 +41,42 @@ class Statement {
       LOOP_STATEMENT,
       MATCH_STATEMENT,
       WHEN_STATEMENT,
+      IMPORT_STATEMENT,
+      RETURN_STATEMENT,
+      BREAK_STATEMENT,
+      CONTINUE_STATEMENT,
     };
 
     Type type;
     Kind kind;
     std::vector<std::unique_ptr<Statement>> children;
+    // Zero based source line of the token the node starts at
+    size_t line = 0;
 
     Statement();
+    Statement(Statement &&) = default;
+    Statement &operator=(Statement &&) = default;
+
+    // Trees are torn down iteratively so deep nesting can't exhaust the stack
+    virtual ~Statement();
+
+    // Hands every owned child node over to the caller
+    virtual void release(std::vector<std::unique_ptr<Statement>> &pending);
+
+    // Called by every destructor whose class owns nodes besides children
+    void dismantle();
+
+    void print(size_t indent = 0) const;
+
+    virtual void describe(Printer &printer, size_t indent) const;
+
+  protected:
+    template <typename T>
+    static void hand_over(std::vector<std::unique_ptr<Statement>> &pending, std::unique_ptr<T> &node);
 
-    virtual void print(size_t indent = 0) const;
+    template <typename T>
+    static void hand_over(
+      std::vector<std::unique_ptr<Statement>> &pending, 
+      std::vector<std::unique_ptr<T>> &nodes
+    );
 };
\ No newline at end of file
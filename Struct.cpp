@@ -4,10 +4,25 @@
 #include "Function.cpp"
 #include "Struct.h"
 
+Struct::Struct() {
+  kind = Kind::STATEMENT;
+  type = Type::STRUCT_DECLARATION;
+}
+
+Struct::~Struct() {
+  dismantle();
+}
+
+void Struct::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, fields);
+  hand_over(pending, methods);
+  Statement::release(pending);
+}
+
 bool Struct::is_struct_literal(const Stream &stream, const size_t &start_index) {
   return 
     // prevent matching <keyword> <identifier< {}  
-    not stream.at(start_index).is_given_kind(Token::Kind::KEYWORD) &&
+    not (start_index < stream.size() && stream.at(start_index).is_given_kind(Token::Kind::KEYWORD)) &&
     stream.is_next(start_index, [](const Token &token) {
       return token.is_given_kind(Token::Kind::IDENTIFIER) && isupper(token.data[0]);
     }) &&
@@ -50,6 +65,7 @@ PeekPtr<Struct> Struct::build(Stream &stream, const size_t &start_index) {
 
     if (next.data.is_given_keyword(Keyword::FUNCTION)) {
       PeekPtr<Function> method = Function::build(stream, next.end_index);
+      method.data->line = next.data.line;
       result.data->methods.push_back(std::move(method.data));
       index = method.end_index;
       continue;
@@ -110,27 +126,36 @@ PeekPtr<Object> Struct::build_as_struct_literal(Stream &stream, const size_t &st
   return result;
 }
 
-void Struct::print(size_t indent) const {
+void Struct::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Struct {");
-  println(indentation + "  name: " + name);
-  println(indentation + "  fields: [");
+  printer.line(indentation + "Struct {");
+  printer.line(indentation + "  name: " + name);
+  printer.line(indentation + "  fields: [");
 
   for (const std::unique_ptr<Variable> &field : fields) {
-    field->print(indent + 2);
+    printer.child(field.get(), indent + 2);
   }
 
   if (not methods.empty()) {
-    println(indentation + "  ]");
-    println(indentation + "  methods: [");
+    printer.line(indentation + "  ]");
+    printer.line(indentation + "  methods: [");
 
     for (const std::unique_ptr<Function> &method : methods) {
-      method->print(indent + 2);
+      printer.child(method.get(), indent + 2);
     }
   }
 
-  println(indentation + "  ]");
-  println(indentation + "}");
+  printer.line(indentation + "  ]");
+  printer.line(indentation + "}");
+}
+
+Object::~Object() {
+  dismantle();
+}
+
+void Object::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, properties);
+  Expression::release(pending);
 }
 
 Peek<MapPtr<Expression>> Object::get_given_properties(
@@ -184,18 +209,18 @@ Peek<MapPtr<Expression>> Object::get_given_properties(
   throw std::runtime_error("USER: Unterminated Struct Literal Declaration");
 }
 
-void Object::print(size_t indent) const {
+void Object::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
-  println(indentation + "Struct Literal {");
-  println(indentation + "  name: " + name);
-  println(indentation + "  properties: [");
+  printer.line(indentation + "Struct Literal {");
+  printer.line(indentation + "  name: " + name);
+  printer.line(indentation + "  properties: [");
 
   for (const std::unique_ptr<Variable> &field : properties) {
-    field->print(indent + 2);
+    printer.child(field.get(), indent + 2);
   }
 
-  println(indentation + "  ]");
-  println(indentation + "}");
+  printer.line(indentation + "  ]");
+  printer.line(indentation + "}");
 }
 
 std::string Object::to_string(size_t indent) const {
@@ -211,4 +236,16 @@ std::string Object::to_string(size_t indent) const {
   result += indentation + "  ]\n";
   result += indentation + "}\n";
   return result;
+}
+
+void Object::write_source(std::string &output) const {
+  output += name + " { ";
+
+  for (size_t i = 0; i < properties.size(); i++) {
+    if (i > 0) output += ", ";
+    output += properties[i]->name + ": ";
+    properties[i]->value->write_source(output);
+  }
+
+  output += " }";
 }
\ No newline at end of file
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "TailCall.h"
+#include "Parser.cpp"
+#include "Fold.cpp"
+#include "DeadCode.cpp"
+
+bool TailCall::is_rebindable(const Variable *parameter) {
+  switch (parameter->typing.data) {
+    case Token::Literal::INTEGER:
+    case Token::Literal::FLOAT:
+    case Token::Literal::BOOLEAN:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool TailCall::has_closures(const Function &function) {
+  std::vector<const Statement *> pending;
+  for (const auto &child : function.children) pending.push_back(child.get());
+
+  while (not pending.empty()) {
+    const Statement *node = pending.back();
+    pending.pop_back();
+
+    bool is_lambda =
+      node->kind == Statement::Kind::EXPRESSION &&
+      static_cast<const Expression *>(node)->variant == Expression::Variant::LITERAL &&
+      static_cast<const Expression *>(node)->literal == Token::Literal::LAMBDA;
+
+    if (is_lambda) return true;
+    if (node->kind == Statement::Kind::STATEMENT && node->type == Statement::Type::FUNCTION_DECLARATION) return true;
+
+    std::vector<const Statement *> nodes = Optimizer::get_nodes(node);
+    pending.insert(pending.end(), nodes.begin(), nodes.end());
+  }
+
+  return false;
+}
+
+std::vector<TailCall::Site> TailCall::find_sites(Function &function) {
+  std::vector<Site> sites;
+  std::vector<std::vector<std::unique_ptr<Statement>> *> pending = {&function.children};
+
+  // Bodies a continue in would go round the loop around the function's
+  auto push_body = [&pending](Statement *owner) {
+    pending.push_back(&owner->children);
+  };
+
+  while (not pending.empty()) {
+    std::vector<std::unique_ptr<Statement>> *statements = pending.back();
+    pending.pop_back();
+
+    for (size_t i = 0; i < statements->size(); i++) {
+      Statement *statement = (*statements)[i].get();
+      if (statement->kind != Statement::Kind::STATEMENT) continue;
+
+      switch (statement->type) {
+        case Statement::Type::IF_STATEMENT: {
+          auto conditional = static_cast<If *>(statement);
+          push_body(conditional);
+
+          // else if { <body> } is held by the nested If, which gets to it itself
+          if (conditional->else_block) push_body(conditional->else_block.get());
+          break;
+        }
+        case Statement::Type::MATCH_STATEMENT: {
+          for (const auto &arm : statement->children) push_body(arm.get());
+          break;
+        }
+        case Statement::Type::RETURN_STATEMENT: {
+          const Expression *value = static_cast<Jump *>(statement)->value.get();
+
+          bool is_tail_call =
+            value &&
+            value->variant == Expression::Variant::FUNCTION_CALL &&
+            value->value == function.name &&
+            value->arguments.size() == function.parameters.size();
+
+          if (is_tail_call) sites.push_back({statements, i});
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+
+  return sites;
+}
+
+std::string TailCall::get_unused(const std::string &name, std::set<std::string> &names) {
+  std::string unused = name + "_next";
+  for (size_t i = 2; names.count(unused); i++) unused = name + "_next" + std::to_string(i);
+
+  names.insert(unused);
+  return unused;
+}
+
+bool TailCall::rebind(Function &function, const Site &site, std::set<std::string> &names) {
+  auto jump = static_cast<Jump *>((*site.statements)[site.index].get());
+  std::vector<std::unique_ptr<Expression>> &arguments = jump->value->arguments;
+  size_t line = jump->line;
+
+  // Parameters passed on as they are stay as they are
+  std::vector<size_t> changed;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    const Variable *parameter = function.parameters[i].get();
+
+    bool is_same =
+      arguments[i]->variant == Expression::Variant::IDENTIFIER &&
+      arguments[i]->value == parameter->name;
+
+    if (is_same) continue;
+    if (not is_rebindable(parameter)) return false;
+    changed.push_back(i);
+  }
+
+  std::vector<std::set<std::string>> reads(arguments.size());
+  for (size_t i : changed) DeadCode::add_references(arguments[i].get(), reads[i]);
+
+  auto create_identifier = [line](const std::string &name) {
+    auto identifier = std::make_unique<Expression>();
+    identifier->variant = Expression::Variant::IDENTIFIER;
+    identifier->value = name;
+    identifier->line = line;
+    return identifier;
+  };
+
+  auto create_assignment = [&](const std::string &name, std::unique_ptr<Expression> value) {
+    auto assignment = std::make_unique<BinaryExpression>();
+    assignment->variant = Expression::Variant::ASSIGNMENT;
+    assignment->operation = "=";
+    assignment->left = create_identifier(name);
+    assignment->right = std::move(value);
+    assignment->line = line;
+    return assignment;
+  };
+
+  // Arguments are evaluated in order as before. A parameter a later argument
+  // reads is only set once all of them were, from a variable holding its value
+  std::vector<std::unique_ptr<Statement>> replacement;
+  std::vector<std::unique_ptr<Statement>> deferred;
+
+  for (size_t k = 0; k < changed.size(); k++) {
+    size_t i = changed[k];
+    const std::string &name = function.parameters[i]->name;
+
+    bool is_read_later = false;
+    for (size_t later = k + 1; later < changed.size(); later++) {
+      is_read_later = is_read_later || reads[changed[later]].count(name);
+    }
+
+    if (not is_read_later) {
+      replacement.push_back(create_assignment(name, std::move(arguments[i])));
+      continue;
+    }
+
+    auto temporary = std::make_unique<Variable>();
+    temporary->name = get_unused(name, names);
+    temporary->is_constant = false;
+    temporary->typing = function.parameters[i]->typing;
+    temporary->value = std::move(arguments[i]);
+    temporary->line = line;
+
+    if (typings) (*typings)[temporary.get()] = temporary->typing;
+
+    deferred.push_back(create_assignment(name, create_identifier(temporary->name)));
+    replacement.push_back(std::move(temporary));
+  }
+
+  for (auto &assignment : deferred) replacement.push_back(std::move(assignment));
+
+  auto next = std::make_unique<Jump>();
+  next->type = Statement::Type::CONTINUE_STATEMENT;
+  next->line = line;
+  replacement.push_back(std::move(next));
+
+  Optimizer::forget(jump, typings);
+  site.statements->erase(site.statements->begin() + site.index);
+  site.statements->insert(
+    site.statements->begin() + site.index,
+    std::make_move_iterator(replacement.begin()),
+    std::make_move_iterator(replacement.end())
+  );
+
+  return true;
+}
+
+void TailCall::eliminate(Function &function, const std::vector<std::string> &members) {
+  std::vector<Site> sites = find_sites(function);
+  if (sites.empty() || has_closures(function)) return;
+
+  // The name has to mean the function everywhere in it
+  std::map<std::string, size_t> declared;
+  std::vector<Statement *> body;
+  for (const auto &child : function.children) body.push_back(child.get());
+  Fold::count_declarations(body, declared);
+
+  for (const auto &parameter : function.parameters) declared[parameter->name]++;
+  if (declared.count(function.name)) return;
+
+  std::set<std::string> names;
+  for (const auto &child : function.children) DeadCode::add_references(child.get(), names);
+  for (const auto &[name, count] : declared) names.insert(name);
+  names.insert(members.begin(), members.end());
+
+  // Falling off the end of the body ends the function as it did
+  const Statement *last = function.children.back().get();
+  bool is_returning = last->kind == Statement::Kind::STATEMENT && last->type == Statement::Type::RETURN_STATEMENT;
+
+  // Later sites first, so the indices of the earlier ones still hold
+  size_t rebound = 0;
+  for (auto site = sites.rbegin(); site != sites.rend(); site++) {
+    if (rebind(function, *site, names)) rebound++;
+  }
+
+  if (rebound == 0) return;
+
+  auto loop = std::make_unique<For>();
+  loop->type = Statement::Type::LOOP_STATEMENT;
+  loop->variant = For::Variant::INFINITE;
+  loop->line = function.children.front()->line;
+  loop->children = std::move(function.children);
+
+  // The loop goes round by itself at the end of the body
+  std::vector<std::unique_ptr<Statement>> &statements = loop->children;
+  if (statements.size() > 1 && statements.back()->type == Statement::Type::CONTINUE_STATEMENT) statements.pop_back();
+
+  if (not is_returning) {
+    auto end = std::make_unique<Jump>();
+    end->type = Statement::Type::BREAK_STATEMENT;
+    end->line = statements.back()->line;
+    statements.push_back(std::move(end));
+  }
+
+  function.children.clear();
+  function.children.push_back(std::move(loop));
+  changes += rebound;
+}
+
+size_t TailCall::run(Statement &program, Context &context) {
+  typings = context.typings;
+  changes = 0;
+
+  for (const auto &child : program.children) {
+    if (child->kind != Statement::Kind::STATEMENT) continue;
+
+    switch (child->type) {
+      case Statement::Type::FUNCTION_DECLARATION:
+        eliminate(*static_cast<Function *>(child.get()), {});
+        break;
+      case Statement::Type::STRUCT_DECLARATION: {
+        auto declaration = static_cast<Struct *>(child.get());
+        std::vector<std::string> members;
+
+        for (const auto &field : declaration->fields) members.push_back(field->name);
+        for (const auto &method : declaration->methods) members.push_back(method->name);
+        for (const auto &method : declaration->methods) eliminate(*method, members);
+        break;
+      }
+      case Statement::Type::ENUM_DECLARATION: {
+        auto declaration = static_cast<Enum *>(child.get());
+        std::vector<std::string> members = declaration->values;
+
+        for (const auto &method : declaration->methods) members.push_back(method->name);
+        for (const auto &method : declaration->methods) eliminate(*method, members);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  typings = nullptr;
+  return changes;
+}
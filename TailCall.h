@@ -0,0 +1,46 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Optimizer.h"
+#include "Fold.h"
+#include "DeadCode.h"
+
+// Turns a function returning a call to itself into a loop over its body, the
+// call setting the parameters to its arguments and going round again, so deep
+// recursion runs in constant stack. Calls are found in the body and the ifs,
+// elses and match arms in it, not in loops, and only functions without
+// closures, which would see the parameters change, are rewritten
+class TailCall : public Pass {
+  private:
+    // A return of a call to the function, at the index of the statements holding it
+    struct Site {
+      std::vector<std::unique_ptr<Statement>> *statements;
+      size_t index;
+    };
+
+    size_t changes = 0;
+    Typings *typings = nullptr;
+
+    // Parameters the C++ backend takes by value, so they can be assigned to
+    static bool is_rebindable(const Variable *parameter);
+    static bool has_closures(const Function &function);
+
+    static std::vector<Site> find_sites(Function &function);
+
+    // A name like the given one that the function doesn't mention yet
+    static std::string get_unused(const std::string &name, std::set<std::string> &names);
+
+    // Replaces the return with the assignments of the parameters and a continue,
+    // unless a parameter that changes can't be assigned
+    bool rebind(Function &function, const Site &site, std::set<std::string> &names);
+
+    // Members are the fields or values and methods around a method, which its
+    // names mustn't take
+    void eliminate(Function &function, const std::vector<std::string> &members);
+
+  public:
+    size_t run(Statement &program, Context &context) override;
+};
@@ -1,7 +1,271 @@
 #pragma once
 
+#include <exception>
+#include <thread>
 #include "Transpiler.h"
 #include "Parser.cpp"
+#include "Checker.cpp"
+#include "Pool.cpp"
+#include "Native.cpp"
+
+// Programs with fewer top level statements per worker are emitted serially
+const size_t PARALLEL_EMIT_MINIMUM = 64;
+const size_t PARALLEL_EMIT_PARTS = 4;
+
+// Types worth declaring, as each typed mode spells them
+const std::map<Token::Literal, std::string> CYTHON_TYPES = {
+  {Token::Literal::INTEGER, "long long"},
+  {Token::Literal::FLOAT, "double"},
+  {Token::Literal::BOOLEAN, "bint"},
+  {Token::Literal::STRING, "str"},
+  {Token::Literal::ARRAY, "list"},
+};
+
+const std::map<Token::Literal, std::string> ANNOTATED_TYPES = {
+  {Token::Literal::INTEGER, "int"},
+  {Token::Literal::FLOAT, "float"},
+  {Token::Literal::BOOLEAN, "bool"},
+  {Token::Literal::STRING, "str"},
+  {Token::Literal::ARRAY, "list"},
+};
+
+// How the elements of arrays read through memoryviews are packed
+const std::map<Token::Literal, std::string> VIEW_CODES = {
+  {Token::Literal::INTEGER, "q"},
+  {Token::Literal::FLOAT, "d"},
+};
+
+const std::string CYTHON_HEADER = R"CYTHON(# cython: language_level=3
+from array import array as _pino_array
+
+
+cdef object _pino_array_of(str code, object values):
+    # Buffers are read where they lie, lists are packed once
+    if isinstance(values, list):
+        return _pino_array(code, values)
+    return values
+
+
+)CYTHON";
+
+Transpiler::Transpiler(Diagnostics *diagnostics, Mode mode) : mode(mode) {
+  this->diagnostics = diagnostics ? diagnostics : &echoed;
+}
+
+void Transpiler::report(const std::string &message) {
+  diagnostics->report(Diagnostic::Stage::EMIT, message, Diagnostic::Severity::INTERNAL);
+}
+
+std::string Transpiler::get_type(const Typing &typing) const {
+  if (mode == Mode::PYTHON) return "";
+
+  const auto &types = mode == Mode::CYTHON ? CYTHON_TYPES : ANNOTATED_TYPES;
+  auto type = types.find(typing.data);
+  if (type == types.end()) return "";
+
+  // Annotations say what arrays hold, when that is known all the way down
+  if (mode == Mode::ANNOTATED && typing.data == Token::Literal::ARRAY && typing.children.size() == 1) {
+    std::string element = get_type(typing.children.front());
+    if (not element.empty()) return "list[" + element + "]";
+  }
+
+  return type->second;
+}
+
+std::string Transpiler::get_parameter(const Variable *parameter) const {
+  const Typing &typing = parameter->typing;
+  std::string type = get_type(typing);
+
+  // Arrays of numbers may come in as any buffer, and are viewed as one inside
+  bool is_buffer =
+    mode == Mode::CYTHON &&
+    typing.data == Token::Literal::ARRAY &&
+    typing.children.size() == 1 &&
+    VIEW_CODES.count(typing.children.front().data);
+
+  if (type.empty() || is_buffer) return parameter->name;
+
+  return mode == Mode::CYTHON ? type + " " + parameter->name : parameter->name + ": " + type;
+}
+
+std::string Transpiler::get_return(const Function *function) const {
+  Token::Literal returned = CppTranspiler::get_return_type(function);
+  if (returned == Token::Literal::VOID) return " -> None";
+
+  std::string type = get_type(Typing::create(returned));
+  if (type.empty()) return "";
+
+  // mypy wants each path to end in a return, so every branch of how the body
+  // ends has to be one
+  auto get_last = [](const Statement *block) {
+    return block->children.empty() ? nullptr : block->children.back().get();
+  };
+
+  std::vector<const Statement *> ends = {get_last(function)};
+
+  while (not ends.empty()) {
+    const Statement *end = ends.back();
+    ends.pop_back();
+
+    if (not end || end->kind != Statement::Kind::STATEMENT) return "";
+    if (end->type == Statement::Type::RETURN_STATEMENT) continue;
+
+    auto conditional = static_cast<const If *>(end);
+    if (end->type != Statement::Type::IF_STATEMENT || not conditional->else_block) return "";
+
+    // An else if owns the If that follows it, which is an end of its own
+    const Statement *owner = conditional->else_block->get_body_owner();
+    ends.push_back(get_last(conditional));
+    ends.push_back(owner == conditional->else_block.get() ? get_last(owner) : owner);
+  }
+
+  return " -> " + type;
+}
+
+std::string Transpiler::declare_locals(const Function *function, size_t indentation) {
+  // The type of each local by name, emptied once two declarations disagree
+  std::map<std::string, std::string> types;
+  std::map<std::string, const Statement *> first;
+  std::vector<std::string> order;
+  std::map<std::string, Typing> arrays;
+  std::vector<const For *> loops;
+
+  for (const auto &parameter : function->parameters) {
+    const Typing &typing = parameter->typing;
+    // Parameters are constants, so they keep the type of their signature
+    types[parameter->name] = "";
+
+    bool is_viewed =
+      typing.data == Token::Literal::ARRAY &&
+      typing.children.size() == 1 &&
+      VIEW_CODES.count(typing.children.front().data);
+
+    if (is_viewed) arrays[parameter->name] = typing.children.front();
+  }
+
+  auto declare = [&](const std::string &name, const std::string &type, const Statement *node) {
+    auto found = types.find(name);
+
+    if (found == types.end()) {
+      types[name] = type;
+      first[name] = node;
+      order.push_back(name);
+    } else if (found->second != type) {
+      found->second = "";
+    }
+  };
+
+  // Nested functions and lambdas are scopes of their own, typed as they are emitted
+  std::vector<const Statement *> pending;
+  for (auto child = function->children.rbegin(); child != function->children.rend(); child++) {
+    pending.push_back(child->get());
+  }
+
+  while (not pending.empty()) {
+    const Statement *statement = pending.back();
+    pending.pop_back();
+
+    if (statement->kind == Statement::Kind::EXPRESSION) continue;
+
+    switch (statement->type) {
+      case Statement::Type::FUNCTION_DECLARATION: {
+        declare(static_cast<const Function *>(statement)->name, "", statement);
+        continue;
+      }
+      case Statement::Type::VARIABLE_DECLARATION: {
+        auto variable = static_cast<const Variable *>(statement);
+        std::string type;
+
+        if (typings) {
+          auto typing = typings->find(variable);
+          if (typing != typings->end()) type = get_type(typing->second);
+        }
+
+        declare(variable->name, type, variable);
+        break;
+      }
+      case Statement::Type::LOOP_STATEMENT: {
+        auto loop = static_cast<const For *>(statement);
+        if (loop->variant != For::Variant::FOR_IN) break;
+
+        const std::string &index = loop->index->value;
+        const Expression *limit = loop->limit.get();
+
+        // Annotations can't go on a loop variable, which mypy types by itself
+        if (mode == Mode::ANNOTATED) {
+          declare(index, "", loop);
+        } else if (limit->literal == Token::Literal::INTEGER) {
+          declare(index, get_type(Typing::create(Token::Literal::INTEGER)), loop);
+        } else if (limit->variant == Expression::Variant::IDENTIFIER && arrays.count(limit->value)) {
+          loops.push_back(loop);
+          declare(index, get_type(arrays[limit->value]), loop);
+          declare("_pino_" + index + "_at", "Py_ssize_t", loop);
+        } else {
+          declare(index, "", loop);
+        }
+
+        break;
+      }
+      case Statement::Type::IF_STATEMENT: {
+        auto if_statement = static_cast<const If *>(statement);
+        if (if_statement->else_block) pending.push_back(if_statement->else_block.get());
+        break;
+      }
+      default:
+        break;
+    }
+
+    for (auto child = statement->children.rbegin(); child != statement->children.rend(); child++) {
+      pending.push_back(child->get());
+    }
+  }
+
+  std::string indent = Utils::get_indent(indentation);
+  std::string text;
+
+  if (mode == Mode::ANNOTATED) {
+    for (const std::string &name : order) {
+      const Statement *declaration = first[name];
+      if (types[name].empty() || declaration->type != Statement::Type::VARIABLE_DECLARATION) continue;
+
+      annotations[declaration] = ": " + types[name];
+    }
+
+    return text;
+  }
+
+  // Arrays are viewed once on entry, and only when a loop reads them
+  std::vector<std::string> viewed;
+
+  for (const For *loop : loops) {
+    const std::string &name = loop->limit->value;
+    std::string view = "_pino_" + name + "_view";
+    views[loop] = view;
+
+    if (std::find(viewed.begin(), viewed.end(), name) != viewed.end()) continue;
+
+    const Typing &element = arrays[name];
+    text += indent + "cdef " + get_type(element) + "[::1] " + view;
+    text += " = _pino_array_of(\"" + VIEW_CODES.at(element.data) + "\", " + name + ")\n";
+    viewed.push_back(name);
+  }
+
+  std::string declarations;
+  for (const std::string &name : order) {
+    if (types[name].empty()) continue;
+    declarations += indent + "cdef " + types[name] + " " + name + "\n";
+  }
+
+  return declarations + text;
+}
+
+std::string Transpiler::get_header(Mode mode) {
+  return mode == Mode::CYTHON ? CYTHON_HEADER : "";
+}
+
+void Transpiler::set_typings(const Typings *typings) {
+  this->typings = typings;
+}
 
 std::string Transpiler::handle_arr_literal(const Expression* literal) {
   const auto arr = static_cast<const Array*>(literal);
@@ -22,16 +286,35 @@ std::string Transpiler::handle_arr_literal(const Expression* literal) {
 std::string Transpiler::handle_str_literal(const Expression* literal) {
   const auto str = static_cast<const String*>(literal);
 
-  if (str->injections.empty()) {
+  bool has_injections = std::any_of(str->segments.begin(), str->segments.end(), [](const Segment &segment) {
+    return segment.kind == Segment::Kind::INJECTION;
+  });
+
+  if (not has_injections) {
     return "\"" + str->value + "\"";
-  
-  } else {
-    std::string output = "f\"" + str->value + "\"";
-    for (const auto &injection : str->injections) {
-      Utils::replace(output, "#" + injection, '{' + injection + '}');
+  }
+
+  // Segments are emitted in a single pass, braces in plain text are escaped for the f-string
+  std::string output = "f\"";
+  output.reserve(str->value.size() + 2 * str->segments.size() + 3);
+
+  for (const Segment &segment : str->segments) {
+    if (segment.kind == Segment::Kind::INJECTION) {
+      output += '{';
+      output.append(str->value, segment.start, segment.length);
+      output += '}';
+      continue;
+    }
+
+    for (size_t i = segment.start; i < segment.start + segment.length; i++) {
+      const char character = str->value[i];
+      if (character == '{' || character == '}') output += character;
+      output += character;
     }
-    return output;
   }
+
+  output += '"';
+  return output;
 }
 
 std::string Transpiler::handle_literal(const Expression* literal) {
@@ -76,15 +359,22 @@ std::string Transpiler::handle_expression(
     case Expression::Variant::ASSIGNMENT:
     case Expression::Variant::PROPERTY_ACCESS:
     case Expression::Variant::BINARY: {
-      auto binary = static_cast<const BinaryExpression*>(expression);
-      std::string indent = Utils::get_indent(indentation);
-      std::string left = handle_expression(binary->left);
-      std::string right = handle_expression(binary->right);
-      
-      if (expression->variant != Expression::Variant::PROPERTY_ACCESS) {
-        output += indent + left + " " + binary->operation + " " + right;
-      } else output += indent + left + "." + right;
-      
+      output += Utils::get_indent(indentation);
+
+      // Chains lean right, so the spine is walked instead of recursed into
+      const Expression *node = expression;
+      while (node->is_binary()) {
+        auto binary = static_cast<const BinaryExpression*>(node);
+        output += handle_expression(binary->left);
+
+        if (binary->variant != Expression::Variant::PROPERTY_ACCESS) {
+          output += " " + binary->operation + " ";
+        } else output += ".";
+
+        node = binary->right.get();
+      }
+
+      output += handle_expression(node);
       break;
     }
     case Expression::Variant::IDENTIFIER: {
@@ -114,69 +404,112 @@ std::string Transpiler::handle_expression(
       break;
     }
     default:
-      println("Expression Unsupported");
+      report("Expression Unsupported");
   }
 
   return output;
 }
 
 void Transpiler::handle_statement(const std::unique_ptr<Statement> &statement, const size_t &indentation) {
+  // Bodies are queued on an explicit stack so deeply nested programs don't recurse
+  std::vector<Pending> pending = {{statement.get(), indentation, ""}};
+
+  while (not pending.empty()) {
+    Pending item = std::move(pending.back());
+    pending.pop_back();
+
+    if (not item.statement) {
+      output += item.text;
+      continue;
+    }
+
+    std::vector<Pending> body;
+    expand_statement(item.statement, item.indentation, body);
+    pending.insert(pending.end(), std::make_move_iterator(body.rbegin()), std::make_move_iterator(body.rend()));
+  }
+}
+
+void Transpiler::expand_statement(
+  const Statement *statement, 
+  const size_t &indentation, 
+  std::vector<Pending> &body
+) {
   if (statement->kind == Statement::Kind::EXPRESSION) {
-    output += handle_expression(statement, indentation) + "\n";
+    output += handle_expression(static_cast<const Expression *>(statement), indentation) + "\n";
     return;
   }
 
+  auto push_children = [&](const Statement *parent) {
+    for (const auto &child : parent->children) {
+      body.push_back({child.get(), indentation + 2, ""});
+    }
+  };
+
   std::string indent = Utils::get_indent(indentation); 
   switch (statement->type) {
     case Statement::Type::VARIABLE_DECLARATION: {
-      auto variable = static_cast<Variable *>(statement.get());
-      output += indent + variable->name + " = " + handle_expression(variable->value);
+      auto variable = static_cast<const Variable *>(statement);
+      auto annotation = annotations.find(variable);
+      output += indent + variable->name;
+      if (annotation != annotations.end()) output += annotation->second;
+      output += " = " + handle_expression(variable->value);
       break;
     }
     case Statement::Type::FUNCTION_DECLARATION: {
-      auto function = static_cast<Function *>(statement.get());
+      auto function = static_cast<const Function *>(statement);
+
+      if (function->is_native && indentation == 0) {
+        output += Native::emit_stub(function, Native::build(function));
+        break;
+      }
+
       output += indent + "def " + function->name + "(";
 
       for (size_t i = 0; i < function->parameters.size(); i++) {
-        output += function->parameters[i]->name;
+        output += get_parameter(function->parameters[i].get());
         if (i < function->parameters.size() - 1) {
           output += ", ";
         }
       }
 
-      output += "):\n";
-      for (const auto &statement : function->children) {
-        handle_statement(statement, indentation + 2);
-      }
+      output += ")";
+      if (mode == Mode::ANNOTATED) output += get_return(function);
+      output += ":\n";
+      if (mode != Mode::PYTHON) output += declare_locals(function, indentation + 2);
+      push_children(function);
       break;
     }
     case Statement::Type::IF_STATEMENT: {
-      auto if_statement = static_cast<If *>(statement.get());
+      auto if_statement = static_cast<const If *>(statement);
       output += indent + "if " + handle_expression(if_statement->condition) + ":\n";
-      for (const auto &statement : if_statement->children) {
-        handle_statement(statement, indentation + 2);
-      }
+      push_children(if_statement);
+
+      // else if chains become a flat elif ladder
+      while (if_statement->else_block) {
+        const Else *else_block = if_statement->else_block.get();
+        const Statement *owner = else_block->get_body_owner();
 
-      if (if_statement->else_block) {
-        output += indent + "else:\n";
-        for (const auto &statement : if_statement->else_block->children) {
-          handle_statement(statement, indentation + 2);
+        if (owner == else_block) {
+          body.push_back({nullptr, 0, indent + "else:\n"});
+          push_children(else_block);
+          break;
         }
+
+        if_statement = static_cast<const If *>(owner);
+        body.push_back({nullptr, 0, indent + "elif " + handle_expression(if_statement->condition) + ":\n"});
+        push_children(if_statement);
       }
 
       break;
     }
     case Statement::Type::MATCH_STATEMENT: {
-      auto match = static_cast<Match *>(statement.get());
+      auto match = static_cast<const Match *>(statement);
       output += indent + "match " + handle_expression(match->condition) + ":\n";
-      
-      for (const auto &statement : match->children) {
-        handle_statement(statement, indentation + 2);
-      }
+      push_children(match);
       break;
     }
     case Statement::Type::WHEN_STATEMENT: {
-      auto when = static_cast<When *>(statement.get());
+      auto when = static_cast<const When *>(statement);
 
       std::vector<std::string> conditions;
 
@@ -185,43 +518,55 @@ void Transpiler::handle_statement(const std::unique_ptr<Statement> &statement, c
       }
 
       output += indent + "case " + Utils::join(conditions, " | ") + ":\n";
-      for (const auto &statement : when->children) {
-        handle_statement(statement, indentation + 2);
-      }
+      push_children(when);
       break;
     }
     case Statement::Type::ELSE_STATEMENT: {
-      const auto else_statement = static_cast<Else *>(statement.get());
+      const auto else_statement = static_cast<const Else *>(statement);
 
       if (else_statement->is_match_else) {
         output += indent + "case _:\n";
-        for (const auto &statement : else_statement->children) {
-          handle_statement(statement, indentation + 2);
-        }
+        push_children(else_statement);
       } else {
         throw std::runtime_error("DEV: Unpaired Else Statement");
       }
 
       break;
     }
+    case Statement::Type::IMPORT_STATEMENT: {
+      std::string module = static_cast<const Import *>(statement)->module;
+      Utils::replace(module, "/", ".");
+      output += indent + "from " + module + " import *";
+      break;
+    }
+    case Statement::Type::RETURN_STATEMENT: {
+      const auto jump = static_cast<const Jump *>(statement);
+      output += indent + "return";
+      if (jump->value) output += " " + handle_expression(jump->value);
+      break;
+    }
+    case Statement::Type::BREAK_STATEMENT: {
+      output += indent + "break";
+      break;
+    }
+    case Statement::Type::CONTINUE_STATEMENT: {
+      output += indent + "continue";
+      break;
+    }
     case Statement::Type::LOOP_STATEMENT: {
-      handle_loop_statement(statement, indentation);
+      handle_loop_statement(static_cast<const For *>(statement), indentation);
+      push_children(statement);
       break;
     }
     default:      
-      println("Statement Unsupported");
+      report("Statement Unsupported");
   }
 
-  output += "\n";
+  body.push_back({nullptr, 0, "\n"});
 }
 
 // TODO: Implement Checker for better loop understaning and compiling
-void Transpiler::handle_loop_statement(const std::unique_ptr<Statement> &statement, const size_t indentation) {
-  if (statement->type != Statement::Type::LOOP_STATEMENT) {
-    throw std::runtime_error("DEV: Expected Loop Statement");
-  }
-
-  auto loop = static_cast<For *>(statement.get());
+void Transpiler::handle_loop_statement(const For *loop, const size_t indentation) {
   std::string indent = Utils::get_indent(indentation);
 
   if (loop->index && loop->index->literal == Token::Literal::FLOAT) {
@@ -240,33 +585,33 @@ void Transpiler::handle_loop_statement(const std::unique_ptr<Statement> &stateme
       break;
     }
     case For::Variant::TIMES: {
-      std::unique_ptr<Expression> index = std::move(loop->index);
-      output += indent + "for _ in range(" + handle_expression(index) + "):\n";
+      output += indent + "for _ in range(" + handle_expression(loop->index) + "):\n";
       break;
     }
     default: {
-      std::unique_ptr<Expression> index = std::move(loop->index);
-      std::unique_ptr<Expression> limit = std::move(loop->limit);
-
-      if (limit->literal == Token::Literal::INTEGER) {
-        output += indent + "for " + handle_expression(index) + " in range(" + handle_expression(limit) + "):\n";
+      auto view = views.find(loop);
+
+      if (view != views.end()) {
+        // Read straight from the buffer, one element at a time
+        std::string index = handle_expression(loop->index);
+        std::string at = "_pino_" + index + "_at";
+        output += indent + "for " + at + " in range(" + view->second + ".shape[0]):\n";
+        output += Utils::get_indent(indentation + 2) + index + " = " + view->second + "[" + at + "]\n";
+      } else if (loop->limit->literal == Token::Literal::INTEGER) {
+        output += indent + "for " + handle_expression(loop->index) + " in range(" + handle_expression(loop->limit) + "):\n";
       } else {
-        output += indent + "for " + handle_expression(index) + " in " + handle_expression(limit) + ":\n";
+        output += indent + "for " + handle_expression(loop->index) + " in " + handle_expression(loop->limit) + ":\n";
       }
       
       break;    
     }
   }
-
-  for (const auto &statement : loop->children) {
-    handle_statement(statement, indentation + 2);
-  }
 }
 
-void Transpiler::transpile(const std::string &file_path, const std::string &output_path) {
-  Statement stream = Parser::parse(file_path);
+void Transpiler::emit_range(const Statement &program, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    const auto &statement = program.children[i];
 
-  for (const auto &statement : stream.children) {
     switch (statement->kind) {
       case Statement::Kind::STATEMENT: {
         handle_statement(statement);
@@ -277,9 +622,100 @@ void Transpiler::transpile(const std::string &file_path, const std::string &outp
         break;
       }
       default:
-        println("Kind Unsupported");
+        report("Kind Unsupported");
     }
   }
+}
+
+void Transpiler::restart() {
+  is_native_imported = false;
+}
+
+const std::string &Transpiler::emit(const Statement &program, size_t jobs) {
+  output.clear();
+  annotations.clear();
+  views.clear();
+
+  // Imported ahead of the first native function, for its stub and any after it
+  for (const auto &statement : program.children) {
+    if (is_native_imported) break;
+
+    bool is_native =
+      statement->kind == Statement::Kind::STATEMENT &&
+      statement->type == Statement::Type::FUNCTION_DECLARATION &&
+      static_cast<const Function *>(statement.get())->is_native;
+
+    if (not is_native) continue;
+
+    output += Native::get_imports();
+    is_native_imported = true;
+  }
+
+  size_t count = program.children.size();
+  size_t workers = std::min(jobs, count / PARALLEL_EMIT_MINIMUM);
+
+  if (workers <= 1) {
+    emit_range(program, 0, count);
+    return output;
+  }
+
+  // A few parts per worker, so stealing can even out statements of uneven size
+  struct Part {
+    std::string output;
+    Diagnostics diagnostics = Diagnostics(false);
+    std::exception_ptr error;
+  };
+
+  size_t part_count = std::min(count, workers * PARALLEL_EMIT_PARTS);
+  std::vector<Part> parts(part_count);
+  Pool pool(workers, part_count);
+
+  auto work = [&](size_t worker) {
+    size_t job;
+
+    while (pool.next(worker, job)) {
+      Part &part = parts[job];
+      Transpiler transpiler(&part.diagnostics, mode);
+      transpiler.typings = typings;
+
+      try {
+        transpiler.emit_range(program, job * count / part_count, (job + 1) * count / part_count);
+      } catch (...) {
+        part.error = std::current_exception();
+      }
+
+      part.output = std::move(transpiler.output);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t worker = 1; worker < workers; worker++) {
+    threads.emplace_back(work, worker);
+  }
+
+  work(0);
+  for (std::thread &thread : threads) thread.join();
+
+  // A part stops at its first error, which is where emitting serially would have stopped
+  for (Part &part : parts) {
+    output += part.output;
+
+    for (const Diagnostic &diagnostic : part.diagnostics.entries) {
+      diagnostics->report(diagnostic.stage, diagnostic.message, diagnostic.severity, diagnostic.line);
+    }
+
+    if (part.error) std::rethrow_exception(part.error);
+  }
+
+  return output;
+}
+
+void Transpiler::transpile(const std::string &file_path, const std::string &output_path) {
+  std::ifstream input(file_path);
+  std::ofstream file(output_path);
 
-  Utils::write_file(output_path, output);
+  // Written as each top level statement is done, so neither the tree nor the output piles up
+  Parser::parse_each(input, [&](Statement &program) {
+    file << emit(program);
+  });
 }
\ No newline at end of file
@@ -1,38 +1,104 @@
 #pragma once
 
+#include <map>
 #include "Utils.h"
+#include "Diagnostic.h"
+#include "Checker.h"
 #include "Parser.cpp"
 #include "Statement.cpp"
 
 class Transpiler {
-  std::string output;
+  public:
+    // How much of what the checker found is written into the output
+    enum class Mode {
+      PYTHON,
+      // Cython, with cdef locals, typed signatures and loops over arrays of
+      // numbers read through typed memoryviews
+      CYTHON,
+      // Python annotated where the types are known, for mypyc
+      ANNOTATED,
+    };
 
-  std::string handle_arr_literal(const Expression* literal);
-  std::string handle_str_literal(const Expression* literal);
-  std::string handle_literal(const Expression* literal);
+  private:
+    // A statement still to be emitted, or text to emit once its body is done
+    struct Pending {
+      const Statement *statement;
+      size_t indentation;
+      std::string text;
+    };
+
+    std::string output;
+    Diagnostics echoed;
+    Diagnostics *diagnostics;
+    Mode mode;
+    const Typings *typings = nullptr;
+    // Set once the output has imported what the stubs of native functions use
+    bool is_native_imported = false;
+
+    // Declarations annotated where they stand, each the first of its name in
+    // its function, and loops lowered to index the memoryview they are mapped to
+    std::map<const Statement *, std::string> annotations;
+    std::map<const Statement *, std::string> views;
+
+    void report(const std::string &message);
+
+    // The type written for a typing in the current mode, empty when it has none
+    std::string get_type(const Typing &typing) const;
+    std::string get_parameter(const Variable *parameter) const;
+    // The return annotation of a function, when its returns agree and it can't
+    // fall off its end, or -> None when none gives a value
+    std::string get_return(const Function *function) const;
+    // Types the locals of a function, returning the cdef lines that open its body
+    std::string declare_locals(const Function *function, size_t indentation);
+
+    std::string handle_arr_literal(const Expression* literal);
+    std::string handle_str_literal(const Expression* literal);
+    std::string handle_literal(const Expression* literal);
     
-  std::string handle_expression(
-    const std::unique_ptr<Statement> &statement,
-    const size_t &indentation = 0
-  );
-  std::string handle_expression(
-    const std::unique_ptr<Expression> &expression,
-    const size_t &indentation = 0
-  );
-  std::string handle_expression(
-    const Expression *expression, 
-    const size_t &indentation = 0
-  );
-
-  void handle_statement(
-    const std::unique_ptr<Statement> &statement,
-    const size_t &indentation = 0
-  );
-  void handle_loop_statement(
-    const std::unique_ptr<Statement> &statement,
-    const size_t indentation = 0
-  );
-
-  public: 
+    std::string handle_expression(
+      const std::unique_ptr<Statement> &statement,
+      const size_t &indentation = 0
+    );
+    std::string handle_expression(
+      const std::unique_ptr<Expression> &expression,
+      const size_t &indentation = 0
+    );
+    std::string handle_expression(
+      const Expression *expression, 
+      const size_t &indentation = 0
+    );
+
+    void handle_statement(
+      const std::unique_ptr<Statement> &statement,
+      const size_t &indentation = 0
+    );
+    void expand_statement(
+      const Statement *statement,
+      const size_t &indentation,
+      std::vector<Pending> &body
+    );
+    void handle_loop_statement(const For *loop, const size_t indentation = 0);
+
+    // Emits the top level statements in [begin, end) onto the end of output
+    void emit_range(const Statement &program, size_t begin, size_t end);
+
+  public:
+    // Unsupported nodes are printed unless a sink is given to collect them
+    Transpiler(Diagnostics *diagnostics = nullptr, Mode mode = Mode::PYTHON);
+
+    // What the output of a mode starts with, before any program
+    static std::string get_header(Mode mode);
+
+    // Types of the declarations of the programs emitted from now on
+    void set_typings(const Typings *typings);
+
+    // Starts another output, as the programs emitted so far made up one module
+    void restart();
+
+    // With more than one job, runs of top level statements are emitted into
+    // buffers of their own on a pool and spliced back in source order, so the
+    // output and diagnostics are the same as emitting them one after another
+    const std::string &emit(const Statement &program, size_t jobs = 1);
+
     void transpile(const std::string &file_path, const std::string &output_path);
 };
\ No newline at end of file
@@ -73,6 +73,10 @@ void Typing::from_expression(const std::unique_ptr<Expression> &expression) {
   }
 }
 
+bool Typing::operator==(const Typing &other) const {
+  return data == other.data && value == other.value && children == other.children;
+}
+
 Typing Typing::create(const Token::Literal &literal) {
   Typing typing;
   typing.data = literal;
@@ -24,4 +24,6 @@ class Typing {
     void print(size_t indent = 0) const;
 
     std::string to_string(size_t indent = 0, const bool &is_child = false) const;
+
+    bool operator==(const Typing &other) const;
 };
\ No newline at end of file
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <vector>
+#include <unistd.h>
 
 template <typename T>
 struct Peek {
@@ -114,6 +120,79 @@ namespace Utils {
     file.close();
   }
 
+  std::string read_file(const std::string &file_path) {
+    std::ifstream file(file_path);
+    if (not file) throw std::runtime_error("USER: Unable to read '" + file_path + "'");
+
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  // Unique to the process and thread, so concurrent writers never share one
+  std::string get_temporary_path(const std::string &file_path) {
+    std::ostringstream temporary;
+    temporary << file_path << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    return temporary.str();
+  }
+
+  // Readers see either the old content or the new one, never a partial write
+  void write_file_atomic(const std::string &file_path, const std::string &content) {
+    std::string temporary = get_temporary_path(file_path);
+
+    std::ofstream file(temporary, std::ios::binary);
+    file << content;
+    file.close();
+
+    if (not file) {
+      std::filesystem::remove(temporary);
+      throw std::runtime_error("USER: Unable to write '" + file_path + "'");
+    }
+
+    std::filesystem::rename(temporary, file_path);
+  }
+
+  // 64 bit FNV-1a, stable across runs and machines so it can be stored on disk
+  // Continuing from the hash of what came before gives the hash of the two joined
+  uint64_t hash(const std::string &content, uint64_t result = 14695981039346656037ull) {
+    for (unsigned char character : content) {
+      result ^= character;
+      result *= 1099511628211ull;
+    }
+    return result;
+  }
+
+  std::string to_hex(uint64_t value) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+  }
+
+  // Strings keep their escapes as written, which the Python output leaves to Python
+  std::string unescape(const std::string &text) {
+    std::string result;
+
+    for (size_t i = 0; i < text.size(); i++) {
+      if (text[i] != '\\' || i + 1 == text.size()) {
+        result += text[i];
+        continue;
+      }
+
+      char escaped = text[++i];
+
+      switch (escaped) {
+        case 'n': result += '\n'; break;
+        case 't': result += '\t'; break;
+        case 'r': result += '\r'; break;
+        case '0': result += '\0'; break;
+        case '\\': case '"': case '\'': result += escaped; break;
+        default: result += '\\'; result += escaped;
+      }
+    }
+
+    return result;
+  }
+
   void replace(std::string &line, const std::string &target, const std::string &replacement) {
     size_t index = 0;
     
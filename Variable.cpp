@@ -10,6 +10,15 @@ Variable::Variable() {
   kind = Kind::STATEMENT;
 }
 
+Variable::~Variable() {
+  dismantle();
+}
+
+void Variable::release(std::vector<std::unique_ptr<Statement>> &pending) {
+  hand_over(pending, value);
+  Statement::release(pending);
+}
+
 PeekPtr<Variable> Variable::build(Stream &stream, const size_t &start_index) {
   Keyword keyword = Token::get_keyword(
     stream.at(start_index).data
@@ -35,6 +44,7 @@ PeekPtr<Variable> Variable::build(Stream &stream, const size_t &start_index) {
   
   result.data->typing.from_expression(value.data);
   result.data->name = name.data.data;
+  result.data->line = name.data.line;
   result.data->value = std::move(value.data);
   result.end_index = value.end_index;
   return result;
@@ -71,6 +81,7 @@ PeekPtr<Variable> Variable::build_as_field(Stream &stream, const size_t &start_i
   }
 
   result.data->name = name.data.data;
+  result.data->line = name.data.line;
   result.data->is_field = true;
   return result;
 }
@@ -85,31 +96,32 @@ PeekPtr<Variable> Variable::build_as_property(Stream &stream, const size_t &star
 
   result.data->typing.from_expression(value.data);
   result.data->name = name.data.data;
+  result.data->line = name.data.line;
   result.data->value = std::move(value.data);
   result.end_index = value.end_index;
   return result;
 }
 
-void Variable::print(size_t indent) const {
+void Variable::describe(Printer &printer, size_t indent) const {
   std::string indentation = Utils::get_indent(indent);
 
   if (is_field) {
-    println(indentation + "Field {");
+    printer.line(indentation + "Field {");
   } else if (is_constant) {
-    println(indentation + "Constant {");
+    printer.line(indentation + "Constant {");
   } else {
-    println(indentation + "Variable {");
+    printer.line(indentation + "Variable {");
   }
 
-  println(indentation + "  name: " + name);
+  printer.line(indentation + "  name: " + name);
 
   if (value != nullptr) {
-    println(
+    printer.line(
       indentation + (is_field ? "  default: " : "  value: ") + value->to_string(indent + 1)
     );
   }
   
-  println(indentation + "  type: " + typing.to_string(indent + 1));  
+  printer.line(indentation + "  type: " + typing.to_string(indent + 1));  
 
-  println(indentation + "}");
+  printer.line(indentation + "}");
 }
\ No newline at end of file
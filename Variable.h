@@ -17,9 +17,13 @@ class Variable : public Statement {
 
     Variable();
 
+    ~Variable() override;
+
+    void release(std::vector<std::unique_ptr<Statement>> &pending) override;
+
     static PeekPtr<Variable> build(Stream &stream, const size_t &start_index);
     static PeekPtr<Variable> build_as_field(Stream &stream, const size_t &start_index);
     static PeekPtr<Variable> build_as_property(Stream &stream, const size_t &start_index);
 
-    virtual void print(size_t indent = 0) const;
+    void describe(Printer &printer, size_t indent) const override;
 };
\ No newline at end of file
@@ -1,8 +1,96 @@
 #include "Parser.cpp"
 #include "Checker.cpp"
 #include "Transpiler.cpp"
+#include "Bench.cpp"
+#include "Build.cpp"
+#include "Daemon.cpp"
+#include "LanguageServer.cpp"
+#include "Index.cpp"
+#include "Pipeline.cpp"
+#include "Machine.cpp"
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> arguments(argv + 1, argv + argc);
+
+  if (not arguments.empty() && arguments[0] == "complexity") {
+    return Bench::complexity() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "compile") {
+    return Pipeline::run(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "run") {
+    return Machine::run(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "build") {
+    return Build::run(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "daemon") {
+    return Daemon::run(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "client") {
+    return Daemon::request(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "index") {
+    return Index::run(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "references") {
+    return Index::query(std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+  }
+
+  if (not arguments.empty() && arguments[0] == "lsp") {
+    LanguageServer server;
+    return server.serve();
+  }
+
+  if (not arguments.empty() && arguments[0] == "lsp-bench") {
+    return Bench::language_server() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "stream-bench") {
+    size_t megabytes = arguments.size() > 1 ? std::stoul(arguments[1]) : 64;
+    return Bench::streaming(megabytes) ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "pipeline-bench") {
+    size_t megabytes = arguments.size() > 1 ? std::stoul(arguments[1]) : 16;
+    return Bench::pipelining(megabytes) ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "emit-bench") {
+    return Bench::emission() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "native-bench") {
+    return Bench::native() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "machine-bench") {
+    return Bench::machine() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "inline-bench") {
+    return Bench::inlining() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "tail-bench") {
+    return Bench::tail_calls() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "stress") {
+    return Bench::stress() ? 0 : 1;
+  }
+
+  if (not arguments.empty() && arguments[0] == "regressions") {
+    return Bench::regressions() ? 0 : 1;
+  }
 
-int main() {
   Statement program = Parser::parse("index.pino");
   program.print();
   // Checker checker(program);